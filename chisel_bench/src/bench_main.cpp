@@ -0,0 +1,241 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+/**
+ * @file bench_main.cpp
+ * @brief Benchmark harness: per-processor recompression cost and
+ * ThreadPool scaling, reported as machine-readable JSON.
+ *
+ * Runs every supporting IProcessor::recompress() over the checked-in
+ * fixture corpus (or a corpus directory given as argv[1]) and reports
+ * wall time, ns/byte and process peak RSS per run, then exercises the
+ * ThreadPool with a synthetic task mix from 1..hardware threads. The
+ * JSON goes to stdout so runs can be diffed across versions.
+ */
+
+#include "../../libchisel/include/processor_registry.hpp"
+#include "../../libchisel/include/mime_detector.hpp"
+#include "../../libchisel/include/thread_pool.hpp"
+#include "../../libchisel/include/file_utils.hpp"
+#include "../../libchisel/include/logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace fs = std::filesystem;
+using namespace chisel;
+
+namespace {
+
+/// Process peak RSS in KiB (0 where unavailable).
+uintmax_t peak_rss_kib() {
+#ifdef _WIN32
+    return 0;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<uintmax_t>(usage.ru_maxrss) / 1024; // bytes on macOS
+#else
+    return static_cast<uintmax_t>(usage.ru_maxrss); // KiB on Linux
+#endif
+#endif
+}
+
+std::string json_escape(const std::string& in) {
+    std::string out;
+    out.reserve(in.size());
+    for (const char c : in) {
+        if (c == '"' || c == '\\') out.push_back('\\');
+        out.push_back(c);
+    }
+    return out;
+}
+
+struct ProcessorRun {
+    std::string processor;
+    std::string fixture;
+    uintmax_t input_bytes = 0;
+    uintmax_t output_bytes = 0;   // 0 if the run failed
+    double seconds = 0.0;         // best of the repeats
+    double ns_per_byte = 0.0;
+    uintmax_t peak_rss_kib = 0;   // process peak after the run (monotonic)
+    bool ok = false;
+};
+
+struct PoolRun {
+    unsigned threads = 0;
+    size_t tasks = 0;
+    double seconds = 0.0;
+    double tasks_per_sec = 0.0;
+};
+
+/**
+ * @brief Times one processor over one fixture, best-of-N wall time.
+ *
+ * Works on a scratch copy so processors that rewrite their input can't
+ * touch the corpus.
+ */
+ProcessorRun bench_processor(IProcessor& proc, const fs::path& fixture, const fs::path& scratch,
+                             const int repeats) {
+    ProcessorRun run;
+    run.processor = std::string(proc.get_name());
+    run.fixture = fixture.filename().string();
+    std::error_code ec;
+    run.input_bytes = fs::file_size(fixture, ec);
+    if (ec || run.input_bytes == 0) return run;
+
+    double best = -1.0;
+    for (int i = 0; i < repeats; ++i) {
+        const fs::path in = scratch / (fixture.filename().string() + ".in");
+        const fs::path out = scratch / (fixture.filename().string() + ".out");
+        fs::copy_file(fixture, in, fs::copy_options::overwrite_existing, ec);
+        if (ec) return run;
+
+        const auto start = std::chrono::steady_clock::now();
+        try {
+            proc.recompress(in, out, /*preserve_metadata=*/true);
+        } catch (const std::exception&) {
+            fs::remove(in, ec);
+            fs::remove(out, ec);
+            return run;
+        }
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::error_code size_ec;
+        const auto out_size = fs::file_size(out, size_ec);
+        fs::remove(in, ec);
+        fs::remove(out, ec);
+        if (size_ec || out_size == 0) return run;
+        run.output_bytes = out_size;
+        if (best < 0.0 || secs < best) best = secs;
+    }
+
+    run.seconds = best;
+    run.ns_per_byte = best * 1e9 / static_cast<double>(run.input_bytes);
+    run.peak_rss_kib = peak_rss_kib();
+    run.ok = true;
+    return run;
+}
+
+/**
+ * @brief Drives the ThreadPool with a synthetic mix at a given width.
+ *
+ * The mix mimics the executor's workload shape: many small CPU-bound
+ * tasks plus a few large ones, enqueued with size-like priorities.
+ */
+PoolRun bench_pool(const unsigned threads) {
+    constexpr size_t small_tasks = 4096;
+    constexpr size_t large_tasks = 32;
+    constexpr size_t small_bytes = 64 * 1024;
+    constexpr size_t large_bytes = 4 * 1024 * 1024;
+
+    const std::vector<std::byte> small_buf(small_bytes, std::byte{0x5a});
+    const std::vector<std::byte> large_buf(large_bytes, std::byte{0xa5});
+
+    PoolRun run;
+    run.threads = threads;
+    run.tasks = small_tasks + large_tasks;
+
+    const auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(threads);
+        for (size_t i = 0; i < small_tasks; ++i) {
+            pool.enqueue([&small_buf](const std::stop_token&) {
+                StreamingChecksum sum;
+                sum.update(small_buf);
+                volatile auto sink = sum.value();
+                (void)sink;
+            }, small_bytes);
+        }
+        for (size_t i = 0; i < large_tasks; ++i) {
+            pool.enqueue([&large_buf](const std::stop_token&) {
+                StreamingChecksum sum;
+                sum.update(large_buf);
+                volatile auto sink = sum.value();
+                (void)sink;
+            }, large_bytes);
+        }
+        pool.wait_idle();
+    }
+    run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    run.tasks_per_sec = run.seconds > 0.0 ? static_cast<double>(run.tasks) / run.seconds : 0.0;
+    return run;
+}
+
+} // namespace
+
+int main(const int argc, char** argv) {
+    const fs::path corpus = argc > 1 ? fs::path(argv[1]) : fs::path(CHISEL_BENCH_FIXTURES);
+    if (!fs::is_directory(corpus)) {
+        std::cerr << "corpus directory not found: " << corpus.string() << "\n";
+        return 1;
+    }
+
+    constexpr int repeats = 3;
+    ProcessorRegistry registry;
+
+    const fs::path scratch = make_temp_dir_for(corpus / "bench", "bench");
+
+    std::vector<ProcessorRun> proc_runs;
+    std::vector<fs::path> fixtures;
+    for (const auto& entry : fs::directory_iterator(corpus)) {
+        if (entry.is_regular_file()) fixtures.push_back(entry.path());
+    }
+    std::sort(fixtures.begin(), fixtures.end());
+
+    for (const auto& fixture : fixtures) {
+        auto procs = registry.find_by_mime(MimeDetector::detect(fixture));
+        if (procs.empty()) {
+            procs = registry.find_by_extension(fixture.extension().string());
+        }
+        for (auto* proc : procs) {
+            if (!proc->can_recompress()) continue;
+            proc_runs.push_back(bench_processor(*proc, fixture, scratch, repeats));
+        }
+    }
+
+    cleanup_temp_dir(scratch, "bench");
+
+    std::vector<PoolRun> pool_runs;
+    const unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned n = 1; n <= max_threads; n *= 2) {
+        pool_runs.push_back(bench_pool(n));
+        if (n != max_threads && n * 2 > max_threads) {
+            pool_runs.push_back(bench_pool(max_threads));
+            break;
+        }
+    }
+
+    std::cout << "{\n  \"processors\": [";
+    for (size_t i = 0; i < proc_runs.size(); ++i) {
+        const auto& r = proc_runs[i];
+        std::cout << (i ? "," : "") << "\n    {\"processor\": \"" << json_escape(r.processor)
+                  << "\", \"fixture\": \"" << json_escape(r.fixture)
+                  << "\", \"ok\": " << (r.ok ? "true" : "false")
+                  << ", \"input_bytes\": " << r.input_bytes
+                  << ", \"output_bytes\": " << r.output_bytes
+                  << ", \"seconds\": " << r.seconds
+                  << ", \"ns_per_byte\": " << r.ns_per_byte
+                  << ", \"peak_rss_kib\": " << r.peak_rss_kib << "}";
+    }
+    std::cout << "\n  ],\n  \"thread_pool\": [";
+    for (size_t i = 0; i < pool_runs.size(); ++i) {
+        const auto& r = pool_runs[i];
+        std::cout << (i ? "," : "") << "\n    {\"threads\": " << r.threads
+                  << ", \"tasks\": " << r.tasks
+                  << ", \"seconds\": " << r.seconds
+                  << ", \"tasks_per_sec\": " << r.tasks_per_sec << "}";
+    }
+    std::cout << "\n  ]\n}\n";
+    return 0;
+}
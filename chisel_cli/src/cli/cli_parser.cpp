@@ -7,6 +7,7 @@
 #include "CLI11.hpp"
 #include <thread>
 #include <algorithm>
+#include <cstdio>
 #include <map>
 
 namespace {
@@ -29,7 +30,7 @@ struct ContainerFormatValidator : CLI::Validator {
 void setup_cli_parser(CLI::App& app, Settings& settings) {
     // setup standard help and version flags
     app.set_help_flag("-h,--help", "Show this help message and exit.");
-    app.set_version_flag("--version", "1.0.1");
+    app.set_version_flag("--version", chisel_version);
 
     // --- Flags (booleans) ---
     app.add_flag("--no-meta", settings.no_meta,
@@ -47,6 +48,21 @@ void setup_cli_parser(CLI::App& app, Settings& settings) {
     app.add_flag("--verify-checksums", settings.verify_checksums,
                  "Verify raw checksums before replacing files.");
 
+    app.add_flag("--dedup", settings.dedup,
+                 "Detect byte-identical files and recompress each content once,\n"
+                 "applying the result to all copies.");
+
+    app.add_flag("--estimate", settings.estimate,
+                 "Sample the corpus and print a forecast of expected savings\n"
+                 "and run time instead of processing it; nothing is modified.");
+
+    app.add_option("--sample-size", settings.sample_size,
+                   "Files recompressed per (MIME, size bucket) stratum in\n"
+                   "--estimate mode (default: 5).")
+                   ->default_val(5)
+                   ->check(CLI::PositiveNumber)
+                   ->take_last();
+
     app.add_option("-o,--output", settings.output_path,
                    "Write optimized files to PATH instead of modifying in-place.\n"
                    "(If input is stdin, PATH is a file. Otherwise, PATH is a directory).");
@@ -55,6 +71,41 @@ void setup_cli_parser(CLI::App& app, Settings& settings) {
                    "CSV report export filename.")
                    ->take_last(); // if used multiple times, take the last one
 
+    app.add_option("--cache", settings.cache_path,
+                   "Persistent result cache database PATH; files already known\n"
+                   "to be unimprovable are skipped on later runs.")
+                   ->take_last();
+
+    app.add_option("--gain-model", settings.gain_model_path,
+                   "Persistent per-stage gain/cost statistics database PATH;\n"
+                   "candidates are ordered best-ratio-first and stages the\n"
+                   "statistics predict pointless on this corpus are skipped.")
+                   ->take_last();
+
+    app.add_option("--journal", settings.journal_path,
+                   "Crash-safe run journal PATH recording per-file completion.")
+                   ->take_last();
+
+    app.add_option("--incremental", settings.incremental_path,
+                   "Persist per-directory signatures to the database at PATH and\n"
+                   "skip descending into directories unchanged since the previous\n"
+                   "run; only changed subtrees are re-scanned.")
+                   ->take_last();
+
+    app.add_option("--files-from", settings.files_from,
+                   "Read NUL-delimited input paths from FILE ('-' for stdin,\n"
+                   "find -print0 compatible) instead of scanning directories.")
+                   ->take_last();
+
+    app.add_option("--trace", settings.trace_path,
+                   "Record pipeline spans and write a Chrome trace_event JSON\n"
+                   "to PATH (open in chrome://tracing or Perfetto).")
+                   ->take_last();
+
+    app.add_flag("--resume", settings.resume,
+                 "Skip files the journal marks as completed by an interrupted run.\n"
+                 "(Requires --journal).");
+
     // calculate default thread count
     settings.num_threads = std::max(1U, std::thread::hardware_concurrency() / 2);
     app.add_option("--threads", settings.num_threads,
@@ -62,6 +113,56 @@ void setup_cli_parser(CLI::App& app, Settings& settings) {
                    ->default_val(settings.num_threads)
                    ->check(CLI::PositiveNumber);
 
+    app.add_option("--effort", settings.effort,
+                   "Effort level: 1 (fast), 2 (default), 3 (deep). Scales\n"
+                   "iteration counts and per-file time budgets of slow codecs.")
+                   ->default_val(2)
+                   ->check(CLI::Range(1, 3));
+
+    app.add_option("--pipe-prune", settings.pipe_prune,
+                   "PIPE mode: skip expensive stages (e.g. ZopfliPNG) when the\n"
+                   "previous stage gained less than this fraction (default:\n"
+                   "0.001 = 0.1%; a negative value disables pruning).")
+                   ->default_val(0.001)
+                   ->take_last();
+
+    app.add_option("--memory-budget", settings.memory_budget,
+                   "Cap the estimated memory of concurrent recompressions\n"
+                   "(accepts suffixes, e.g. 4GiB; default: unlimited).")
+                   ->transform(CLI::AsSizeValue(false))
+                   ->take_last();
+
+    app.add_option("--temp-budget", settings.temp_budget,
+                   "Cap the extracted container bytes held on the temp volume;\n"
+                   "further extractions stall until finalized containers\n"
+                   "reclaim space (accepts suffixes; default: unlimited).")
+                   ->transform(CLI::AsSizeValue(false))
+                   ->take_last();
+
+    app.add_option("--min-size", settings.min_size,
+                   "Skip files smaller than SIZE; tiny files cost more in\n"
+                   "overhead than they can ever save (accepts suffixes,\n"
+                   "e.g. 4KiB; default: no minimum).")
+                   ->transform(CLI::AsSizeValue(false))
+                   ->take_last();
+
+    app.add_option("--max-size", settings.max_size,
+                   "Skip files larger than SIZE (accepts suffixes, e.g. 2GiB;\n"
+                   "default: no maximum).")
+                   ->transform(CLI::AsSizeValue(false))
+                   ->take_last();
+
+    app.add_flag("--nice", settings.nice_mode,
+                 "Run workers in the platform's idle CPU and I/O classes:\n"
+                 "full speed on a quiet box, automatic yielding when\n"
+                 "foreground load arrives.");
+
+    app.add_option("--read-limit", settings.read_limit,
+                   "Self-imposed cap on aggregate read bandwidth (accepts\n"
+                   "suffixes, e.g. 50MiB = 50 MiB/s; default: unlimited).")
+                   ->transform(CLI::AsSizeValue(false))
+                   ->take_last();
+
     app.add_option("--log-level", settings.log_level,
                    "Log level: ERROR, WARNING, INFO, DEBUG, NONE.")
                    ->default_val("ERROR")
@@ -79,6 +180,18 @@ void setup_cli_parser(CLI::App& app, Settings& settings) {
                 {"parallel", EncodeMode::PARALLEL}
             }, CLI::ignore_case));
 
+    app.add_option("--shard", settings.shard_spec,
+                   "Process only this invocation's deterministic share of the\n"
+                   "corpus, given as K/N (e.g. 2/4): N invocations running the\n"
+                   "same command with shards 1/N..N/N cover every file exactly\n"
+                   "once, with no coordination between them.")
+                   ->take_last();
+
+    app.add_option("--merge-reports", settings.merge_reports,
+                   "Combine per-shard CSV reports into the file given by --report\n"
+                   "and exit; nothing is scanned or modified. (Can be used\n"
+                   "multiple times).");
+
     app.add_option("--include", settings.include_patterns,
                    "Process only files matching regex PATTERN. (Can be used multiple times).");
 
@@ -87,7 +200,6 @@ void setup_cli_parser(CLI::App& app, Settings& settings) {
 
     // --- Positional Arguments ---
     app.add_option("inputs", settings.inputs, "One or more files or directories (use '-' for stdin)")
-        ->required()
         ->check([](const std::string& str) {
             // allow stdin or an existing path
             if (str == "-") return std::string();
@@ -120,5 +232,64 @@ void setup_cli_parser(CLI::App& app, Settings& settings) {
         if (settings.dry_run && !settings.output_path.empty()) {
             throw CLI::ValidationError("--dry-run and -o, --output cannot be used together.");
         }
+
+        if (settings.estimate && settings.is_pipe) {
+            throw CLI::ValidationError("--estimate requires file or directory inputs.");
+        }
+
+        if (settings.estimate && !settings.files_from.empty()) {
+            throw CLI::ValidationError("--estimate cannot be combined with --files-from.");
+        }
+
+        if (settings.min_size > 0 && settings.max_size > 0 &&
+            settings.min_size > settings.max_size) {
+            throw CLI::ValidationError("--min-size cannot exceed --max-size.");
+        }
+
+        if (settings.resume && settings.journal_path.empty()) {
+            throw CLI::ValidationError("--resume requires --journal.");
+        }
+
+        if (!settings.shard_spec.empty()) {
+            unsigned k = 0;
+            unsigned n = 0;
+            char extra = '\0';
+            if (std::sscanf(settings.shard_spec.c_str(), "%u/%u%c", &k, &n, &extra) != 2 ||
+                k < 1 || n < 1 || k > n) {
+                throw CLI::ValidationError("--shard must be K/N with 1 <= K <= N (e.g. 2/4).");
+            }
+            if (settings.is_pipe) {
+                throw CLI::ValidationError("--shard requires file or directory inputs.");
+            }
+            settings.shard_index = k;
+            settings.shard_count = n;
+        }
+
+        if (!settings.merge_reports.empty()) {
+            if (!settings.inputs.empty() || !settings.files_from.empty()) {
+                throw CLI::ValidationError("--merge-reports cannot be combined with inputs.");
+            }
+            if (settings.report_path.empty()) {
+                throw CLI::ValidationError("--merge-reports requires --report for the combined output.");
+            }
+            for (const auto& report : settings.merge_reports) {
+                if (!std::filesystem::exists(report)) {
+                    throw CLI::ValidationError("--merge-reports file '" + report.string() + "' not found.");
+                }
+            }
+        }
+
+        if (settings.merge_reports.empty() && settings.files_from.empty() && settings.inputs.empty()) {
+            throw CLI::ValidationError("inputs is required (or use --files-from).");
+        }
+
+        if (!settings.files_from.empty()) {
+            if (!settings.inputs.empty()) {
+                throw CLI::ValidationError("--files-from cannot be combined with positional inputs.");
+            }
+            if (settings.files_from != "-" && !std::filesystem::exists(settings.files_from)) {
+                throw CLI::ValidationError("--files-from path '" + settings.files_from + "' not found.");
+            }
+        }
     });
 }
\ No newline at end of file
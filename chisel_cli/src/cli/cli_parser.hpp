@@ -15,19 +15,44 @@
 namespace CLI { class App; }
 enum class ContainerFormat;
 
+/// Version string shown by --version and used as part of cache keys.
+inline constexpr const char* chisel_version = "1.0.1";
+
 struct Settings {
     bool no_meta = false;
     bool recursive = false;
     bool dry_run = false;
     bool quiet = false;
     bool verify_checksums = false;
+    bool dedup = false;
+    bool estimate = false; ///< Sample the corpus and forecast instead of processing
+    unsigned sample_size = 5; ///< Files sampled per (MIME, size bucket) stratum
 
     unsigned num_threads = 1;
     std::string log_level = "ERROR";
     std::string log_file;
     std::filesystem::path output_path;
     std::filesystem::path report_path;
+    std::filesystem::path cache_path;
+    std::filesystem::path gain_model_path;
+    std::filesystem::path journal_path;
+    std::filesystem::path incremental_path; ///< Per-directory scan index DB (empty = full walk)
+    bool resume = false;
+    std::string files_from; ///< Path list source ("-" for stdin), NUL-delimited
+    std::filesystem::path trace_path; ///< Chrome trace_event JSON output (empty = off)
+    uintmax_t memory_budget = 0; ///< Estimated-memory admission budget in bytes (0 = unlimited)
+    uintmax_t temp_budget = 0; ///< Extracted-bytes temp-volume budget in bytes (0 = unlimited)
+    uintmax_t min_size = 0; ///< Smallest file size processed in bytes (0 = no floor)
+    uintmax_t max_size = 0; ///< Largest file size processed in bytes (0 = no ceiling)
+    bool nice_mode = false; ///< Run workers in the platform's idle CPU/I-O classes
+    uintmax_t read_limit = 0; ///< Self-imposed read bandwidth cap in bytes/s (0 = off)
+    int effort = 2; ///< Effort level: 1 (fast), 2 (default), 3 (deep)
+    double pipe_prune = 0.001; ///< Min upstream gain keeping expensive PIPE stages (<0 = off)
     EncodeMode encode_mode = EncodeMode::PIPE;
+    std::string shard_spec; ///< Raw --shard K/N argument (empty = sharding off)
+    unsigned shard_index = 0; ///< 1-based shard owned by this invocation (0 = off)
+    unsigned shard_count = 0; ///< Total cooperating shard invocations (0 = off)
+    std::vector<std::filesystem::path> merge_reports; ///< Per-shard CSVs to combine (non-empty = merge mode)
     std::vector<std::string> include_patterns;
     std::vector<std::string> exclude_patterns;
 
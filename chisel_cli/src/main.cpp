@@ -9,6 +9,10 @@
 #include <chrono>
 #include <iomanip>
 #include <fstream>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <thread>
 #include "utils/color.hpp"
 #include "cli/cli_parser.hpp"
 #include "cli/CLI11.hpp"
@@ -18,15 +22,44 @@
 #include "../../libchisel/include/event_bus.hpp"
 #include "../../libchisel/include/events.hpp"
 #include "utils/console_log_sink.hpp"
+#include "utils/estimator.hpp"
 #include "utils/file_scanner.hpp"
 #include "../../libchisel/include/logger.hpp"
 #include "../../libchisel/include/file_type.hpp"
+#include "../../libchisel/include/file_utils.hpp"
 #include "../../libchisel/include/mime_detector.hpp"
+#include "../../libchisel/include/gain_model.hpp"
+#include "../../libchisel/include/result_cache.hpp"
+#include "../../libchisel/include/run_journal.hpp"
+#include "../../libchisel/include/scan_index.hpp"
+#include "../../libchisel/include/stats.hpp"
+#include "../../libchisel/include/trace.hpp"
 #include "utils/file_log_sink.hpp"
 
 // Global mutex to synchronize console output from multiple threads
 static std::mutex g_console_mtx;
-static std::vector<std::string> g_active_files;
+
+// set by SIGUSR1; polled (and cleared) by the UI thread, since folding
+// and logging the counters is not async-signal-safe
+static std::atomic<bool> g_dump_stats{false};
+
+/**
+ * @brief Progress state shared between worker event handlers and the UI thread.
+ *
+ * Event handlers run on worker threads and only bump counters or queue
+ * text here; a dedicated UI thread repaints the bar from this state at
+ * a fixed rate, so workers never block on terminal I/O (redrawing per
+ * event throttled the whole pipeline on slow ttys).
+ */
+struct ProgressUi {
+    std::atomic<size_t> done{0};     ///< Finished work items
+    std::atomic<size_t> total{0};    ///< Scheduled work items (grows as containers extract)
+    std::atomic<uint64_t> version{0}; ///< Bumped on every change; unchanged state skips the repaint
+
+    std::mutex mtx;                            ///< Guards the two fields below
+    std::vector<std::string> active_files;     ///< Filenames currently being processed
+    std::vector<std::string> completed_lines;  ///< Fully formatted [DONE] lines awaiting output
+};
 
 // Helper to clear the current line
 inline void clear_line_internal() {
@@ -90,6 +123,81 @@ inline void print_progress_bar_internal(const size_t done, const size_t total, c
     std::cerr << "\033[K" << std::flush; // ANSI Clear Line to right
 }
 
+// Folds the global counters and logs them; triggered by SIGUSR1.
+static void dump_stats() {
+    const auto snap = chisel::stats();
+    std::ostringstream oss;
+    oss << "stats: analyzed=" << snap.files_analyzed
+        << " processed=" << snap.files_processed
+        << " skipped=" << snap.files_skipped
+        << " size-window=" << snap.files_size_filtered
+        << " errored=" << snap.files_errored
+        << " read=" << snap.bytes_read
+        << "B written=" << snap.bytes_written
+        << "B saved=" << snap.bytes_saved << "B";
+    if (!snap.processor_calls.empty()) {
+        oss << " calls:";
+        for (const auto& [name, calls] : snap.processor_calls) {
+            oss << " " << name << "=" << calls;
+        }
+    }
+    Logger::log(LogLevel::Info, oss.str(), "stats");
+}
+
+// UI thread body: repaints the bar at ~10 Hz from the shared counters and
+// drains queued per-file lines. Idle state (version unchanged) skips the
+// repaint entirely so an idle run does not spin the terminal.
+static void run_progress_ui(const std::stop_token& st, ProgressUi& ui,
+                            const std::chrono::steady_clock::time_point start) {
+    uint64_t painted = std::numeric_limits<uint64_t>::max();
+    while (!st.stop_requested()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (g_dump_stats.exchange(false, std::memory_order_relaxed)) {
+            dump_stats();
+        }
+        const uint64_t version = ui.version.load(std::memory_order_acquire);
+        if (version == painted) continue;
+        painted = version;
+
+        std::vector<std::string> lines;
+        std::string status_text;
+        {
+            std::scoped_lock lock(ui.mtx);
+            lines.swap(ui.completed_lines);
+            if (ui.active_files.size() > 1) {
+                status_text = "Processing: " + std::to_string(ui.active_files.size()) + " files";
+            } else if (!ui.active_files.empty()) {
+                status_text = "Processing: " + ui.active_files.front();
+            }
+        }
+
+        std::scoped_lock lock(g_console_mtx);
+        if (!lines.empty()) {
+            clear_line_internal();
+            for (const auto& line : lines) {
+                std::cerr << line << "\n";
+            }
+        }
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        print_progress_bar_internal(ui.done.load(), ui.total.load(), elapsed, status_text);
+    }
+
+    // final drain so no queued lines are lost between the last repaint
+    // and the thread being stopped
+    std::vector<std::string> lines;
+    {
+        std::scoped_lock lock(ui.mtx);
+        lines.swap(ui.completed_lines);
+    }
+    if (!lines.empty()) {
+        std::scoped_lock lock(g_console_mtx);
+        clear_line_internal();
+        for (const auto& line : lines) {
+            std::cerr << line << "\n";
+        }
+    }
+}
+
 using namespace chisel;
 namespace fs = std::filesystem;
 
@@ -97,6 +205,12 @@ static std::atomic<chisel::ProcessorExecutor*> g_executor{nullptr};
 
 // handle ctrl+c or termination signals
 void signal_handler(int sig) {
+#ifdef SIGUSR1
+    if (sig == SIGUSR1) {
+        g_dump_stats.store(true, std::memory_order_relaxed);
+        return;
+    }
+#endif
     if (sig == SIGINT || sig == SIGTERM) {
         // Protect interrupt message so it doesn't mix with progress bar
         std::lock_guard<std::mutex> lock(g_console_mtx);
@@ -155,6 +269,9 @@ int main(int argc, char* argv[]) {
 
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
+#ifdef SIGUSR1
+    std::signal(SIGUSR1, signal_handler);
+#endif
     init_utf8_locale();
 
     try {
@@ -183,81 +300,93 @@ int main(int argc, char* argv[]) {
         Logger::add_sink(std::move(consoleSink));
     }
 
+    // drain log records on a background thread so workers never block on sink I/O
+    Logger::set_async(true);
+
+    // merge mode: combine per-shard CSV reports into --report and exit;
+    // nothing is scanned or modified
+    if (!settings.merge_reports.empty()) {
+        const int rc = merge_shard_reports(settings.merge_reports, settings.report_path);
+        Logger::flush();
+        return rc;
+    }
+
     // registry of processors and event bus
     ProcessorRegistry registry;
     EventBus bus;
 
-    // results collected for reporting
-    std::vector<Result> results;
-    std::vector<ContainerResult> container_results;
+    // streaming CSV report: rows are appended as results arrive instead
+    // of accumulating every Result until the end of the run
+    StreamingCsvReport csv_report(settings.report_path, settings.encode_mode);
+
+    // collect input files (skipped in --files-from mode, which streams
+    // paths straight into the executor instead)
+    std::vector<fs::path> inputs;
+    // opt-in incremental scan index: unchanged directories are pruned
+    // from the walk; signatures land only after a successful run
+    std::optional<ScanIndex> scan_index;
+    if (!settings.incremental_path.empty()) {
+        scan_index.emplace(settings.incremental_path);
+    }
+    if (settings.files_from.empty()) {
+        inputs = collect_input_files(settings.inputs, settings, settings.is_pipe,
+                                     scan_index ? &*scan_index : nullptr);
+        if (inputs.empty()) {
+            Logger::log(LogLevel::Error, "No valid input files.", "main");
+            return 1;
+        }
+    }
 
-    // collect input files
-    auto inputs = collect_input_files(settings.inputs, settings, settings.is_pipe);
-    if (inputs.empty()) {
-        Logger::log(LogLevel::Error, "No valid input files.", "main");
-        return 1;
+    // forecast mode: sample the corpus, print the projection, done
+    if (settings.estimate) {
+        return run_estimate(settings, inputs);
     }
 
-    // progress tracking
-    size_t total = 0;
-    std::atomic<size_t> done{0};
+    // progress tracking: handlers run on worker threads and only touch
+    // this shared state; the UI thread below owns the terminal
+    ProgressUi ui;
     auto start_total = std::chrono::steady_clock::now();
 
-    // subscribe to events: print progress and collect results
+    // subscribe to events: track progress and collect results
     // bus.subscribe<FileAnalyzeStartEvent>([](const FileAnalyzeStartEvent& e) {
     //     std::cerr << "[ANALYZE] " << e.path.filename().string() << std::endl;
     // });
 
     // update total if a container is extracted (finalization step counts as extra work)
     bus.subscribe<FileAnalyzeCompleteEvent>([&](const FileAnalyzeCompleteEvent& e) {
-        if (e.scheduled) {
-            total++;
-        }
         if (e.extracted) {
-            total++;
+            csv_report.note_container(e.path);
+        }
+        size_t added = 0;
+        if (e.scheduled) added++;
+        if (e.extracted) added++;
+        if (added != 0) {
+            ui.total.fetch_add(added, std::memory_order_relaxed);
+            ui.version.fetch_add(1, std::memory_order_release);
         }
     });
 
-    // Process Start: Update the "Processing: ..." text dynamically
+    // Process Start: record the active file; the UI thread picks it up
     bus.subscribe<FileProcessStartEvent>([&](const FileProcessStartEvent& e) {
         if (settings.quiet) return;
-
-        std::scoped_lock lock(g_console_mtx);
-        g_active_files.push_back(e.path.filename().string());
-
-        std::string status_text;
-        if (g_active_files.size() > 1) {
-            status_text = "Processing: " + std::to_string(g_active_files.size()) + " files";
-        } else {
-            status_text = "Processing: " + g_active_files.back();
+        {
+            std::scoped_lock lock(ui.mtx);
+            ui.active_files.push_back(e.path.filename().string());
         }
-
-        // Force an immediate redraw of the bar with the new status
-        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_total).count();
-        print_progress_bar_internal(done.load(), total, elapsed, status_text);
+        ui.version.fetch_add(1, std::memory_order_release);
     });
 
-    // generic handler for "finished" events to update progress bar
+    // generic handler for "finished" events to update progress counters
     auto on_finish = [&](const std::string& finished_filename) {
-        const size_t current = ++done;
-        if (settings.quiet) return;
-
-        std::scoped_lock lock(g_console_mtx);
-
-        auto it = std::find(g_active_files.begin(), g_active_files.end(), finished_filename);
-        if (it != g_active_files.end()) {
-            g_active_files.erase(it);
-        }
-
-        std::string status_text;
-        if (g_active_files.empty()) {
-        } else if (g_active_files.size() > 1) {
-            status_text = "Processing: " + std::to_string(g_active_files.size()) + " files";
-        } else {
-            status_text = "Processing: " + g_active_files.front();
+        ++ui.done;
+        if (!settings.quiet) {
+            std::scoped_lock lock(ui.mtx);
+            auto it = std::find(ui.active_files.begin(), ui.active_files.end(), finished_filename);
+            if (it != ui.active_files.end()) {
+                ui.active_files.erase(it);
+            }
         }
-        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_total).count();
-        print_progress_bar_internal(current, total, elapsed, status_text);
+        ui.version.fetch_add(1, std::memory_order_release);
     };
 
     bus.subscribe<FileProcessCompleteEvent>([&](const FileProcessCompleteEvent& e) {
@@ -270,45 +399,49 @@ int main(int argc, char* argv[]) {
                              (settings.output_path.empty() ? " [replaced]" : " [OK]");
             }
 
+            std::ostringstream line;
+            line << (e.replaced ? GREEN : YELLOW)
+                 << "[DONE] " << e.path.filename().string()
+                 << " (" << e.original_size << " -> " << e.new_size << " bytes)"
+                 << status_msg
+                 << RESET;
             {
-                std::scoped_lock lock(g_console_mtx);
-                clear_line_internal();
-
-                std::cerr
-                    << (e.replaced ? GREEN : YELLOW)
-                    << "[DONE] " << e.path.filename().string()
-                    << " (" << e.original_size << " -> " << e.new_size << " bytes)"
-                    << status_msg
-                    << RESET << std::endl;
+                std::scoped_lock lock(ui.mtx);
+                ui.completed_lines.push_back(line.str());
             }
         }
-        Result r;
-        r.path = e.path;
-        r.mime = MimeDetector::detect(e.path);
-        r.size_before = e.original_size;
-        r.size_after = e.new_size;
-        r.success = true;
-        r.replaced = e.replaced;
-        r.seconds = static_cast<double>(e.duration.count()) / 1000.0;
-        results.push_back(std::move(r));
+        if (csv_report.is_open()) {
+            Result r;
+            r.path = e.path;
+            r.mime = MimeDetector::detect(e.path);
+            r.size_before = e.original_size;
+            r.size_after = e.new_size;
+            r.success = true;
+            r.replaced = e.replaced;
+            r.seconds = static_cast<double>(e.duration.count()) / 1000.0;
+            csv_report.add_result(std::move(r));
+        }
 
         on_finish(e.path.filename().string());
     });
 
+    // per-processor time attribution for the report trailer
+    bus.subscribe<ProcessorTimingEvent>([&](const ProcessorTimingEvent& e) {
+        csv_report.add_processor_timing(e.processor, e.input_bytes, e.output_bytes, e.duration);
+    });
+
     bus.subscribe<FileProcessErrorEvent>([&](const FileProcessErrorEvent& e) {
-        {
-            std::lock_guard<std::mutex> lock(g_console_mtx);
-            clear_line_internal();
-            Logger::log(LogLevel::Error, e.path.filename().string() + " " + e.error_message, "main");
+        Logger::log(LogLevel::Error, e.path.filename().string() + " " + e.error_message, "main");
+
+        if (csv_report.is_open()) {
+            Result r;
+            r.path = e.path;
+            r.mime = MimeDetector::detect(e.path);
+            r.success = false;
+            r.error_msg = e.error_message;
+            csv_report.add_result(std::move(r));
         }
 
-        Result r;
-        r.path = e.path;
-        r.mime = MimeDetector::detect(e.path);
-        r.success = false;
-        r.error_msg = e.error_message;
-        results.push_back(std::move(r));
-
         on_finish(e.path.filename().string());
     });
 
@@ -316,34 +449,39 @@ int main(int argc, char* argv[]) {
         on_finish(e.path.filename().string());
     });
 
+    bus.subscribe<DuplicateClusterEvent>([&](const DuplicateClusterEvent& e) {
+        Logger::log(LogLevel::Info,
+                    std::to_string(e.duplicates) + " duplicate(s) of " +
+                    e.representative.filename().string() + " reused its result (" +
+                    std::to_string(e.deduplicated_bytes) + " bytes not recompressed)",
+                    "main");
+    });
+
     bus.subscribe<ContainerFinalizeCompleteEvent>([&](const ContainerFinalizeCompleteEvent& e) {
-        auto it = std::find_if(results.begin(), results.end(),
-                             [&](const Result& r){ return r.path == e.path; });
-        if (it != results.end()) {
-            it->size_after = e.final_size;
+        if (csv_report.is_open()) {
+            // patch the parked per-file row with the repacked size, then
+            // record the trailer row
+            csv_report.finalize_container_size(e.path, e.final_size);
+            ContainerResult c;
+            c.filename = e.path;
+            c.success = true;
+            c.size_after = e.final_size;
+            csv_report.add_container(std::move(c));
         }
-
-        ContainerResult c;
-        c.filename = e.path;
-        c.success = true;
-        c.size_after = e.final_size;
-        container_results.push_back(std::move(c));
         on_finish(e.path.filename().string());
     });
 
     bus.subscribe<ContainerFinalizeErrorEvent>([&](const ContainerFinalizeErrorEvent& e) {
-        {
-            std::lock_guard<std::mutex> lock(g_console_mtx);
-            clear_line_internal();
-            Logger::log(LogLevel::Error, e.path.filename().string() + " " + e.error_message, "main");
+        Logger::log(LogLevel::Error, e.path.filename().string() + " " + e.error_message, "main");
+
+        if (csv_report.is_open()) {
+            ContainerResult c;
+            c.filename = e.path;
+            c.success = false;
+            c.error_msg = e.error_message;
+            csv_report.add_container(std::move(c));
         }
 
-        ContainerResult c;
-        c.filename = e.path;
-        c.success = false;
-        c.error_msg = e.error_message;
-        container_results.push_back(std::move(c));
-
         on_finish(e.path.filename().string());
     });
 
@@ -361,14 +499,128 @@ int main(int argc, char* argv[]) {
                                executor_output_dir,
                                bus,
                                settings.num_threads);
+    executor.set_deduplicate(settings.dedup);
+    executor.set_memory_budget(settings.memory_budget);
+    executor.set_temp_budget(settings.temp_budget);
+    executor.set_size_window(settings.min_size, settings.max_size);
+    executor.set_effort(settings.effort);
+    executor.set_pipe_prune_threshold(settings.pipe_prune);
+    executor.set_background(settings.nice_mode);
+    if (settings.read_limit > 0) {
+        chisel::set_read_throttle(settings.read_limit);
+    }
+
+    // opt-in cross-run result cache
+    std::optional<ResultCache> result_cache;
+    if (!settings.cache_path.empty()) {
+        result_cache.emplace(settings.cache_path, chisel_version);
+        if (result_cache->is_open()) {
+            executor.set_result_cache(&*result_cache);
+        }
+    }
+
+    // opt-in cross-run gain/cost statistics
+    std::optional<GainModel> gain_model;
+    if (!settings.gain_model_path.empty()) {
+        gain_model.emplace(settings.gain_model_path, chisel_version);
+        if (gain_model->is_open()) {
+            executor.set_gain_model(&*gain_model);
+        }
+    }
+
+    // opt-in crash-safe journal with resume support
+    std::optional<RunJournal> run_journal;
+    if (!settings.journal_path.empty()) {
+        run_journal.emplace(settings.journal_path, settings.resume);
+        if (run_journal->is_open()) {
+            executor.set_run_journal(&*run_journal);
+        }
+    }
+
+    // opt-in pipeline span tracing
+    if (!settings.trace_path.empty()) {
+        Trace::enable(settings.trace_path);
+    }
+
     g_executor.store(&executor);
+
+    // dedicated UI thread: coalesces progress updates and repaints at
+    // ~10 Hz so workers never wait on the terminal
+    std::optional<std::jthread> ui_thread;
+    if (!settings.quiet) {
+        ui_thread.emplace([&ui, start_total](const std::stop_token& st) {
+            run_progress_ui(st, ui, start_total);
+        });
+    }
+
     // run processing
-    executor.process(inputs);
+    if (!settings.files_from.empty()) {
+        // stream NUL-delimited paths from the list source; recompression
+        // starts before the list has been fully read
+        std::ifstream list_file;
+        std::istream* list = &std::cin;
+        if (settings.files_from != "-") {
+            list_file.open(settings.files_from, std::ios::binary);
+            if (!list_file) {
+                Logger::log(LogLevel::Error, "Cannot open --files-from: " + settings.files_from, "main");
+                g_executor.store(nullptr);
+                return 1;
+            }
+            list = &list_file;
+        }
+        const PathFilter filter(settings.include_patterns, settings.exclude_patterns);
+        executor.process([&](fs::path& out) -> bool {
+            std::string token;
+            while (std::getline(*list, token, '\0')) {
+                if (token.empty()) continue;
+                fs::path candidate(token);
+                std::error_code ec;
+                if (!fs::is_regular_file(candidate, ec) || ec) {
+                    Logger::log(LogLevel::Warning, "Skipping non-file list entry: " + token, "main");
+                    continue;
+                }
+                if (filter.is_filtered(candidate)) continue;
+                if (shard_excludes(candidate, settings)) continue;
+                out = std::move(candidate);
+                return true;
+            }
+            return false;
+        });
+    } else {
+        executor.process(inputs);
+    }
     g_executor.store(nullptr);
 
+    // stop the UI thread; its final drain flushes any queued lines
+    if (ui_thread) {
+        ui_thread->request_stop();
+        ui_thread->join();
+        ui_thread.reset();
+    }
+
+    // the pipeline has drained: serialize recorded spans
+    if (!settings.trace_path.empty() && Trace::write()) {
+        Logger::log(LogLevel::Info, "Trace written to " + settings.trace_path.string(), "main");
+    }
+
+    // land any journaled completions before reporting
+    if (run_journal) {
+        run_journal->flush();
+    }
+
+    // commit this run's directory signatures only after a completed,
+    // non-dry run: pruned directories must actually have been handled
+    if (scan_index && !settings.dry_run && !executor.is_stopped()) {
+        scan_index->flush();
+    }
+
+    // make sure every queued log record lands before the summary output
+    Logger::flush();
+
     // Final cleanup of the progress bar line
     if (!settings.quiet) {
         std::lock_guard<std::mutex> lock(g_console_mtx);
+        const size_t total = ui.total.load();
         double total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_total).count();
         print_progress_bar_internal(total, total, total_seconds, "Completed.");
         std::cerr << std::endl;
@@ -407,14 +659,8 @@ int main(int argc, char* argv[]) {
         fs::remove(inputs.front(), ec);
     }
 
-    // export CSV if requested
-    if (!settings.report_path.empty()) {
-        export_csv_report(results,
-                          container_results,
-                          settings.report_path,
-                          total_seconds,
-                          settings.encode_mode);
-    }
+    // flush parked container rows and write the CSV trailer
+    csv_report.finish(total_seconds, chisel::stats().files_size_filtered);
 
     if (executor.is_stopped()) {
         return 130; // standard exit code for SIGINT
@@ -66,6 +66,37 @@ static std::string csv_escape(const std::string& data) {
     return result;
 }
 
+/// Splits one CSV line into fields, honouring quoted fields with "" escapes.
+static std::vector<std::string> csv_split(const std::string& line) {
+    std::vector<std::string> fields;
+    std::string field;
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        const char c = line[i];
+        if (quoted) {
+            if (c == '"') {
+                if (i + 1 < line.size() && line[i + 1] == '"') {
+                    field.push_back('"');
+                    ++i;
+                } else {
+                    quoted = false;
+                }
+            } else {
+                field.push_back(c);
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.push_back(std::move(field));
+            field.clear();
+        } else {
+            field.push_back(c);
+        }
+    }
+    fields.push_back(std::move(field));
+    return fields;
+}
+
 void print_console_report(const std::vector<Result>& results,
                           const std::vector<ContainerResult>& container_results,
                           const unsigned num_threads,
@@ -235,72 +266,401 @@ void print_console_report(const std::vector<Result>& results,
               << (num_threads > 1U ? "s" : "") << ")\n";
 }
 
-void export_csv_report(const std::vector<Result>& results,
-                       const std::vector<ContainerResult>& container_results,
-                       const std::filesystem::path& output_path,
-                       const double total_seconds,
-                       const EncodeMode mode) {
-    std::ofstream out(output_path);
-    if (!out) return;
+void print_estimate_report(const std::vector<EstimateStratumRow>& strata,
+                           const std::vector<EstimateProcessorRow>& processors,
+                           const unsigned num_threads,
+                           const double sample_seconds) {
+    uint64_t total_files = 0;
+    std::size_t total_sampled = 0;
+    uintmax_t total_bytes = 0;
+    uintmax_t total_saved = 0;
+    double total_cpu = 0.0;
+    for (const auto& s : strata) {
+        total_files += s.files;
+        total_sampled += s.sampled_files;
+        total_bytes += s.total_bytes;
+        total_saved += s.projected_saved;
+    }
+    for (const auto& p : processors) total_cpu += p.projected_seconds;
+
+    std::cerr << "\n=== Estimate (sampled " << total_sampled << " of " << total_files
+              << " files in " << std::fixed << std::setprecision(1) << sample_seconds
+              << " s) ===\n";
+    std::cerr << std::left << std::setw(28) << "MIME type"
+              << std::setw(12) << "Size bucket"
+              << std::right << std::setw(9)  << "Files"
+              << std::setw(11) << "Total(MB)"
+              << std::setw(9)  << "Sampled"
+              << std::setw(14) << "Est.saved(MB)"
+              << std::setw(10) << "Delta(%)"
+              << std::setw(12) << "Est.CPU(s)"
+              << "\n";
+    for (const auto& s : strata) {
+        const double pct = s.total_bytes
+            ? 100.0 * static_cast<double>(s.projected_saved) / static_cast<double>(s.total_bytes)
+            : 0.0;
+        std::cerr << std::left << std::setw(28) << s.mime
+                  << std::setw(12) << s.bucket
+                  << std::right << std::setw(9)  << s.files
+                  << std::setw(11) << (s.total_bytes / (1024 * 1024))
+                  << std::setw(9)  << s.sampled_files
+                  << std::setw(14) << (s.projected_saved / (1024 * 1024))
+                  << std::setw(10) << std::fixed << std::setprecision(2) << pct
+                  << std::setw(12) << std::setprecision(1) << s.projected_seconds
+                  << "\n";
+    }
 
-    out << "File,Container,MIME,Before(KB),After(KB),Delta(%),Time(s),Result,Codecs,Error\n";
+    if (!processors.empty()) {
+        std::cerr << "\nPer-processor forecast:\n";
+        std::cerr << std::left << std::setw(24) << "Processor"
+                  << std::right << std::setw(12) << "Sampled(s)"
+                  << std::setw(12) << "Est.CPU(s)"
+                  << std::setw(14) << "Est.saved(MB)"
+                  << "\n";
+        for (const auto& p : processors) {
+            std::cerr << std::left << std::setw(24) << p.processor
+                      << std::right << std::setw(12) << std::fixed << std::setprecision(1)
+                      << p.sampled_seconds
+                      << std::setw(12) << p.projected_seconds
+                      << std::setw(14) << (p.projected_saved / (1024 * 1024))
+                      << "\n";
+        }
+    }
 
-    for (const auto& r : results) {
-        const double pct = r.success && r.size_before
-                         ? 100.0 * (1.0 - static_cast<double>(r.size_after) / static_cast<double>(r.size_before))
-                         : 0.0;
-        const std::string outcome = !r.success ? "FAIL"
-                                         : r.replaced ? "OK (replaced)"
-                                                      : "OK (skipped)";
-
-        std::string codecs_str;
-        for (size_t i = 0; i < r.codecs_used.size(); ++i) {
-            std::ostringstream ossc;
-            ossc << std::fixed << std::setprecision(2) << r.codecs_used[i].second;
-            codecs_str += r.codecs_used[i].first + ":" + ossc.str() + "%";
-            if (i + 1 < r.codecs_used.size()) {
-                if (mode == EncodeMode::PIPE)
-                    codecs_str += " -> ";
-                else
-                    codecs_str += "; ";
+    const double total_pct = total_bytes
+        ? 100.0 * static_cast<double>(total_saved) / static_cast<double>(total_bytes)
+        : 0.0;
+    const double wall_minutes = num_threads > 0 ? total_cpu / num_threads / 60.0 : 0.0;
+    std::cerr << "\nProjected: ~" << (total_saved / (1024 * 1024)) << " MB saved ("
+              << std::fixed << std::setprecision(2) << total_pct << "%), ~"
+              << std::setprecision(0) << total_cpu << " CPU-seconds, ~"
+              << std::setprecision(1) << wall_minutes << " min wall clock on "
+              << num_threads << " thread" << (num_threads > 1U ? "s" : "") << ".\n"
+              << "Figures assume effort 3 with pruning off; lower effort will run\n"
+              << "faster and save somewhat less.\n";
+}
+
+int merge_shard_reports(const std::vector<std::filesystem::path>& shard_reports,
+                        const std::filesystem::path& output_path) {
+    // section headers exactly as StreamingCsvReport writes them; a line
+    // matching one of these switches the parser to that trailer section
+    static const std::string kFileHeader =
+        "File,Container,MIME,Before(KB),After(KB),Delta(%),Time(s),Result,Codecs,Error";
+    static const std::string kContainerHeader = "Container,Format,Before(KB),After(KB),Delta(%),Error";
+    static const std::string kProcessorHeader = "Processor,Calls,Wall(s),Throughput(MB/s),Saved(KB),Saved(KB)/s";
+    static const std::string kSkipHeader = "Skipped by size window";
+    static const std::string kTotalHeader = "Total amount of time,Encoding mode used";
+
+    /// Re-aggregated per-processor trailer columns across all shards.
+    struct ProcessorTotals {
+        size_t calls = 0;
+        double wall_seconds = 0.0;
+        double input_mb = 0.0;  ///< Recovered from throughput × wall time
+        uintmax_t saved_kb = 0;
+    };
+
+    std::vector<std::string> file_rows;
+    std::vector<std::string> container_rows;
+    std::map<std::string, ProcessorTotals> processors;
+    uint64_t size_window_skips = 0;
+    double max_seconds = 0.0;   // shards run concurrently: the pass takes as long as the slowest
+    std::string mode_label;
+    uintmax_t before_kb = 0;
+    uintmax_t saved_kb = 0;
+    size_t replaced_rows = 0;
+
+    for (const auto& report : shard_reports) {
+        std::ifstream in(report);
+        if (!in) {
+            std::cerr << "Cannot open shard report: " << report.string() << "\n";
+            return 1;
+        }
+
+        std::string line;
+        if (!std::getline(in, line)) {
+            std::cerr << "Empty shard report: " << report.string() << "\n";
+            return 1;
+        }
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line != kFileHeader) {
+            std::cerr << "Not a chisel CSV report: " << report.string() << "\n";
+            return 1;
+        }
+
+        enum class Section { Files, Containers, Processors, Skips, Total };
+        Section section = Section::Files;
+
+        while (std::getline(in, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+            if (line == kContainerHeader) { section = Section::Containers; continue; }
+            if (line == kProcessorHeader) { section = Section::Processors; continue; }
+            if (line == kSkipHeader)      { section = Section::Skips; continue; }
+            if (line == kTotalHeader)     { section = Section::Total; continue; }
+
+            switch (section) {
+                case Section::Files: {
+                    file_rows.push_back(line);
+                    // fold the row into the console summary; a malformed
+                    // row is still copied verbatim, just not counted
+                    const auto fields = csv_split(line);
+                    if (fields.size() >= 8) {
+                        try {
+                            const auto before = std::stoull(fields[3]);
+                            const auto after = std::stoull(fields[4]);
+                            before_kb += before;
+                            if (fields[7] == "OK (replaced)") {
+                                replaced_rows++;
+                                if (before > after) saved_kb += before - after;
+                            }
+                        } catch (const std::exception&) {}
+                    }
+                    break;
+                }
+                case Section::Containers:
+                    container_rows.push_back(line);
+                    break;
+                case Section::Processors: {
+                    const auto fields = csv_split(line);
+                    if (fields.size() >= 6) {
+                        try {
+                            auto& totals = processors[fields[0]];
+                            totals.calls += std::stoull(fields[1]);
+                            const double wall = std::stod(fields[2]);
+                            totals.wall_seconds += wall;
+                            totals.input_mb += std::stod(fields[3]) * wall;
+                            totals.saved_kb += std::stoull(fields[4]);
+                        } catch (const std::exception&) {}
+                    }
+                    break;
+                }
+                case Section::Skips:
+                    try {
+                        size_window_skips += std::stoull(line);
+                    } catch (const std::exception&) {}
+                    break;
+                case Section::Total: {
+                    const auto fields = csv_split(line);
+                    if (!fields.empty()) {
+                        try {
+                            // "12.34 seconds"; stod stops at the space
+                            max_seconds = std::max(max_seconds, std::stod(fields[0]));
+                        } catch (const std::exception&) {}
+                    }
+                    if (fields.size() >= 2) {
+                        if (mode_label.empty()) mode_label = fields[1];
+                        else if (mode_label != fields[1]) mode_label = "MIXED";
+                    }
+                    break;
+                }
             }
         }
+    }
 
-        out << csv_escape(r.path.filename().string()) << ","
-            << csv_escape(r.container_origin ? r.container_origin->filename().string() : "") << ","
-            << csv_escape(r.mime) << ","
-            << (r.size_before / 1024) << ","
-            << (r.size_after / 1024) << ",";
-
-        std::ostringstream osspct;
-        osspct << std::fixed << std::setprecision(2) << pct;
-        out << osspct.str() << ",";
-
-        std::ostringstream osstime;
-        osstime << std::fixed << std::setprecision(2) << r.seconds;
-        out << osstime.str() << ","
-            << csv_escape(outcome) << ","
-            << csv_escape(codecs_str) << ","
-            << csv_escape(r.error_msg) << "\n";
+    std::ofstream out(output_path);
+    if (!out) {
+        std::cerr << "Cannot open merged report output: " << output_path.string() << "\n";
+        return 1;
     }
-    if (!container_results.empty()) {
-        out << "\n\nContainer,Format,Before(KB),After(KB),Delta(%),Error\n";
-        for (const auto& c : container_results) {
+
+    out << kFileHeader << "\n";
+    for (const auto& row : file_rows) {
+        out << row << "\n";
+    }
+
+    if (!container_rows.empty()) {
+        out << "\n\n" << kContainerHeader << "\n";
+        for (const auto& row : container_rows) {
+            out << row << "\n";
+        }
+    }
+
+    if (!processors.empty()) {
+        out << "\n\n" << kProcessorHeader << "\n";
+        for (const auto& [name, totals] : processors) {
+            const double mb_per_s = totals.wall_seconds > 0.0
+                ? totals.input_mb / totals.wall_seconds
+                : 0.0;
+            const double saved_kb_per_s = totals.wall_seconds > 0.0
+                ? static_cast<double>(totals.saved_kb) / totals.wall_seconds
+                : 0.0;
+            out << csv_escape(name) << ","
+                << totals.calls << ","
+                << std::fixed << std::setprecision(2) << totals.wall_seconds << ","
+                << std::fixed << std::setprecision(2) << mb_per_s << ","
+                << totals.saved_kb << ","
+                << std::fixed << std::setprecision(2) << saved_kb_per_s << "\n";
+        }
+    }
+
+    if (size_window_skips > 0) {
+        out << "\n\n" << kSkipHeader << "\n" << size_window_skips << "\n";
+    }
+
+    out << "\n\n" << kTotalHeader << "\n";
+    out << std::fixed << std::setprecision(2) << max_seconds << " seconds,"
+        << (mode_label.empty() ? "PIPE" : mode_label) << "\n";
+    out.close();
+
+    std::cerr << "Merged " << shard_reports.size() << " shard report(s): "
+              << file_rows.size() << " file rows, " << replaced_rows << " replaced, "
+              << saved_kb << " KB saved";
+    if (before_kb > 0) {
+        const double pct = 100.0 * static_cast<double>(saved_kb) / static_cast<double>(before_kb);
+        std::cerr << " (" << std::fixed << std::setprecision(2) << pct << "%)";
+    }
+    std::cerr << " -> " << output_path.string() << "\n";
+    return 0;
+}
+
+StreamingCsvReport::StreamingCsvReport(const std::filesystem::path& output_path, const EncodeMode mode)
+    : mode_(mode) {
+    if (output_path.empty()) return;
+    out_.open(output_path);
+    if (!out_) return;
+    out_ << "File,Container,MIME,Before(KB),After(KB),Delta(%),Time(s),Result,Codecs,Error\n";
+}
+
+void StreamingCsvReport::note_container(const std::filesystem::path& path) {
+    std::scoped_lock lock(mtx_);
+    if (!out_.is_open()) return;
+    pending_containers_.insert(path);
+}
+
+void StreamingCsvReport::write_row_locked(const Result& r) {
+    const double pct = r.success && r.size_before
+                     ? 100.0 * (1.0 - static_cast<double>(r.size_after) / static_cast<double>(r.size_before))
+                     : 0.0;
+    const std::string outcome = !r.success ? "FAIL"
+                                     : r.replaced ? "OK (replaced)"
+                                                  : "OK (skipped)";
+
+    std::string codecs_str;
+    for (size_t i = 0; i < r.codecs_used.size(); ++i) {
+        std::ostringstream ossc;
+        ossc << std::fixed << std::setprecision(2) << r.codecs_used[i].second;
+        codecs_str += r.codecs_used[i].first + ":" + ossc.str() + "%";
+        if (i + 1 < r.codecs_used.size()) {
+            if (mode_ == EncodeMode::PIPE)
+                codecs_str += " -> ";
+            else
+                codecs_str += "; ";
+        }
+    }
+
+    out_ << csv_escape(r.path.filename().string()) << ","
+         << csv_escape(r.container_origin ? r.container_origin->filename().string() : "") << ","
+         << csv_escape(r.mime) << ","
+         << (r.size_before / 1024) << ","
+         << (r.size_after / 1024) << ",";
+
+    std::ostringstream osspct;
+    osspct << std::fixed << std::setprecision(2) << pct;
+    out_ << osspct.str() << ",";
+
+    std::ostringstream osstime;
+    osstime << std::fixed << std::setprecision(2) << r.seconds;
+    out_ << osstime.str() << ","
+         << csv_escape(outcome) << ","
+         << csv_escape(codecs_str) << ","
+         << csv_escape(r.error_msg) << "\n";
+}
+
+void StreamingCsvReport::add_result(Result r) {
+    std::scoped_lock lock(mtx_);
+    if (!out_.is_open()) return;
+    // container rows wait for the repacked size from finalization
+    if (pending_containers_.erase(r.path) > 0) {
+        parked_.push_back(std::move(r));
+        return;
+    }
+    write_row_locked(r);
+}
+
+void StreamingCsvReport::add_container(ContainerResult c) {
+    std::scoped_lock lock(mtx_);
+    if (!out_.is_open()) return;
+    containers_.push_back(std::move(c));
+}
+
+void StreamingCsvReport::add_processor_timing(const std::string& processor,
+                                              const uintmax_t input_bytes,
+                                              const uintmax_t output_bytes,
+                                              const std::chrono::milliseconds duration) {
+    std::scoped_lock lock(mtx_);
+    if (!out_.is_open()) return;
+    auto& stats = processor_stats_[processor];
+    stats.calls++;
+    stats.input_bytes += input_bytes;
+    if (output_bytes > 0 && output_bytes < input_bytes) {
+        stats.saved_bytes += input_bytes - output_bytes;
+    }
+    stats.wall_seconds += static_cast<double>(duration.count()) / 1000.0;
+}
+
+void StreamingCsvReport::finalize_container_size(const std::filesystem::path& path, const uintmax_t final_size) {
+    std::scoped_lock lock(mtx_);
+    if (!out_.is_open()) return;
+    const auto it = std::find_if(parked_.begin(), parked_.end(),
+                                 [&](const Result& r) { return r.path == path; });
+    if (it == parked_.end()) return;
+    it->size_after = final_size;
+    write_row_locked(*it);
+    parked_.erase(it);
+}
+
+void StreamingCsvReport::finish(const double total_seconds, const uint64_t size_window_skips) {
+    std::scoped_lock lock(mtx_);
+    if (!out_.is_open()) return;
+
+    // containers whose finalization failed never got patched; flush
+    // their rows as recorded
+    for (const auto& r : parked_) {
+        write_row_locked(r);
+    }
+    parked_.clear();
+
+    if (!containers_.empty()) {
+        out_ << "\n\nContainer,Format,Before(KB),After(KB),Delta(%),Error\n";
+        for (const auto& c : containers_) {
             double pct = c.success && c.size_before
                          ? 100.0 * (1.0 - static_cast<double>(c.size_after) / static_cast<double>(c.size_before))
                          : 0.0;
-            out << csv_escape(c.filename.filename().string()) << ","
-                << csv_escape(c.format) << ","
-                << (c.size_before / 1024) << ","
-                << (c.size_after / 1024) << ",";
+            out_ << csv_escape(c.filename.filename().string()) << ","
+                 << csv_escape(c.format) << ","
+                 << (c.size_before / 1024) << ","
+                 << (c.size_after / 1024) << ",";
             std::ostringstream osspct;
             osspct << std::fixed << std::setprecision(2) << (c.success ? pct : 0.0);
-            out << osspct.str() << ","
-                << csv_escape(c.error_msg) << "\n";
+            out_ << osspct.str() << ","
+                 << csv_escape(c.error_msg) << "\n";
         }
     }
 
-    out << "\n\nTotal amount of time,Encoding mode used\n";
-    out << std::fixed << std::setprecision(2) << total_seconds << " seconds,"
-        << (mode == EncodeMode::PIPE ? "PIPE" : "PARALLEL") << "\n";
+    if (!processor_stats_.empty()) {
+        out_ << "\n\nProcessor,Calls,Wall(s),Throughput(MB/s),Saved(KB),Saved(KB)/s\n";
+        for (const auto& [name, stats] : processor_stats_) {
+            const double mb_per_s = stats.wall_seconds > 0.0
+                ? static_cast<double>(stats.input_bytes) / (1024.0 * 1024.0) / stats.wall_seconds
+                : 0.0;
+            const double saved_kb_per_s = stats.wall_seconds > 0.0
+                ? static_cast<double>(stats.saved_bytes) / 1024.0 / stats.wall_seconds
+                : 0.0;
+            out_ << csv_escape(name) << ","
+                 << stats.calls << ","
+                 << std::fixed << std::setprecision(2) << stats.wall_seconds << ","
+                 << std::fixed << std::setprecision(2) << mb_per_s << ","
+                 << (stats.saved_bytes / 1024) << ","
+                 << std::fixed << std::setprecision(2) << saved_kb_per_s << "\n";
+        }
+    }
+
+    if (size_window_skips > 0) {
+        out_ << "\n\nSkipped by size window\n" << size_window_skips << "\n";
+    }
+
+    out_ << "\n\nTotal amount of time,Encoding mode used\n";
+    out_ << std::fixed << std::setprecision(2) << total_seconds << " seconds,"
+         << (mode_ == EncodeMode::PIPE ? "PIPE" : "PARALLEL") << "\n";
+    out_.close();
 }
\ No newline at end of file
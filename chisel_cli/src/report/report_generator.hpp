@@ -8,7 +8,13 @@
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
 #include <optional>
+#include <set>
 
 enum class EncodeMode;
 
@@ -41,11 +47,149 @@ void print_console_report(const std::vector<Result>& results,
                           EncodeMode mode
                           );
 
-void export_csv_report(const std::vector<Result>& results,
-                       const std::vector<ContainerResult>& container_results,
-                       const std::filesystem::path& output_path,
-                       double total_seconds,
-                       EncodeMode mode);
+/// One (MIME type, size bucket) stratum of the --estimate forecast.
+struct EstimateStratumRow {
+    std::string mime;            ///< Detected MIME type
+    std::string bucket;          ///< Human-readable size bucket label
+    uint64_t files{};            ///< Files in the stratum
+    uintmax_t total_bytes{};     ///< Bytes in the stratum
+    std::size_t sampled_files{}; ///< Files actually recompressed
+    uintmax_t sampled_bytes{};   ///< Bytes actually recompressed
+    uintmax_t sampled_saved{};   ///< Bytes saved on the sample
+    double sampled_seconds{};    ///< CPU-seconds spent on the sample
+    uintmax_t projected_saved{}; ///< sampled_saved scaled to the stratum
+    double projected_seconds{};  ///< CPU-seconds scaled to the stratum
+};
+
+/// Per-processor slice of the --estimate forecast.
+struct EstimateProcessorRow {
+    std::string processor;       ///< Processor name
+    double sampled_seconds{};    ///< Wall time measured on the sample
+    double projected_seconds{};  ///< CPU-seconds scaled to the corpus
+    uintmax_t projected_saved{}; ///< Bytes saved scaled to the corpus
+};
+
+/**
+ * @brief Prints the --estimate forecast breakdown to the console.
+ *
+ * One row per sampled stratum, a per-processor forecast table, and the
+ * projected corpus totals including a wall-clock figure derived from
+ * the CPU-second total and the thread count.
+ *
+ * @param strata Per-stratum measurements and projections.
+ * @param processors Per-processor projections.
+ * @param num_threads Threads the real run would use.
+ * @param sample_seconds Wall time the sampling run itself took.
+ */
+void print_estimate_report(const std::vector<EstimateStratumRow>& strata,
+                           const std::vector<EstimateProcessorRow>& processors,
+                           unsigned num_threads,
+                           double sample_seconds);
+
+/**
+ * @brief Combines per-shard CSV reports into one merged report.
+ *
+ * Reads the machine-readable reports written by N --shard invocations,
+ * concatenates their per-file and container rows, re-aggregates the
+ * per-processor trailer table, and sums the size-window skip counts,
+ * writing one report in the same format. The merged run time is the
+ * slowest shard's, since shards run concurrently on separate machines.
+ * A one-line summary of the combined savings goes to stderr.
+ *
+ * @param shard_reports The per-shard CSV files, in any order.
+ * @param output_path Destination for the merged CSV.
+ * @return 0 on success, 1 if any input cannot be read or is not a
+ *         chisel report.
+ */
+int merge_shard_reports(const std::vector<std::filesystem::path>& shard_reports,
+                        const std::filesystem::path& output_path);
+
+/**
+ * @brief Streaming CSV report writer with bounded memory.
+ *
+ * Rows are appended as per-file results arrive instead of accumulating
+ * every Result until the end of the run, which grew RSS by gigabytes on
+ * multi-million-file runs. The only resident state is the container
+ * table for the trailer section and the (rare) container rows parked
+ * until finalization reports their real final size.
+ *
+ * All methods are thread-safe; with an empty output path every call is
+ * a cheap no-op.
+ */
+class StreamingCsvReport {
+public:
+    /**
+     * @brief Opens the CSV and writes the header row.
+     * @param output_path Report filename; empty disables the report.
+     * @param mode Encoding mode, used to format the codec chain column.
+     */
+    StreamingCsvReport(const std::filesystem::path& output_path, EncodeMode mode);
+
+    /// Whether the report file opened successfully.
+    [[nodiscard]] bool is_open() const { return out_.is_open(); }
+
+    /**
+     * @brief Marks a path as an extracted container.
+     *
+     * Its per-file row is parked until finalize_container_size() so the
+     * streamed row carries the repacked size, not the pre-finalize one.
+     */
+    void note_container(const std::filesystem::path& path);
+
+    /// Appends one per-file row (or parks it if the path is a container).
+    void add_result(Result r);
+
+    /// Records one row for the container trailer section.
+    void add_container(ContainerResult c);
+
+    /**
+     * @brief Folds one processor invocation into the per-processor stats.
+     *
+     * Aggregated into the trailer's processor table: calls, wall time,
+     * input throughput and savings per CPU-second — the ratio used to
+     * decide which processors are worth enabling on a corpus.
+     * @param processor Processor name.
+     * @param input_bytes Size of the invocation's input.
+     * @param output_bytes Size of its output (0 on failure).
+     * @param duration Wall time of the invocation.
+     */
+    void add_processor_timing(const std::string& processor,
+                              uintmax_t input_bytes,
+                              uintmax_t output_bytes,
+                              std::chrono::milliseconds duration);
+
+    /// Patches and flushes the parked row of a finalized container.
+    void finalize_container_size(const std::filesystem::path& path, uintmax_t final_size);
+
+    /**
+     * @brief Flushes parked rows and writes the trailer sections.
+     * @param total_seconds Wall-clock duration of the whole run.
+     * @param size_window_skips Files the --min-size/--max-size window
+     *        excluded; a trailer line is written when non-zero.
+     */
+    void finish(double total_seconds, uint64_t size_window_skips = 0);
+
+private:
+    /// Formats and appends one CSV row; caller must hold mtx_.
+    void write_row_locked(const Result& r);
+
+    std::ofstream out_;   ///< Destination stream (buffered)
+    std::mutex mtx_;      ///< Guards the stream and the state below
+    EncodeMode mode_;     ///< Formats the codec chain separator
+
+    /// Running per-processor aggregates (one entry per processor, bounded).
+    struct ProcessorStats {
+        size_t calls = 0;            ///< Invocations seen
+        uintmax_t input_bytes = 0;   ///< Total bytes fed in
+        uintmax_t saved_bytes = 0;   ///< Total bytes shaved off (improving calls only)
+        double wall_seconds = 0.0;   ///< Total wall time spent
+    };
+
+    std::set<std::filesystem::path> pending_containers_; ///< Extracted containers awaiting their row
+    std::vector<Result> parked_;                         ///< Container rows awaiting final size
+    std::vector<ContainerResult> containers_;            ///< Trailer section rows
+    std::map<std::string, ProcessorStats> processor_stats_; ///< Trailer processor table
+};
 
 unsigned get_terminal_width();
 
@@ -11,6 +11,11 @@
 class ConsoleLogSink final : public ILogSink {
 public:
     LogLevel log_level = LogLevel::Error;
+
+    [[nodiscard]] bool accepts(const LogLevel level) const noexcept override {
+        return level == log_level;
+    }
+
     void log(const LogLevel level,
              const std::string_view message,
              const std::string_view tag) override {
@@ -0,0 +1,224 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+#include "estimator.hpp"
+#include "../cli/cli_parser.hpp"
+#include "../report/report_generator.hpp"
+#include "../../libchisel/include/processor_registry.hpp"
+#include "../../libchisel/include/processor_executor.hpp"
+#include "../../libchisel/include/event_bus.hpp"
+#include "../../libchisel/include/events.hpp"
+#include "../../libchisel/include/logger.hpp"
+#include "../../libchisel/include/mime_detector.hpp"
+#include "../../libchisel/include/random_utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+namespace fs = std::filesystem;
+using namespace chisel;
+
+namespace {
+
+/// Upper bounds of the size buckets; the last bucket is open-ended.
+constexpr uintmax_t bucket_limits[] = {
+    16ull << 10, 256ull << 10, 4ull << 20, 64ull << 20
+};
+constexpr const char* bucket_labels[] = {
+    "<16KB", "16KB-256KB", "256KB-4MB", "4MB-64MB", ">=64MB"
+};
+
+size_t size_bucket(const uintmax_t size) {
+    size_t bucket = 0;
+    for (const uintmax_t limit : bucket_limits) {
+        if (size < limit) return bucket;
+        ++bucket;
+    }
+    return bucket;
+}
+
+/// One (MIME, size bucket) stratum: population plus a reservoir sample.
+struct Stratum {
+    uint64_t files = 0;
+    uintmax_t total_bytes = 0;
+    std::vector<std::pair<fs::path, uintmax_t>> sample; ///< path + size
+
+    /// Reservoir sampling: every file ends up kept with probability k/files.
+    void offer(const fs::path& path, const uintmax_t size, const size_t k) {
+        ++files;
+        total_bytes += size;
+        if (sample.size() < k) {
+            sample.emplace_back(path, size);
+        } else if (const auto j = RandomUtils::next_u64() % files; j < k) {
+            sample[j] = {path, size};
+        }
+    }
+
+    [[nodiscard]] uintmax_t sampled_bytes() const {
+        uintmax_t bytes = 0;
+        for (const auto& [path, size] : sample) bytes += size;
+        return bytes;
+    }
+};
+
+} // namespace
+
+int run_estimate(const Settings& settings, const std::vector<fs::path>& inputs) {
+    const auto start = std::chrono::steady_clock::now();
+
+    // Phase 1: stratify the corpus by (MIME, size bucket). One header
+    // read per file — the same cost the real run's analysis phase pays.
+    std::map<std::pair<std::string, size_t>, Stratum> strata;
+    for (const auto& path : inputs) {
+        std::error_code ec;
+        const auto size = fs::file_size(path, ec);
+        if (ec) continue;
+        const auto mime = MimeDetector::detect(path, MimeDetector::read_header(path));
+        strata[{mime, size_bucket(size)}].offer(path, size, settings.sample_size);
+    }
+
+    // Union of all reservoirs, plus a path → stratum key index so the
+    // sampling run's events can be attributed back to their stratum.
+    std::vector<fs::path> sampled;
+    std::unordered_map<std::string, std::pair<std::string, size_t>> stratum_of;
+    for (const auto& [key, stratum] : strata) {
+        for (const auto& [path, size] : stratum.sample) {
+            sampled.push_back(path);
+            stratum_of.emplace(path.string(), key);
+        }
+    }
+    if (sampled.empty()) {
+        Logger::log(LogLevel::Error, "Nothing to sample.", "estimate");
+        return 1;
+    }
+    Logger::log(LogLevel::Info, [&] {
+        return "Sampling " + std::to_string(sampled.size()) + " of " +
+               std::to_string(inputs.size()) + " files across " +
+               std::to_string(strata.size()) + " strata";
+    }, "estimate");
+
+    // Phase 2: recompress the sample with the normal dataflow in
+    // dry-run mode, at full effort with pruning off, so the forecast
+    // bounds the deepest configuration a real run could pick.
+    struct Measured {
+        uintmax_t saved = 0;
+        double seconds = 0.0;
+    };
+    std::mutex measure_mtx;
+    std::map<std::pair<std::string, size_t>, Measured> per_stratum;
+    // (processor, stratum-or-nullopt) wall time; events on paths we did
+    // not schedule ourselves (extracted container members, finalize
+    // passes) carry no stratum and are scaled by the global ratio.
+    struct TimingSlice {
+        double seconds = 0.0;
+        uintmax_t saved = 0;
+    };
+    std::map<std::pair<std::string, std::optional<std::pair<std::string, size_t>>>,
+             TimingSlice> per_processor;
+
+    ProcessorRegistry registry;
+    EventBus bus;
+    bus.subscribe<FileProcessCompleteEvent>([&](const FileProcessCompleteEvent& e) {
+        const auto it = stratum_of.find(e.path.string());
+        if (it == stratum_of.end()) return; // container member: counted via its parent
+        std::scoped_lock lock(measure_mtx);
+        auto& m = per_stratum[it->second];
+        if (e.new_size < e.original_size) m.saved += e.original_size - e.new_size;
+        m.seconds += std::chrono::duration<double>(e.duration).count();
+    });
+    bus.subscribe<ProcessorTimingEvent>([&](const ProcessorTimingEvent& e) {
+        const auto it = stratum_of.find(e.path.string());
+        std::optional<std::pair<std::string, size_t>> key;
+        if (it != stratum_of.end()) key = it->second;
+        std::scoped_lock lock(measure_mtx);
+        auto& slice = per_processor[{e.processor, std::move(key)}];
+        slice.seconds += std::chrono::duration<double>(e.duration).count();
+        if (e.output_bytes > 0 && e.output_bytes < e.input_bytes) {
+            slice.saved += e.input_bytes - e.output_bytes;
+        }
+    });
+
+    ProcessorExecutor executor(registry,
+                               settings.should_preserve_metadata(),
+                               false, // checksums add nothing to a forecast
+                               settings.encode_mode,
+                               true,  // dry run: never touch the corpus
+                               {},
+                               bus,
+                               settings.num_threads);
+    executor.set_effort(3);
+    executor.set_pipe_prune_threshold(-1.0);
+    executor.set_memory_budget(settings.memory_budget);
+    executor.set_temp_budget(settings.temp_budget);
+    executor.process(sampled);
+
+    // Phase 3: scale each stratum's measurements by its population.
+    uintmax_t corpus_bytes = 0;
+    uintmax_t corpus_sampled_bytes = 0;
+    for (const auto& [key, stratum] : strata) {
+        corpus_bytes += stratum.total_bytes;
+        corpus_sampled_bytes += stratum.sampled_bytes();
+    }
+    const double global_factor = corpus_sampled_bytes > 0
+        ? static_cast<double>(corpus_bytes) / static_cast<double>(corpus_sampled_bytes)
+        : 1.0;
+    auto stratum_factor = [&](const std::pair<std::string, size_t>& key) {
+        const auto& stratum = strata.at(key);
+        const auto bytes = stratum.sampled_bytes();
+        return bytes > 0
+            ? static_cast<double>(stratum.total_bytes) / static_cast<double>(bytes)
+            : 1.0;
+    };
+
+    std::vector<EstimateStratumRow> stratum_rows;
+    stratum_rows.reserve(strata.size());
+    for (const auto& [key, stratum] : strata) {
+        EstimateStratumRow row;
+        row.mime = key.first;
+        row.bucket = bucket_labels[key.second];
+        row.files = stratum.files;
+        row.total_bytes = stratum.total_bytes;
+        row.sampled_files = stratum.sample.size();
+        row.sampled_bytes = stratum.sampled_bytes();
+        if (const auto it = per_stratum.find(key); it != per_stratum.end()) {
+            row.sampled_saved = it->second.saved;
+            row.sampled_seconds = it->second.seconds;
+        }
+        const double factor = stratum_factor(key);
+        row.projected_saved =
+            static_cast<uintmax_t>(static_cast<double>(row.sampled_saved) * factor);
+        row.projected_seconds = row.sampled_seconds * factor;
+        stratum_rows.push_back(std::move(row));
+    }
+    std::ranges::sort(stratum_rows, [](const auto& a, const auto& b) {
+        return a.projected_saved > b.projected_saved;
+    });
+
+    std::map<std::string, EstimateProcessorRow> processor_rows;
+    for (const auto& [key, slice] : per_processor) {
+        const double factor = key.second ? stratum_factor(*key.second) : global_factor;
+        auto& row = processor_rows[key.first];
+        row.processor = key.first;
+        row.sampled_seconds += slice.seconds;
+        row.projected_seconds += slice.seconds * factor;
+        row.projected_saved +=
+            static_cast<uintmax_t>(static_cast<double>(slice.saved) * factor);
+    }
+    std::vector<EstimateProcessorRow> processor_list;
+    processor_list.reserve(processor_rows.size());
+    for (auto& [name, row] : processor_rows) processor_list.push_back(std::move(row));
+    std::ranges::sort(processor_list, [](const auto& a, const auto& b) {
+        return a.projected_seconds > b.projected_seconds;
+    });
+
+    const double sample_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    print_estimate_report(stratum_rows, processor_list, settings.num_threads, sample_seconds);
+    return executor.is_stopped() ? 130 : 0;
+}
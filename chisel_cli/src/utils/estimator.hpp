@@ -0,0 +1,30 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+#ifndef CHISEL_ESTIMATOR_HPP
+#define CHISEL_ESTIMATOR_HPP
+
+#include <filesystem>
+#include <vector>
+
+struct Settings;
+
+/**
+ * @brief Samples the corpus and forecasts savings and run time.
+ *
+ * The collected inputs are stratified by (MIME type, size bucket), a
+ * random sample per stratum is recompressed for real (dry-run, full
+ * effort), and the measured savings and wall time are scaled back up by
+ * each stratum's total byte count. A forecast for a 10-hour corpus
+ * finishes in minutes, so effort levels and processor sets can be
+ * chosen per corpus instead of guessed.
+ *
+ * @param settings Parsed CLI settings (sample size, threads, mode).
+ * @param inputs The already-scanned input files.
+ * @return Process exit code (0 on success).
+ */
+int run_estimate(const Settings& settings,
+                 const std::vector<std::filesystem::path>& inputs);
+
+#endif //CHISEL_ESTIMATOR_HPP
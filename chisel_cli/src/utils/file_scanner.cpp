@@ -5,10 +5,17 @@
 #include "file_scanner.hpp"
 #include "../cli/cli_parser.hpp"
 #include "../../libchisel/include/logger.hpp"
+#include "../../libchisel/include/scan_index.hpp"
+#include "../../libchisel/include/stats.hpp"
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
 #include <regex>
+#include <thread>
 
 namespace fs = std::filesystem;
 
@@ -21,30 +28,91 @@ static bool is_junk(const fs::path& p) {
     return name == ".ds_store" || name == "desktop.ini";
 }
 
-namespace {
-bool is_filtered(const fs::path& path, const Settings& settings) {
+PathFilter::CompiledPattern PathFilter::compile(const std::string& pattern, const char* which) {
+    CompiledPattern compiled;
+    compiled.text = pattern;
+
+    static constexpr std::string_view metacharacters = R"(.^$|()[]{}*+?\)";
+
+    // "*.ext" glob: an extension suffix check, no regex needed
+    if (pattern.size() > 2 && pattern[0] == '*' && pattern[1] == '.' &&
+        pattern.find_first_of(metacharacters, 2) == std::string::npos) {
+        compiled.kind = CompiledPattern::Kind::Extension;
+        compiled.text = pattern.substr(1); // keep ".ext"
+        return compiled;
+    }
+
+    // no metacharacters at all: a plain substring scan
+    if (pattern.find_first_of(metacharacters) == std::string::npos) {
+        compiled.kind = CompiledPattern::Kind::Substring;
+        return compiled;
+    }
+
+    try {
+        compiled.regex = std::regex(pattern);
+        compiled.kind = CompiledPattern::Kind::Regex;
+    } catch (const std::regex_error& e) {
+        // warn once at startup instead of once per scanned file
+        Logger::log(LogLevel::Warning,
+                    "Invalid " + std::string(which) + " regex: " + pattern + " (" + e.what() + ")",
+                    "scanner");
+        compiled.kind = CompiledPattern::Kind::Invalid;
+    }
+    return compiled;
+}
+
+bool PathFilter::matches(const CompiledPattern& pattern, const std::string& path_str) {
+    switch (pattern.kind) {
+        case CompiledPattern::Kind::Substring:
+            return path_str.find(pattern.text) != std::string::npos;
+        case CompiledPattern::Kind::Extension:
+            return path_str.ends_with(pattern.text);
+        case CompiledPattern::Kind::Regex:
+            return std::regex_search(path_str, pattern.regex);
+        case CompiledPattern::Kind::Invalid:
+            return false;
+    }
+    return false;
+}
+
+PathFilter::PathFilter(const std::vector<std::string>& include_patterns,
+                       const std::vector<std::string>& exclude_patterns) {
+    includes_.reserve(include_patterns.size());
+    for (const auto& pattern : include_patterns) {
+        includes_.push_back(compile(pattern, "include"));
+    }
+    excludes_.reserve(exclude_patterns.size());
+    for (const auto& pattern : exclude_patterns) {
+        excludes_.push_back(compile(pattern, "exclude"));
+    }
+}
+
+bool shard_excludes(const fs::path& path, const Settings& settings) {
+    if (settings.shard_count < 2) return false;
+    // FNV-1a over the generic path form: std::hash is not guaranteed
+    // stable across platforms or runs, and shard membership must agree
+    // between independent boxes pointed at the same corpus
+    uint64_t hash = 1469598103934665603ULL;
+    for (const char c : path.generic_string()) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash % settings.shard_count != settings.shard_index - 1;
+}
+
+bool PathFilter::is_filtered(const fs::path& path) const {
     const std::string path_str = path.string();
 
-    if (!settings.exclude_patterns.empty()) {
-        for (const auto& pattern : settings.exclude_patterns) {
-            try {
-                if (std::regex_search(path_str, std::regex(pattern))) {
-                    return true;
-                }
-            } catch (const std::regex_error& e) {
-                Logger::log(LogLevel::Warning, "Invalid exclude regex: " + pattern + " (" + e.what() + ")", "scanner");
-            }
+    for (const auto& pattern : excludes_) {
+        if (matches(pattern, path_str)) {
+            return true;
         }
     }
 
-    if (!settings.include_patterns.empty()) {
-        for (const auto& pattern : settings.include_patterns) {
-            try {
-                if (std::regex_search(path_str, std::regex(pattern))) {
-                    return false;
-                }
-            } catch (const std::regex_error& e) {
-                Logger::log(LogLevel::Warning, "Invalid include regex: " + pattern + " (" + e.what() + ")", "scanner");
+    if (!includes_.empty()) {
+        for (const auto& pattern : includes_) {
+            if (matches(pattern, path_str)) {
+                return false;
             }
         }
         return true;
@@ -52,15 +120,135 @@ bool is_filtered(const fs::path& path, const Settings& settings) {
 
     return false;
 }
-} // namespace
 
+namespace {
+/**
+ * @brief Stat-only size-window prescreen applied during the scan.
+ *
+ * Counted separately from the generic skip counter so the report can
+ * say how much the window excluded. Unknown sizes pass through; the
+ * executor surfaces the real error.
+ */
+bool size_window_excludes(const uintmax_t size, const Settings& settings) {
+    if ((settings.min_size > 0 && size < settings.min_size) ||
+        (settings.max_size > 0 && size > settings.max_size)) {
+        chisel::Stats::add(chisel::Stats::Counter::FilesSkipped);
+        chisel::Stats::add(chisel::Stats::Counter::FilesSizeFiltered);
+        return true;
+    }
+    return false;
+}
 
-std::vector<fs::path>
-collect_input_files(const std::vector<fs::path>& inputs,
-                    const Settings& settings,
-                    bool& is_pipe) {
-    std::vector<fs::path> result;
+/**
+ * @brief Walks directory trees with one task per directory on a small pool.
+ *
+ * Each worker pops a directory, emits its accepted files, and pushes its
+ * subdirectories back as new work, so independent directories are
+ * listed concurrently — on high-latency metadata stores the walk is
+ * bounded by the deepest chain, not the total directory count.
+ */
+void scan_directories(std::deque<fs::path> roots,
+                      const Settings& settings,
+                      const PathFilter& filter,
+                      chisel::ScanIndex* index,
+                      const std::function<void(fs::path)>& emit) {
     const bool recursive = settings.recursive;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<fs::path>& pending_dirs = roots;
+    size_t in_flight = 0;
+
+    const unsigned workers = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+    std::vector<std::jthread> threads;
+    threads.reserve(workers);
+
+    for (unsigned t = 0; t < workers; ++t) {
+        threads.emplace_back([&] {
+            std::unique_lock lock(mtx);
+            for (;;) {
+                cv.wait(lock, [&] { return !pending_dirs.empty() || in_flight == 0; });
+                if (pending_dirs.empty()) {
+                    // no queued work and nobody producing more: done
+                    if (in_flight == 0) return;
+                    continue;
+                }
+                const fs::path dir = std::move(pending_dirs.front());
+                pending_dirs.pop_front();
+                ++in_flight;
+                lock.unlock();
+
+                std::vector<fs::path> subdirs;
+                bool walk = true;
+
+                // Incremental pruning: a directory whose signature is
+                // unchanged since the previous run is not listed at all;
+                // only its previously-known subdirectories are re-checked.
+                if (index != nullptr) {
+                    std::error_code sig_ec;
+                    const auto sig = chisel::ScanIndex::signature_of(dir, sig_ec);
+                    if (sig_ec) {
+                        index->forget(dir.string());
+                        walk = false;
+                    } else {
+                        if (const auto prev = index->lookup(dir.string());
+                            prev && *prev == sig) {
+                            if (recursive) {
+                                for (auto& child : index->children(dir.string())) {
+                                    subdirs.emplace_back(std::move(child));
+                                }
+                            }
+                            walk = false;
+                        }
+                        index->record(dir.string(), sig);
+                    }
+                }
+
+                if (walk) {
+                    std::error_code ec;
+                    for (fs::directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec), end;
+                         !ec && it != end; it.increment(ec)) {
+                        const auto& entry = *it;
+                        if (recursive && entry.is_directory(ec) && !ec) {
+                            subdirs.push_back(entry.path());
+                        } else if (entry.is_regular_file(ec) && !ec &&
+                                   !is_junk(entry.path()) && !filter.is_filtered(entry.path()) &&
+                                   !shard_excludes(entry.path(), settings)) {
+                            std::error_code size_ec;
+                            const auto size = entry.file_size(size_ec);
+                            if (!size_ec && size_window_excludes(size, settings)) continue;
+                            emit(entry.path());
+                        }
+                    }
+                    if (ec) {
+                        Logger::log(LogLevel::Warning,
+                                    "Scan error in " + dir.string() + " (" + ec.message() + ")",
+                                    "scanner");
+                    }
+                }
+
+                lock.lock();
+                --in_flight;
+                if (!subdirs.empty()) {
+                    pending_dirs.insert(pending_dirs.end(),
+                                        std::make_move_iterator(subdirs.begin()),
+                                        std::make_move_iterator(subdirs.end()));
+                    cv.notify_all();
+                } else if (pending_dirs.empty() && in_flight == 0) {
+                    cv.notify_all();
+                }
+            }
+        });
+    }
+}
+} // namespace
+
+void scan_input_files(const std::vector<fs::path>& inputs,
+                      const Settings& settings,
+                      bool& is_pipe,
+                      const std::function<void(fs::path)>& emit,
+                      chisel::ScanIndex* index) {
+    const PathFilter filter(settings.include_patterns, settings.exclude_patterns);
+    std::deque<fs::path> dirs;
 
     for (const auto& in : inputs) {
         if (in == "-") {
@@ -68,7 +256,7 @@ collect_input_files(const std::vector<fs::path>& inputs,
             std::ofstream out(tmp, std::ios::binary);
             out << std::cin.rdbuf();
             out.close();
-            result.push_back(tmp);
+            emit(tmp);
             is_pipe = true;
             continue;
         }
@@ -77,24 +265,36 @@ collect_input_files(const std::vector<fs::path>& inputs,
             continue;
         }
         if (fs::is_directory(in)) {
-            if (recursive) {
-                for (auto& e : fs::recursive_directory_iterator(in)) {
-                    if (fs::is_regular_file(e.path()) && !is_junk(e.path()) && !is_filtered(e.path(), settings))
-                        result.push_back(e.path());
-                }
-            } else {
-                for (auto& e : fs::directory_iterator(in)) {
-                    if (fs::is_regular_file(e.path()) && !is_junk(e.path()) && !is_filtered(e.path(), settings))
-                        result.push_back(e.path());
-                }
-            }
-        } else if (fs::is_regular_file(in) && !is_junk(in) && !is_filtered(in, settings)) {
-            result.push_back(in);
+            dirs.push_back(in);
+        } else if (fs::is_regular_file(in) && !is_junk(in) && !filter.is_filtered(in) &&
+                   !shard_excludes(in, settings)) {
+            std::error_code size_ec;
+            const auto size = fs::file_size(in, size_ec);
+            if (!size_ec && size_window_excludes(size, settings)) continue;
+            emit(in);
         }
     }
 
+    if (!dirs.empty()) {
+        scan_directories(std::move(dirs), settings, filter, index, emit);
+    }
+}
+
+std::vector<fs::path>
+collect_input_files(const std::vector<fs::path>& inputs,
+                    const Settings& settings,
+                    bool& is_pipe,
+                    chisel::ScanIndex* index) {
+    std::vector<fs::path> result;
+    std::mutex result_mtx;
+
+    scan_input_files(inputs, settings, is_pipe, [&](fs::path p) {
+        std::lock_guard lock(result_mtx);
+        result.push_back(std::move(p));
+    }, index);
+
     Logger::log(LogLevel::Info,
                 "Scanner collected " + std::to_string(result.size()) + " files",
                 "scanner");
     return result;
-}
\ No newline at end of file
+}
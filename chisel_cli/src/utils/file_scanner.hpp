@@ -7,13 +7,115 @@
 
 #include <vector>
 #include <filesystem>
+#include <functional>
+#include <regex>
+#include <string>
 
 // Aggiunto
 struct Settings; // Forward declaration
+namespace chisel { class ScanIndex; }
+
+/**
+ * @brief Include/exclude filter with patterns compiled once at startup.
+ *
+ * Building a std::regex per file × per pattern made filtering the
+ * dominant cost of large scans. Each pattern is compiled exactly once
+ * here, and the two shapes that cover most real rule lists skip regex
+ * entirely: plain substrings (no regex metacharacters) and "*.ext"
+ * globs, which become a substring scan and an extension suffix check.
+ * Invalid patterns are warned about once and never match.
+ */
+class PathFilter {
+public:
+    /**
+     * @brief Compiles the include and exclude pattern lists.
+     * @param include_patterns If non-empty, only matching paths pass.
+     * @param exclude_patterns Matching paths are always filtered out.
+     */
+    PathFilter(const std::vector<std::string>& include_patterns,
+               const std::vector<std::string>& exclude_patterns);
+
+    /**
+     * @brief Whether a path should be dropped from the scan.
+     *
+     * Exclude patterns win over include patterns; with a non-empty
+     * include list, paths matching no include pattern are filtered.
+     * @param path The candidate file path.
+     */
+    [[nodiscard]] bool is_filtered(const std::filesystem::path& path) const;
+
+private:
+    /// One pattern, pre-classified into its cheapest matching strategy.
+    struct CompiledPattern {
+        enum class Kind {
+            Substring, ///< Literal text: plain find()
+            Extension, ///< "*.ext" glob: suffix comparison
+            Regex,     ///< Everything else: real regex_search
+            Invalid    ///< Failed to compile: never matches
+        };
+
+        Kind kind = Kind::Invalid;
+        std::string text;  ///< Literal or suffix for the fast paths
+        std::regex regex;  ///< Compiled expression for Kind::Regex
+    };
+
+    /// Classifies and compiles one pattern; warns once if it is invalid.
+    static CompiledPattern compile(const std::string& pattern, const char* which);
+
+    /// Tests one compiled pattern against a path string.
+    static bool matches(const CompiledPattern& pattern, const std::string& path_str);
+
+    std::vector<CompiledPattern> includes_; ///< Compiled include patterns
+    std::vector<CompiledPattern> excludes_; ///< Compiled exclude patterns
+};
+
+/**
+ * @brief Whether --shard assigns a path to a different invocation.
+ *
+ * The owning shard is a stable hash of the full path (FNV-1a over its
+ * generic form) modulo the shard count, so N independent invocations
+ * given the same inputs partition the corpus deterministically with no
+ * coordination. Only top-level scanned files are hashed — contents
+ * extracted from a container never pass through the scanner — so a
+ * container and its extraction/finalization stay wholly on the shard
+ * that owns the container file.
+ *
+ * @param path The candidate file path.
+ * @param settings Carries the --shard K/N assignment (off when count < 2).
+ * @return true if sharding is active and another shard owns the path.
+ */
+bool shard_excludes(const std::filesystem::path& path, const Settings& settings);
+
+/**
+ * @brief Scans the inputs and emits accepted files as they are found.
+ *
+ * Directory trees are walked by a small pool of threads, one directory
+ * per task, so high-latency metadata stores (NFS) are queried in
+ * parallel instead of serially. emit is called once per accepted file,
+ * from multiple threads, in no particular order — callers that want to
+ * overlap scanning with processing can start consuming immediately.
+ *
+ * With a ScanIndex attached, directories whose signature is unchanged
+ * since the previous run are not listed at all — only their
+ * previously-known subdirectories are re-checked — so an untouched
+ * subtree costs one stat per directory and emits nothing.
+ *
+ * @param inputs Files, directories, or "-" for stdin.
+ * @param settings Scan settings (recursion, include/exclude patterns).
+ * @param is_pipe Set to true if stdin input was consumed.
+ * @param emit Callback invoked for every accepted file (must be thread-safe).
+ * @param index Optional incremental scan index (nullptr = full walk).
+ */
+void scan_input_files(const std::vector<std::filesystem::path>& inputs,
+                      const Settings& settings,
+                      bool& is_pipe,
+                      const std::function<void(std::filesystem::path)>& emit,
+                      chisel::ScanIndex* index = nullptr);
 
 std::vector<std::filesystem::path>
 collect_input_files(const std::vector<std::filesystem::path>& inputs,
                     const Settings& settings,
-                    bool& is_pipe);
+                    bool& is_pipe,
+                    chisel::ScanIndex* index = nullptr);
 
-#endif //CHISEL_FILE_SCANNER_HPP
\ No newline at end of file
+#endif //CHISEL_FILE_SCANNER_HPP
@@ -56,6 +56,11 @@ namespace chisel {
          *
          * Performs a full decode and re-encode cycle using the
          * "insane" compression level (APE_COMPRESSION_LEVEL_INSANE).
+         * The decoder runs on its own thread feeding the encoder
+         * through a bounded queue, and when the vendored MACLib
+         * exposes encoder multithreading its frame workers are fed
+         * from the shared core budget, so a full album rip no longer
+         * encodes at single-core speed.
          *
          * @param input Path to the source APE file.
          * @param output Path to write the optimized APE file.
@@ -66,6 +71,13 @@ namespace chisel {
                         const std::filesystem::path& output,
                         bool preserve_metadata) override;
 
+        /// Cancellable variant: polls the token per 16k-block chunk on
+        /// both sides of the decode/encode pipeline.
+        void recompress(const std::filesystem::path& input,
+                        const std::filesystem::path& output,
+                        bool preserve_metadata,
+                        const std::stop_token& stop) override;
+
         /**
          * @brief Extracts embedded cover art from the APE file.
          * @param input_path Path to the APE file.
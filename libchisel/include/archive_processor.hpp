@@ -87,6 +87,26 @@ public:
      */
     [[nodiscard]] bool can_extract_contents() const noexcept override { return true; }
 
+    /**
+     * @brief Finalize only re-packs the extracted members.
+     *
+     * When no member shrank, the rebuild would reproduce an equivalent
+     * archive, so the executor may keep the original instead.
+     * @return true
+     */
+    [[nodiscard]] bool finalize_is_rebuild_only() const noexcept override { return true; }
+
+    // --- configuration ---
+
+    /**
+     * @brief Cap on the size of members staged in memory during extraction.
+     *
+     * Members at or above the limit (and anything that looks like a
+     * nested archive) are written to the temp directory as before; pass
+     * 0 to disable in-memory staging entirely.
+     */
+    void set_memory_member_limit(const uintmax_t bytes) noexcept { memory_member_limit_ = bytes; }
+
     // --- operations ---
 
     /**
@@ -97,10 +117,13 @@ public:
                     bool) override {}
 
     /**
-     * @brief Extracts all files from a supported archive into a temp directory.
+     * @brief Extracts all files from a supported archive.
      *
      * Uses `archive_read_...` functions (libarchive) to decompress the
-     * container and write all entries to a unique temporary directory.
+     * container. Members under the memory limit are staged in memory
+     * (see ExtractedContent::MemoryMember) so nested extraction never
+     * touches the temp volume for them; oversized members and nested
+     * archives are written to a unique temporary directory as before.
      *
      * @param input_path Path to the archive file (e.g., .zip, .rar).
      * @return An ExtractedContent struct containing the list of
@@ -131,6 +154,9 @@ public:
      * @return An empty string.
      */
     [[nodiscard]] std::string get_raw_checksum(const std::filesystem::path& file_path) const override;
+
+private:
+    uintmax_t memory_member_limit_ = 64ull << 20; ///< In-memory staging cap per member (64 MiB)
 };
 
 } // namespace chisel
@@ -47,6 +47,20 @@ namespace chisel {
         [[nodiscard]] bool can_recompress() const noexcept override { return true; }
         [[nodiscard]] bool can_extract_contents() const noexcept override { return false; }
 
+        /**
+         * @brief Buffer-to-buffer recompression is supported on POSIX.
+         *
+         * bmplib only speaks FILE*, so the in-memory path rides on
+         * fmemopen()/open_memstream(), which Windows lacks.
+         */
+        [[nodiscard]] bool can_recompress_buffer() const noexcept override {
+#if defined(_WIN32)
+            return false;
+#else
+            return true;
+#endif
+        }
+
         // --- operations ---
 
         /**
@@ -66,6 +80,18 @@ namespace chisel {
                         const std::filesystem::path& output,
                         bool preserve_metadata) override;
 
+        /**
+         * @brief In-memory variant of recompress().
+         *
+         * Runs the same bmplib transcode over memory streams, so batch
+         * runs over many small BMPs skip the per-file temp-file churn
+         * entirely.
+         * @return false if the input is not a decodable BMP (or on Windows).
+         */
+        bool recompress_buffer(std::span<const std::byte> input,
+                               std::vector<std::byte>& output,
+                               bool preserve_metadata) override;
+
         /**
          * @brief BMP is not a container format.
          * @return std::nullopt
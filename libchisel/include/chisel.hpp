@@ -13,7 +13,10 @@
 #include <string>
 #include <vector>
 #include <filesystem>
+#include <functional>
 #include <memory>
+#include <span>
+#include <cstddef>
 #include <cstdint>
 
 namespace chisel {
@@ -32,6 +35,27 @@ enum class EncodeMode {
     PARALLEL
 };
 
+/**
+ * @brief Worker placement policy on multi-socket (NUMA) machines.
+ *
+ * Workers are pinned to whole NUMA-node CPU sets, so the buffers they
+ * allocate stay in node-local memory via first-touch.
+ */
+enum class AffinityPolicy {
+    /**
+     * @brief Leave placement to the OS scheduler (default).
+     */
+    NONE,
+    /**
+     * @brief Fill one node's cores before spilling to the next.
+     */
+    COMPACT,
+    /**
+     * @brief Spread workers round-robin across the nodes.
+     */
+    SCATTER
+};
+
 /**
  * @brief Interface for receiving progress and status events during execution.
  */
@@ -51,6 +75,66 @@ struct ChiselObserver {
     virtual void onLog(int level, const std::string& msg, const std::string& tag) {}
 };
 
+/// @brief Point-in-time progress snapshot of one asynchronous run.
+struct RunProgress {
+    uint64_t files_done = 0;   ///< Files brought to a terminal outcome
+    uint64_t files_total = 0;  ///< Known work items (grows as containers extract)
+    uintmax_t bytes_saved = 0; ///< Bytes shaved off accepted results so far
+    bool finished = false;     ///< True once the run has fully drained
+};
+
+/**
+ * @brief Handle to one asynchronous recompression run.
+ *
+ * @details Returned by Chisel::recompressAsync(). The handle observes
+ * and controls a single run: progress snapshots, a completion callback,
+ * blocking wait, and per-run cancellation. Dropping the handle does not
+ * cancel the run — it keeps going and is joined when the owning Chisel
+ * is destroyed. Handles are move-only.
+ */
+class RunHandle {
+public:
+    ~RunHandle();
+
+    RunHandle(const RunHandle&) = delete;
+    RunHandle& operator=(const RunHandle&) = delete;
+    RunHandle(RunHandle&&) noexcept;
+    RunHandle& operator=(RunHandle&&) noexcept;
+
+    /**
+     * @brief Blocks until this run has fully drained.
+     */
+    void wait();
+
+    /// @return True once the run has completed (or was cancelled).
+    [[nodiscard]] bool finished() const;
+
+    /**
+     * @brief Returns a point-in-time progress snapshot. Thread-safe.
+     */
+    [[nodiscard]] RunProgress progress() const;
+
+    /**
+     * @brief Registers a callback invoked once when the run completes.
+     *
+     * The callback runs on the run's own thread; if the run has already
+     * finished it is invoked immediately on the calling thread. Only
+     * one callback is kept.
+     */
+    void onComplete(std::function<void(const RunProgress&)> callback);
+
+    /**
+     * @brief Requests cancellation of this run only. Thread-safe.
+     */
+    void stop();
+
+private:
+    friend class Chisel;
+    struct State;
+    explicit RunHandle(std::shared_ptr<State> state);
+    std::shared_ptr<State> state_;
+};
+
 /**
  * @brief Main interface for the Chisel library.
  *
@@ -93,6 +177,82 @@ public:
      */
     Chisel& threads(unsigned val);
 
+    /**
+     * @brief Set the worker placement policy on NUMA machines.
+     *
+     * COMPACT and SCATTER pin each worker to one NUMA node's CPU set,
+     * keeping decode buffers in node-local memory; most valuable for
+     * large-file formats (TIFF, FLAC) on multi-socket boxes. Linux
+     * only; a no-op elsewhere and on single-node machines.
+     * Default: NONE.
+     */
+    Chisel& affinity(AffinityPolicy policy);
+
+    /**
+     * @brief Let the worker pool size itself around I/O stalls.
+     *
+     * The pool samples which workers are actually on-CPU versus blocked
+     * (network filesystems, rename retries) and parks or unparks
+     * workers so runnable ones track the core count: one threads()
+     * baseline then serves both SSD and NFS deployments. Pass 0/0 to
+     * keep the pool fixed at threads().
+     * Default: 0/0 (fixed).
+     *
+     * @param min_threads Lower bound on active workers.
+     * @param max_threads Upper bound on active workers.
+     */
+    Chisel& adaptiveThreads(unsigned min_threads, unsigned max_threads);
+
+    /**
+     * @brief Cap the estimated memory of concurrent recompressions, in bytes.
+     * Default: 0 (unlimited).
+     */
+    Chisel& memoryBudget(uintmax_t bytes);
+
+    /**
+     * @brief Cap the extracted bytes held on the temp volume at once, in bytes.
+     *
+     * Container extraction stalls while the budget is exhausted, until
+     * finalized containers reclaim their temp space.
+     * Default: 0 (unlimited).
+     */
+    Chisel& tempBudget(uintmax_t bytes);
+
+    /**
+     * @brief Process only files whose size lies in [min, max], in bytes.
+     *
+     * Checked against stat data alone, before MIME detection; extracted
+     * container members are exempt. Either bound may be 0 to disable it.
+     * Default: 0/0 (no window).
+     */
+    Chisel& sizeWindow(uintmax_t min_bytes, uintmax_t max_bytes);
+
+    /**
+     * @brief Run the worker threads in the platform's idle classes.
+     *
+     * Workers self-demote to idle CPU and I/O scheduling (SCHED_IDLE +
+     * idle ionice on Linux, background QoS on macOS, background thread
+     * mode on Windows): full throughput on a quiet box, automatic
+     * yielding under foreground load.
+     * Default: false.
+     */
+    Chisel& backgroundMode(bool val);
+
+    /**
+     * @brief Set the effort level: 1 (fast), 2 (default) or 3 (deep).
+     * Out-of-range values are clamped.
+     */
+    Chisel& effort(int level);
+
+    /**
+     * @brief Minimum upstream gain that keeps expensive PIPE stages.
+     *
+     * Deep-search stages (e.g. ZopfliPNG) are skipped when the stage
+     * before them gained less than this fraction.
+     * Default: 0.001 (0.1%); a negative value disables pruning.
+     */
+    Chisel& pipePruneThreshold(double fraction);
+
     /**
      * @brief Set the encoding strategy.
      * Default: PIPE.
@@ -117,19 +277,80 @@ public:
 
     /**
      * @brief Recompresses a list of files. Blocks until completion.
+     *
+     * @details The Chisel object keeps a warm session across calls: the
+     * processor registry, the worker thread pool, and the per-thread
+     * magic databases are initialized on the first call and reused by
+     * later ones, so repeated calls on single files pay only the codec
+     * work. Per-call state (temp arena, duplicate tracking, budgets)
+     * is isolated; changing configuration between calls is safe and
+     * rebuilds the session only when it has to.
      */
     void recompress(const std::vector<std::filesystem::path>& paths);
 
     void recompress(const std::filesystem::path& path);
     void recompress(const std::vector<std::string>& paths);
 
+    /**
+     * @brief Recompresses a single in-memory buffer. Blocks until done.
+     *
+     * @details Detects the type from the buffer contents, runs the
+     * applicable buffer-capable processors entirely in memory (PIPE
+     * chains them, PARALLEL keeps the best independent result), and
+     * never touches the filesystem — made for request paths where the
+     * payload exists only as bytes. Containers and formats whose
+     * processors are path-based are not handled here; use recompress().
+     *
+     * Honors the configured metadata, effort, mode, and prune settings.
+     * Dry-run, output directory, budgets, and the size window do not
+     * apply. Thread-safe against other recompressBuffer() calls.
+     *
+     * @param input The original file contents.
+     * @param output Receives the recompressed contents on success;
+     * untouched otherwise.
+     * @param name_hint Optional file name used only for the extension
+     * fallback when content sniffing is inconclusive.
+     * @return true when output holds a strictly smaller result.
+     */
+    bool recompressBuffer(std::span<const std::byte> input,
+                          std::vector<std::byte>& output,
+                          const std::filesystem::path& name_hint = {});
+
+    /**
+     * @brief Starts a recompression run in the background.
+     *
+     * @details Returns immediately with a handle for progress snapshots,
+     * a completion callback, blocking wait, and per-run cancellation.
+     * Several runs may be in flight at once on the same Chisel; each
+     * gets its own isolated executor and event stream, and all are
+     * stopped and joined when the Chisel is destroyed. Configuration is
+     * snapshotted at call time, so later builder changes do not affect
+     * runs already started.
+     */
+    [[nodiscard]] RunHandle recompressAsync(std::vector<std::filesystem::path> paths);
+
     // --- Control ---
 
     /**
-     * @brief Requests cancellation. Thread-safe.
+     * @brief Requests cancellation of every run, sync and async. Thread-safe.
      */
     void stop();
 
+    /**
+     * @brief Freezes every run, sync and async, without abandoning it.
+     *
+     * In-flight tasks finish; queued work (including container
+     * finalization) stays queued and no completed work is lost. A
+     * blocking recompress() stays blocked until resume(). Thread-safe —
+     * meant to be called from an operator thread or a load watcher.
+     */
+    void pause();
+
+    /**
+     * @brief Resumes runs frozen by pause(). Thread-safe.
+     */
+    void resume();
+
 private:
     struct Impl;
     std::unique_ptr<Impl> impl_;
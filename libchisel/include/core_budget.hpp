@@ -0,0 +1,60 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+/**
+ * @file core_budget.hpp
+ * @brief Process-wide budget of cores for intra-file worker threads.
+ *
+ * Processors that parallelize inside a single file (Zopfli IDAT chunks,
+ * multithreaded xz/zstd filters) draw their extra threads from this
+ * shared pool instead of each assuming the whole machine, so several
+ * big files in flight don't oversubscribe the cores the executor's own
+ * pool is already using.
+ */
+
+#ifndef CHISEL_CORE_BUDGET_HPP
+#define CHISEL_CORE_BUDGET_HPP
+
+namespace chisel {
+
+/**
+ * @brief Static facade for the shared intra-file core budget.
+ *
+ * The budget starts at the hardware thread count; borrow() hands out as
+ * many cores as are currently free (possibly fewer than requested, down
+ * to zero) and release() puts them back. Callers always keep their own
+ * calling thread, so a zero grant degrades to serial work rather than
+ * blocking.
+ */
+class CoreBudget {
+public:
+    /**
+     * @brief Take up to @p want cores from the budget, without blocking.
+     * @param want Number of extra worker threads desired (<= 0 is a no-op).
+     * @return The number of cores actually granted, possibly 0.
+     */
+    [[nodiscard]] static int borrow(int want);
+
+    /// Return cores previously granted by borrow().
+    static void release(int taken);
+
+    /// RAII lease pairing one borrow() with its release().
+    class Lease {
+    public:
+        explicit Lease(const int want) : taken_(borrow(want)) {}
+        ~Lease() { release(taken_); }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        /// @return The number of cores this lease holds.
+        [[nodiscard]] int taken() const noexcept { return taken_; }
+
+    private:
+        int taken_;
+    };
+};
+
+} // namespace chisel
+
+#endif // CHISEL_CORE_BUDGET_HPP
@@ -10,12 +10,14 @@
 #ifndef CHISEL_EVENT_BUS_HPP
 #define CHISEL_EVENT_BUS_HPP
 
+#include "events.hpp"
+#include <atomic>
 #include <functional>
-#include <unordered_map>
-#include <typeindex>
-#include <vector>
-#include <mutex>
 #include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 namespace chisel {
 
@@ -27,10 +29,24 @@ namespace chisel {
      * knowing who is listening. Consumers (e.g. CLI, report generator)
      * can subscribe to specific event types to receive notifications.
      *
-     * This class is thread-safe. Subscriptions and publications
-     * are protected by a mutex.
+     * The event types are the closed set in events.hpp (AllEvents), so
+     * each one gets its own compile-time channel: publish() resolves the
+     * subscriber vector statically via std::get on the channel tuple —
+     * no typeid hashing, no type-erased wrapper and no shared lock on
+     * the hot path. Each channel's handler list is an immutable
+     * snapshot read with a single atomic load; subscribe() builds a new
+     * list under the channel's own mutex and swaps it in, so in-flight
+     * publishers keep running the old snapshot and handlers always run
+     * on the publishing thread, outside any lock.
      */
     class EventBus {
+        /// True when Event appears in the AllEvents tuple.
+        template <typename Event, typename Tuple>
+        struct is_listed;
+        template <typename Event, typename... Events>
+        struct is_listed<Event, std::tuple<Events...>>
+            : std::bool_constant<(std::is_same_v<Event, Events> || ...)> {};
+
     public:
         EventBus() = default;
 
@@ -42,38 +58,69 @@ namespace chisel {
          */
         template <typename Event>
         void subscribe(std::function<void(const Event&)> handler) {
-            std::lock_guard lock(mtx_);
-            auto& vec = subscribers_[std::type_index(typeid(Event))];
-            vec.push_back([handler](const void* e) {
-                handler(*static_cast<const Event*>(e));
-            });
+            static_assert(is_listed<Event, AllEvents>::value,
+                          "Event type must be listed in AllEvents (events.hpp)");
+            auto& ch = std::get<Channel<Event>>(channels_);
+            std::lock_guard lock(ch.mtx);
+            // Copy-on-write: in-flight publishers keep reading the old
+            // snapshot while we build and install the new one.
+            const auto current = ch.handlers.load(std::memory_order_relaxed);
+            auto next = current
+                ? std::make_shared<typename Channel<Event>::HandlerList>(*current)
+                : std::make_shared<typename Channel<Event>::HandlerList>();
+            next->push_back(std::move(handler));
+            ch.handlers.store(std::move(next), std::memory_order_release);
         }
 
         /**
          * @brief Publish an event to all subscribers of its type.
+         *
+         * One atomic load resolves the channel snapshot; handlers run on
+         * the publishing thread, so slow handlers delay their caller but
+         * never block other publishing threads.
          * @tparam Event The event struct type.
          * @param event The event instance to publish.
          */
         template <typename Event>
         void publish(const Event& event) {
-            std::lock_guard lock(mtx_);
-            auto it = subscribers_.find(std::type_index(typeid(Event)));
-            if (it != subscribers_.end()) {
-                for (auto& fn : it->second) {
-                    fn(&event);
+            static_assert(is_listed<Event, AllEvents>::value,
+                          "Event type must be listed in AllEvents (events.hpp)");
+            const auto snapshot =
+                std::get<Channel<Event>>(channels_).handlers.load(std::memory_order_acquire);
+            if (snapshot) {
+                for (const auto& fn : *snapshot) {
+                    fn(event);
                 }
             }
         }
 
     private:
-        ///< Type alias for the internal type-erased callback.
-        using Callback = std::function<void(const void*)>;
-        ///< Map of event type_index to a vector of callbacks.
-        std::unordered_map<std::type_index, std::vector<Callback>> subscribers_;
-        ///< Protects subscriber map during read/write.
-        std::mutex mtx_;
+        /**
+         * @brief Per-event-type subscriber channel.
+         *
+         * Handlers are stored with their real signature — no void*
+         * erasure — behind an atomically swapped immutable snapshot.
+         * The mutex only serializes subscribers against each other.
+         */
+        template <typename Event>
+        struct Channel {
+            using HandlerList = std::vector<std::function<void(const Event&)>>;
+            std::mutex mtx;                                           ///< Serializes subscribe() calls
+            std::atomic<std::shared_ptr<const HandlerList>> handlers; ///< Immutable snapshot, null until first subscribe
+        };
+
+        /// Expands AllEvents into the matching tuple of channels.
+        template <typename Tuple>
+        struct ChannelsFor;
+        template <typename... Events>
+        struct ChannelsFor<std::tuple<Events...>> {
+            using type = std::tuple<Channel<Events>...>;
+        };
+
+        ///< One statically resolved channel per event type.
+        typename ChannelsFor<AllEvents>::type channels_;
     };
 
 } // namespace chisel
 
-#endif // CHISEL_EVENT_BUS_HPP
\ No newline at end of file
+#endif // CHISEL_EVENT_BUS_HPP
@@ -16,6 +16,7 @@
 #include <filesystem>
 #include <string>
 #include <chrono>
+#include <tuple>
 
 namespace chisel {
 
@@ -64,6 +65,18 @@ struct FileAnalyzeSkippedEvent {
 
 // --- Phase 2: Processing ---
 
+/**
+ * @brief Emitted when a file is enqueued for recompression.
+ *
+ * Exposes the size-aware dispatch order so subscribers can verify how
+ * the scheduler sequenced the work (e.g. largest-first).
+ */
+struct FileProcessQueuedEvent {
+    std::filesystem::path path; ///< Path of the queued file
+    uintmax_t size = 0;         ///< File size at analysis time
+    uintmax_t priority = 0;     ///< Dispatch priority assigned to the task
+};
+
 /**
  * @brief Emitted when recompression of a file begins.
  */
@@ -82,6 +95,22 @@ struct FileProcessCompleteEvent {
     std::chrono::milliseconds duration{0};  ///< Processing duration
 };
 
+/**
+ * @brief Emitted once per processor invocation with its wall time.
+ *
+ * Published by both the PIPE and PARALLEL recompression branches, one
+ * event per stage/candidate, so subscribers can attribute where run
+ * time went per processor (throughput, savings per CPU-second) rather
+ * than only per file.
+ */
+struct ProcessorTimingEvent {
+    std::filesystem::path path;            ///< File the processor ran on
+    std::string processor;                 ///< Processor name (IProcessor::get_name)
+    uintmax_t input_bytes = 0;             ///< Size of the stage's input
+    uintmax_t output_bytes = 0;            ///< Size of the stage's output (0 on failure)
+    std::chrono::milliseconds duration{0}; ///< Wall time of the invocation
+};
+
 /**
  * @brief Emitted when processing of a file fails with an exception.
  */
@@ -98,6 +127,19 @@ struct FileProcessSkippedEvent {
     std::string reason;         ///< Reason for skipping
 };
 
+/**
+ * @brief Emitted when a cluster of byte-identical files reuses one result.
+ *
+ * Only the representative was actually recompressed; the duplicates had
+ * its outcome applied directly, so subscribers can report how much
+ * recompression work deduplication avoided.
+ */
+struct DuplicateClusterEvent {
+    std::filesystem::path representative; ///< The file that was actually processed
+    std::size_t duplicates = 0;           ///< Byte-identical copies that reused the result
+    uintmax_t deduplicated_bytes = 0;     ///< Total input bytes not recompressed
+};
+
 // --- Phase 3: Finalization ---
 
 /**
@@ -123,6 +165,32 @@ struct ContainerFinalizeErrorEvent {
     std::string error_message;  ///< Error description
 };
 
+/**
+ * @brief The closed set of event types, in phase order.
+ *
+ * EventBus keys its compile-time channels off this list: one statically
+ * resolved subscriber vector per entry, with no typeid lookup or
+ * type-erased wrapper on the publish path. A new event struct must be
+ * added here before the bus will carry it (enforced by a static_assert
+ * in event_bus.hpp).
+ */
+using AllEvents = std::tuple<
+    FileAnalyzeStartEvent,
+    FileAnalyzeCompleteEvent,
+    FileAnalyzeErrorEvent,
+    FileAnalyzeSkippedEvent,
+    FileProcessQueuedEvent,
+    FileProcessStartEvent,
+    FileProcessCompleteEvent,
+    ProcessorTimingEvent,
+    FileProcessErrorEvent,
+    FileProcessSkippedEvent,
+    DuplicateClusterEvent,
+    ContainerFinalizeStartEvent,
+    ContainerFinalizeCompleteEvent,
+    ContainerFinalizeErrorEvent
+>;
+
 } // namespace chisel
 
 #endif // CHISEL_EVENTS_HPP
\ No newline at end of file
@@ -5,10 +5,14 @@
 #ifndef CHISEL_FILE_UTILS_HPP
 #define CHISEL_FILE_UTILS_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <filesystem>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace chisel {
 
@@ -33,6 +37,179 @@ namespace chisel {
     std::filesystem::path make_temp_dir_for(const std::filesystem::path &input_path,
                                             const std::string &prefix);
 
+    /**
+     * @brief Builds a unique hidden temp path beside the given target file.
+     *
+     * A temp created here lives on the same filesystem as the target, so
+     * the final fs::rename onto the target is an atomic metadata-only
+     * operation instead of silently degrading to a cross-device copy.
+     *
+     * @param target The file the temp will eventually replace.
+     * @param label A short label distinguishing the producer (e.g. "pipe").
+     * @return A unique sibling path of the form ".chisel-tmp.{name}.{label}.{rand}".
+     */
+    std::filesystem::path make_sibling_temp(const std::filesystem::path &target,
+                                            const std::string &label);
+
+    /**
+     * @brief Copies a file using the cheapest mechanism the platform offers.
+     *
+     * Tries a reflink/clone first (FICLONE on Linux, clonefile on macOS),
+     * which shares extents at metadata speed on XFS/btrfs/APFS, then an
+     * in-kernel copy_file_range loop, and finally falls back to a plain
+     * std::filesystem::copy_file. An existing destination is overwritten.
+     *
+     * @param src The file to copy.
+     * @param dst The destination path.
+     * @return true on success, false if every mechanism failed.
+     */
+    bool clone_or_copy_file(const std::filesystem::path &src,
+                            const std::filesystem::path &dst);
+
+    /**
+     * @brief Caps the aggregate rate of the reading file helpers.
+     *
+     * A process-wide token bucket paces read_file() and checksum_file()
+     * across all threads, for runs that must leave disk bandwidth to
+     * foreground traffic (see the CLI's background mode). Memory-mapped
+     * views are not throttled — their I/O happens on page faults.
+     *
+     * @param bytes_per_second The cap; 0 (the default) disables throttling.
+     */
+    void set_read_throttle(uintmax_t bytes_per_second);
+
+    /**
+     * @brief Reads an entire file into a byte buffer.
+     * @param path The file to read.
+     * @param out Receives the file contents (cleared first).
+     * @return true on success, false if the file could not be read.
+     */
+    bool read_file(const std::filesystem::path &path, std::vector<std::byte> &out);
+
+    /**
+     * @brief Writes a byte buffer to a file, replacing any existing content.
+     * @param path The destination file.
+     * @param data The bytes to write.
+     * @return true on success, false if the file could not be written.
+     */
+    bool write_file(const std::filesystem::path &path, std::span<const std::byte> data);
+
+    /**
+     * @brief Read-only memory-mapped view of a file.
+     *
+     * Mapping replaces slurping whole files through stdio buffers into a
+     * vector: pages come straight from the page cache with no userspace
+     * copy, and consecutive PIPE stages touching the same file share
+     * them. Uses mmap on POSIX and CreateFileMapping on Windows.
+     *
+     * The view stays valid for the lifetime of the object; the type is
+     * movable but not copyable.
+     */
+    class MappedFile {
+    public:
+        MappedFile() = default;
+
+        /**
+         * @brief Maps the given file read-only.
+         *
+         * On failure the object is left closed (is_open() == false); the
+         * error is logged. An empty file maps successfully to an empty view.
+         * @param path The file to map.
+         */
+        explicit MappedFile(const std::filesystem::path &path);
+
+        ~MappedFile();
+
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        /// @return True if the file was mapped successfully.
+        [[nodiscard]] bool is_open() const { return open_; }
+
+        /// @return Pointer to the first mapped byte (nullptr for an empty file).
+        [[nodiscard]] const std::byte *data() const {
+            return static_cast<const std::byte *>(data_);
+        }
+
+        /// @return Size of the mapped file in bytes.
+        [[nodiscard]] std::size_t size() const { return size_; }
+
+        /// @return The whole file as a read-only byte span.
+        [[nodiscard]] std::span<const std::byte> bytes() const {
+            return {data(), size_};
+        }
+
+    private:
+        void close();
+
+        void *data_ = nullptr;  ///< Start of the mapped view
+        std::size_t size_ = 0;  ///< Length of the view in bytes
+        bool open_ = false;     ///< Whether the mapping succeeded
+#ifdef _WIN32
+        void *mapping_ = nullptr; ///< File-mapping object handle
+#endif
+    };
+
+    /**
+     * @brief Streaming CRC32C checksum shared by processors.
+     *
+     * Uses the SSE4.2 / ARMv8 CRC instructions when the build targets
+     * them and falls back to a table-driven implementation otherwise.
+     * Processors can fold decoded samples or pixels into the hash as the
+     * decoder produces them, so integrity verification piggybacks on
+     * work already being done instead of re-reading the file.
+     */
+    class StreamingChecksum {
+    public:
+        /**
+         * @brief Folds a block of bytes into the checksum.
+         * @param data Pointer to the block.
+         * @param len Length of the block in bytes.
+         */
+        void update(const void *data, std::size_t len);
+
+        /// @brief Folds a span of bytes into the checksum.
+        void update(const std::span<const std::byte> data) {
+            update(data.data(), data.size());
+        }
+
+        /// @return The CRC32C of everything folded in so far.
+        [[nodiscard]] std::uint32_t value() const { return crc_ ^ 0xFFFFFFFFu; }
+
+        /**
+         * @return value() as an 8-digit lowercase hex string, the format
+         * expected from IProcessor::get_raw_checksum().
+         */
+        [[nodiscard]] std::string hex() const;
+
+    private:
+        std::uint32_t crc_ = 0xFFFFFFFFu; ///< Running CRC state (pre-inverted)
+    };
+
+    /**
+     * @brief Checksums an entire file by streaming it in large blocks.
+     * @param path The file to checksum.
+     * @return The hex digest, or an empty string if the file could not be read.
+     */
+    std::string checksum_file(const std::filesystem::path &path);
+
+    /**
+     * @brief Compares two files for byte identity with minimal I/O.
+     *
+     * A size mismatch returns false before any byte is read. Otherwise
+     * both files are mapped and compared block-wise, returning on the
+     * first differing block instead of reading the rest; when mapping
+     * fails (special filesystems) a buffered loop does the same
+     * early-exit compare. This is the fast path behind the default
+     * IProcessor::raw_equal().
+     *
+     * @return true if both files exist and hold identical bytes.
+     */
+    bool raw_equal_files(const std::filesystem::path &a,
+                         const std::filesystem::path &b);
+
     /**
      * @brief Recursively removes a directory and logs any errors.
      * @param dir The path to the directory to be removed.
@@ -79,6 +79,11 @@ public:
      */
     void recompress(const std::filesystem::path &input, const std::filesystem::path &output, bool preserve_metadata) override;
 
+    /// Cancellable variant: decodes frame by frame and polls the token
+    /// between frames, so a stop lands within one FLAC frame.
+    void recompress(const std::filesystem::path &input, const std::filesystem::path &output,
+                    bool preserve_metadata, const std::stop_token &stop) override;
+
     // --- integrity check ---
 
     /**
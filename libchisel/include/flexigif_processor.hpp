@@ -45,6 +45,23 @@ namespace chisel {
         [[nodiscard]] bool can_recompress() const noexcept override { return true; }
         [[nodiscard]] bool can_extract_contents() const noexcept override { return false; }
 
+        /// The LZW search is by far the costliest GIF stage; the executor
+        /// may prune it when gifsicle's pass already found no headroom.
+        [[nodiscard]] bool is_expensive() const noexcept override { return true; }
+
+        // --- configuration ---
+
+        /**
+         * @brief Set the effort level (1 = fast, 2 = default, 3 = deep).
+         *
+         * FlexiGIF's LZW search costs orders of magnitude more CPU than
+         * gifsicle's pass for single-digit extra savings, so the knob
+         * gates it hard: level 1 passes the input through untouched,
+         * level 2 optimizes only files under a size cap with a bounded
+         * pre-pass, level 3 lifts the cap and stretches the budget.
+         */
+        void set_effort(const int level) noexcept override { effort_ = level; }
+
         // --- operations ---
 
         /**
@@ -54,6 +71,10 @@ namespace chisel {
          * LzwEncoder::optimize to find a more optimal LZW encoding.
          * The result is written using `writeOptimized`.
          *
+         * The work is gated by the effort level (see set_effort()); a
+         * gated-out file is copied through unchanged so a PIPE chain
+         * keeps the previous stage's result.
+         *
          * @param input Path to the source GIF file.
          * @param output Path to write the optimized GIF file.
          * @param preserve_metadata This processor currently does not
@@ -88,6 +109,9 @@ namespace chisel {
          * @note This means raw_equal() will always return true.
          */
         [[nodiscard]] std::string get_raw_checksum(const std::filesystem::path& file_path) const override;
+
+    private:
+        int effort_ = 2; ///< Current effort level (see set_effort())
     };
 
 } // namespace chisel
@@ -0,0 +1,115 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+/**
+ * @file gain_model.hpp
+ * @brief Persistent per-stage gain/cost statistics across runs.
+ */
+
+#ifndef CHISEL_GAIN_MODEL_HPP
+#define CHISEL_GAIN_MODEL_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace chisel {
+
+/**
+ * @brief Opt-in SQLite-backed model of what each stage actually achieves.
+ *
+ * Candidate processors come out of the registry in fixed construction
+ * order, so PIPE mode runs every stage on every file regardless of how
+ * little a stage has ever gained on the corpus at hand. This model
+ * accumulates per-(processor, mime, size-bucket) statistics — bytes in,
+ * bytes out, wall time — across runs; on homogeneous corpora last
+ * night's numbers predict tonight's, letting the executor order
+ * candidates best-ratio-first and drop stages whose expected gain is
+ * negligible (see ProcessorExecutor::set_gain_model()).
+ *
+ * All methods are thread-safe; failures degrade to "no data" and are
+ * logged rather than thrown, since the model is purely an accelerator.
+ */
+class GainModel {
+public:
+    /// @brief What the statistics predict for one stage on one input.
+    struct Expectation {
+        double gain;          ///< Expected fractional size reduction
+        double millis_per_mib; ///< Expected wall time per MiB of input
+    };
+
+    /**
+     * @brief Opens (or creates) the statistics database.
+     *
+     * On failure the model is left closed and every operation becomes a
+     * no-op; the error is logged.
+     *
+     * @param db_path Path to the SQLite database file.
+     * @param version The chisel version string, part of the row key so
+     * upgraded processors start from fresh statistics.
+     */
+    explicit GainModel(const std::filesystem::path& db_path, std::string version);
+
+    ~GainModel();
+
+    GainModel(const GainModel&) = delete;
+    GainModel& operator=(const GainModel&) = delete;
+
+    /// @return True if the database was opened successfully.
+    [[nodiscard]] bool is_open() const { return db_ != nullptr; }
+
+    /**
+     * @brief Records one stage invocation.
+     *
+     * @param processor The stage's IProcessor::get_name().
+     * @param mime MIME type of the input, as detected during analysis.
+     * @param input_bytes Size of the stage's input.
+     * @param output_bytes Size of the stage's output (pass input_bytes
+     * for a failed stage: the cost was paid, the gain was zero).
+     * @param elapsed Wall time the stage took.
+     */
+    void record(std::string_view processor,
+                const std::string& mime,
+                uintmax_t input_bytes,
+                uintmax_t output_bytes,
+                std::chrono::milliseconds elapsed);
+
+    /**
+     * @brief Predicts a stage's outcome on an input of the given size.
+     *
+     * @param processor The stage's IProcessor::get_name().
+     * @param mime MIME type of the input.
+     * @param input_bytes Size of the input (selects the size bucket).
+     * @return The prediction, or std::nullopt when fewer than
+     * min_samples invocations have been recorded for this combination.
+     */
+    [[nodiscard]] std::optional<Expectation> expect(std::string_view processor,
+                                                    const std::string& mime,
+                                                    uintmax_t input_bytes);
+
+    /// Invocations required before a combination's statistics are trusted.
+    static constexpr int min_samples = 8;
+
+private:
+    /// Power-of-two size bucket, so e.g. thumbnails and photographs of
+    /// the same MIME type keep separate statistics.
+    [[nodiscard]] static int size_bucket(uintmax_t bytes) noexcept;
+
+    sqlite3* db_ = nullptr;               ///< Database handle (nullptr if closed)
+    sqlite3_stmt* record_stmt_ = nullptr; ///< Prepared upsert
+    sqlite3_stmt* expect_stmt_ = nullptr; ///< Prepared SELECT
+    std::mutex mtx_;                      ///< Serializes statement use across workers
+    std::string version_;                 ///< Version component of the row key
+};
+
+} // namespace chisel
+
+#endif // CHISEL_GAIN_MODEL_HPP
@@ -38,6 +38,13 @@ namespace chisel {
                         const std::filesystem::path& output,
                         bool preserve_metadata) override;
 
+        /// Cancellable variant: the frame-compression loop polls the
+        /// token, so a stop lands within one LZW frame.
+        void recompress(const std::filesystem::path& input,
+                        const std::filesystem::path& output,
+                        bool preserve_metadata,
+                        const std::stop_token& stop) override;
+
         std::optional<ExtractedContent> prepare_extraction(
             [[maybe_unused]] const std::filesystem::path& input_path) override { return std::nullopt; }
 
@@ -0,0 +1,58 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+/**
+ * @file io_engine.hpp
+ * @brief Bulk file I/O backend: io_uring on Linux, portable fallback elsewhere.
+ */
+
+#ifndef CHISEL_IO_ENGINE_HPP
+#define CHISEL_IO_ENGINE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace chisel::io {
+
+    /**
+     * @brief Whether the io_uring backend is compiled in and usable.
+     *
+     * True only when the build enabled CHISEL_WITH_IOURING, liburing was
+     * present, and the running kernel accepts ring setup (checked once).
+     * When false every operation takes the portable synchronous path.
+     */
+    [[nodiscard]] bool uring_available() noexcept;
+
+    /**
+     * @brief Reads an entire file into a byte buffer.
+     *
+     * With the io_uring backend a large file is split into chunks read
+     * in parallel through the calling worker's ring, so a single slurp
+     * fills the device queue depth instead of issuing one blocking read
+     * at a time; small files cost one submission. Falls back to a plain
+     * buffered read when the ring is unavailable or an operation fails.
+     *
+     * @param path The file to read.
+     * @param out Receives the file contents (cleared first).
+     * @return true on success, false if the file could not be read.
+     */
+    bool read_whole(const std::filesystem::path &path, std::vector<std::byte> &out);
+
+    /**
+     * @brief Writes a byte buffer to a file, replacing existing content.
+     *
+     * Chunked and batched through the ring like read_whole(); used for
+     * writing pipeline temps and spilled container members.
+     *
+     * @param path The destination file.
+     * @param data The bytes to write.
+     * @return true on success, false if the file could not be written.
+     */
+    bool write_whole(const std::filesystem::path &path, std::span<const std::byte> data);
+
+} // namespace chisel::io
+
+#endif // CHISEL_IO_ENGINE_HPP
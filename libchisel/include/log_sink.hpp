@@ -39,6 +39,20 @@ enum class LogLevel {
 struct ILogSink {
     virtual ~ILogSink() = default;
 
+    /**
+     * @brief Whether this sink would emit a message of the given level.
+     *
+     * Lets the Logger skip building messages no sink will consume.
+     * The default accepts everything.
+     *
+     * @param level Severity level to query.
+     * @return true if a message at this level would be written.
+     */
+    [[nodiscard]] virtual bool accepts(LogLevel level) const noexcept {
+        (void)level;
+        return true;
+    }
+
     /**
      * @brief Log a message.
      *
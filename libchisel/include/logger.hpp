@@ -15,9 +15,14 @@
 #define CHISEL_LOGGER_HPP
 
 #include "log_sink.hpp"
+#include <atomic>
+#include <concepts>
+#include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 /**
@@ -25,6 +30,13 @@
  *
  * Provides a global, thread-safe entry point for logging. It delegates
  * log messages to all registered ILogSink implementations.
+ *
+ * By default messages are written to the sinks synchronously. In async
+ * mode (see set_async()) producers only push a record into a bounded
+ * in-memory queue and a background thread drains it to the sinks, so
+ * worker threads are never serialized behind sink I/O. When the queue
+ * is full the oldest records are dropped (and the drop is reported) so
+ * logging can never stall the pipeline.
  */
 class Logger {
 public:
@@ -53,6 +65,54 @@ public:
                     std::string_view msg,
                     std::string_view tag = "chisel");
 
+    /**
+     * @brief Whether any registered sink would emit the given level.
+     *
+     * Cheap (one atomic load): use it to skip building expensive
+     * messages that no sink will consume.
+     * @param level Severity level to query.
+     * @return true if at least one sink accepts the level.
+     */
+    static bool enabled(const LogLevel level) {
+        return (enabled_mask_.load(std::memory_order_relaxed) &
+                (1u << static_cast<unsigned>(level))) != 0;
+    }
+
+    /**
+     * @brief Lazy variant of log(): the message is only built if needed.
+     *
+     * The callable is invoked to materialize the message string only
+     * when a sink accepts the level, so hot paths can log Debug detail
+     * without paying for string concatenation on every call.
+     *
+     * @tparam F Callable returning something convertible to std::string.
+     * @param level Severity level.
+     * @param make_msg Callable producing the message text.
+     * @param tag Optional tag (default: "chisel").
+     */
+    template <typename F>
+        requires std::invocable<F>
+    static void log(const LogLevel level, F&& make_msg, const std::string_view tag = "chisel") {
+        if (!enabled(level)) return;
+        const std::string msg = std::forward<F>(make_msg)();
+        log(level, std::string_view(msg), tag);
+    }
+
+    /**
+     * @brief Enable or disable asynchronous logging.
+     *
+     * Enabling starts the background drain thread; disabling flushes
+     * any queued records and stops it. Safe to call at any time.
+     * @param enabled True for async mode, false for synchronous.
+     */
+    static void set_async(bool enabled);
+
+    /**
+     * @brief Block until every queued record has reached the sinks.
+     * No-op in synchronous mode.
+     */
+    static void flush();
+
     /**
      * @brief Converts a LogLevel enum to its string representation.
      * @param level The enum value.
@@ -84,10 +144,47 @@ public:
         return LogLevel::Error; // Default fallback
     }
 private:
+    ///< One queued log message in async mode.
+    struct LogRecord {
+        LogLevel level;
+        std::string msg;
+        std::string tag;
+    };
+
+    ///< Upper bound on queued records before the oldest are dropped.
+    static constexpr size_t max_queue_length = 8192;
+
+    /// Recompute enabled_mask_ from the current sinks. Caller holds mtx_.
+    static void refresh_enabled_mask();
+
+    /// Deliver a batch of records to the sinks.
+    static void write_records(const std::deque<LogRecord>& records);
+
+    /// Body of the background drain thread.
+    static void drain_loop(const std::stop_token& st);
+
     ///< List of all registered sink implementations.
     static std::vector<std::unique_ptr<ILogSink>> sinks_;
     ///< Protects access to the sinks_ vector.
     static std::mutex mtx_;
+    ///< Pending records awaiting the drain thread (async mode).
+    static std::deque<LogRecord> queue_;
+    ///< Guards queue_, dropped_ and in_flight_.
+    static std::mutex queue_mtx_;
+    ///< Wakes the drain thread when records arrive.
+    static std::condition_variable_any queue_cv_;
+    ///< Wakes flush() when the queue has fully drained.
+    static std::condition_variable drained_cv_;
+    ///< True while async mode is active.
+    static std::atomic<bool> async_;
+    ///< True while the drain thread is writing a swapped-out batch.
+    static bool in_flight_;
+    ///< Records discarded because the queue was full.
+    static size_t dropped_;
+    ///< The background drain thread.
+    static std::jthread drain_thread_;
+    ///< Bitmask of levels at least one sink accepts (bit = LogLevel value).
+    static std::atomic<unsigned> enabled_mask_;
 };
 
 #endif //CHISEL_LOGGER_HPP
\ No newline at end of file
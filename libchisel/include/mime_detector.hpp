@@ -5,8 +5,15 @@
 #ifndef CHISEL_MIME_DETECTOR_HPP
 #define CHISEL_MIME_DETECTOR_HPP
 
+#include <cstddef>
 #include <filesystem>
+#include <span>
 #include <string>
+#include <vector>
+
+#ifndef _WIN32
+struct magic_set; ///< Opaque libmagic state (magic_t is a pointer to this).
+#endif
 
 namespace chisel {
 
@@ -17,18 +24,124 @@ namespace chisel {
      */
     class MimeDetector {
     public:
+        /**
+         * @brief A persistent libmagic session holding a loaded magic database.
+         *
+         * @details Opening and loading the compiled magic database is by far
+         * the most expensive part of a detection, so a Session does it once
+         * and reuses the handle for every subsequent query. Sessions are not
+         * thread-safe; use one per thread (see thread_session()).
+         *
+         * On Windows (where libmagic is unavailable) a Session is an empty
+         * shell and queries fall back to the extension map.
+         */
+        class Session {
+        public:
+            Session();
+            ~Session();
+
+            Session(const Session&) = delete;
+            Session& operator=(const Session&) = delete;
+
+            /**
+             * @brief Detect the MIME type of a file using the cached handle.
+             * @param path The filesystem path to the file.
+             * @return A string representing the MIME type (e.g., "image/jpeg").
+             */
+            [[nodiscard]] std::string detect(const std::filesystem::path& path) const;
+
+            /**
+             * @brief Detect the MIME type from an already-read file header.
+             *
+             * @details Feeds the buffer through magic_buffer(), so libmagic
+             * never opens the file itself. Callers that already hold the
+             * first few kilobytes of a file (see read_header()) avoid a
+             * second open+read round trip.
+             *
+             * @param path The filesystem path (used only for the extension
+             * fallback on platforms without libmagic).
+             * @param header The first bytes of the file (sniff_length is plenty).
+             * @return A string representing the MIME type (e.g., "image/jpeg").
+             */
+            [[nodiscard]] std::string detect(const std::filesystem::path& path,
+                                             std::span<const std::byte> header) const;
+
+            /**
+             * @brief Checks if a file is MPEG-1 Layer 3 (MP3) using the cached handle.
+             * @param path The filesystem path to the file.
+             * @return true if the file is identified as MP3, false otherwise.
+             */
+            [[nodiscard]] bool is_mpeg1_layer3(const std::filesystem::path& path) const;
+
+            /**
+             * @brief Buffer variant of is_mpeg1_layer3() for an already-read header.
+             * @param path The filesystem path (extension fallback only).
+             * @param header The first bytes of the file.
+             * @return true if the header identifies MPEG-1 Layer 3, false otherwise.
+             */
+            [[nodiscard]] bool is_mpeg1_layer3(const std::filesystem::path& path,
+                                               std::span<const std::byte> header) const;
+
+        private:
+#ifndef _WIN32
+            magic_set* magic_ = nullptr; ///< Loaded libmagic handle, or nullptr if loading failed.
+#endif
+        };
+
+        /**
+         * @brief Returns the calling thread's persistent Session.
+         *
+         * The session is created (and the magic database loaded) on first
+         * use and lives for the remainder of the thread's lifetime, so
+         * repeated detections on worker threads pay the load cost once.
+         */
+        static Session& thread_session();
+
         /**
          * @brief Detect the MIME type of a file.
          *
          * @param path The filesystem path to the file.
          * @return A string representing the MIME type (e.g., "image/jpeg").
          *
-         * @note On Linux/macOS, this uses libmagic for accurate detection.
+         * @note On Linux/macOS, this uses libmagic for accurate detection,
+         * via the calling thread's cached Session.
          * @note On Windows, this currently falls back to a simple
          * map of file extensions to MIME types.
+         * @note Verdicts are cached process-wide keyed on the file's
+         * (device, inode, mtime, size), so repeat detections of the same
+         * unchanged file cost one stat.
          */
         static std::string detect(const std::filesystem::path& path);
 
+        /**
+         * @brief Detect the MIME type from an already-read file header.
+         * Convenience wrapper around the calling thread's Session;
+         * shares the stat-keyed verdict cache with the path overload.
+         * @param path The filesystem path (extension fallback only).
+         * @param header The first bytes of the file.
+         */
+        static std::string detect(const std::filesystem::path& path,
+                                  std::span<const std::byte> header);
+
+        /**
+         * @brief How many leading bytes read_header() fetches.
+         *
+         * 16 KB covers every magic pattern chisel cares about while keeping
+         * the read to a handful of filesystem blocks.
+         */
+        static constexpr std::size_t sniff_length = 16 * 1024;
+
+        /**
+         * @brief Read the first sniff_length bytes of a file.
+         *
+         * The returned buffer can be fed to the buffer overloads of
+         * detect() / is_mpeg1_layer3() so the file is opened once.
+         * @param path The filesystem path to the file.
+         * @return The leading bytes (shorter than sniff_length for small
+         * files), or an empty vector if the file could not be opened.
+         */
+        static std::vector<std::byte> read_header(const std::filesystem::path& path);
+
         /**
          * @brief Specifically checks if a file is MPEG-1 Layer 3 (MP3).
          * * Used for formats where MIME detection alone might be ambiguous.
@@ -52,4 +165,4 @@ namespace chisel {
     };
 
 } // namespace chisel
-#endif //CHISEL_MIME_DETECTOR_HPP
\ No newline at end of file
+#endif //CHISEL_MIME_DETECTOR_HPP
@@ -16,7 +16,10 @@ namespace chisel {
      * @brief Implements IProcessor for MP4/M4A files.
      *
      * @details Extracts and re-inserts cover art (atom 'covr') using
-     * AudioMetadataUtil. Stream recompression is not yet implemented.
+     * AudioMetadataUtil. Recompression is a lossless structural rewrite:
+     * free/skip padding atoms are dropped and moov is hoisted before the
+     * media data (faststart) with the chunk-offset tables patched; no
+     * stream is re-encoded.
      */
     class Mp4Processor final : public IProcessor {
     public:
@@ -36,7 +39,7 @@ namespace chisel {
             return {kExts.data(), kExts.size()};
         }
 
-        [[nodiscard]] bool can_recompress() const noexcept override { return false; }
+        [[nodiscard]] bool can_recompress() const noexcept override { return true; }
         [[nodiscard]] bool can_extract_contents() const noexcept override { return true; }
 
         void recompress(const std::filesystem::path& input,
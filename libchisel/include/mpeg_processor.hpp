@@ -22,8 +22,9 @@ namespace chisel {
      *
      * @details This processor acts as a container for extracting and
      * re-inserting cover art (ID3v2 APIC tags), allowing the image
-     * files to be processed by image optimizers. Audio recompression
-     * logic (Phase 2) is left as a future implementation task.
+     * files to be processed by image optimizers. Recompression is a
+     * tag-region rewrite: the MPEG audio frames are never touched,
+     * only the surrounding ID3v2/ID3v1/APEv2 regions are trimmed.
      */
     class MpegProcessor final : public IProcessor {
     public:
@@ -44,10 +45,10 @@ namespace chisel {
 
         // --- capabilities ---
         /**
-         * @brief Audio recompression is planned for the future.
-         * @return false
+         * @brief Tag-region trimming is supported (audio frames stay untouched).
+         * @return true
          */
-        [[nodiscard]] bool can_recompress() const noexcept override { return false; }
+        [[nodiscard]] bool can_recompress() const noexcept override { return true; }
 
         /**
          * @brief This processor extracts cover art.
@@ -58,9 +59,18 @@ namespace chisel {
         // --- operations ---
 
         /**
-         * @brief (Placeholder) Direct recompression is not implemented yet.
+         * @brief Rewrites only the tag regions of an MP3 file.
+         *
+         * The MPEG frame data is spliced to the output without a
+         * userspace copy (copy_file_range on Linux, a buffered loop
+         * elsewhere). With preserve_metadata the ID3v2 tag is kept but
+         * its padding is dropped; without it the leading ID3v2 and
+         * trailing ID3v1/APEv2 regions are stripped entirely. A 200 MB
+         * podcast therefore costs a 4 KB tag rewrite plus a kernel-side
+         * splice, not a full decode or copy of the audio.
          *
-         * @throws std::runtime_error always, if this is called improperly.
+         * @throws std::runtime_error if the input cannot be read or the
+         * output cannot be written.
          */
         void recompress(const std::filesystem::path& input,
                         const std::filesystem::path& output,
@@ -83,7 +93,15 @@ namespace chisel {
         std::filesystem::path finalize_extraction(const ExtractedContent &content) override;
 
         // --- integrity check ---
-        [[nodiscard]] std::string get_raw_checksum(const std::filesystem::path& file_path) const override { return ""; }
+
+        /**
+         * @brief Computes a CRC32C over the MPEG frame region only.
+         *
+         * Leading ID3v2 and trailing ID3v1/APEv2 tags are excluded, so a
+         * file whose tags were trimmed still compares raw-equal to the
+         * original.
+         */
+        [[nodiscard]] std::string get_raw_checksum(const std::filesystem::path& file_path) const override;
     };
 
 } // namespace chisel
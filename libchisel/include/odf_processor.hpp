@@ -61,6 +61,10 @@ namespace chisel {
          */
         [[nodiscard]] bool can_extract_contents() const noexcept override { return true; }
 
+        /// Finalize only re-zips the extracted members (mimetype first),
+        /// so an unchanged document keeps its original bytes.
+        [[nodiscard]] bool finalize_is_rebuild_only() const noexcept override { return true; }
+
         // --- operations ---
 
         /**
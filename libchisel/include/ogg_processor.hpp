@@ -49,8 +49,9 @@ namespace chisel {
          * @brief Attempts to recompress Ogg-FLAC streams.
          *
          * If the input is Ogg FLAC, decodes and re-encodes with maximum compression,
-         * preserving Vorbis comments. If input is lossy (Vorbis/Opus), performs a
-         * direct copy to preserve data.
+         * preserving Vorbis comments. If input is lossy (Vorbis/Opus), remuxes it
+         * losslessly via OptiVorbis; chained files are split on logical-stream
+         * boundaries and each chain is remuxed on its own leased core.
          */
         void recompress(const std::filesystem::path& input,
                         const std::filesystem::path& output,
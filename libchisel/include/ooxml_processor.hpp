@@ -60,6 +60,10 @@ public:
      */
     [[nodiscard]] bool can_extract_contents() const noexcept override { return true; }
 
+    /// Finalize only re-zips the extracted parts, so an unchanged
+    /// document keeps its original bytes without a rebuild.
+    [[nodiscard]] bool finalize_is_rebuild_only() const noexcept override { return true; }
+
     // --- operations ---
 
     /**
@@ -0,0 +1,74 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+/**
+ * @file pcm_utils.hpp
+ * @brief SIMD-accelerated PCM sample conversion shared by the audio processors.
+ *
+ * Decoding a multi-GB master spends a surprising share of its time just
+ * shuffling samples: widening 16/24-bit PCM to the int32 layout the
+ * codecs exchange, interleaving planar decoder output, swapping
+ * big-endian words. These helpers give each of those loops a vectorized
+ * body — AVX2 behind a runtime check on x86-64, NEON via the
+ * auto-vectorized fallback on ARM — so ingestion is bound by memory
+ * bandwidth instead of per-sample instruction overhead.
+ */
+
+#ifndef CHISEL_PCM_UTILS_HPP
+#define CHISEL_PCM_UTILS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace chisel {
+
+    /**
+     * @brief Sign-extends 16-bit samples to 32-bit.
+     * @param src   The 16-bit samples.
+     * @param dst   Receives @p count widened samples.
+     * @param count Number of samples.
+     */
+    void pcm_widen16(const int16_t *src, int32_t *dst, std::size_t count);
+
+    /**
+     * @brief Sign-extends packed little-endian 24-bit samples to 32-bit.
+     * @param src   The packed samples, 3 bytes each.
+     * @param dst   Receives @p count widened samples.
+     * @param count Number of samples.
+     */
+    void pcm_widen24(const unsigned char *src, int32_t *dst, std::size_t count);
+
+    /**
+     * @brief Byte-swaps 16-bit words in place (big-endian AIFF payloads).
+     * @param data  The words to swap.
+     * @param count Number of words.
+     */
+    void pcm_byteswap16(uint16_t *data, std::size_t count);
+
+    /**
+     * @brief Byte-swaps 32-bit words in place.
+     * @param data  The words to swap.
+     * @param count Number of words.
+     */
+    void pcm_byteswap32(uint32_t *data, std::size_t count);
+
+    /**
+     * @brief Interleaves planar channel buffers into frame order.
+     *
+     * The layout produced by the FLAC and similar decoders: one pointer
+     * per channel, @p frames samples each. Stereo — nearly every file —
+     * takes a dedicated vector path; other widths fall back to the
+     * generic loop.
+     *
+     * @param channels One buffer pointer per channel.
+     * @param nch      Number of channels.
+     * @param frames   Samples per channel.
+     * @param dst      Receives nch * frames interleaved samples.
+     */
+    void pcm_interleave(const int32_t *const *channels, unsigned nch,
+                        std::size_t frames, int32_t *dst);
+
+} // namespace chisel
+
+#endif // CHISEL_PCM_UTILS_HPP
@@ -48,6 +48,12 @@ namespace chisel {
         [[nodiscard]] bool can_recompress() const noexcept override { return true; }
         [[nodiscard]] bool can_extract_contents() const noexcept override { return false; }
 
+        /**
+         * @brief Buffer-to-buffer recompression is supported.
+         * @return true
+         */
+        [[nodiscard]] bool can_recompress_buffer() const noexcept override { return true; }
+
         // --- operations ---
 
         /**
@@ -65,6 +71,18 @@ namespace chisel {
                         const std::filesystem::path& output,
                         bool preserve_metadata) override;
 
+        /**
+         * @brief In-memory variant of recompress().
+         *
+         * Assembles the P5/P6 header and pixel rows directly into the
+         * caller's buffer, so batch runs over many small PNMs skip the
+         * per-file temp-file churn entirely.
+         * @return false if the input is not a decodable PNM.
+         */
+        bool recompress_buffer(std::span<const std::byte> input,
+                               std::vector<std::byte>& output,
+                               bool preserve_metadata) override;
+
         std::optional<ExtractedContent> prepare_extraction(
             [[maybe_unused]] const std::filesystem::path& input_path) override { return std::nullopt; }
 
@@ -6,11 +6,13 @@
 #define CHISEL_PROCESSOR_HPP
 
 #include <any>
+#include <cstddef>
 #include <filesystem>
 #include <vector>
 #include <string>
 #include <optional>
 #include <span>
+#include <stop_token>
 #include <string_view>
 #include <stdexcept>
 
@@ -39,9 +41,24 @@ namespace chisel {
  * be reassembled by finalize_extraction().
  */
 struct ExtractedContent {
+    /**
+     * @brief A container member staged in memory instead of on disk.
+     *
+     * Small members can skip the temp volume entirely: the extractor
+     * keeps their payload in memory, the executor recompresses them via
+     * the buffer-based IProcessor overload (updating data in place), and
+     * finalize_extraction() writes only the final bytes when the
+     * container is reassembled.
+     */
+    struct MemoryMember {
+        std::filesystem::path path; ///< Virtual path under temp_dir (drives processor dispatch)
+        std::vector<std::byte> data; ///< Member payload (replaced in place when improved)
+    };
+
     std::filesystem::path original_path;                ///< Path to the original container file
     std::filesystem::path temp_dir;                     ///< Temporary directory holding extracted files
     std::vector<std::filesystem::path> extracted_files; ///< Absolute paths to extracted files
+    std::vector<MemoryMember> memory_members;           ///< Members staged in memory (may be empty)
     ContainerFormat format;                             ///< Format of the container
     /**
      * @brief Type-erased storage for processor-specific state.
@@ -53,6 +70,12 @@ struct ExtractedContent {
     std::any extras;
 };
 
+/// Chunked byte-identity compare with early exit; declared in
+/// file_utils.hpp and defined in file_utils.cpp. Re-declared here so the
+/// interface header stays free of chisel includes.
+bool raw_equal_files(const std::filesystem::path &a,
+                     const std::filesystem::path &b);
+
 /**
  * @brief Interface for a file processing module in chisel.
  *
@@ -89,6 +112,63 @@ public:
     /// @return True if this processor can extract container contents.
     [[nodiscard]] virtual bool can_extract_contents() const noexcept = 0;
 
+    /**
+     * @brief Whether this processor supports buffer-to-buffer recompression.
+     *
+     * Processors that can work entirely in memory let the executor chain
+     * PIPE stages without writing intermediate results to disk.
+     * @return True if recompress_buffer() is implemented.
+     */
+    [[nodiscard]] virtual bool can_recompress_buffer() const noexcept { return false; }
+
+    /**
+     * @brief Whether this stage is a deep-search pass worth pruning.
+     *
+     * Expensive stages (Zopfli-class searches) cost orders of magnitude
+     * more CPU than the stages before them for single-digit extra
+     * savings. In PIPE mode the executor may skip such a stage when the
+     * preceding stage found no headroom in the same data (see
+     * ProcessorExecutor::set_pipe_prune_threshold()).
+     * @return True if the executor may prune this stage.
+     */
+    [[nodiscard]] virtual bool is_expensive() const noexcept { return false; }
+
+    /**
+     * @brief Whether finalize_extraction() is a pure rebuild of the children.
+     *
+     * True for container processors whose finalize only reassembles the
+     * extracted members with fixed settings: when no member changed, the
+     * rebuild can at best reproduce the original container, so the
+     * executor skips the rebuild (and its I/O) and keeps the original.
+     * Processors whose finalize performs work of its own (PDF object
+     * streams, cover-art reattachment) keep the default and always run.
+     */
+    [[nodiscard]] virtual bool finalize_is_rebuild_only() const noexcept { return false; }
+
+    /**
+     * @brief Estimated peak working-set of one recompression, in bytes.
+     *
+     * Used by the executor's memory admission control to delay
+     * high-memory tasks when a budget is configured. The default is a
+     * deliberately conservative multiple of the input size; processors
+     * known to spike harder (or lighter) should override.
+     * @param input_bytes Size of the input file.
+     */
+    [[nodiscard]] virtual uintmax_t estimate_memory(const uintmax_t input_bytes) const noexcept {
+        // several working copies plus codec state
+        return input_bytes * 4 + (32ull << 20);
+    }
+
+    /**
+     * @brief Set the effort level for subsequent recompressions.
+     *
+     * 1 = fast, 2 = default, 3 = deep. Processors with a tunable
+     * speed/ratio trade-off override this; the default ignores it.
+     * The executor applies it before any task is scheduled, so
+     * overrides need no synchronization with recompress().
+     */
+    virtual void set_effort(const int level) noexcept { (void)level; }
+
     // --- operations ---
 
     /**
@@ -101,6 +181,44 @@ public:
                             const std::filesystem::path& output_path,
                             bool preserve_metadata) = 0;
 
+    /**
+     * @brief Recompress with cooperative cancellation (optional).
+     *
+     * The executor passes each task's std::stop_token through this
+     * overload. Long-running processors override it and poll the token
+     * at natural checkpoints (per frame, per strip, per decoded FLAC
+     * frame), so a stop request takes effect within one chunk instead
+     * of after the whole file. The default ignores the token and
+     * forwards to the three-argument overload.
+     */
+    virtual void recompress(const std::filesystem::path& input_path,
+                            const std::filesystem::path& output_path,
+                            const bool preserve_metadata,
+                            const std::stop_token& stop) {
+        (void)stop;
+        recompress(input_path, output_path, preserve_metadata);
+    }
+
+    /**
+     * @brief Perform lossless recompression entirely in memory (optional).
+     *
+     * Only meaningful when can_recompress_buffer() returns true; the
+     * default implementation throws.
+     *
+     * @param input The original file contents.
+     * @param output Receives the recompressed contents on success.
+     * @param preserve_metadata Whether to preserve metadata blocks.
+     * @return true on success, false if the input could not be processed.
+     */
+    virtual bool recompress_buffer(std::span<const std::byte> input,
+                                   std::vector<std::byte>& output,
+                                   bool preserve_metadata) {
+        (void)input;
+        (void)output;
+        (void)preserve_metadata;
+        throw std::logic_error("recompress_buffer not supported by this processor");
+    }
+
     /**
      * @brief Extract processable internal contents if supported.
      * @param input_path Path to the container file.
@@ -130,12 +248,21 @@ public:
 
     /**
      * @brief Compare two files at raw level (using checksums or direct comparison).
+     *
+     * The default probes byte identity first via raw_equal_files(),
+     * which checks the sizes before any I/O and stops at the first
+     * mismatching block — identical files skip the double checksum
+     * read entirely, while files that legitimately differ after
+     * recompression fall through after one block and are compared by
+     * their raw checksums as before.
+     *
      * @param a First file path.
      * @param b Second file path.
      * @return true if the two files are raw-equivalent.
      */
     [[nodiscard]] virtual bool raw_equal(const std::filesystem::path& a,
                                          const std::filesystem::path& b) const {
+        if (raw_equal_files(a, b)) return true;
         return get_raw_checksum(a) == get_raw_checksum(b);
     }
 };
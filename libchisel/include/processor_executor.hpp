@@ -16,9 +16,14 @@
 
 #include "processor.hpp"
 #include "processor_registry.hpp"
+#include <atomic>
+#include <condition_variable>
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
-#include <stack>
 #include <thread>
 #include <mutex>
 #include "event_bus.hpp"
@@ -41,15 +46,39 @@ enum class EncodeMode {
 
 namespace chisel {
 
+class GainModel;
+class ResultCache;
+class RunJournal;
+
+/**
+ * @brief A file that Phase 1 resolved and queued for recompression.
+ *
+ * @details analyze_path() already pays for MIME detection and the registry
+ * lookup, so the result is carried into Phase 2 instead of being recomputed
+ * inside every pool task.
+ */
+struct AnalyzedFile {
+    std::filesystem::path path;            ///< Path to the file to recompress
+    std::vector<IProcessor*> processors;   ///< Candidate processors, in registry order
+    std::string mime;                      ///< MIME type detected in Phase 1
+    uintmax_t size{0};                     ///< File size at analysis time (0 if stat failed)
+    std::string content_hash;              ///< Content digest (only when the result cache is active)
+    std::string processor_set;             ///< Cache key: candidate names joined with '+'
+};
+
 /**
  * @brief Orchestrates the analysis, processing, and finalization of files.
  *
- * @details ProcessorExecutor coordinates the three main phases of chisel:
- * - Phase 1: Recursive analysis of input files and containers.
- * - Phase 2: Recompression of eligible files (in PIPE or PARALLEL mode)
- * using the ThreadPool.
- * - Phase 3: Finalization (re-assembly) of containers after their
- * contents have been processed.
+ * @details ProcessorExecutor coordinates the three stages of chisel:
+ * - Analysis: recursive inspection of input files and containers.
+ * - Recompression: optimization of eligible files (in PIPE or PARALLEL mode).
+ * - Finalization: re-assembly of containers after their contents are done.
+ *
+ * The stages run as a pipelined dataflow on a single ThreadPool rather
+ * than as global barriers: a file enters recompression as soon as it has
+ * been analyzed, and a container is re-assembled as soon as its own
+ * children have completed (tracked by a per-container counter), without
+ * waiting for unrelated files.
  *
  * It uses a ProcessorRegistry to discover processors, a ThreadPool to
  * parallelize work, and an EventBus to publish progress and results.
@@ -77,14 +106,35 @@ public:
                                EventBus& bus,
                                unsigned threads = std::thread::hardware_concurrency());
 
+    /// Stops the rename-retry timer thread if a run left it behind.
+    ~ProcessorExecutor();
+
     /**
      * @brief Entry point: process a list of input files.
      *
-     * This function executes the 3-phase processing pipeline.
+     * Schedules analysis of every input on the thread pool and returns
+     * once the whole dataflow (analysis, recompression, container
+     * finalization) has drained.
      * @param inputs Vector of filesystem paths to process.
      */
     void process(const std::vector<std::filesystem::path>& inputs);
 
+    /// Pull-based input source: fills @p out and returns true, or
+    /// returns false once the stream is exhausted.
+    using PathSource = std::function<bool(std::filesystem::path& out)>;
+
+    /**
+     * @brief Entry point: process a stream of input paths.
+     *
+     * Pulls paths from @p source one at a time and schedules each for
+     * analysis immediately, so recompression overlaps with reading the
+     * rest of the list and the full path set is never held in memory.
+     * With an output directory set it is always treated as a directory,
+     * since the input count is unknown up front.
+     * @param source Callback yielding one path per call until exhausted.
+     */
+    void process(const PathSource& source);
+
     /**
      * @brief Checks if a stop has been requested.
      * @return true if the internal stop flag is set, false otherwise.
@@ -94,6 +144,117 @@ public:
         return stop_flag_.load(std::memory_order_relaxed);
     }
 
+    /**
+     * @brief Attach an opt-in persistent result cache.
+     *
+     * When set, analysis consults the cache before scheduling
+     * recompression (skipping content already known to be unimprovable)
+     * and recompression outcomes are recorded back. The cache must
+     * outlive the executor; pass nullptr to detach.
+     */
+    void set_result_cache(ResultCache* cache) { result_cache_ = cache; }
+
+    /**
+     * @brief Attach an opt-in crash-safe run journal.
+     *
+     * When set, every file reaching a terminal outcome is recorded and
+     * paths a previous (resumed) run already completed are skipped
+     * during analysis. The journal must outlive the executor; pass
+     * nullptr to detach.
+     */
+    void set_run_journal(RunJournal* journal) { run_journal_ = journal; }
+
+    /**
+     * @brief Attach an opt-in persistent gain model.
+     *
+     * When set, every stage invocation feeds its achieved gain and cost
+     * back into the model, and analysis uses the accumulated statistics
+     * to order a file's candidates best-ratio-first and drop stages whose
+     * expected gain on this corpus is negligible (a combination is only
+     * trusted after GainModel::min_samples invocations). The model must
+     * outlive the executor; pass nullptr to detach.
+     */
+    void set_gain_model(GainModel* model) { gain_model_ = model; }
+
+    /**
+     * @brief Enable opt-in duplicate-content detection.
+     *
+     * When enabled, byte-identical recompressible files are clustered by
+     * content hash during analysis; only one representative per cluster
+     * is recompressed and its outcome is applied to the other copies.
+     */
+    void set_deduplicate(bool enabled) { deduplicate_ = enabled; }
+
+    /**
+     * @brief Set the effort level applied by tunable processors.
+     *
+     * Forwards the level (1 = fast, 2 = default, 3 = deep) to every
+     * registered processor; those with a speed/ratio trade-off (e.g.
+     * ZopfliPNG) scale their work accordingly. Call before process().
+     */
+    void set_effort(const int level) {
+        for (const auto& processor : registry_.all()) {
+            processor->set_effort(level);
+        }
+    }
+
+    /**
+     * @brief Cap the estimated memory of concurrently running recompressions.
+     *
+     * Each recompress task reserves its candidates' worst-case
+     * IProcessor::estimate_memory() before running; tasks that would push
+     * the in-flight total past the budget wait until enough running work
+     * retires. A task is always admitted when nothing else is in flight,
+     * so a single file larger than the budget still gets processed.
+     * @param bytes Budget in bytes; 0 (the default) disables admission control.
+     */
+    void set_memory_budget(const uintmax_t bytes) { memory_budget_ = bytes; }
+
+    /**
+     * @brief Cap the extracted bytes sitting on the temp volume at once.
+     *
+     * Phase 1 extracts containers as it discovers them, so a batch of
+     * large archives can fill the temp volume before any finalization
+     * reclaims space. With a budget set, further prepare_extraction()
+     * calls stall until enough already-extracted containers finalize —
+     * backpressure between extraction and finalization. A single
+     * container is always admitted when nothing is in flight, and a
+     * stall never parks the last free worker (the dataflow that
+     * reclaims the space must keep running), so the budget is a target,
+     * not a hard ceiling.
+     * @param bytes Budget in bytes; 0 (the default) disables the control.
+     */
+    void set_temp_budget(const uintmax_t bytes) { temp_budget_ = bytes; }
+
+    /**
+     * @brief Restrict processing to files whose size lies in [min, max].
+     *
+     * Checked against stat data alone, before the header read, MIME
+     * detection or processor lookup, so an excluded file costs one
+     * metadata query and nothing else. Applies to top-level inputs
+     * only: members of an extracted container already paid the
+     * extraction cost and are always processed.
+     * @param min_bytes Smallest size processed; 0 disables the floor.
+     * @param max_bytes Largest size processed; 0 disables the ceiling.
+     */
+    void set_size_window(const uintmax_t min_bytes, const uintmax_t max_bytes) {
+        size_min_ = min_bytes;
+        size_max_ = max_bytes;
+    }
+
+    /**
+     * @brief Set the minimum upstream gain that keeps expensive PIPE stages.
+     *
+     * In PIPE mode, a stage flagged IProcessor::is_expensive() is skipped
+     * when the stage right before it shrank the data by less than this
+     * fraction — an input the cheap pass could not touch is very unlikely
+     * to yield to a deeper search either. Only applies after at least one
+     * stage has run, so an expensive stage that is first in its chain
+     * always runs. A negative value disables pruning.
+     * @param fraction Minimum fractional gain (default 0.001 = 0.1%).
+     */
+    void set_pipe_prune_threshold(const double fraction) { pipe_prune_min_gain_ = fraction; }
+
     /**
      * @brief Request the executor and its thread pool to stop.
      *
@@ -102,31 +263,370 @@ public:
      */
     void request_stop();
 
+    /**
+     * @brief Freeze the run without abandoning it. Thread-safe.
+     *
+     * The pool stops dequeuing: tasks already running finish, and
+     * everything still queued — analysis, recompression, and container
+     * finalization tasks alike — stays queued, so the run checkpoints
+     * at task boundaries (between containers included). No journal,
+     * cache, or temp state is released; resume() picks the run back up
+     * exactly where it froze, losing no completed work.
+     */
+    void pause() { pool_.pause(); }
+
+    /**
+     * @brief Resume a paused run. Thread-safe.
+     */
+    void resume() { pool_.resume(); }
+
+    /**
+     * @brief Move the worker pool in or out of background scheduling.
+     *
+     * Workers demote themselves to the platform's idle CPU and I/O
+     * classes (see ThreadPool::set_background()), so the run uses spare
+     * capacity only. Can be toggled mid-run. Thread-safe.
+     */
+    void set_background(const bool background) { pool_.set_background(background); }
+
+    /**
+     * @brief Set the worker placement policy for multi-socket machines.
+     *
+     * Forwards to ThreadPool::set_affinity(); see there for the
+     * policies and the first-touch rationale. Thread-safe.
+     */
+    void set_affinity(const ThreadPool::Affinity policy) { pool_.set_affinity(policy); }
+
+    /**
+     * @brief Let the pool grow and shrink within [min_threads, max_threads].
+     *
+     * Forwards to ThreadPool::enable_adaptive(); the pool parks workers
+     * when runnable ones oversubscribe the cores and unparks them when
+     * I/O-blocked workers leave cores idle. Calling again updates the
+     * bounds.
+     */
+    void set_adaptive_sizing(const size_t min_threads, const size_t max_threads) {
+        pool_.enable_adaptive(min_threads, max_threads);
+    }
+
+    /// @return True while the run is paused.
+    [[nodiscard]] bool is_paused() const noexcept { return pool_.is_paused(); }
+
 private:
     /**
-     * @brief Phase 1: Recursively analyze a path.
+     * @brief Tracks a container whose children are still in flight.
      *
-     * If it's a file, it's added to work_list_.
-     * If it's a container, its contents are extracted, added to
-     * work_list_, and the container is added to finalize_stack_.
+     * @details pending counts the outstanding work units inside the
+     * container: one per extracted child plus one for the container's own
+     * recompression (if any). The last unit to complete triggers
+     * finalization (see child_done()), and the finalized container then
+     * counts as one completed unit of its own parent. This replaces the
+     * old global finalize stack and its end-of-run barrier.
+     *
+     * The parent links form the container dependency DAG: a child
+     * container always finalizes before its parent (the parent's counter
+     * still holds the child's unit), while unrelated containers finalize
+     * concurrently on the pool as soon as they are ready.
+     */
+    struct ContainerNode {
+        ExtractedContent content;              ///< Extraction state needed to reassemble
+        std::shared_ptr<ContainerNode> parent; ///< Enclosing container, or nullptr for top level
+        std::atomic<size_t> pending{0};        ///< Outstanding children + own recompression
+        /**
+         * @brief Whether any work unit of this container actually shrank.
+         *
+         * Set by every improving outcome (a replaced child file, an
+         * in-memory member, an applied duplicate, a rebuilt nested
+         * container). When it stays false and the finalizing processor
+         * declares finalize_is_rebuild_only(), finalize_container()
+         * skips the rebuild: on pre-optimized inputs this saves the
+         * full container rewrite for a byte-equivalent result.
+         */
+        std::atomic<bool> any_child_improved{false};
+        /**
+         * @brief Temp-volume bytes reserved for this container's extraction.
+         *
+         * Taken by acquire_temp_space() before extraction, trimmed to
+         * the measured on-disk size afterwards, and returned when the
+         * container finalizes and its temp dir is reclaimed.
+         */
+        uintmax_t temp_reserved{0};
+    };
+
+    /**
+     * @brief Recursively analyze a path.
+     *
+     * Eligible files are scheduled for recompression immediately; a
+     * container is extracted, its children scheduled for analysis, and a
+     * ContainerNode created to finalize it once they all complete.
+     *
+     * Runs on pool_ workers; analysis tasks are submitted in bulk by
+     * process() (for inputs) and by the container branch below (for
+     * extracted children).
      *
      * @param path The file or directory path to analyze.
+     * @param owner The container this path was extracted from, if any.
+     */
+    void analyze_path(const std::filesystem::path& path,
+                      const std::shared_ptr<ContainerNode>& owner);
+
+    /**
+     * @brief Enqueue the recompression of one analyzed file.
+     *
+     * Dispatches a task according to the specified EncodeMode (PIPE or
+     * PARALLEL). On completion (success, skip or error) the task reports
+     * back to the owning container via child_done().
+     *
+     * @param entry The analysis record produced by analyze_path().
+     * @param owner The container the file belongs to, if any.
      */
-    void analyze_path(const std::filesystem::path& path);
+    void schedule_recompress(AnalyzedFile entry,
+                             const std::shared_ptr<ContainerNode>& owner);
 
     /**
-     * @brief Phase 2: Recompress all files in work_list_ using the ThreadPool.
+     * @brief PIPE mode: run one file through its candidate chain.
      *
-     * Dispatches tasks according to the specified EncodeMode (PIPE or PARALLEL).
+     * The body of a recompress task, shared by the per-file pool task
+     * and the small-file batch drainer. Handles the done/cluster
+     * guards, memory admission, the stage chain, verification and
+     * replacement for exactly one file.
      */
-    void process_work_list();
+    void recompress_file(const AnalyzedFile& entry,
+                         const std::shared_ptr<ContainerNode>& owner,
+                         const std::stop_token& st);
+
+    /// One small file parked for composite-task processing.
+    struct SmallFileBatch {
+        AnalyzedFile entry;                   ///< The analysis record
+        std::shared_ptr<ContainerNode> owner; ///< Its owning container, if any
+    };
 
     /**
-     * @brief Phase 3: Finalize all containers in finalize_stack_.
+     * @brief Park a small file for composite-task processing.
      *
-     * This runs sequentially (LIFO) after all file processing is complete.
+     * For icon/sprite trees the per-task overhead (dispatch, temp
+     * create/rename) exceeds the codec time, so files under the batch
+     * threshold are grouped by resolved processor and drained in a
+     * tight loop on one worker. A drainer task is scheduled when a
+     * bucket turns non-empty, so every parked file is covered by an
+     * enqueued task and the pool's drain semantics are preserved.
      */
-    void finalize_containers();
+    void enqueue_small_file(AnalyzedFile entry,
+                            const std::shared_ptr<ContainerNode>& owner);
+
+    /// Claim and process everything accumulated in one batch bucket.
+    void drain_small_batch(const std::string& key, const std::stop_token& st);
+
+    /**
+     * @brief Enqueue the recompression of one in-memory container member.
+     *
+     * Members staged in memory by extraction have no file behind them, so
+     * they are chained through buffer-capable candidates only (regardless
+     * of EncodeMode); an improved result replaces the member's bytes in
+     * place and reaches disk once, when the container is reassembled. A
+     * member whose candidates are all path-based is spilled to its
+     * virtual path and handed to analyze_path() like a disk child.
+     *
+     * @param node The owning container (holds the member storage).
+     * @param index Index into node->content.memory_members.
+     */
+    void schedule_memory_recompress(const std::shared_ptr<ContainerNode>& node,
+                                    size_t index);
+
+    /**
+     * @brief Reorder (and possibly thin out) candidates using the gain model.
+     *
+     * Candidates with trusted statistics are sorted by expected
+     * gain-per-cost, best first; candidates without enough samples keep
+     * their registry order so they still run and feed the model. Stages
+     * the model confidently predicts below the gain floor are dropped,
+     * but never the whole list. No-op without an attached model.
+     *
+     * @param procs The candidate list resolved during analysis.
+     * @param mime MIME type of the file being analyzed.
+     * @param size Its size (selects the model's size bucket).
+     */
+    void order_candidates(std::vector<IProcessor*>& procs,
+                          const std::string& mime,
+                          uintmax_t size);
+
+    /// Shared state for one file whose candidates race as separate tasks.
+    struct ParallelFileState;
+
+    /**
+     * @brief PARALLEL mode: enqueue each candidate processor as its own task.
+     *
+     * Candidates for one file used to run back-to-back inside a single
+     * task; racing them as independent pool tasks lets the slowest file
+     * use idle cores near the end of a run. A per-file countdown latch
+     * (ParallelFileState::remaining) tracks the race; the last candidate
+     * to finish picks the winner via finish_parallel().
+     *
+     * @param entry The analysis record produced by analyze_path().
+     * @param owner The container the file belongs to, if any.
+     */
+    void schedule_parallel_candidates(AnalyzedFile entry,
+                                      const std::shared_ptr<ContainerNode>& owner);
+
+    /**
+     * @brief Select and apply the best candidate result for one file.
+     *
+     * Invoked by the last candidate task to complete; publishes the
+     * outcome and reports to the owning container.
+     */
+    void finish_parallel(const std::shared_ptr<ParallelFileState>& state);
+
+    /**
+     * @brief Record the completion of one work unit of a container.
+     *
+     * When the last outstanding unit completes, the container's
+     * finalization is scheduled on the pool. No-op if node is null
+     * (top-level files have no owning container).
+     */
+    void child_done(const std::shared_ptr<ContainerNode>& node);
+
+    /**
+     * @brief Enqueue the finalization (re-assembly) of a container.
+     */
+    void schedule_finalize(const std::shared_ptr<ContainerNode>& node);
+
+    /**
+     * @brief Re-assemble one container from its processed contents.
+     *
+     * Invoked from the pool once all of the container's children have
+     * completed; propagates completion to the enclosing container.
+     */
+    void finalize_container(const std::shared_ptr<ContainerNode>& node);
+
+    /**
+     * @brief Block until @p estimate fits under the memory budget, then reserve it.
+     *
+     * Immediately returns the reservation when no budget is set. The
+     * caller must pair it with release_memory() on every exit path; see
+     * MemoryReservation for the RAII wrapper the tasks use.
+     * @return The number of bytes actually reserved.
+     */
+    [[nodiscard]] uintmax_t acquire_memory(uintmax_t estimate);
+
+    /// Return a reservation taken by acquire_memory() and wake waiters.
+    void release_memory(uintmax_t reserved);
+
+    /**
+     * @brief Block until @p estimate fits under the temp budget, then reserve it.
+     *
+     * Immediately returns when no budget is set. Admission is forced
+     * when nothing is in flight (one oversized container must not
+     * deadlock the run) and when every other pool worker is already
+     * stalled here — the finalize tasks that reclaim temp space need a
+     * worker to run on.
+     * @return The number of bytes actually reserved.
+     */
+    [[nodiscard]] uintmax_t acquire_temp_space(uintmax_t estimate);
+
+    /**
+     * @brief Correct a temp reservation to the measured extracted size.
+     *
+     * The pre-extraction estimate is a multiple of the container size;
+     * once the children exist on disk their real footprint replaces it,
+     * so an over-estimate stops blocking other extractions.
+     * @return The adjusted reservation (the value to release later).
+     */
+    [[nodiscard]] uintmax_t adjust_temp_space(uintmax_t reserved, uintmax_t actual);
+
+    /// Return a reservation taken by acquire_temp_space() and wake waiters.
+    void release_temp_space(uintmax_t reserved);
+
+    /// RAII guard releasing a memory reservation on task exit.
+    struct MemoryReservation {
+        ProcessorExecutor* executor;
+        uintmax_t reserved;
+        ~MemoryReservation() {
+            if (reserved > 0) executor->release_memory(reserved);
+        }
+    };
+
+    /**
+     * @brief Builds a temp path for a result destined to replace original_file.
+     *
+     * The temp is placed beside the final destination (the original file,
+     * or its --output location) so handle_temp_file()'s rename is an
+     * atomic same-filesystem operation rather than a cross-device copy.
+     *
+     * @param original_file The source file being optimized.
+     * @param label A short label distinguishing the producing stage.
+     */
+    [[nodiscard]] std::filesystem::path temp_destination(const std::filesystem::path& original_file,
+                                                         const std::string& label) const;
+
+    /**
+     * @brief One group of byte-identical files sharing a recompression.
+     *
+     * The first file seen with a given (content hash, size) becomes the
+     * cluster's representative and is scheduled normally; copies arriving
+     * while it is in flight queue up as followers, and copies arriving
+     * after completion have the recorded outcome applied immediately.
+     */
+    struct DupCluster {
+        /// A duplicate waiting for (or receiving) the representative's outcome.
+        struct Follower {
+            std::filesystem::path path;            ///< The duplicate file
+            uintmax_t size{0};                     ///< Its size (identical across the cluster)
+            std::shared_ptr<ContainerNode> owner;  ///< Its owning container, if any
+        };
+
+        std::filesystem::path representative; ///< The one file actually recompressed
+        std::vector<Follower> followers;      ///< Copies waiting for the outcome
+        bool done = false;                    ///< Whether the representative finished
+        bool improved = false;                ///< Whether its recompression paid off
+        uintmax_t new_size = 0;               ///< Result size when improved
+    };
+
+    /**
+     * @brief Fold a file into its duplicate cluster, if one exists.
+     *
+     * The first file of a given content becomes the representative and
+     * is not absorbed; later copies either queue as followers or, when
+     * the representative already finished, get its outcome applied on
+     * the spot.
+     *
+     * @param entry The analysis record (content_hash must be filled in).
+     * @param owner The container the file belongs to, if any.
+     * @return true if the file was absorbed (the caller must not schedule it).
+     */
+    bool register_duplicate(const AnalyzedFile& entry,
+                            const std::shared_ptr<ContainerNode>& owner);
+
+    /**
+     * @brief Record the representative's terminal outcome for its cluster.
+     *
+     * Applies the outcome to all queued followers and leaves it in place
+     * for copies discovered later. No-op when the file belongs to no
+     * cluster; safe to call from every exit path of a recompress task.
+     */
+    void complete_cluster(const AnalyzedFile& entry, bool improved, uintmax_t new_size);
+
+    /**
+     * @brief Apply a finished cluster's outcome to one duplicate.
+     *
+     * Copies the winning bytes to the duplicate's destination (or mirrors
+     * the original when the representative saw no improvement), publishes
+     * the per-file events, and reports to the owning container.
+     */
+    void apply_duplicate_outcome(const DupCluster& cluster,
+                                 const DupCluster::Follower& follower);
+
+    /**
+     * @brief Mirror an unimproved file into the output tree.
+     *
+     * In --output mode a file that yields no gain must still appear in
+     * the output tree; this copies it via clone_or_copy_file(), so on
+     * reflink-capable filesystems the (typically large) share of
+     * already-optimal files moves at metadata speed. No-op without an
+     * output directory or in dry-run mode.
+     *
+     * @param original_file The source file to mirror.
+     */
+    void copy_unimproved_to_output(const std::filesystem::path& original_file) const;
 
     /**
      * @brief Handles file replacement logic after a task succeeds.
@@ -138,11 +638,70 @@ private:
      * @param temp_file The path to the newly created optimized file.
      * @param original_size The size of the original file in bytes.
      * @param duration The time taken for the recompression task.
+     * @param allow_deferral Whether a rename blocked by a sharing
+     * violation may be parked on the retry queue instead of retried
+     * synchronously. Must be false for container children: the parent's
+     * finalize may start as soon as the calling task returns.
      */
     void handle_temp_file(const std::filesystem::path& original_file,
                             const std::filesystem::path& temp_file,
                             uintmax_t original_size,
-                            std::chrono::milliseconds duration) const;
+                            std::chrono::milliseconds duration,
+                            bool allow_deferral);
+
+    /**
+     * @brief A rename blocked by a sharing violation, parked for retry.
+     *
+     * On Windows an antivirus sweep can hold the destination open for
+     * seconds; instead of sleeping a pool worker through the retries,
+     * the rename is deferred here and serviced by a timer thread (see
+     * rename_retry_loop()), which publishes the completion event once
+     * the rename finally lands (or gives up).
+     */
+    struct PendingRename {
+        std::filesystem::path temp_file;               ///< The optimized result awaiting its rename
+        std::filesystem::path dest;                    ///< Final destination (original file or --output target)
+        std::filesystem::path original_file;           ///< Source path, for events and logging
+        uintmax_t original_size = 0;                   ///< Size before recompression
+        uintmax_t new_size = 0;                        ///< Size of the optimized result
+        std::chrono::milliseconds duration{0};         ///< Recompression time, carried into the event
+        std::chrono::milliseconds retry_interval{0};   ///< Spacing between attempts
+        int attempts_left = 0;                         ///< Remaining attempts before giving up
+        std::chrono::steady_clock::time_point next_attempt; ///< Earliest time of the next attempt
+    };
+
+    /**
+     * @brief Park a blocked rename on the retry queue.
+     *
+     * Starts the timer thread lazily on first use (most runs never hit
+     * a sharing violation). The calling worker returns immediately and
+     * picks up the next file.
+     */
+    void defer_rename(PendingRename entry);
+
+    /**
+     * @brief Timer-thread loop retrying parked renames until each lands
+     * or exhausts its attempts.
+     */
+    void rename_retry_loop();
+
+    /**
+     * @brief Publish the terminal outcome of a rename.
+     *
+     * On success records the stats and FileProcessCompleteEvent; on
+     * failure removes the orphaned temp and publishes the error. Shared
+     * by the synchronous path and the retry thread.
+     */
+    void complete_rename(const PendingRename& entry, const std::error_code& ec);
+
+    /**
+     * @brief Drain the retry queue and stop the timer thread.
+     *
+     * Called at the end of process() so every deferred completion event
+     * is published before the run returns. Parked entries keep retrying
+     * on their own schedule until they land or give up.
+     */
+    void wait_pending_renames();
 
     ProcessorRegistry& registry_;                 ///< Reference to the processor registry
     bool preserve_metadata_;                      ///< Whether to preserve metadata
@@ -151,12 +710,46 @@ private:
     std::filesystem::path output_dir_;            ///< Optional output directory
     bool has_output_dir_;                         ///< Convenience flag for !output_dir_.empty()
     bool output_is_directory_ = true;             ///< True if the output path refers to a directory
-    std::vector<std::filesystem::path> work_list_;///< (Phase 1->2) Files to be recompressed
-    std::stack<ExtractedContent> finalize_stack_; ///< (Phase 1->3) Containers to be re-assembled
-    ThreadPool pool_;                             ///< Thread pool for Phase 2
+    /**
+     * @brief Run-scoped directory holding all intermediate temps.
+     *
+     * Created at the start of process() and removed wholesale when the
+     * run ends (or is interrupted), so aborted runs leave no orphan
+     * temps scattered through the system temp dir and teardown is a
+     * single remove_all instead of one unlink per temp.
+     */
+    std::filesystem::path arena_dir_;
+    ThreadPool pool_;                             ///< Thread pool running the whole dataflow
     std::atomic<bool> stop_flag_{false};       ///< Flag to signal interruption
     EventBus& event_bus_;                         ///< Bus for publishing events
-    EncodeMode mode_;                             ///< (Phase 2) Strategy for recompression
+    EncodeMode mode_;                             ///< Strategy for recompression
+    ResultCache* result_cache_ = nullptr;         ///< Optional cross-run verdict cache
+    GainModel* gain_model_ = nullptr;             ///< Optional cross-run stage statistics
+    RunJournal* run_journal_ = nullptr;           ///< Optional crash-safe completion journal
+    bool deduplicate_ = false;                    ///< Whether duplicate clustering is enabled
+    uintmax_t memory_budget_ = 0;                 ///< Memory admission budget in bytes (0 = unlimited)
+    double pipe_prune_min_gain_ = 0.001;          ///< Min upstream gain keeping expensive PIPE stages (<0 = off)
+    uintmax_t memory_in_flight_ = 0;              ///< Sum of reservations held by running tasks
+    std::mutex memory_mtx_;                       ///< Guards memory_in_flight_
+    std::condition_variable memory_cv_;           ///< Wakes tasks waiting for budget headroom
+    uintmax_t size_min_ = 0;                      ///< Smallest file size processed (0 = no floor)
+    uintmax_t size_max_ = 0;                      ///< Largest file size processed (0 = no ceiling)
+    uintmax_t temp_budget_ = 0;                   ///< Extracted-bytes admission budget (0 = unlimited)
+    uintmax_t temp_in_flight_ = 0;                ///< Extracted bytes currently on the temp volume
+    size_t temp_waiters_ = 0;                     ///< Workers stalled waiting for temp headroom
+    std::mutex temp_mtx_;                         ///< Guards temp_in_flight_ and temp_waiters_
+    std::condition_variable temp_cv_;             ///< Wakes extractions waiting for temp headroom
+    std::mutex batch_mtx_;                        ///< Guards small_batches_
+    /// Small files parked for composite tasks, keyed by front processor name.
+    std::unordered_map<std::string, std::vector<SmallFileBatch>> small_batches_;
+    std::mutex dedup_mtx_;                        ///< Guards dup_clusters_
+    /// Duplicate clusters keyed by "content_hash:size".
+    std::unordered_map<std::string, std::shared_ptr<DupCluster>> dup_clusters_;
+    std::mutex rename_mtx_;                       ///< Guards pending_renames_ and the retry thread
+    std::condition_variable rename_cv_;           ///< Wakes the retry thread for new entries or shutdown
+    std::vector<PendingRename> pending_renames_;  ///< Renames parked after a sharing violation
+    bool rename_thread_exit_ = false;             ///< Tells the retry thread to drain and return
+    std::thread rename_retry_thread_;             ///< Lazily started timer thread servicing the queue
 };
 
 } // namespace chisel
@@ -0,0 +1,109 @@
+//
+// Created by Giuseppe Francione on 19/10/25.
+//
+
+/**
+ * @file result_cache.hpp
+ * @brief Persistent cache of per-file recompression verdicts.
+ */
+
+#ifndef CHISEL_RESULT_CACHE_HPP
+#define CHISEL_RESULT_CACHE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace chisel {
+
+/// @brief Outcome recorded for one (content, processor set) combination.
+enum class CacheVerdict {
+    NoImprovement, ///< Recompression produced nothing smaller
+    Optimized      ///< Recompression produced a smaller file
+};
+
+/// @brief A verdict retrieved from the cache.
+struct CacheEntry {
+    CacheVerdict verdict;        ///< What the previous run concluded
+    uintmax_t optimized_size{0}; ///< Result size for Optimized verdicts (0 otherwise)
+};
+
+/**
+ * @brief Opt-in SQLite-backed cache of recompression verdicts across runs.
+ *
+ * Nightly runs over mostly-unchanged trees redo full recompression
+ * attempts on files already known to be optimal. This cache keys a
+ * verdict on (content hash, size, processor set, chisel version), so the
+ * executor can skip a file whose exact content was already concluded to
+ * be unimprovable by the same processors and version. Only the
+ * NoImprovement verdict short-circuits work: an Optimized verdict can't
+ * reproduce the output bytes, so such files are simply re-processed.
+ *
+ * All methods are thread-safe; failures degrade to cache misses and are
+ * logged rather than thrown, since the cache is purely an accelerator.
+ */
+class ResultCache {
+public:
+    /**
+     * @brief Opens (or creates) the cache database.
+     *
+     * On failure the cache is left closed and every operation becomes a
+     * no-op; the error is logged.
+     *
+     * @param db_path Path to the SQLite database file.
+     * @param version The chisel version string, part of the cache key so
+     * upgraded processors invalidate old verdicts.
+     */
+    explicit ResultCache(const std::filesystem::path& db_path, std::string version);
+
+    ~ResultCache();
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    /// @return True if the database was opened successfully.
+    [[nodiscard]] bool is_open() const { return db_ != nullptr; }
+
+    /**
+     * @brief Looks up the verdict for a file's exact content.
+     *
+     * @param content_hash Hex digest of the file contents (see checksum_file()).
+     * @param size File size in bytes, a cheap second key component.
+     * @param processor_set The candidate processor names, joined with '+'.
+     * @return The recorded entry, or std::nullopt on a miss.
+     */
+    [[nodiscard]] std::optional<CacheEntry> lookup(const std::string& content_hash,
+                                                   uintmax_t size,
+                                                   const std::string& processor_set);
+
+    /**
+     * @brief Records (or overwrites) the verdict for a file's content.
+     *
+     * @param content_hash Hex digest of the file contents.
+     * @param size File size in bytes.
+     * @param processor_set The candidate processor names, joined with '+'.
+     * @param verdict The outcome of this run's recompression attempt.
+     * @param optimized_size Result size for Optimized verdicts, 0 otherwise.
+     */
+    void store(const std::string& content_hash,
+               uintmax_t size,
+               const std::string& processor_set,
+               CacheVerdict verdict,
+               uintmax_t optimized_size);
+
+private:
+    sqlite3* db_ = nullptr;          ///< Cache database handle (nullptr if closed)
+    sqlite3_stmt* lookup_stmt_ = nullptr; ///< Prepared SELECT
+    sqlite3_stmt* store_stmt_ = nullptr;  ///< Prepared INSERT OR REPLACE
+    std::mutex mtx_;                 ///< Serializes statement use across workers
+    std::string version_;            ///< Version component of the cache key
+};
+
+} // namespace chisel
+
+#endif // CHISEL_RESULT_CACHE_HPP
@@ -0,0 +1,97 @@
+//
+// Created by Giuseppe Francione on 19/10/25.
+//
+
+/**
+ * @file run_journal.hpp
+ * @brief Crash-safe journal of per-file completion for resumable runs.
+ */
+
+#ifndef CHISEL_RUN_JOURNAL_HPP
+#define CHISEL_RUN_JOURNAL_HPP
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace chisel {
+
+/**
+ * @brief SQLite-backed journal of files a run has finished with.
+ *
+ * A reboot mid-run used to mean starting over, because all progress
+ * lived in executor memory. With a journal attached, every file that
+ * reaches a terminal outcome (replaced, no improvement, finalized
+ * container) is recorded; a later run opened with resume = true skips
+ * those paths during analysis and redoes only in-flight and untouched
+ * work. Files that errored are deliberately not recorded, so they are
+ * retried.
+ *
+ * Writes are batched: completions accumulate in memory and are
+ * committed in one transaction per batch (and on flush()), so workers
+ * never wait on a per-file fsync. All methods are thread-safe; open
+ * failures degrade to a disabled journal and are logged, never thrown.
+ */
+class RunJournal {
+public:
+    /// Completions buffered before a transaction is committed.
+    static constexpr std::size_t batch_size = 256;
+
+    /**
+     * @brief Opens (or creates) the journal database.
+     *
+     * Without resume the journal is truncated so it reflects only the
+     * current run; with resume the recorded completions are loaded and
+     * served from memory by is_completed().
+     *
+     * @param db_path Path to the SQLite journal file.
+     * @param resume Whether to keep and honor a previous run's records.
+     */
+    explicit RunJournal(const std::filesystem::path& db_path, bool resume);
+
+    ~RunJournal();
+
+    RunJournal(const RunJournal&) = delete;
+    RunJournal& operator=(const RunJournal&) = delete;
+
+    /// @return True if the database was opened successfully.
+    [[nodiscard]] bool is_open() const { return db_ != nullptr; }
+
+    /**
+     * @brief Whether a previous run already completed this path.
+     * @param path The file to check (as passed to the executor).
+     */
+    [[nodiscard]] bool is_completed(const std::filesystem::path& path) const;
+
+    /**
+     * @brief Records that this run is done with the given path.
+     *
+     * The record lands in the current batch; it is durable after the
+     * batch commits (every batch_size completions or on flush()).
+     */
+    void mark_completed(const std::filesystem::path& path);
+
+    /**
+     * @brief Commits any buffered completions immediately.
+     */
+    void flush();
+
+private:
+    /// Commits the pending batch; the caller must hold mtx_.
+    void commit_batch_locked();
+
+    sqlite3* db_ = nullptr;               ///< Journal database handle (nullptr if disabled)
+    sqlite3_stmt* insert_stmt_ = nullptr; ///< Prepared INSERT OR IGNORE
+    mutable std::mutex mtx_;              ///< Guards the batch and statement
+    std::vector<std::string> pending_;    ///< Completions awaiting commit
+    std::unordered_set<std::string> completed_; ///< Prior run's records (resume mode)
+};
+
+} // namespace chisel
+
+#endif // CHISEL_RUN_JOURNAL_HPP
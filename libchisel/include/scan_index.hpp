@@ -0,0 +1,118 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+/**
+ * @file scan_index.hpp
+ * @brief Persistent per-directory signatures for incremental scans.
+ */
+
+#ifndef CHISEL_SCAN_INDEX_HPP
+#define CHISEL_SCAN_INDEX_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace chisel {
+
+/// @brief Cheap change signature of one directory (two stat fields).
+struct DirSignature {
+    int64_t mtime = 0;       ///< last_write_time, raw tick count
+    uint64_t link_count = 0; ///< Hard link count (~subdirectories + 2)
+
+    bool operator==(const DirSignature&) const = default;
+};
+
+/**
+ * @brief Opt-in SQLite-backed index of directory signatures across runs.
+ *
+ * Nightly target trees are largely unchanged, yet every run re-walks
+ * them in full — on high-latency metadata stores the traversal alone
+ * takes longer than the work. This index remembers each directory's
+ * (mtime, link count) from the previous run so the scanner can skip
+ * listing a directory whose signature is unchanged, re-checking only
+ * its previously-known subdirectories: an untouched subtree costs one
+ * stat per directory and none per file.
+ *
+ * New signatures are buffered in memory and land in one transaction at
+ * flush(), which callers should invoke only after a successful run — an
+ * interrupted run must not mark its unprocessed directories as seen.
+ *
+ * All methods are thread-safe; failures degrade to index misses and are
+ * logged rather than thrown, since the index is purely an accelerator.
+ */
+class ScanIndex {
+public:
+    /**
+     * @brief Opens (or creates) the index database.
+     *
+     * On failure the index is left closed and every operation becomes a
+     * no-op; the error is logged.
+     * @param db_path Path to the SQLite database file.
+     */
+    explicit ScanIndex(const std::filesystem::path& db_path);
+
+    ~ScanIndex();
+
+    ScanIndex(const ScanIndex&) = delete;
+    ScanIndex& operator=(const ScanIndex&) = delete;
+
+    /// @return True if the database was opened successfully.
+    [[nodiscard]] bool is_open() const { return db_ != nullptr; }
+
+    /**
+     * @brief Stats one directory into its change signature.
+     * @param dir The directory to stat.
+     * @param ec Set on failure (e.g. the directory vanished).
+     */
+    static DirSignature signature_of(const std::filesystem::path& dir,
+                                     std::error_code& ec);
+
+    /// @return The signature recorded by the previous run, if any.
+    [[nodiscard]] std::optional<DirSignature> lookup(const std::string& dir);
+
+    /**
+     * @brief Subdirectories the previous run recorded under a directory.
+     *
+     * Consulted when the parent is pruned: its listing is skipped, so
+     * the known children are re-enqueued from here instead.
+     */
+    [[nodiscard]] std::vector<std::string> children(const std::string& dir);
+
+    /// Buffers this run's signature of a directory (written at flush()).
+    void record(const std::string& dir, const DirSignature& sig);
+
+    /// Buffers removal of a directory that no longer exists.
+    void forget(const std::string& dir);
+
+    /// Writes all buffered records in one transaction.
+    void flush();
+
+private:
+    sqlite3* db_ = nullptr;
+    sqlite3_stmt* lookup_stmt_ = nullptr;
+    sqlite3_stmt* children_stmt_ = nullptr;
+    sqlite3_stmt* store_stmt_ = nullptr;
+    sqlite3_stmt* delete_stmt_ = nullptr;
+    std::mutex mtx_; ///< Serializes statement use and the buffers
+
+    /// One buffered upsert: directory, parent, signature.
+    struct PendingRecord {
+        std::string dir;
+        std::string parent;
+        DirSignature sig;
+    };
+    std::vector<PendingRecord> pending_;  ///< Upserts parked until flush()
+    std::vector<std::string> forgotten_;  ///< Deletes parked until flush()
+};
+
+} // namespace chisel
+
+#endif //CHISEL_SCAN_INDEX_HPP
@@ -0,0 +1,73 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+#ifndef CHISEL_SCRATCH_ARENA_HPP
+#define CHISEL_SCRATCH_ARENA_HPP
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace chisel {
+
+    /**
+     * @brief Per-thread bump allocator for per-file scratch buffers.
+     *
+     * On corpora full of tiny files the allocator time for fresh decode
+     * buffers rivals the codec time, so processors rent their scratch
+     * from the calling thread's arena instead: rents bump a pointer in
+     * one block that is kept across files and grown high-water-mark
+     * style, so steady-state recompression stops touching the heap.
+     *
+     * Rented spans stay valid until the arena is reset — a rent never
+     * moves earlier rents (requests that outgrow the block land in
+     * overflow allocations that are folded into the block on reset).
+     * The arena is thread-local: spans must not cross threads, and
+     * worker threads reset it between files via Scope.
+     */
+    class ScratchArena {
+    public:
+        /// The calling thread's arena.
+        static ScratchArena &local();
+
+        /**
+         * @brief Rents a block of scratch memory from the arena.
+         *
+         * The block is aligned for any fundamental type and its
+         * contents are indeterminate, like a fresh malloc.
+         *
+         * @param bytes Size of the block.
+         * @return A span over the block, valid until reset().
+         */
+        std::span<unsigned char> rent(size_t bytes);
+
+        /// Returns all rented memory to the arena, keeping (and growing
+        /// to the high-water mark) the underlying block for reuse.
+        void reset() noexcept;
+
+        /**
+         * @brief RAII per-file reset of the calling thread's arena.
+         *
+         * Processors open a Scope at the top of recompress(); every
+         * rent made underneath it is returned when the Scope dies,
+         * whether the file succeeded or threw.
+         */
+        class Scope {
+        public:
+            Scope() = default;
+            ~Scope() { local().reset(); }
+
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+        };
+
+    private:
+        std::vector<unsigned char> block_;                  ///< Main bump-allocated block.
+        std::vector<std::vector<unsigned char>> overflow_;  ///< Rents that outgrew block_.
+        size_t used_ = 0;                                   ///< Bytes rented from block_.
+    };
+
+} // namespace chisel
+
+#endif // CHISEL_SCRATCH_ARENA_HPP
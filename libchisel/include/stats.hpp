@@ -0,0 +1,95 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+/**
+ * @file stats.hpp
+ * @brief Always-on global run counters with per-thread accumulation.
+ *
+ * This file defines the Stats facade: relaxed atomic counters for
+ * files analyzed/processed/skipped/errored, bytes read/written/saved,
+ * and per-processor invocation counts. Increments land in padded
+ * per-thread slots and are folded on read, so keeping them always on
+ * costs a relaxed add on a thread-private cache line — far cheaper
+ * than subscribing a handler to every EventBus message.
+ */
+
+#ifndef CHISEL_STATS_HPP
+#define CHISEL_STATS_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace chisel {
+
+/**
+ * @brief Static facade for global run counters.
+ *
+ * Incremented from ProcessorExecutor's hot paths; readable at any time
+ * (including mid-run, e.g. from a signal-triggered dump) via
+ * snapshot(), which folds the per-thread slots.
+ */
+class Stats {
+public:
+    /// Scalar counters, one padded per-thread slot each.
+    enum class Counter : std::size_t {
+        FilesAnalyzed,  ///< Paths that entered analysis
+        FilesProcessed, ///< Files that completed recompression
+        FilesSkipped,   ///< Files skipped (no gain, cached, unsupported, ...)
+        FilesSizeFiltered, ///< Files excluded by the size-window prescreen
+        FilesErrored,   ///< Files that failed
+        BytesRead,      ///< Input bytes fed to recompression
+        BytesWritten,   ///< Output bytes written for improved files
+        BytesSaved,     ///< Bytes shaved off accepted results
+        Count_          ///< Number of counters (not a counter)
+    };
+
+    /**
+     * @brief Adds to one scalar counter (relaxed, thread-private slot).
+     * @param counter Which counter to bump.
+     * @param value Amount to add (default 1).
+     */
+    static void add(Counter counter, uint64_t value = 1) noexcept;
+
+    /**
+     * @brief Counts one invocation of the named processor.
+     *
+     * The name→slot mapping is resolved through a small thread-local
+     * cache, so steady-state calls take no lock.
+     * @param processor Processor name (IProcessor::get_name).
+     */
+    static void add_processor_call(std::string_view processor);
+
+    /// Folded view of all counters at one point in time.
+    struct Snapshot {
+        uint64_t files_analyzed = 0;
+        uint64_t files_processed = 0;
+        uint64_t files_skipped = 0;
+        uint64_t files_size_filtered = 0;
+        uint64_t files_errored = 0;
+        uint64_t bytes_read = 0;
+        uint64_t bytes_written = 0;
+        uint64_t bytes_saved = 0;
+        /// Invocation count per processor name, registration order.
+        std::vector<std::pair<std::string, uint64_t>> processor_calls;
+    };
+
+    /**
+     * @brief Folds every thread's slots into one consistent-enough view.
+     *
+     * Safe to call concurrently with increments; individual counters
+     * are read atomically, the set as a whole is a point-in-time
+     * approximation.
+     */
+    [[nodiscard]] static Snapshot snapshot();
+};
+
+/// Convenience accessor for the folded counters.
+[[nodiscard]] inline Stats::Snapshot stats() { return Stats::snapshot(); }
+
+} // namespace chisel
+
+#endif //CHISEL_STATS_HPP
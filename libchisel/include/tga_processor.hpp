@@ -45,6 +45,12 @@ namespace chisel {
         [[nodiscard]] bool can_recompress() const noexcept override { return true; }
         [[nodiscard]] bool can_extract_contents() const noexcept override { return false; }
 
+        /**
+         * @brief Buffer-to-buffer recompression is supported.
+         * @return true
+         */
+        [[nodiscard]] bool can_recompress_buffer() const noexcept override { return true; }
+
         // --- operations ---
 
         /**
@@ -63,6 +69,18 @@ namespace chisel {
                         const std::filesystem::path& output,
                         bool preserve_metadata) override;
 
+        /**
+         * @brief In-memory variant of recompress().
+         *
+         * Decodes from and re-encodes RLE into caller buffers, so batch
+         * runs over many small TGAs skip the per-file temp-file churn
+         * entirely.
+         * @return false if the input is not a decodable TGA.
+         */
+        bool recompress_buffer(std::span<const std::byte> input,
+                               std::vector<std::byte>& output,
+                               bool preserve_metadata) override;
+
         /**
          * @brief TGA is not a container format.
          * @return std::nullopt
@@ -68,6 +68,13 @@ namespace chisel {
                         const std::filesystem::path& output,
                         bool preserve_metadata) override;
 
+        /// Cancellable variant: polls the token per strip and per
+        /// directory, so a stop lands within ~1 MiB of encoding.
+        void recompress(const std::filesystem::path& input,
+                        const std::filesystem::path& output,
+                        bool preserve_metadata,
+                        const std::stop_token& stop) override;
+
         /**
          * @brief TIFF is not a container format.
          * @return std::nullopt
@@ -0,0 +1,87 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+/**
+ * @file trace.hpp
+ * @brief Opt-in Chrome trace_event span recording.
+ *
+ * This file defines the Trace facade and its RAII Span helper. When
+ * tracing is enabled, scoped spans record where pipeline time goes
+ * (analysis, per-processor stages, finalization, rename/verify) into
+ * per-thread buffers and are written out as a Chrome trace_event JSON
+ * file loadable in chrome://tracing or Perfetto.
+ */
+
+#ifndef CHISEL_TRACE_HPP
+#define CHISEL_TRACE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Static facade for opt-in pipeline span tracing.
+ *
+ * Disabled by default: a Span construction is then a single relaxed
+ * atomic load and nothing is recorded, so instrumented hot paths pay
+ * essentially nothing. When enabled, each thread appends completed
+ * spans to its own thread-local buffer with no locking, so tracing
+ * does not perturb the concurrency it is measuring; buffers are only
+ * gathered under a mutex by write(), which must run after the pipeline
+ * has drained.
+ */
+class Trace {
+public:
+    /**
+     * @brief Enables span recording for this run.
+     * @param output_path Destination of the trace JSON written by write().
+     */
+    static void enable(std::filesystem::path output_path);
+
+    /// Whether tracing is enabled (one relaxed atomic load).
+    [[nodiscard]] static bool enabled() noexcept;
+
+    /**
+     * @brief Serializes all recorded spans to the configured JSON file.
+     *
+     * Call once, after processing has drained (worker threads idle);
+     * gathering the per-thread buffers is not synchronized against
+     * concurrent span completion.
+     * @return true if the trace file was written successfully.
+     */
+    static bool write();
+
+    /**
+     * @brief RAII scoped span: records [construction, destruction).
+     *
+     * Arguments are only copied when tracing is enabled.
+     */
+    class Span {
+    public:
+        /**
+         * @brief Starts a span.
+         * @param name Span name (e.g. "analyze", a processor name).
+         * @param path File the span is about; stored as an argument tag.
+         * @param size Size in bytes of the data involved (0 if unknown).
+         */
+        Span(std::string_view name, const std::filesystem::path& path, uintmax_t size = 0);
+        ~Span();
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+        Span(Span&&) = delete;
+        Span& operator=(Span&&) = delete;
+
+    private:
+        bool active_ = false;                          ///< False when tracing is off: dtor is a no-op
+        std::string name_;                             ///< Span name
+        std::string path_;                             ///< Tagged file path
+        uintmax_t size_ = 0;                           ///< Tagged byte size
+        std::chrono::steady_clock::time_point start_;  ///< Span start time
+    };
+};
+
+#endif //CHISEL_TRACE_HPP
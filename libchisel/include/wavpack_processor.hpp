@@ -54,6 +54,12 @@ namespace chisel {
          * This processor correctly handles both single (.wv) and
          * dual-file (.wv + .wvc) inputs.
          *
+         * The decoder runs on its own thread feeding the encoder
+         * through a bounded queue, and when the vendored libwavpack
+         * supports worker threads (5.7+) both sides encode/decode
+         * blocks in parallel with cores leased from the shared budget,
+         * so multichannel stems no longer pack at single-core speed.
+         *
          * @param input Path to the source WavPack file (.wv).
          * @param output Path to write the optimized WavPack file.
          * @param preserve_metadata If true, copies APEv2 tags
@@ -64,6 +70,13 @@ namespace chisel {
                         const std::filesystem::path& output,
                         bool preserve_metadata) override;
 
+        /// Cancellable variant: polls the token per 64k-sample chunk on
+        /// both sides of the decode/encode pipeline.
+        void recompress(const std::filesystem::path& input,
+                        const std::filesystem::path& output,
+                        bool preserve_metadata,
+                        const std::stop_token& stop) override;
+
         /**
          * @brief This format cannot be extracted.
          * @return std::nullopt
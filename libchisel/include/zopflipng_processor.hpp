@@ -46,13 +46,29 @@ namespace chisel {
         [[nodiscard]] bool can_recompress() const noexcept override { return true; }
         [[nodiscard]] bool can_extract_contents() const noexcept override { return false; }
 
+        /// Zopfli's search dwarfs PngProcessor's pass; the executor may
+        /// prune this stage when that pass found nothing left to gain.
+        [[nodiscard]] bool is_expensive() const noexcept override { return true; }
+
+        // --- configuration ---
+
+        /**
+         * @brief Set the effort level (1 = fast, 2 = default, 3 = deep).
+         *
+         * Scales the Zopfli iteration budget and the per-file wall-clock
+         * cap applied by recompress().
+         */
+        void set_effort(const int level) noexcept override { effort_ = level; }
+
         // --- operations ---
 
         /**
          * @brief Optimizes a PNG file using ZopfliPNG.
          *
-         * Uses the `ZopfliPNGOptimize` function to re-compress the file
-         * with a specified number of iterations (e.g., 15).
+         * Uses the `ZopfliPNGOptimize` function with an iteration count
+         * scaled to the input size and the configured effort level; when
+         * time remains within the per-file budget, a deeper refinement
+         * pass runs and the smaller result is kept.
          *
          * @param input Path to the source PNG file.
          * @param output Path to write the optimized PNG file.
@@ -64,6 +80,19 @@ namespace chisel {
                         const std::filesystem::path& output,
                         bool preserve_metadata) override;
 
+        /**
+         * @brief Cancellable variant.
+         *
+         * The parallel IDAT path polls the token per Zopfli chunk and
+         * the standard path checks it between passes (skipping the
+         * refinement pass), so a stop on a large PNG lands within one
+         * chunk instead of after minutes of search.
+         */
+        void recompress(const std::filesystem::path& input,
+                        const std::filesystem::path& output,
+                        bool preserve_metadata,
+                        const std::stop_token& stop) override;
+
         /**
          * @brief This format cannot be extracted.
          * @return std::nullopt
@@ -104,6 +133,9 @@ namespace chisel {
          * @return A vector containing the Zopfli-compressed zlib stream.
          */
         static std::vector<unsigned char> recompress_with_zopfli(const std::vector<unsigned char>& input);
+
+    private:
+        int effort_ = 2; ///< Effort level set before the run (1..3)
     };
 
 } // namespace chisel
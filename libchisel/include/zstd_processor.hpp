@@ -0,0 +1,143 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+/**
+ * @file zstd_processor.hpp
+ * @brief Defines the IProcessor implementation for standalone zstd frames.
+ */
+
+#ifndef CHISEL_ZSTD_PROCESSOR_HPP
+#define CHISEL_ZSTD_PROCESSOR_HPP
+
+#include "processor.hpp"
+#include <array>
+#include <string_view>
+#include <span>
+
+namespace chisel {
+
+    /**
+     * @brief Implements IProcessor for .zst files using libzstd.
+     *
+     * @details Backup and log pipelines write zstd at low levels for
+     * speed, leaving ratio on the table. This processor decompresses the
+     * input (multi-frame and skippable frames included) and re-encodes
+     * it as one frame at a high level with long-distance matching,
+     * spreading the work over zstd's multithreaded compression contexts
+     * with workers drawn from the core budget. The output frame carries
+     * the XXH64 content checksum, so decoders — and raw_equal() — verify
+     * the payload end to end.
+     *
+     * ArchiveProcessor also claims .zst (to recurse into tar.zst
+     * payloads); this processor is the direct path and the executor
+     * keeps whichever result is smaller.
+     */
+    class ZstdProcessor final : public IProcessor {
+    public:
+        // --- self-description ---
+        [[nodiscard]] std::string_view get_name() const noexcept override {
+            return "ZstdProcessor";
+        }
+
+        [[nodiscard]] std::span<const std::string_view> get_supported_mime_types() const noexcept override {
+            static constexpr std::array<std::string_view, 2> kMimes = {
+                "application/zstd", "application/x-zstd"
+            };
+            return {kMimes.data(), kMimes.size()};
+        }
+
+        [[nodiscard]] std::span<const std::string_view> get_supported_extensions() const noexcept override {
+            static constexpr std::array<std::string_view, 1> kExts = { ".zst" };
+            return {kExts.data(), kExts.size()};
+        }
+
+        // --- capabilities ---
+        [[nodiscard]] bool can_recompress() const noexcept override { return true; }
+        [[nodiscard]] bool can_extract_contents() const noexcept override { return false; }
+        [[nodiscard]] bool can_recompress_buffer() const noexcept override { return true; }
+
+        /// 1 = level 12, 2 = level 19 (default), 3 = level 22 (ultra).
+        void set_effort(const int level) noexcept override { effort_ = level; }
+
+        /**
+         * @brief Peak working set: the decompressed payload plus the
+         * long-distance-matching window and per-worker job buffers.
+         *
+         * Level-3 backup output typically shrinks 3-5x, so the plain
+         * data dominates the default input-based multiple.
+         */
+        [[nodiscard]] uintmax_t estimate_memory(const uintmax_t input_bytes) const noexcept override {
+            return input_bytes * 8 + (128ull << 20);
+        }
+
+        // --- operations ---
+
+        /**
+         * @brief Re-encodes a zstd file at high compression.
+         *
+         * Decompresses all frames, then compresses the payload as a
+         * single frame with long-distance matching, the content size
+         * header, the frame checksum, and as many zstd workers as the
+         * core budget grants.
+         *
+         * @param input Path to the source .zst file.
+         * @param output Path to write the optimized .zst file.
+         * @param preserve_metadata Ignored; zstd frames carry no metadata.
+         * @throws std::runtime_error if the input is not a valid zstd
+         * stream or encoding fails.
+         */
+        void recompress(const std::filesystem::path& input,
+                        const std::filesystem::path& output,
+                        bool preserve_metadata) override;
+
+        /// Cancellable variant: polls the token per decompressed MiB and
+        /// per compressed input chunk.
+        void recompress(const std::filesystem::path& input,
+                        const std::filesystem::path& output,
+                        bool preserve_metadata,
+                        const std::stop_token& stop) override;
+
+        /**
+         * @brief In-memory variant of recompress(), same re-encode path.
+         * @return true if the input was a valid zstd stream and was
+         * re-encoded; false otherwise.
+         */
+        bool recompress_buffer(std::span<const std::byte> input,
+                               std::vector<std::byte>& output,
+                               bool preserve_metadata) override;
+
+        /**
+         * @brief zstd is not treated as a container here.
+         * @return std::nullopt
+         */
+        std::optional<ExtractedContent> prepare_extraction(
+            [[maybe_unused]] const std::filesystem::path& input_path) override { return std::nullopt; }
+
+        /**
+         * @brief zstd is not treated as a container here.
+         * @return Empty path.
+         */
+        std::filesystem::path finalize_extraction(const ExtractedContent &) override { return {}; }
+
+        // --- integrity check ---
+
+        /**
+         * @brief CRC32C of the decompressed payload.
+         *
+         * Decompression itself verifies the frame's XXH64 checksum when
+         * present, so a passing digest also attests the stored one.
+         *
+         * @param file_path Path to the file.
+         * @return The hex digest, or an empty string if the stream does
+         * not decompress.
+         */
+        [[nodiscard]] std::string get_raw_checksum(const std::filesystem::path& file_path) const override;
+
+    private:
+        int effort_ = 2; ///< Current effort level (see set_effort())
+    };
+
+} // namespace chisel
+
+#endif // CHISEL_ZSTD_PROCESSOR_HPP
@@ -5,15 +5,21 @@
 #include "../../include/ape_processor.hpp"
 #include "../../include/logger.hpp"
 #include "../../include/audio_metadata_util.hpp"
+#include "../../include/pcm_utils.hpp"
 #include "../../include/file_utils.hpp"
 #include "../../include/random_utils.hpp"
+#include "../../include/core_budget.hpp"
 #include <MACLib.h>
 #include <APETag.h>
 #include <vector>
 #include <stdexcept>
 #include <filesystem>
 #include <algorithm>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <any>
 #include "file_type.hpp"
 
@@ -67,13 +73,41 @@ bool copy_apetag(const std::filesystem::path &input,
     }
 }
 
+/**
+ * @brief Whether the vendored MACLib exposes codec multithreading.
+ *
+ * APE frames are independent given fixed parameters, and the 10.x
+ * MACLib line encodes/decodes frame ranges on worker threads behind
+ * this setter. Older copies simply compile the call away and keep the
+ * single-threaded codec paths.
+ */
+template <typename Codec>
+concept mac_has_threads = requires(Codec *codec, int threads) {
+    codec->SetNumberOfThreads(threads);
+};
+
+/// Applies the codec thread count when the API exists, a no-op otherwise.
+template <typename Codec>
+void set_mac_threads(Codec *codec, const int threads) {
+    if constexpr (mac_has_threads<Codec>) {
+        codec->SetNumberOfThreads(threads);
+    }
+}
+
 } // namespace
 
 namespace chisel {
 
 void ApeProcessor::recompress(const std::filesystem::path& input,
                               const std::filesystem::path& output,
-                              bool preserve_metadata) {
+                              const bool preserve_metadata) {
+    recompress(input, output, preserve_metadata, std::stop_token{});
+}
+
+void ApeProcessor::recompress(const std::filesystem::path& input,
+                              const std::filesystem::path& output,
+                              bool preserve_metadata,
+                              const std::stop_token& stop) {
     Logger::log(LogLevel::Info, "Starting APE re-encoding: " + input.string(), "ape_processor");
 
     if (std::filesystem::exists(output)) {
@@ -138,30 +172,95 @@ void ApeProcessor::recompress(const std::filesystem::path& input,
         throw std::runtime_error("ApeProcessor: encoder start failed");
     }
 
-    std::vector<uint8_t> block(static_cast<size_t>(block_bytes));
-    int64_t frames_processed_total = 0;
-
-    while (frames_processed_total < total_frames) {
-        APE::int64 blocks_retrieved = 0;
-        int rc = pDecompress->GetData(block.data(), block_frames_request, &blocks_retrieved);
-        if (rc != ERROR_SUCCESS) {
-            pCompress->Finish(NULL, 0, 0);
-            APE_SAFE_DELETE(pCompress)
-            delete pDecompress;
-            throw std::runtime_error("ApeProcessor: decoding failed");
+    // Lease the free cores for the whole transcode, the same shape as
+    // the FLAC path: when the vendored MACLib can run frame workers,
+    // both codec sides get the grant (plus this thread); otherwise the
+    // setter compiles away and only the pipeline overlap below remains.
+    const auto hw = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    const CoreBudget::Lease ape_cores(hw - 1);
+    set_mac_threads(pDecompress, ape_cores.taken() + 1);
+    set_mac_threads(pCompress, ape_cores.taken() + 1);
+
+    // Decode and encode are both CPU-bound, so running them back to back
+    // wastes half the machine even single-threaded. The decoder runs on
+    // its own thread and hands chunks to the encoder through a small
+    // bounded queue.
+    struct Chunk {
+        std::vector<uint8_t> data;
+        APE::int64 blocks = 0;
+    };
+    constexpr size_t queue_depth = 4;
+    std::deque<Chunk> queue;
+    std::mutex queue_mtx;
+    std::condition_variable queue_cv;
+    bool decode_done = false;
+    bool decode_failed = false;
+    bool abort_pipeline = false;
+
+    std::jthread decoder([&] {
+        std::vector<uint8_t> block(static_cast<size_t>(block_bytes));
+        int64_t frames_decoded = 0;
+        while (frames_decoded < total_frames && !stop.stop_requested()) {
+            APE::int64 blocks_retrieved = 0;
+            if (pDecompress->GetData(block.data(), block_frames_request, &blocks_retrieved) != ERROR_SUCCESS) {
+                std::lock_guard lock(queue_mtx);
+                decode_failed = true;
+                break;
+            }
+            if (blocks_retrieved <= 0) break;
+
+            Chunk chunk;
+            chunk.blocks = blocks_retrieved;
+            const size_t bytes = static_cast<size_t>(blocks_retrieved) * static_cast<size_t>(block_align);
+            chunk.data.assign(block.begin(), block.begin() + bytes);
+            {
+                std::unique_lock lock(queue_mtx);
+                queue_cv.wait(lock, [&] { return queue.size() < queue_depth || abort_pipeline; });
+                if (abort_pipeline) return;
+                queue.push_back(std::move(chunk));
+            }
+            queue_cv.notify_all();
+            frames_decoded += blocks_retrieved;
         }
-        if (blocks_retrieved <= 0) break;
-
-        const size_t bytes_to_add = static_cast<size_t>(blocks_retrieved) * static_cast<size_t>(block_align);
-        int add_rc = pCompress->AddData(block.data(), static_cast<APE::int64>(bytes_to_add));
-        if (add_rc != 0) {
-            pCompress->Finish(NULL, 0, 0);
-            APE_SAFE_DELETE(pCompress)
-            delete pDecompress;
-            throw std::runtime_error("ApeProcessor: AddData failed");
+        {
+            std::lock_guard lock(queue_mtx);
+            decode_done = true;
+        }
+        queue_cv.notify_all();
+    });
+
+    bool add_failed = false;
+    while (true) {
+        Chunk chunk;
+        {
+            std::unique_lock lock(queue_mtx);
+            queue_cv.wait(lock, [&] { return !queue.empty() || decode_done; });
+            if (queue.empty()) break; // drained and decoder finished (or failed)
+            chunk = std::move(queue.front());
+            queue.pop_front();
+        }
+        queue_cv.notify_all();
+
+        if (stop.stop_requested() ||
+            pCompress->AddData(chunk.data.data(), static_cast<APE::int64>(chunk.data.size())) != 0) {
+            add_failed = !stop.stop_requested();
+            std::lock_guard lock(queue_mtx);
+            abort_pipeline = true;
+            queue_cv.notify_all();
+            break;
         }
+    }
+    decoder.join();
 
-        frames_processed_total += blocks_retrieved;
+    if (decode_failed || add_failed || stop.stop_requested()) {
+        pCompress->Finish(NULL, 0, 0);
+        APE_SAFE_DELETE(pCompress)
+        delete pDecompress;
+        if (stop.stop_requested()) {
+            throw std::runtime_error("ApeProcessor: recompression interrupted");
+        }
+        throw std::runtime_error(decode_failed ? "ApeProcessor: decoding failed"
+                                               : "ApeProcessor: AddData failed");
     }
 
     delete pDecompress;
@@ -293,17 +392,19 @@ std::vector<int32_t> decode_ape_pcm(const std::filesystem::path& file,
         if (blocks_retrieved <= 0) break;
 
         const size_t bytes_to_copy = static_cast<size_t>(blocks_retrieved) * block_align;
-        const auto* src16 = reinterpret_cast<const int16_t*>(block.data());
-        const auto* src32 = reinterpret_cast<const int32_t*>(block.data());
+        const size_t sample_count = bytes_to_copy / bytes_per_sample;
+        const size_t old_size = pcm.size();
+        pcm.resize(old_size + sample_count);
 
         if (bps == 16) {
-            for (size_t i = 0; i < bytes_to_copy / 2; ++i) {
-                pcm.push_back(static_cast<int32_t>(src16[i]));
-            }
-        } else if (bps == 24 || bps == 32) {
-            for (size_t i = 0; i < bytes_to_copy / 4; ++i) {
-                pcm.push_back(src32[i]);
-            }
+            pcm_widen16(reinterpret_cast<const int16_t*>(block.data()),
+                        pcm.data() + old_size, sample_count);
+        } else if (bps == 24) {
+            // GetData hands back WAV-layout samples: 24-bit is 3 packed
+            // bytes, not an aligned int32
+            pcm_widen24(block.data(), pcm.data() + old_size, sample_count);
+        } else if (bps == 32) {
+            std::memcpy(pcm.data() + old_size, block.data(), bytes_to_copy);
         } else {
             delete dec;
             throw std::runtime_error("Unsupported bit depth in APE");
@@ -3,12 +3,16 @@
 //
 
 #include "../../include/archive_processor.hpp"
+#include "../../include/core_budget.hpp"
 #include "../../include/logger.hpp"
 #include "../../include/mime_detector.hpp"
 #include "../../include/file_type.hpp"
 #include "../../include/random_utils.hpp"
 #include <archive.h>
 #include <archive_entry.h>
+#include <zlib.h>
+#include <atomic>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <string>
@@ -19,6 +23,7 @@
 #include <algorithm>
 #include <chrono>
 #include <cctype>
+#include <thread>
 #include "file_utils.hpp"
 #ifndef _WIN32
 #include <sys/stat.h>
@@ -193,12 +198,38 @@ static bool is_archive_file(const fs::path& path, ContainerFormat& fmt_out) {
 // --- libarchive extract/create ---
 
 /**
- * @brief Extracts the contents of an archive to a destination directory using libarchive.
+ * @brief Guesses from the name alone whether an entry is a nested archive.
+ *
+ * Used while extracting to memory, where MIME sniffing (which works on
+ * files) is not yet available; nested archives must go to disk so the
+ * executor can recurse into them.
+ */
+static bool name_suggests_archive(const fs::path& p) {
+    std::string ext = to_lower_copy(p.extension().string());
+    if (!ext.empty() && ext.front() == '.') ext.erase(0, 1);
+    if (!ext.empty() && parse_container_format(ext)) return true;
+    const auto fname = to_lower_copy(p.filename().string());
+    return fname.ends_with(".tar.gz") || fname.ends_with(".tar.bz2") ||
+           fname.ends_with(".tar.xz") || fname.ends_with(".tar.zst") ||
+           fname.ends_with(".tzst");
+}
+
+/**
+ * @brief Extracts the contents of an archive using libarchive.
+ *
+ * Regular members below @p memory_limit whose name does not suggest a
+ * nested archive are staged into @p memory_out instead of being written
+ * to disk; everything else lands in @p dest_dir as before.
+ *
  * @param archive_path The path to the archive file.
- * @param dest_dir The directory where contents will be extracted.
+ * @param dest_dir The directory where oversized contents are extracted.
+ * @param memory_out Receives in-memory members (may be null to disable).
+ * @param memory_limit Per-member cap for in-memory staging, in bytes.
  * @return True on successful extraction, false otherwise.
  */
-static bool extract_with_libarchive(const fs::path& archive_path, const fs::path& dest_dir) {
+static bool extract_with_libarchive(const fs::path& archive_path, const fs::path& dest_dir,
+                                    std::vector<ExtractedContent::MemoryMember>* memory_out = nullptr,
+                                    const uintmax_t memory_limit = 0) {
     struct archive* a = archive_read_new();
     struct archive_entry* entry = nullptr;
 
@@ -267,6 +298,29 @@ static bool extract_with_libarchive(const fs::path& archive_path, const fs::path
             continue;
         }
 
+        // Small plain members stay in memory; the temp volume is only
+        // touched for their final recompressed bytes at reassembly.
+        if (memory_out != nullptr && memory_limit > 0 &&
+            archive_entry_size_is_set(entry) &&
+            static_cast<uintmax_t>(archive_entry_size(entry)) < memory_limit &&
+            !name_suggests_archive(out_path)) {
+            ExtractedContent::MemoryMember member;
+            member.path = out_path;
+            member.data.reserve(static_cast<size_t>(archive_entry_size(entry)));
+            la_ssize_t got = 0;
+            while ((got = archive_read_data(a, buffer.data(), buffer.size())) > 0) {
+                const auto* bytes = reinterpret_cast<const std::byte*>(buffer.data());
+                member.data.insert(member.data.end(), bytes, bytes + got);
+            }
+            if (got < 0) {
+                Logger::log(LogLevel::Error, "Error reading data: " + std::string(archive_error_string(a)), processor_tag());
+                archive_read_free(a);
+                return false;
+            }
+            memory_out->push_back(std::move(member));
+            continue;
+        }
+
         FILE* out = chisel::open_file(out_path, "wb");
         if (!out) {
             Logger::log(LogLevel::Error, "Can't open file in write mode: " + out_path.string(), processor_tag());
@@ -309,6 +363,242 @@ struct PairHash {
     }
 };
 
+// --- parallel ZIP writer ---
+
+/**
+ * @brief Whether a format is written as a plain ZIP container.
+ */
+static bool is_zip_family(const ContainerFormat fmt) {
+    switch (fmt) {
+        case ContainerFormat::Epub:
+        case ContainerFormat::Zip:
+        case ContainerFormat::Cbz:
+        case ContainerFormat::Jar:
+        case ContainerFormat::Xpi:
+        case ContainerFormat::Ora:
+        case ContainerFormat::Dwfx:
+        case ContainerFormat::Xps:
+        case ContainerFormat::Apk:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief One ZIP member prepared by a compression worker.
+ */
+struct ZipMember {
+    std::string name;                 ///< Forward-slash relative path
+    std::vector<unsigned char> data;  ///< Payload as written (stored or deflated)
+    uint32_t crc = 0;                 ///< CRC-32 of the uncompressed payload
+    uint32_t usize = 0;               ///< Uncompressed size
+    uint16_t method = 0;              ///< 0 = store, 8 = deflate
+    bool ok = false;                  ///< Whether preparation succeeded
+};
+
+/**
+ * @brief Raw-deflate a buffer at maximum level.
+ * @return True on success, with @p out holding the compressed bytes.
+ */
+static bool deflate_raw_max(const std::vector<unsigned char>& in, std::vector<unsigned char>& out) {
+    z_stream s{};
+    if (deflateInit2(&s, 9, Z_DEFLATED, -15, 9, Z_DEFAULT_STRATEGY) != Z_OK) return false;
+    out.resize(deflateBound(&s, static_cast<uLong>(in.size())));
+    s.next_in = const_cast<Bytef*>(in.data());
+    s.avail_in = static_cast<uInt>(in.size());
+    s.next_out = out.data();
+    s.avail_out = static_cast<uInt>(out.size());
+    const int r = deflate(&s, Z_FINISH);
+    const size_t produced = out.size() - s.avail_out;
+    deflateEnd(&s);
+    if (r != Z_STREAM_END) return false;
+    out.resize(produced);
+    return true;
+}
+
+static void put_u16_le(std::vector<unsigned char>& v, const uint16_t x) {
+    v.push_back(static_cast<unsigned char>(x & 0xFF));
+    v.push_back(static_cast<unsigned char>(x >> 8 & 0xFF));
+}
+
+static void put_u32_le(std::vector<unsigned char>& v, const uint32_t x) {
+    v.push_back(static_cast<unsigned char>(x & 0xFF));
+    v.push_back(static_cast<unsigned char>(x >> 8 & 0xFF));
+    v.push_back(static_cast<unsigned char>(x >> 16 & 0xFF));
+    v.push_back(static_cast<unsigned char>(x >> 24 & 0xFF));
+}
+
+/**
+ * @brief Rebuild a ZIP-family archive with member compression spread across threads.
+ *
+ * ZIP members are independent, so every payload is read and deflated to a
+ * memory buffer by a pool of workers (store wins when deflate does not
+ * shrink), then the local headers, data and central directory are written
+ * serially in the collected order. EPUB keeps its stored mimetype first,
+ * CBZ keeps natural page order.
+ *
+ * @return True when the archive was written; false when the layout cannot
+ * be represented here (symlinks, zip64 sizes/counts, unreadable entries)
+ * and the caller should fall back to the sequential libarchive writer.
+ */
+static bool write_zip_parallel(const fs::path& src_dir, const fs::path& out_path, const ContainerFormat fmt) {
+    std::error_code ec;
+    const fs::path root(src_dir);
+
+    std::vector<fs::path> files;
+    for (auto it = fs::recursive_directory_iterator(root, ec); !ec && it != fs::recursive_directory_iterator(); ++it) {
+        std::error_code ec2;
+        if (fs::is_symlink(it->path(), ec2)) return false; // let libarchive handle links
+        if (fs::is_regular_file(it->path(), ec2)) {
+            if (fmt == ContainerFormat::Epub && it->path().filename() == "mimetype") continue;
+            files.push_back(it->path());
+        }
+    }
+    if (fmt == ContainerFormat::Cbz) {
+        std::sort(files.begin(), files.end(), [&](const fs::path& a, const fs::path& b) {
+            return natural_less_path(a, b, root);
+        });
+    }
+
+    std::vector<ZipMember> members(files.size());
+    std::atomic<size_t> next{0};
+    auto work = [&] {
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < files.size();
+             i = next.fetch_add(1, std::memory_order_relaxed)) {
+            auto& m = members[i];
+            m.name = rel_path_of(root, files[i]);
+
+            std::ifstream ifs(files[i], std::ios::binary);
+            if (!ifs) continue;
+            std::vector<unsigned char> raw((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+            if (raw.size() >= 0xFFFFFFFFull) continue; // zip64 territory
+
+            m.usize = static_cast<uint32_t>(raw.size());
+            uLong crc = crc32(0L, Z_NULL, 0);
+            if (!raw.empty()) crc = crc32(crc, raw.data(), static_cast<uInt>(raw.size()));
+            m.crc = static_cast<uint32_t>(crc);
+
+            // EPUB members stay stored, matching the sequential path
+            std::vector<unsigned char> deflated;
+            if (fmt != ContainerFormat::Epub &&
+                !raw.empty() && deflate_raw_max(raw, deflated) && deflated.size() < raw.size()) {
+                m.method = 8;
+                m.data = std::move(deflated);
+            } else {
+                m.method = 0;
+                m.data = std::move(raw);
+            }
+            m.ok = true;
+        }
+    };
+    {
+        const auto hw = static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency()));
+        const size_t workers_wanted = std::min(files.size(), hw);
+        std::vector<std::jthread> workers;
+        workers.reserve(workers_wanted > 0 ? workers_wanted - 1 : 0);
+        for (size_t k = 1; k < workers_wanted; ++k) {
+            workers.emplace_back(work);
+        }
+        work(); // the calling thread compresses too
+    }
+    for (const auto& m : members) {
+        if (!m.ok) return false;
+    }
+
+    // EPUB: the stored mimetype member must come first
+    if (fmt == ContainerFormat::Epub) {
+        const fs::path mimetype_path = root / "mimetype";
+        if (fs::exists(mimetype_path, ec)) {
+            std::ifstream ifs(mimetype_path, std::ios::binary);
+            ZipMember m;
+            m.name = "mimetype";
+            m.data.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+            m.usize = static_cast<uint32_t>(m.data.size());
+            uLong crc = crc32(0L, Z_NULL, 0);
+            if (!m.data.empty()) crc = crc32(crc, m.data.data(), static_cast<uInt>(m.data.size()));
+            m.crc = static_cast<uint32_t>(crc);
+            m.method = 0;
+            m.ok = true;
+            members.insert(members.begin(), std::move(m));
+        }
+    }
+
+    if (members.size() > 0xFFFF) return false; // needs zip64 counts
+
+    std::ofstream out(out_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        Logger::log(LogLevel::Error, "Can't open archive for writing: " + out_path.string(), processor_tag());
+        return false;
+    }
+
+    std::vector<uint32_t> offsets(members.size());
+    uint64_t pos = 0;
+    for (size_t i = 0; i < members.size(); ++i) {
+        const auto& m = members[i];
+        if (pos >= 0xFFFFFFFFull) return false; // needs zip64 offsets
+        offsets[i] = static_cast<uint32_t>(pos);
+
+        std::vector<unsigned char> hdr;
+        put_u32_le(hdr, 0x04034b50); // local file header
+        put_u16_le(hdr, 20);         // version needed
+        put_u16_le(hdr, 0x0800);     // UTF-8 names
+        put_u16_le(hdr, m.method);
+        put_u16_le(hdr, 0);          // mod time (DOS epoch, like the sequential path)
+        put_u16_le(hdr, 0x0021);     // mod date: 1980-01-01
+        put_u32_le(hdr, m.crc);
+        put_u32_le(hdr, static_cast<uint32_t>(m.data.size()));
+        put_u32_le(hdr, m.usize);
+        put_u16_le(hdr, static_cast<uint16_t>(m.name.size()));
+        put_u16_le(hdr, 0);          // extra length
+        out.write(reinterpret_cast<const char*>(hdr.data()), static_cast<std::streamsize>(hdr.size()));
+        out.write(m.name.data(), static_cast<std::streamsize>(m.name.size()));
+        out.write(reinterpret_cast<const char*>(m.data.data()), static_cast<std::streamsize>(m.data.size()));
+        pos += hdr.size() + m.name.size() + m.data.size();
+    }
+
+    const uint64_t cd_start = pos;
+    for (size_t i = 0; i < members.size(); ++i) {
+        const auto& m = members[i];
+        std::vector<unsigned char> hdr;
+        put_u32_le(hdr, 0x02014b50); // central directory header
+        put_u16_le(hdr, 20);         // version made by
+        put_u16_le(hdr, 20);         // version needed
+        put_u16_le(hdr, 0x0800);     // UTF-8 names
+        put_u16_le(hdr, m.method);
+        put_u16_le(hdr, 0);
+        put_u16_le(hdr, 0x0021);
+        put_u32_le(hdr, m.crc);
+        put_u32_le(hdr, static_cast<uint32_t>(m.data.size()));
+        put_u32_le(hdr, m.usize);
+        put_u16_le(hdr, static_cast<uint16_t>(m.name.size()));
+        put_u16_le(hdr, 0);          // extra length
+        put_u16_le(hdr, 0);          // comment length
+        put_u16_le(hdr, 0);          // disk number
+        put_u16_le(hdr, 0);          // internal attributes
+        put_u32_le(hdr, 0);          // external attributes
+        put_u32_le(hdr, offsets[i]);
+        out.write(reinterpret_cast<const char*>(hdr.data()), static_cast<std::streamsize>(hdr.size()));
+        out.write(m.name.data(), static_cast<std::streamsize>(m.name.size()));
+        pos += hdr.size() + m.name.size();
+    }
+
+    const uint64_t cd_size = pos - cd_start;
+    if (cd_start >= 0xFFFFFFFFull || cd_size >= 0xFFFFFFFFull) return false;
+    std::vector<unsigned char> eocd;
+    put_u32_le(eocd, 0x06054b50); // end of central directory
+    put_u16_le(eocd, 0);
+    put_u16_le(eocd, 0);
+    put_u16_le(eocd, static_cast<uint16_t>(members.size()));
+    put_u16_le(eocd, static_cast<uint16_t>(members.size()));
+    put_u32_le(eocd, static_cast<uint32_t>(cd_size));
+    put_u32_le(eocd, static_cast<uint32_t>(cd_start));
+    put_u16_le(eocd, 0);          // comment length
+    out.write(reinterpret_cast<const char*>(eocd.data()), static_cast<std::streamsize>(eocd.size()));
+
+    return out.good();
+}
+
 /**
  * @brief Creates an archive from a source directory using libarchive.
  * @param src_dir The directory containing the files to be archived.
@@ -317,9 +607,30 @@ struct PairHash {
  * @return True on successful creation, false otherwise.
  */
 static bool create_with_libarchive(const fs::path& src_dir, const fs::path& out_path, ContainerFormat fmt) {
+    // ZIP-family rebuilds go through the parallel writer so 10k-member
+    // archives scale with cores; layouts it cannot represent (symlinks,
+    // zip64 sizes) fall through to the sequential libarchive path below.
+    if (is_zip_family(fmt)) {
+        if (write_zip_parallel(src_dir, out_path, fmt)) return true;
+        std::error_code cleanup_ec;
+        fs::remove(out_path, cleanup_ec); // discard any partial fast-path output
+    }
+
     archive* a = archive_write_new();
     if (!a) return false;
 
+    // xz and zstd funnel the whole tar stream through one filter, so a
+    // single-threaded encoder leaves the rest of the machine idle for
+    // the entire rebuild of a solid archive. Both encoders support
+    // multithreading (lzma_stream_encoder_mt, zstd worker contexts);
+    // lease the free cores for the duration of the write and pass the
+    // count through libarchive's "threads" filter option. The lease
+    // keeps the calling thread, so a zero grant still encodes serially.
+    const bool mt_filter = fmt == ContainerFormat::Xz || fmt == ContainerFormat::Zstd;
+    const CoreBudget::Lease filter_cores(
+        mt_filter ? static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) - 1 : 0);
+    const std::string filter_threads = std::to_string(filter_cores.taken() + 1);
+
     int r = ARCHIVE_OK;
 
     switch (fmt) {
@@ -371,6 +682,7 @@ static bool create_with_libarchive(const fs::path& src_dir, const fs::path& out_
                 r = archive_write_add_filter_xz(a);
                 if (r == ARCHIVE_OK) {
                     archive_write_set_filter_option(a, "xz", "compression-level", "9");
+                    archive_write_set_filter_option(a, "xz", "threads", filter_threads.c_str());
                 }
             }
             break;
@@ -380,6 +692,7 @@ static bool create_with_libarchive(const fs::path& src_dir, const fs::path& out_
                 r = archive_write_add_filter_zstd(a);
                 if (r == ARCHIVE_OK) {
                     archive_write_set_filter_option(a, "zstd", "compression-level", "22");
+                    archive_write_set_filter_option(a, "zstd", "threads", filter_threads.c_str());
                 }
             }
             break;
@@ -612,8 +925,9 @@ std::optional<ExtractedContent> ArchiveProcessor::prepare_extraction(const std::
 
     Logger::log(LogLevel::Info, "Extracting archive: " + input_path.filename().string() + " -> " + content.temp_dir.filename().string(), processor_tag());
 
-    if (!extract_with_libarchive(input_path, content.temp_dir)) {
+    if (!extract_with_libarchive(input_path, content.temp_dir, &content.memory_members, memory_member_limit_)) {
         Logger::log(LogLevel::Error, "Extraction failed for: " + input_path.filename().string(), processor_tag());
+        content.memory_members.clear();
         return content;
     }
 
@@ -633,7 +947,8 @@ std::optional<ExtractedContent> ArchiveProcessor::prepare_extraction(const std::
 
     Logger::log(
         LogLevel::Debug,
-        "Extracted files: " + std::to_string(content.extracted_files.size()),
+        "Extracted files: " + std::to_string(content.extracted_files.size()) +
+            " on disk, " + std::to_string(content.memory_members.size()) + " in memory",
         processor_tag()
     );
 
@@ -650,6 +965,23 @@ std::filesystem::path ArchiveProcessor::finalize_extraction(const ExtractedConte
 
     Logger::log(LogLevel::Info, "Recreating archive: " + tmp_archive.string(), processor_tag());
 
+    // In-memory members touch the temp volume exactly once, here, with
+    // their final (possibly recompressed) bytes.
+    for (const auto& member : content.memory_members) {
+        if (member.path.empty()) continue; // spilled to disk during analysis
+        std::error_code mec;
+        if (!ensure_parent_dirs(member.path, mec)) {
+            fs::remove_all(content.temp_dir);
+            throw std::runtime_error("ArchiveProcessor: can't create folder for " + member.path.string());
+        }
+        std::ofstream ofs(member.path, std::ios::binary | std::ios::trunc);
+        if (!ofs.write(reinterpret_cast<const char*>(member.data.data()),
+                       static_cast<std::streamsize>(member.data.size()))) {
+            fs::remove_all(content.temp_dir);
+            throw std::runtime_error("ArchiveProcessor: can't write member " + member.path.string());
+        }
+    }
+
     if (!create_with_libarchive(content.temp_dir, tmp_archive, out_fmt)) {
         Logger::log(LogLevel::Error, "Archive creation failed: " + tmp_archive.string(), processor_tag());
         fs::remove_all(content.temp_dir);
@@ -5,9 +5,11 @@
 #include "../../include/bmp_processor.hpp"
 #include "../../include/logger.hpp"
 #include "../../include/file_utils.hpp"
+#include "../../include/scratch_arena.hpp"
 #include <stdexcept>
 #include <vector>
 #include <cstdio>
+#include <cstdlib>
 #include <string>
 
 extern "C" {
@@ -49,6 +51,19 @@ namespace {
         ScopedBmp(const ScopedBmp&) = delete;
         ScopedBmp& operator=(const ScopedBmp&) = delete;
     };
+
+    // RAII for a BMPHANDLE bound to a stream the caller owns
+    struct ScopedBmpHandle {
+        BMPHANDLE h = nullptr;
+
+        ScopedBmpHandle() = default;
+        ~ScopedBmpHandle() {
+            if (h) bmp_free(h);
+        }
+
+        ScopedBmpHandle(const ScopedBmpHandle&) = delete;
+        ScopedBmpHandle& operator=(const ScopedBmpHandle&) = delete;
+    };
 }
 
 namespace chisel {
@@ -57,19 +72,18 @@ static const char* processor_tag() {
     return "BmpProcessor";
 }
 
-void BmpProcessor::recompress(const std::filesystem::path& input,
-                              const std::filesystem::path& output,
-                              bool preserve_metadata) {
-    Logger::log(LogLevel::Info, "Recompressing BMP: " + input.string(), processor_tag());
-
+/**
+ * @brief Transcodes one BMP between open streams.
+ *
+ * Shared by the file path (recompress) and the in-memory path
+ * (recompress_buffer): the two differ only in where the FILE* streams
+ * come from. Throws std::runtime_error on any bmplib failure; a Bitmap
+ * Array (BA) input is passed through verbatim instead.
+ */
+static void transcode_bmp(FILE* f_in, FILE* f_out, const bool preserve_metadata) {
     // 1. READ
-    ScopedBmp in(input, "rb");
-    if (!in.f) {
-        Logger::log(LogLevel::Error, "Failed to open input BMP", processor_tag());
-        throw std::runtime_error("BmpProcessor: cannot open input");
-    }
-
-    in.h = bmpread_new(in.f);
+    ScopedBmpHandle in;
+    in.h = bmpread_new(f_in);
     if (!in.h) throw std::runtime_error("BmpProcessor: failed to create read handle");
 
     // Load info
@@ -82,8 +96,14 @@ void BmpProcessor::recompress(const std::filesystem::path& input,
         if (res == BMP_RESULT_ARRAY) {
              Logger::log(LogLevel::Warning, "Input is a Bitmap Array (BA), skipping recompression.", processor_tag());
              // We stop here without throwing to avoid flagging it as a critical error in the batch
-             std::error_code ec;
-             std::filesystem::copy_file(input, output, std::filesystem::copy_options::overwrite_existing, ec);
+             rewind(f_in);
+             std::vector<unsigned char> block(1 << 16);
+             size_t read;
+             while ((read = fread(block.data(), 1, block.size(), f_in)) > 0) {
+                 if (fwrite(block.data(), 1, read, f_out) != read) {
+                     throw std::runtime_error("BmpProcessor: failed to pass through Bitmap Array");
+                 }
+             }
              return;
         }
 
@@ -135,18 +155,13 @@ void BmpProcessor::recompress(const std::filesystem::path& input,
         ydpi = bmpread_resolution_ydpi(in.h);
     }
 
-    // Allocate image buffer
+    // Rent the image buffer from the thread's scratch arena; palette
+    // and ICC profile stay bmplib-allocated (bmplib owns their layout).
     const size_t buf_size = bmpread_buffersize(in.h);
-    img_buffer = static_cast<unsigned char*>(malloc(buf_size));
-    if (!img_buffer) {
-        if (palette) free(palette);
-        if (icc_profile) free(icc_profile);
-        throw std::runtime_error("BmpProcessor: malloc failed");
-    }
+    img_buffer = ScratchArena::local().rent(buf_size).data();
 
     // Cleanup helper
     auto free_resources = [&]() {
-        free(img_buffer);
         if (palette) free(palette);
         if (icc_profile) free(icc_profile);
     };
@@ -162,14 +177,8 @@ void BmpProcessor::recompress(const std::filesystem::path& input,
     }
 
     // 2. WRITE
-    ScopedBmp out(output, "wb");
-    if (!out.f) {
-        free_resources();
-        Logger::log(LogLevel::Error, "Failed to open output BMP", processor_tag());
-        throw std::runtime_error("BmpProcessor: cannot open output");
-    }
-
-    out.h = bmpwrite_new(out.f);
+    ScopedBmpHandle out;
+    out.h = bmpwrite_new(f_out);
     if (!out.h) {
         free_resources();
         throw std::runtime_error("BmpProcessor: failed to create write handle");
@@ -232,9 +241,79 @@ void BmpProcessor::recompress(const std::filesystem::path& input,
     }
 
     free_resources();
+}
+
+void BmpProcessor::recompress(const std::filesystem::path& input,
+                              const std::filesystem::path& output,
+                              bool preserve_metadata) {
+    Logger::log(LogLevel::Info, "Recompressing BMP: " + input.string(), processor_tag());
+
+    // per-file arena scope for the pixel buffer rented by the transcode
+    const ScratchArena::Scope scratch;
+
+    ScopedBmp in(input, "rb");
+    if (!in.f) {
+        Logger::log(LogLevel::Error, "Failed to open input BMP", processor_tag());
+        throw std::runtime_error("BmpProcessor: cannot open input");
+    }
+
+    ScopedBmp out(output, "wb");
+    if (!out.f) {
+        Logger::log(LogLevel::Error, "Failed to open output BMP", processor_tag());
+        throw std::runtime_error("BmpProcessor: cannot open output");
+    }
+
+    transcode_bmp(in.f, out.f, preserve_metadata);
+
     Logger::log(LogLevel::Info, "BMP recompression finished: " + output.string(), processor_tag());
 }
 
+bool BmpProcessor::recompress_buffer(const std::span<const std::byte> input,
+                                     std::vector<std::byte>& output,
+                                     const bool preserve_metadata) {
+#if defined(_WIN32)
+    // no fmemopen()/open_memstream(); the executor falls back to paths
+    (void)input;
+    (void)output;
+    (void)preserve_metadata;
+    return false;
+#else
+    if (input.empty()) return false;
+
+    const ScratchArena::Scope scratch;
+
+    // bmplib only speaks FILE*, so the in-memory path rides on memory streams
+    FILE* f_in = fmemopen(const_cast<std::byte*>(input.data()), input.size(), "rb");
+    if (f_in == nullptr) return false;
+
+    char* out_buf = nullptr;
+    size_t out_len = 0;
+    FILE* f_out = open_memstream(&out_buf, &out_len);
+    if (f_out == nullptr) {
+        fclose(f_in);
+        return false;
+    }
+
+    bool ok = true;
+    try {
+        transcode_bmp(f_in, f_out, preserve_metadata);
+    } catch (const std::exception& e) {
+        Logger::log(LogLevel::Warning, std::string("recompress_buffer: ") + e.what(), processor_tag());
+        ok = false;
+    }
+
+    fclose(f_in);
+    fclose(f_out); // flushes out_buf / out_len
+
+    if (ok) {
+        const auto* p = reinterpret_cast<const std::byte*>(out_buf);
+        output.assign(p, p + out_len);
+    }
+    free(out_buf);
+    return ok;
+#endif
+}
+
 std::string BmpProcessor::get_raw_checksum(const std::filesystem::path& /*file_path*/) const {
     return "";
 }
@@ -0,0 +1,269 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+#include "../../include/bzip2_processor.hpp"
+#include "../../include/core_budget.hpp"
+#include "../../include/file_utils.hpp"
+#include "../../include/logger.hpp"
+
+#include <bzlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /**
+     * Plain-data bytes per recompressed block. A level-9 block holds
+     * 900 000 bytes *after* bzip2's initial run-length pass, whose worst
+     * case expands 4 input bytes into 5; 700 000 * 5/4 = 875 000, so
+     * every chunk is guaranteed to land in exactly one block and the
+     * reassembly below never has to split a mini-stream.
+     */
+    constexpr std::size_t chunk_size = 700'000;
+
+    constexpr std::uint64_t block_magic = 0x314159265359;  ///< Start-of-block marker
+    constexpr std::uint64_t footer_magic = 0x177245385090; ///< End-of-stream marker
+
+    /// Reads @p count (<= 56) bits starting at absolute bit @p pos.
+    std::uint64_t read_bits(const unsigned char *buf, const std::size_t pos, const unsigned count) {
+        const std::size_t first = pos >> 3;
+        const auto lead = static_cast<unsigned>(pos & 7);
+        const std::size_t nbytes = (lead + count + 7) >> 3;
+        std::uint64_t window = 0;
+        for (std::size_t i = 0; i < nbytes; ++i) {
+            window = window << 8 | buf[first + i];
+        }
+        window >>= nbytes * 8 - lead - count;
+        return window & ((std::uint64_t{1} << count) - 1);
+    }
+
+    /**
+     * @brief Appends values at bit granularity; bzip2 blocks start and
+     * end at arbitrary bit offsets, so stitching them into one stream is
+     * inherently a bit-copy.
+     */
+    class BitWriter {
+    public:
+        void push_bits(const std::uint64_t value, unsigned count) {
+            while (count > 0) {
+                const unsigned take = std::min(count, 8u - fill_);
+                const auto bits = static_cast<unsigned char>(
+                    value >> (count - take) & ((1u << take) - 1));
+                if (fill_ == 0) bytes_.push_back(std::byte{0});
+                bytes_.back() |= static_cast<std::byte>(bits << (8 - fill_ - take));
+                fill_ = (fill_ + take) % 8;
+                count -= take;
+            }
+        }
+
+        /// Copies the bit range [first, end) out of @p src, a word at a time.
+        void append(const unsigned char *src, std::size_t first, const std::size_t end) {
+            while (first < end) {
+                const auto take = static_cast<unsigned>(std::min<std::size_t>(40, end - first));
+                push_bits(read_bits(src, first, take), take);
+                first += take;
+            }
+        }
+
+        /// @return The accumulated bytes; the final partial byte is zero-padded.
+        std::vector<std::byte> take() { return std::move(bytes_); }
+
+    private:
+        std::vector<std::byte> bytes_;
+        unsigned fill_ = 0; ///< Bits already used in the last byte
+    };
+
+    /**
+     * @brief Decompresses a whole .bz2 payload, following concatenated
+     * streams the way bunzip2 does.
+     *
+     * Fails (rather than truncating) on trailing bytes that are not
+     * another stream, so a re-encode never silently drops data.
+     */
+    bool decompress_all(const std::span<const std::byte> input, std::vector<std::byte> &out,
+                        const std::stop_token &stop) {
+        std::size_t in_pos = 0;
+        std::vector<char> buf(1 << 20);
+        while (true) {
+            if (in_pos + 4 > input.size() ||
+                std::memcmp(input.data() + in_pos, "BZh", 3) != 0) {
+                return false;
+            }
+            bz_stream strm{};
+            if (BZ2_bzDecompressInit(&strm, 0, 0) != BZ_OK) return false;
+            int rc = BZ_OK;
+            while (rc == BZ_OK) {
+                if (stop.stop_requested()) {
+                    BZ2_bzDecompressEnd(&strm);
+                    return false;
+                }
+                if (strm.avail_in == 0) {
+                    if (in_pos >= input.size()) break; // truncated stream
+                    const auto feed = static_cast<unsigned>(
+                        std::min<std::size_t>(input.size() - in_pos, 1u << 28));
+                    strm.next_in = const_cast<char *>(
+                        reinterpret_cast<const char *>(input.data() + in_pos));
+                    strm.avail_in = feed;
+                    in_pos += feed;
+                }
+                strm.next_out = buf.data();
+                strm.avail_out = static_cast<unsigned>(buf.size());
+                rc = BZ2_bzDecompress(&strm);
+                const auto *produced = reinterpret_cast<const std::byte *>(buf.data());
+                out.insert(out.end(), produced, produced + (buf.size() - strm.avail_out));
+            }
+            const std::size_t leftover = strm.avail_in;
+            BZ2_bzDecompressEnd(&strm);
+            if (rc != BZ_STREAM_END) return false;
+            in_pos -= leftover; // hand unconsumed bytes to the next stream
+            if (in_pos >= input.size()) return true;
+        }
+    }
+
+    /// Compresses one plain-data chunk into a standalone level-9 stream.
+    bool compress_chunk(const std::span<const std::byte> chunk, std::vector<unsigned char> &out) {
+        auto dest_len = static_cast<unsigned>(chunk.size() + chunk.size() / 100 + 600);
+        out.resize(dest_len);
+        const int rc = BZ2_bzBuffToBuffCompress(
+            reinterpret_cast<char *>(out.data()), &dest_len,
+            const_cast<char *>(reinterpret_cast<const char *>(chunk.data())),
+            static_cast<unsigned>(chunk.size()), /*blockSize100k=*/9, 0, /*workFactor=*/0);
+        if (rc != BZ_OK) return false;
+        out.resize(dest_len);
+        return true;
+    }
+
+    /**
+     * @brief Re-encodes a bzip2 payload block-parallel; the shared path
+     * behind both recompress() overloads and recompress_buffer().
+     */
+    bool reencode(const std::span<const std::byte> input, std::vector<std::byte> &output,
+                  const std::stop_token &stop) {
+        std::vector<std::byte> data;
+        if (!decompress_all(input, data, stop)) return false;
+
+        if (data.empty()) {
+            // canonical empty stream: header, footer magic, zero CRC
+            static constexpr unsigned char empty[] = {
+                0x42, 0x5A, 0x68, 0x39, 0x17, 0x72, 0x45, 0x38, 0x50, 0x90, 0, 0, 0, 0};
+            const auto *bytes = reinterpret_cast<const std::byte *>(empty);
+            output.assign(bytes, bytes + sizeof empty);
+            return true;
+        }
+
+        const std::size_t count = (data.size() + chunk_size - 1) / chunk_size;
+        std::vector<std::vector<unsigned char>> blocks(count);
+        std::atomic<std::size_t> next{0};
+        std::atomic<bool> failed{false};
+        auto compress_blocks = [&] {
+            for (std::size_t i = next.fetch_add(1, std::memory_order_relaxed);
+                 i < count;
+                 i = next.fetch_add(1, std::memory_order_relaxed)) {
+                if (stop.stop_requested()) return;
+                const std::size_t off = i * chunk_size;
+                const std::span chunk(data.data() + off,
+                                      std::min(chunk_size, data.size() - off));
+                if (!compress_chunk(chunk, blocks[i])) {
+                    failed.store(true, std::memory_order_relaxed);
+                }
+            }
+        };
+        const auto hw = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        const chisel::CoreBudget::Lease lease(std::min(hw, static_cast<int>(count)) - 1);
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(lease.taken());
+            for (int k = 0; k < lease.taken(); ++k) {
+                workers.emplace_back(compress_blocks);
+            }
+            compress_blocks(); // this thread compresses too
+        }
+        if (failed.load(std::memory_order_relaxed) || stop.stop_requested()) return false;
+
+        // Stitch the single-block mini-streams into one stream. Each one
+        // is header(32) | block magic(48) | block CRC(32) | payload |
+        // footer magic(48) | stream CRC(32) | padding(0-7); the footer is
+        // located exactly by trying the eight possible pad widths.
+        BitWriter writer;
+        writer.push_bits(0x425A6839, 32); // "BZh9"
+        std::uint32_t combined = 0;
+        for (const auto &mini : blocks) {
+            if (mini.size() < 14 || read_bits(mini.data(), 32, 48) != block_magic) return false;
+            const std::size_t total_bits = mini.size() * 8;
+            std::size_t footer_pos = 0;
+            for (unsigned pad = 0; pad < 8; ++pad) {
+                const std::size_t pos = total_bits - pad - 80;
+                if (read_bits(mini.data(), pos, 48) == footer_magic) {
+                    footer_pos = pos;
+                    break;
+                }
+            }
+            if (footer_pos == 0) return false;
+            const auto block_crc = static_cast<std::uint32_t>(read_bits(mini.data(), 80, 32));
+            combined = (combined << 1 | combined >> 31) ^ block_crc;
+            writer.append(mini.data(), 32, footer_pos);
+        }
+        writer.push_bits(footer_magic, 48);
+        writer.push_bits(combined, 32);
+        output = writer.take();
+        return true;
+    }
+
+} // namespace
+
+namespace chisel {
+
+void Bzip2Processor::recompress(const std::filesystem::path &input,
+                                const std::filesystem::path &output,
+                                const bool preserve_metadata) {
+    recompress(input, output, preserve_metadata, std::stop_token{});
+}
+
+void Bzip2Processor::recompress(const std::filesystem::path &input,
+                                const std::filesystem::path &output,
+                                [[maybe_unused]] const bool preserve_metadata,
+                                const std::stop_token &stop) {
+    std::vector<std::byte> in_data;
+    if (!read_file(input, in_data)) {
+        Logger::log(LogLevel::Error, "Failed to read bzip2 file: " + input.string(), "bzip2_processor");
+        throw std::runtime_error("Bzip2Processor: cannot read input");
+    }
+    std::vector<std::byte> out_data;
+    if (!reencode(in_data, out_data, stop)) {
+        if (stop.stop_requested()) {
+            throw std::runtime_error("Bzip2Processor: recompression interrupted");
+        }
+        Logger::log(LogLevel::Warning, "Not a recompressible bzip2 stream: " + input.string(), "bzip2_processor");
+        throw std::runtime_error("Bzip2Processor: malformed bzip2 stream");
+    }
+    if (!write_file(output, out_data)) {
+        Logger::log(LogLevel::Error, "Failed to write bzip2 file: " + output.string(), "bzip2_processor");
+        throw std::runtime_error("Bzip2Processor: cannot write output");
+    }
+    Logger::log(LogLevel::Info, "Re-encoding complete: " + output.string(), "bzip2_processor");
+}
+
+bool Bzip2Processor::recompress_buffer(const std::span<const std::byte> input,
+                                       std::vector<std::byte> &output,
+                                       [[maybe_unused]] const bool preserve_metadata) {
+    return reencode(input, output, std::stop_token{});
+}
+
+std::string Bzip2Processor::get_raw_checksum(const std::filesystem::path &file_path) const {
+    std::vector<std::byte> in_data;
+    if (!read_file(file_path, in_data)) return "";
+    std::vector<std::byte> data;
+    if (!decompress_all(in_data, data, std::stop_token{})) return "";
+    StreamingChecksum crc;
+    crc.update(data);
+    return crc.hex();
+}
+
+} // namespace chisel
@@ -3,12 +3,16 @@
 //
 
 #include "../../include/flac_processor.hpp"
+#include "../../include/core_budget.hpp"
 #include "../../include/logger.hpp"
+#include "../../include/pcm_utils.hpp"
 #include <FLAC/all.h>
+#include <algorithm>
 #include <stdexcept>
 #include <cstdlib>
 #include <iostream>
 #include <sstream>
+#include <thread>
 #include <taglib/tag.h>
 #include "audio_metadata_util.hpp"
 #include "file_type.hpp"
@@ -24,6 +28,7 @@ struct TranscodeContext {
     bool preserve_metadata = true;
     FLAC__StreamMetadata** metadata_blocks = nullptr;
     unsigned num_blocks = 0;
+    unsigned encoder_threads = 1;
     bool failed = false;
 };
 
@@ -57,6 +62,16 @@ static FLAC__StreamDecoderWriteStatus write_callback(
         FLAC__stream_encoder_set_max_residual_partition_order(ctx->encoder, 6);
         FLAC__stream_encoder_set_do_exhaustive_model_search(ctx->encoder, true);
         FLAC__stream_encoder_set_streamable_subset(ctx->encoder, false);
+        // frames are independent given fixed parameters, so libFLAC can
+        // spread the exhaustive model search across worker threads while
+        // producing the same stream (MD5 included) as a serial encode
+        if (ctx->encoder_threads > 1 &&
+            FLAC__stream_encoder_set_num_threads(ctx->encoder, ctx->encoder_threads) !=
+                FLAC__STREAM_ENCODER_SET_NUM_THREADS_OK) {
+            Logger::log(LogLevel::Debug,
+                        "FLAC encoder multithreading unavailable; encoding single-threaded",
+                        "flac_processor");
+        }
 
         if (ctx->preserve_metadata && ctx->metadata_blocks && ctx->num_blocks > 0) {
             FLAC__stream_encoder_set_metadata(ctx->encoder, ctx->metadata_blocks, ctx->num_blocks);
@@ -103,6 +118,14 @@ static void error_callback(const FLAC__StreamDecoder*, FLAC__StreamDecoderErrorS
 void FlacProcessor::recompress(const std::filesystem::path& input,
                                const std::filesystem::path& output,
                                const bool preserve_metadata)
+{
+    recompress(input, output, preserve_metadata, std::stop_token{});
+}
+
+void FlacProcessor::recompress(const std::filesystem::path& input,
+                               const std::filesystem::path& output,
+                               const bool preserve_metadata,
+                               const std::stop_token& stop)
 {
     Logger::log(LogLevel::Info, "Starting FLAC re-encoding: " + input.string(), "flac_processor");
 
@@ -114,6 +137,13 @@ void FlacProcessor::recompress(const std::filesystem::path& input,
     ctx.output = output;
     ctx.preserve_metadata = preserve_metadata;
 
+    // Lease the free cores for the whole transcode: a big lone FLAC at
+    // the tail of a run gets the idle machine, while many files in
+    // flight degrade gracefully toward one thread each.
+    const CoreBudget::Lease flac_cores(
+        static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) - 1);
+    ctx.encoder_threads = static_cast<unsigned>(flac_cores.taken()) + 1;
+
     // metadata copy (optional)
     FLAC__Metadata_Chain* chain = nullptr;
     FLAC__Metadata_Iterator* it = nullptr;
@@ -192,8 +222,21 @@ void FlacProcessor::recompress(const std::filesystem::path& input,
         throw std::runtime_error("decoder init failed");
     }
 
-    // transcode
-    const bool ok = FLAC__stream_decoder_process_until_end_of_stream(decoder);
+    // transcode frame by frame instead of one monolithic
+    // process_until_end_of_stream() call, so a stop request is honoured
+    // at the next frame boundary instead of after the whole file
+    bool ok = true;
+    bool interrupted = false;
+    while (FLAC__stream_decoder_get_state(decoder) != FLAC__STREAM_DECODER_END_OF_STREAM) {
+        if (stop.stop_requested()) {
+            interrupted = true;
+            break;
+        }
+        if (!FLAC__stream_decoder_process_single(decoder)) {
+            ok = false;
+            break;
+        }
+    }
     const bool failed = (!ok) || ctx.failed;
 
     FLAC__stream_decoder_finish(decoder);
@@ -211,6 +254,10 @@ void FlacProcessor::recompress(const std::filesystem::path& input,
     if (it) FLAC__metadata_iterator_delete(it);
     if (chain) FLAC__metadata_chain_delete(chain);
 
+    if (interrupted) {
+        throw std::runtime_error("FLAC recompression interrupted");
+    }
+
     if (failed) {
         Logger::log(LogLevel::Error, "decoding or encoding failed", "flac_processor");
         throw std::runtime_error("FLAC transcoding failed");
@@ -361,11 +408,9 @@ std::vector<int32_t> decode_flac_pcm(const std::filesystem::path& file,
                        void* client_data) -> FLAC__StreamDecoderWriteStatus {
         auto* c = static_cast<Context*>(client_data);
         const size_t n = frame->header.blocksize;
-        for (size_t i = 0; i < n; ++i) {
-            for (unsigned ch = 0; ch < frame->header.channels; ++ch) {
-                c->pcm->push_back(buffer[ch][i]);
-            }
-        }
+        const size_t old_size = c->pcm->size();
+        c->pcm->resize(old_size + n * frame->header.channels);
+        pcm_interleave(buffer, frame->header.channels, n, c->pcm->data() + old_size);
         return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
     };
 
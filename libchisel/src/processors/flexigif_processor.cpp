@@ -6,16 +6,53 @@
 #include "../../include/logger.hpp"
 #include "GifImage.h"
 #include "LzwEncoder.h"
+#include <chrono>
 #include <stdexcept>
+#include <system_error>
 #include <vector>
 #include "file_utils.hpp"
 #include "stb_image.h"
 #include <cstring>
 namespace chisel {
 
+namespace {
+
+/// Size above which the default effort level skips the LZW search.
+constexpr uintmax_t flexigif_size_cap = 4ull << 20;
+
+/// Wall-clock budget for the optimizePartial pre-pass, per file.
+constexpr auto flexigif_budget_default = std::chrono::seconds(15);
+constexpr auto flexigif_budget_deep = std::chrono::seconds(300);
+
+} // namespace
+
 void FlexiGifProcessor::recompress(const std::filesystem::path& input,
                                    const std::filesystem::path& output,
                                    bool /*preserve_metadata*/) {
+    // Cost gate: this search is orders of magnitude slower than the
+    // gifsicle pass that usually precedes it, for single-digit extra
+    // savings. A gated-out file is copied through unchanged so the
+    // pipeline keeps the previous stage's result.
+    std::error_code size_ec;
+    const auto input_size = std::filesystem::file_size(input, size_ec);
+    const bool too_big = effort_ <= 2 && !size_ec && input_size >= flexigif_size_cap;
+    if (effort_ <= 1 || too_big) {
+        Logger::log(LogLevel::Debug,
+                    [&] {
+                        return std::string("flexiGIF gated out (") +
+                               (effort_ <= 1 ? "fast effort" : "size cap") +
+                               "); passing through: " + input.string();
+                    },
+                    "flexigif_processor");
+        std::error_code copy_ec;
+        std::filesystem::copy_file(input, output,
+                                   std::filesystem::copy_options::overwrite_existing, copy_ec);
+        if (copy_ec) {
+            throw std::runtime_error("flexiGIF pass-through copy failed: " + copy_ec.message());
+        }
+        return;
+    }
+
     Logger::log(LogLevel::Info,
                 "Start flexiGIF recompression: " + input.string(),
                 "flexigif_processor");
@@ -34,6 +71,13 @@ void FlexiGifProcessor::recompress(const std::filesystem::path& input,
         std::vector<std::vector<bool>> optimizedBits;
         optimizedBits.reserve(numFrames);
 
+        // One budget for the whole file: the pre-pass is an anytime
+        // refinement, so running out mid-animation just means later
+        // frames get the plain (still valid) final pass.
+        const auto deadline = std::chrono::steady_clock::now() +
+                              (effort_ >= 3 ? flexigif_budget_deep : flexigif_budget_default);
+        bool budget_exhausted = false;
+
         for (unsigned int frameIndex = 0; frameIndex < numFrames; frameIndex++) {
             const auto& frame = gif.getFrame(frameIndex);
             const auto& indices = frame.pixels;
@@ -66,6 +110,16 @@ void FlexiGifProcessor::recompress(const std::filesystem::path& input,
             const int lastPos = static_cast<int>(indices.size()) - 1;
             for (int i = lastPos; i >= 0; i--) {
                 if ((i % static_cast<int>(settings.alignment)) != 0) continue;
+                if (std::chrono::steady_clock::now() > deadline) {
+                    if (!budget_exhausted) {
+                        budget_exhausted = true;
+                        Logger::log(LogLevel::Debug,
+                                    "flexiGIF pre-pass budget exhausted at frame " +
+                                        std::to_string(frameIndex + 1) + "/" + std::to_string(numFrames),
+                                    "flexigif_processor");
+                    }
+                    break;
+                }
                 encoder.optimizePartial(static_cast<unsigned int>(i),
                                         0,
                                         false,
@@ -99,27 +153,13 @@ void FlexiGifProcessor::recompress(const std::filesystem::path& input,
     }
 }
 
-static std::vector<unsigned char> read_file_to_buffer(const std::filesystem::path& path) {
-    FILE* f = chisel::open_file(path, "rb");
-    if (!f) return {};
-    fseek(f, 0, SEEK_END);
-    long size = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    if (size <= 0) {
-        fclose(f);
-        return {};
-    }
-    std::vector<unsigned char> buf(size);
-    fread(buf.data(), 1, size, f);
-    fclose(f);
-    return buf;
-}
-
 bool FlexiGifProcessor::raw_equal(const std::filesystem::path& a, const std::filesystem::path& b) const {
-    auto bufA = read_file_to_buffer(a);
-    auto bufB = read_file_to_buffer(b);
+    // map instead of slurping: no userspace copy, and both decodes read
+    // straight from the page cache
+    const MappedFile bufA(a);
+    const MappedFile bufB(b);
 
-    if (bufA.empty() || bufB.empty()) {
+    if (!bufA.is_open() || bufA.size() == 0 || !bufB.is_open() || bufB.size() == 0) {
         Logger::log(LogLevel::Warning, "raw_equal: empty or unreadable file(s)", "flexigif_processor");
         return false;
     }
@@ -128,7 +168,7 @@ bool FlexiGifProcessor::raw_equal(const std::filesystem::path& a, const std::fil
     int* delaysA = nullptr;
 
     unsigned char* dataA = stbi_load_gif_from_memory(
-        bufA.data(), static_cast<int>(bufA.size()),
+        reinterpret_cast<const unsigned char*>(bufA.data()), static_cast<int>(bufA.size()),
         &delaysA, &wA, &hA, &framesA, nullptr, 4
     );
 
@@ -140,7 +180,7 @@ bool FlexiGifProcessor::raw_equal(const std::filesystem::path& a, const std::fil
     int wB, hB, framesB;
     int* delaysB = nullptr;
     unsigned char* dataB = stbi_load_gif_from_memory(
-        bufB.data(), static_cast<int>(bufB.size()),
+        reinterpret_cast<const unsigned char*>(bufB.data()), static_cast<int>(bufB.size()),
         &delaysB, &wB, &hB, &framesB, nullptr, 4
     );
 
@@ -173,8 +213,34 @@ bool FlexiGifProcessor::raw_equal(const std::filesystem::path& a, const std::fil
 }
 
 std::string FlexiGifProcessor::get_raw_checksum(const std::filesystem::path& file_path) const {
-    // TODO: implement checksum of raw GIF data
-    return "";
+    const MappedFile buf(file_path);
+    if (!buf.is_open() || buf.size() == 0) {
+        return "";
+    }
+
+    int w, h, frames;
+    int* delays = nullptr;
+    unsigned char* data = stbi_load_gif_from_memory(
+        reinterpret_cast<const unsigned char*>(buf.data()), static_cast<int>(buf.size()),
+        &delays, &w, &h, &frames, nullptr, 4
+    );
+    if (!data) {
+        Logger::log(LogLevel::Warning, "get_raw_checksum: failed to decode GIF", "flexigif_processor");
+        return "";
+    }
+
+    // fold geometry, frame delays and decoded pixels into the hash while
+    // the decoded buffers are hot, so the digest identifies the animation
+    // regardless of how its LZW streams were encoded
+    StreamingChecksum sum;
+    const int dims[3] = {w, h, frames};
+    sum.update(dims, sizeof(dims));
+    if (delays) sum.update(delays, static_cast<size_t>(frames) * sizeof(int));
+    sum.update(data, static_cast<size_t>(w) * h * 4 * frames);
+
+    stbi_image_free(data);
+    if (delays) stbi_image_free(delays);
+    return sum.hex();
 }
 
 } // namespace chisel
\ No newline at end of file
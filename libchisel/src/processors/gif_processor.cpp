@@ -3,9 +3,12 @@
 //
 
 #include "../../include/gif_processor.hpp"
+#include "../../include/core_budget.hpp"
 #include "../../include/logger.hpp"
 #include "file_utils.hpp"
 #include "stb_image.h"
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <cstdio>
 #include <stdexcept>
@@ -21,29 +24,16 @@ extern "C" {
 
 namespace chisel {
 
-static std::vector<unsigned char> read_file_to_buffer(const std::filesystem::path& path) {
-    FILE* f = chisel::open_file(path, "rb");
-    if (!f) return {};
-    fseek(f, 0, SEEK_END);
-    long size = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    if (size <= 0) {
-        fclose(f);
-        return {};
-    }
-    std::vector<unsigned char> buf(size);
-    size_t read_count = fread(buf.data(), 1, size, f);
-    fclose(f);
-
-    if (read_count != static_cast<size_t>(size)) {
-        return {};
-    }
-    return buf;
+void GifProcessor::recompress(const std::filesystem::path& input,
+                              const std::filesystem::path& output,
+                              const bool preserve_metadata) {
+    recompress(input, output, preserve_metadata, std::stop_token{});
 }
 
 void GifProcessor::recompress(const std::filesystem::path& input,
                               const std::filesystem::path& output,
-                              const bool preserve_metadata) {
+                              const bool preserve_metadata,
+                              const std::stop_token& stop) {
 
     std::exception_ptr error_ptr = nullptr;
 
@@ -82,6 +72,39 @@ void GifProcessor::recompress(const std::filesystem::path& input,
             std::memset(&local_info, 0, sizeof(local_info));
             Gif_InitCompressInfo(&local_info);
 
+            // Gif_FullWriteFile LZW-compresses one frame after another,
+            // which is where nearly all the time goes on long animations.
+            // Each frame's compression is independent, so pre-compress
+            // them here across workers from the shared core budget; the
+            // write below then just streams the ready-made blocks.
+            if (gfs->nimages > 1) {
+                std::atomic<int> next{0};
+                const auto compress_frames = [&]() {
+                    for (int i = next.fetch_add(1, std::memory_order_relaxed);
+                         i < gfs->nimages;
+                         i = next.fetch_add(1, std::memory_order_relaxed)) {
+                        if (stop.stop_requested()) return;
+                        Gif_FullCompressImage(gfs, gfs->images[i], &local_info);
+                    }
+                };
+                const auto hw = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+                const CoreBudget::Lease lease(std::min(hw, gfs->nimages) - 1);
+                {
+                    std::vector<std::jthread> workers;
+                    workers.reserve(lease.taken());
+                    for (int k = 0; k < lease.taken(); ++k) {
+                        workers.emplace_back(compress_frames);
+                    }
+                    compress_frames(); // this thread compresses too
+                }
+            }
+
+            if (stop.stop_requested()) {
+                std::fclose(out);
+                Gif_DeleteStream(gfs);
+                throw std::runtime_error("GIF recompression interrupted");
+            }
+
             if (!Gif_FullWriteFile(gfs, &local_info, out)) {
                 std::fclose(out);
                 Gif_DeleteStream(gfs);
@@ -104,17 +127,25 @@ void GifProcessor::recompress(const std::filesystem::path& input,
 }
 
 bool GifProcessor::raw_equal(const std::filesystem::path& a, const std::filesystem::path& b) const {
-    const auto bufA = read_file_to_buffer(a);
-    const auto bufB = read_file_to_buffer(b);
+    // map instead of slurping: no userspace copy, and both decodes read
+    // straight from the page cache
+    const MappedFile bufA(a);
+    const MappedFile bufB(b);
 
-    if (bufA.empty() || bufB.empty()) {
+    if (!bufA.is_open() || bufA.size() == 0 || !bufB.is_open() || bufB.size() == 0) {
         return false;
     }
 
+    // byte-identical files decode identically; skip both decodes
+    if (bufA.size() == bufB.size() &&
+        std::memcmp(bufA.data(), bufB.data(), bufA.size()) == 0) {
+        return true;
+    }
+
     int wA, hA, framesA;
     int* delaysA = nullptr;
     unsigned char* dataA = stbi_load_gif_from_memory(
-        bufA.data(), static_cast<int>(bufA.size()),
+        reinterpret_cast<const unsigned char*>(bufA.data()), static_cast<int>(bufA.size()),
         &delaysA, &wA, &hA, &framesA, nullptr, 4
     );
 
@@ -126,7 +157,7 @@ bool GifProcessor::raw_equal(const std::filesystem::path& a, const std::filesyst
     int wB, hB, framesB;
     int* delaysB = nullptr;
     unsigned char* dataB = stbi_load_gif_from_memory(
-        bufB.data(), static_cast<int>(bufB.size()),
+        reinterpret_cast<const unsigned char*>(bufB.data()), static_cast<int>(bufB.size()),
         &delaysB, &wB, &hB, &framesB, nullptr, 4
     );
 
@@ -156,9 +187,35 @@ bool GifProcessor::raw_equal(const std::filesystem::path& a, const std::filesyst
     return equal;
 }
 
-std::string GifProcessor::get_raw_checksum(const std::filesystem::path&) const {
-    // TODO: implement checksum of raw GIF data
-    return "";
+std::string GifProcessor::get_raw_checksum(const std::filesystem::path& file_path) const {
+    const MappedFile buf(file_path);
+    if (!buf.is_open() || buf.size() == 0) {
+        return "";
+    }
+
+    int w, h, frames;
+    int* delays = nullptr;
+    unsigned char* data = stbi_load_gif_from_memory(
+        reinterpret_cast<const unsigned char*>(buf.data()), static_cast<int>(buf.size()),
+        &delays, &w, &h, &frames, nullptr, 4
+    );
+    if (!data) {
+        Logger::log(LogLevel::Warning, "get_raw_checksum: failed to decode GIF", "gif_processor");
+        return "";
+    }
+
+    // fold geometry, frame delays and decoded pixels into the hash as the
+    // decoder hands them over, so two encodings of the same animation
+    // produce the same digest
+    StreamingChecksum sum;
+    const int dims[3] = {w, h, frames};
+    sum.update(dims, sizeof(dims));
+    if (delays) sum.update(delays, static_cast<size_t>(frames) * sizeof(int));
+    sum.update(data, static_cast<size_t>(w) * h * 4 * frames);
+
+    stbi_image_free(data);
+    if (delays) stbi_image_free(delays);
+    return sum.hex();
 }
 
 } // namespace chisel
\ No newline at end of file
@@ -6,7 +6,9 @@
 #include "../../include/logger.hpp"
 #include <jpeglib.h>
 #include <cstdio>
+#include <cstdlib>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 #include <algorithm>
 #include <memory>
@@ -93,25 +95,26 @@ void copy_saved_markers(const j_decompress_ptr srcinfo,
     }
 }
 
-} // namespace
-
-namespace chisel {
-
-void JpegProcessor::recompress(const std::filesystem::path& input,
-                               const std::filesystem::path& output,
-                               bool preserve_metadata) {
-    Logger::log(LogLevel::Info, "Start JPEG recompression: " + input.string(), "jpeg_processor");
-
+/**
+ * @brief Losslessly transcodes a JPEG with one scan layout, into memory.
+ *
+ * Each racing variant re-reads the source itself: libjpeg's virtual
+ * coefficient arrays belong to one decompressor and cannot be shared
+ * across threads.
+ *
+ * @param input The source JPEG file.
+ * @param preserve_metadata Whether to carry APPn/COM markers over.
+ * @param progressive Emit a progressive scan script instead of a
+ * sequential stream; both variants get optimized Huffman tables.
+ * @return The encoded bytes, or an empty vector if this variant failed.
+ */
+std::vector<unsigned char> encode_jpeg_variant(const std::filesystem::path &input,
+                                               const bool preserve_metadata,
+                                               const bool progressive) {
     unique_FILE infile(chisel::open_file(input.string().c_str(), "rb"));
     if (!infile) {
         Logger::log(LogLevel::Error, "Cannot open JPEG input: " + input.string(), "jpeg_processor");
-        throw std::runtime_error("Cannot open JPEG input");
-    }
-    unique_FILE outfile(chisel::open_file(output.string().c_str(), "wb"));
-    if (!outfile) {
-        // infile is closed automatically by raii
-        Logger::log(LogLevel::Error, "Cannot open JPEG output: " + output.string(), "jpeg_processor");
-        throw std::runtime_error("Cannot open JPEG output");
+        return {};
     }
 
     jpeg_decompress_struct srcinfo{};
@@ -125,6 +128,10 @@ void JpegProcessor::recompress(const std::filesystem::path& input,
     dstinfo.err = jpeg_std_error(&jdsterr.pub);
     jdsterr.pub.error_exit = jpeg_error_exit_throw;
 
+    unsigned char *mem = nullptr;
+    unsigned long mem_size = 0;
+    std::vector<unsigned char> out;
+
     try {
         jpeg_create_decompress(&srcinfo);
         jpeg_create_compress(&dstinfo);
@@ -136,65 +143,100 @@ void JpegProcessor::recompress(const std::filesystem::path& input,
             throw std::runtime_error("Invalid JPEG header");
         }
 
-        Logger::log(LogLevel::Debug,
-                    std::string("JPEG ") + (srcinfo.progressive_mode ? "progressive" : "baseline"),
-                    "jpeg_processor");
-
         jvirt_barray_ptr *coef_arrays = jpeg_read_coefficients(&srcinfo);
         jpeg_copy_critical_parameters(&srcinfo, &dstinfo);
 
-        if (srcinfo.progressive_mode) {
+        if (progressive) {
             jpeg_simple_progression(&dstinfo);
         }
 
         dstinfo.optimize_coding = TRUE;
-        jpeg_stdio_dest(&dstinfo, outfile.get());
+        jpeg_mem_dest(&dstinfo, &mem, &mem_size);
         jpeg_write_coefficients(&dstinfo, coef_arrays);
 
         copy_saved_markers(&srcinfo, &dstinfo, preserve_metadata);
 
         jpeg_finish_compress(&dstinfo);
         jpeg_finish_decompress(&srcinfo);
-        // destroy structs on success path
+        out.assign(mem, mem + mem_size);
+
+    } catch (const std::exception &e) {
+        Logger::log(LogLevel::Warning,
+                    std::string("JPEG ") + (progressive ? "progressive" : "sequential") +
+                        " variant failed: " + e.what(),
+                    "jpeg_processor");
+        out.clear();
+    }
+
+    // cleanup must not bypass freeing the in-memory destination
+    try {
         jpeg_destroy_compress(&dstinfo);
+    } catch (...) {
+        Logger::log(LogLevel::Warning,
+                    "jpeg_destroy_compress threw an exception during cleanup",
+                    "jpeg_processor");
+    }
+    try {
         jpeg_destroy_decompress(&srcinfo);
+    } catch (...) {
+        Logger::log(LogLevel::Warning,
+                    "jpeg_destroy_decompress threw an exception during cleanup",
+                    "jpeg_processor");
+    }
+    if (mem != nullptr) free(mem);
 
-        infile.reset();
+    return out;
+}
 
-        // explicitly flush stdio buffer to disk before returning
-        if (fflush(outfile.get()) != 0) {
-            Logger::log(LogLevel::Warning, "fflush failed for " + output.string(), "jpeg_processor");
-        }
-        outfile.reset();
+} // namespace
 
-        Logger::log(LogLevel::Info, "JPEG recompression completed: " + output.string(), "jpeg_processor");
+namespace chisel {
 
-    } catch (const std::exception& e) {
-        infile.reset();
-        outfile.reset();
-        Logger::log(LogLevel::Error,
-                    "JPEG recompression failed: " + std::string(e.what()),
-                    "jpeg_processor");
+void JpegProcessor::recompress(const std::filesystem::path& input,
+                               const std::filesystem::path& output,
+                               bool preserve_metadata) {
+    Logger::log(LogLevel::Info, "Start JPEG recompression: " + input.string(), "jpeg_processor");
 
-        // safely cleanup libjpeg structures
-        try {
-            jpeg_destroy_compress(&dstinfo);
-        } catch (...) {
-            Logger::log(LogLevel::Warning,
-                        "jpeg_destroy_compress threw an exception during cleanup",
-                        "jpeg_processor");
-        }
+    // Sequential and progressive scan layouts win on different content;
+    // race both (each with optimized Huffman tables) on two threads —
+    // the same wall time as one encode — and keep the smaller. Either
+    // result is a lossless transcode of the same coefficients.
+    std::vector<unsigned char> progressive_out;
+    std::thread worker([&]() {
+        progressive_out = encode_jpeg_variant(input, preserve_metadata, true);
+    });
+    auto sequential_out = encode_jpeg_variant(input, preserve_metadata, false);
+    worker.join();
+
+    const bool sequential_wins = !sequential_out.empty() &&
+                                 (progressive_out.empty() ||
+                                  sequential_out.size() <= progressive_out.size());
+    const auto &best = sequential_wins ? sequential_out : progressive_out;
+    if (best.empty()) {
+        Logger::log(LogLevel::Error, "JPEG recompression failed: " + input.string(), "jpeg_processor");
+        throw std::runtime_error("JPEG recompression failed");
+    }
+    Logger::log(LogLevel::Debug,
+                [&] {
+                    return std::string("JPEG ") + (sequential_wins ? "sequential" : "progressive") +
+                           " scan layout wins (" + std::to_string(sequential_out.size()) + " vs " +
+                           std::to_string(progressive_out.size()) + " bytes)";
+                },
+                "jpeg_processor");
 
-        try {
-            jpeg_destroy_decompress(&srcinfo);
-        } catch (...) {
-            Logger::log(LogLevel::Warning,
-                        "jpeg_destroy_decompress threw an exception during cleanup",
-                        "jpeg_processor");
-        }
+    unique_FILE outfile(chisel::open_file(output.string().c_str(), "wb"));
+    if (!outfile) {
+        Logger::log(LogLevel::Error, "Cannot open JPEG output: " + output.string(), "jpeg_processor");
+        throw std::runtime_error("Cannot open JPEG output");
+    }
+    if (fwrite(best.data(), 1, best.size(), outfile.get()) != best.size() ||
+        fflush(outfile.get()) != 0) {
+        Logger::log(LogLevel::Error, "Cannot write JPEG output: " + output.string(), "jpeg_processor");
+        throw std::runtime_error("Cannot write JPEG output");
     }
+    outfile.reset();
 
-    // files are closed automatically by unique_FILE destructor
+    Logger::log(LogLevel::Info, "JPEG recompression completed: " + output.string(), "jpeg_processor");
 }
 
 /**
@@ -3,10 +3,15 @@
 //
 
 #include "../../include/jxl_processor.hpp"
+#include "../../include/core_budget.hpp"
 #include "../../include/logger.hpp"
 #include <jxl/encode.h>
 #include <jxl/decode.h>
+#include <jxl/thread_parallel_runner.h>
+#include <algorithm>
 #include <fstream>
+#include <memory>
+#include <thread>
 #include <vector>
 #include <iterator>
 #include <string>
@@ -35,6 +40,12 @@ size_t get_bytes_per_channel(const JxlDataType data_type) {
     return 1; // JXL_TYPE_UINT8
 }
 
+/// RAII holder for libjxl's thread pool runner.
+struct RunnerDestroyer {
+    void operator()(void* r) const { if (r) JxlThreadParallelRunnerDestroy(r); }
+};
+using unique_runner = std::unique_ptr<void, RunnerDestroyer>;
+
 } // namespace
 
 namespace chisel {
@@ -51,10 +62,27 @@ void JxlProcessor::recompress(const std::filesystem::path& input,
         throw std::runtime_error("JxlProcessor: cannot read input");
     }
 
+    // libjxl parallelizes internally through its runner; lease the free
+    // cores from the shared budget for the whole transcode, so a lone
+    // big file at the end of a run gets the idle machine while files
+    // competing with other intra-file workers are clamped down. The
+    // lease keeps this thread, so a zero grant just runs single-threaded.
+    const CoreBudget::Lease jxl_cores(
+        static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) - 1);
+    const auto runner_threads = static_cast<size_t>(jxl_cores.taken()) + 1;
+    const unique_runner runner(JxlThreadParallelRunnerCreate(nullptr, runner_threads));
+    if (!runner) {
+        Logger::log(LogLevel::Warning, "Failed to create JXL parallel runner", "jxl_processor");
+    }
+
     // decoder setup
     JxlDecoder* dec = JxlDecoderCreate(nullptr);
     if (!dec) throw std::runtime_error("JxlProcessor: cannot create decoder");
 
+    if (runner && JXL_DEC_SUCCESS != JxlDecoderSetParallelRunner(dec, JxlThreadParallelRunner, runner.get())) {
+        Logger::log(LogLevel::Warning, "Failed to attach parallel runner to JXL decoder", "jxl_processor");
+    }
+
     JxlDecoderSubscribeEvents(dec,
         JXL_DEC_BASIC_INFO | JXL_DEC_FRAME | JXL_DEC_FULL_IMAGE | JXL_DEC_BOX);
     JxlDecoderSetInput(dec, input_buf.data(), input_buf.size());
@@ -153,6 +181,10 @@ void JxlProcessor::recompress(const std::filesystem::path& input,
     JxlEncoder* enc = JxlEncoderCreate(nullptr);
     if (!enc) throw std::runtime_error("JxlProcessor: cannot create encoder");
 
+    if (runner && JXL_ENC_SUCCESS != JxlEncoderSetParallelRunner(enc, JxlThreadParallelRunner, runner.get())) {
+        Logger::log(LogLevel::Warning, "Failed to attach parallel runner to JXL encoder", "jxl_processor");
+    }
+
     if (JXL_ENC_SUCCESS != JxlEncoderSetBasicInfo(enc, &info)) {
         JxlEncoderDestroy(enc);
         throw std::runtime_error("JxlProcessor: failed to set basic info");
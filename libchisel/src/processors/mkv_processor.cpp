@@ -7,7 +7,6 @@
 #include <vector>
 #include <string>
 #include <stdexcept>
-#include <system_error>
 #include <filesystem>
 
 // forward declaration of mkclean API
@@ -20,17 +19,6 @@ void MkvProcessor::recompress(const std::filesystem::path& input,
                               bool preserve_metadata) {
     Logger::log(LogLevel::Info, "Starting Matroska optimization: " + input.string(), "mkv_processor");
 
-    namespace fs = std::filesystem;
-    std::error_code ec;
-
-    const fs::path temp_input = fs::temp_directory_path() / (input.filename().string() + ".tmp.mkv");
-    fs::copy_file(input, temp_input, fs::copy_options::overwrite_existing, ec);
-
-    if (ec) {
-        Logger::log(LogLevel::Error, "Failed to create temporary copy: " + ec.message(), "mkv_processor");
-        throw std::runtime_error("MkvProcessor: temp copy failed");
-    }
-
     std::vector<std::string> args;
     args.emplace_back("mkclean");
 
@@ -42,7 +30,10 @@ void MkvProcessor::recompress(const std::filesystem::path& input,
         args.emplace_back("--unsafe");
     }
     args.emplace_back("--quiet");
-    args.push_back(temp_input.string());
+    // mkclean only reads its input, so it gets the original directly:
+    // the former defensive temp copy doubled the read I/O of multi-GB
+    // containers (and tripled writes) for no protection.
+    args.push_back(input.string());
     args.push_back(output.string());
 
     std::vector<char*> argv;
@@ -56,16 +47,12 @@ void MkvProcessor::recompress(const std::filesystem::path& input,
         return_code = mkclean_optimize(static_cast<int>(argv.size()), argv.data());
     } catch (const std::exception& e) {
         Logger::log(LogLevel::Error, "mkclean_optimize exception: " + std::string(e.what()), "mkv_processor");
-        fs::remove(temp_input, ec);
         throw;
     } catch (...) {
         Logger::log(LogLevel::Error, "mkclean_optimize unknown exception", "mkv_processor");
-        fs::remove(temp_input, ec);
         throw;
     }
 
-    fs::remove(temp_input, ec);
-
     if (return_code != 0) {
         Logger::log(LogLevel::Error, "mkclean failed with exit code " + std::to_string(return_code), "mkv_processor");
         throw std::runtime_error("MkvProcessor: mkclean failed");
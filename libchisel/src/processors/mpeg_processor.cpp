@@ -9,6 +9,14 @@
 #include "../../include/random_utils.hpp"
 #include <stdexcept>
 #include <filesystem>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
 #include "file_type.hpp"
 
 namespace chisel {
@@ -18,17 +26,266 @@ static const char* processor_tag() {
     return "MpegProcessor";
 }
 
+namespace {
+
+    /**
+     * @brief Byte layout of an MP3 file: tag regions around the frames.
+     *
+     * The MPEG frame data between audio_begin and audio_end is never
+     * rewritten; only the surrounding regions are. padding is only
+     * trustworthy when frames_walked is set (the ID3v2 frame walk
+     * reached the padding without losing sync).
+     */
+    struct TagLayout {
+        std::uint64_t file_size = 0;
+        std::uint64_t audio_begin = 0;       ///< first byte past the ID3v2 region
+        std::uint64_t audio_end = 0;         ///< first byte of the trailing tags
+        std::size_t padding = 0;             ///< zero bytes at the tail of the ID3v2 region
+        bool frames_walked = false;          ///< frame walk succeeded, padding is exact
+        std::vector<std::byte> v2_region;    ///< leading ID3v2 tag, header included
+        std::vector<std::byte> trailer;      ///< trailing ID3v1/APEv2 tags, verbatim
+    };
+
+    std::uint32_t syncsafe32(const unsigned char* p) {
+        return static_cast<std::uint32_t>(p[0] & 0x7F) << 21 |
+               static_cast<std::uint32_t>(p[1] & 0x7F) << 14 |
+               static_cast<std::uint32_t>(p[2] & 0x7F) << 7 |
+               static_cast<std::uint32_t>(p[3] & 0x7F);
+    }
+
+    std::uint32_t be32(const unsigned char* p) {
+        return static_cast<std::uint32_t>(p[0]) << 24 |
+               static_cast<std::uint32_t>(p[1]) << 16 |
+               static_cast<std::uint32_t>(p[2]) << 8 |
+               static_cast<std::uint32_t>(p[3]);
+    }
+
+    /**
+     * @brief Walks the ID3v2 frames to find where the padding starts.
+     *
+     * Frame IDs are uppercase alphanumerics, so the first NUL where a
+     * frame header should be marks the padding run. Bails (returns
+     * false) on v2.2 tags, unsynchronised tags and anything that loses
+     * sync, in which case the region is kept byte-for-byte.
+     */
+    bool walk_id3v2_frames(const std::vector<std::byte>& region, std::size_t& padding) {
+        const auto* p = reinterpret_cast<const unsigned char*>(region.data());
+        const unsigned char version = p[3];
+        const unsigned char flags = p[5];
+        if ((version != 3 && version != 4) || (flags & 0x80)) return false;
+        if (flags & 0x10) { padding = 0; return true; } // footer forbids padding
+
+        std::size_t pos = 10;
+        const std::size_t end = region.size();
+        if (flags & 0x40) { // extended header
+            if (pos + 4 > end) return false;
+            const std::uint32_t ext = version == 4 ? syncsafe32(p + pos) : be32(p + pos) + 4;
+            pos += ext;
+        }
+        while (pos + 10 <= end) {
+            if (p[pos] == 0) break; // padding starts here
+            for (int i = 0; i < 4; ++i) {
+                const unsigned char c = p[pos + i];
+                if (!((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))) return false;
+            }
+            const std::uint32_t fsize = version == 4 ? syncsafe32(p + pos + 4) : be32(p + pos + 4);
+            if (pos + 10 + fsize > end || fsize == 0) return false;
+            pos += 10 + fsize;
+        }
+        if (pos > end) return false;
+        padding = end - pos;
+        return true;
+    }
+
+    /**
+     * @brief Locates the leading ID3v2 and trailing ID3v1/APEv2 regions.
+     *
+     * Reads only the tag regions into memory; the frame data in between
+     * is left on disk for splicing. Returns false when the file cannot
+     * be read.
+     */
+    bool scan_tag_layout(FILE* f, TagLayout& layout) {
+        if (fseek(f, 0, SEEK_END) != 0) return false;
+        const long size = ftell(f);
+        if (size < 0) return false;
+        layout.file_size = static_cast<std::uint64_t>(size);
+        layout.audio_end = layout.file_size;
+
+        // leading ID3v2: "ID3" + version + flags + syncsafe size
+        unsigned char hdr[10];
+        if (fseek(f, 0, SEEK_SET) != 0) return false;
+        if (fread(hdr, 1, 10, f) == 10 && memcmp(hdr, "ID3", 3) == 0) {
+            std::uint64_t region = 10 + syncsafe32(hdr + 6);
+            if (hdr[5] & 0x10) region += 10; // footer
+            if (region <= layout.file_size) {
+                layout.v2_region.resize(region);
+                fseek(f, 0, SEEK_SET);
+                if (fread(layout.v2_region.data(), 1, region, f) != region) return false;
+                layout.audio_begin = region;
+                layout.frames_walked = walk_id3v2_frames(layout.v2_region, layout.padding);
+            }
+        }
+
+        // trailing ID3v1 (128 bytes, "TAG"), then an APEv2 tag before it
+        unsigned char tail[32];
+        if (layout.audio_end >= layout.audio_begin + 128) {
+            fseek(f, static_cast<long>(layout.audio_end) - 128, SEEK_SET);
+            if (fread(tail, 1, 3, f) == 3 && memcmp(tail, "TAG", 3) == 0) {
+                layout.audio_end -= 128;
+            }
+        }
+        if (layout.audio_end >= layout.audio_begin + 32) {
+            fseek(f, static_cast<long>(layout.audio_end) - 32, SEEK_SET);
+            if (fread(tail, 1, 32, f) == 32 && memcmp(tail, "APETAGEX", 8) == 0) {
+                const std::uint32_t ape_size = static_cast<std::uint32_t>(tail[12]) |
+                                               static_cast<std::uint32_t>(tail[13]) << 8 |
+                                               static_cast<std::uint32_t>(tail[14]) << 16 |
+                                               static_cast<std::uint32_t>(tail[15]) << 24;
+                const bool has_header = (tail[23] & 0x80) != 0;
+                const std::uint64_t total = ape_size + (has_header ? 32u : 0u);
+                if (total <= layout.audio_end - layout.audio_begin) {
+                    layout.audio_end -= total;
+                }
+            }
+        }
+
+        const std::uint64_t trailer_len = layout.file_size - layout.audio_end;
+        if (trailer_len > 0) {
+            layout.trailer.resize(trailer_len);
+            fseek(f, static_cast<long>(layout.audio_end), SEEK_SET);
+            if (fread(layout.trailer.data(), 1, trailer_len, f) != trailer_len) return false;
+        }
+        return layout.audio_end >= layout.audio_begin;
+    }
+
+    /**
+     * @brief Copies [src_off, src_off + len) of f_in to f_out's position.
+     *
+     * On Linux the frame data is spliced kernel-side via
+     * copy_file_range(); elsewhere (or when the kernel refuses, e.g.
+     * cross-filesystem on old kernels) a buffered loop rewrites the same
+     * range, so a partial splice is harmless.
+     */
+    bool copy_region(FILE* f_in, FILE* f_out, const std::uint64_t src_off, const std::uint64_t len) {
+        if (len == 0) return true;
+        const long out_pos = ftell(f_out);
+        if (out_pos < 0) return false;
+#if defined(__linux__)
+        if (fflush(f_out) == 0) {
+            off_t off_in = static_cast<off_t>(src_off);
+            off_t off_out = out_pos;
+            std::uint64_t left = len;
+            while (left > 0) {
+                const ssize_t n = copy_file_range(fileno(f_in), &off_in,
+                                                  fileno(f_out), &off_out, left, 0);
+                if (n <= 0) break;
+                left -= static_cast<std::uint64_t>(n);
+            }
+            if (left == 0) {
+                fseek(f_out, out_pos + static_cast<long>(len), SEEK_SET);
+                return true;
+            }
+        }
+#endif
+        if (fseek(f_in, static_cast<long>(src_off), SEEK_SET) != 0) return false;
+        if (fseek(f_out, out_pos, SEEK_SET) != 0) return false;
+        std::vector<unsigned char> buffer(1 << 20);
+        std::uint64_t left = len;
+        while (left > 0) {
+            const std::size_t want = static_cast<std::size_t>(std::min<std::uint64_t>(left, buffer.size()));
+            if (fread(buffer.data(), 1, want, f_in) != want) return false;
+            if (fwrite(buffer.data(), 1, want, f_out) != want) return false;
+            left -= want;
+        }
+        return true;
+    }
+
+} // namespace
+
 void MpegProcessor::recompress(const fs::path& input,
                               const fs::path& output,
                               bool preserve_metadata) {
-    Logger::log(LogLevel::Error, "Recompress called on MpegProcessor placeholder.", processor_tag());
+    Logger::log(LogLevel::Info, "Rewriting MP3 tag regions: " + input.string(), processor_tag());
 
-    std::error_code ec;
-    fs::copy_file(input, output, fs::copy_options::overwrite_existing, ec);
+    FILE* f_in = chisel::open_file(input, "rb");
+    if (f_in == nullptr) throw std::runtime_error("MpegProcessor: cannot open input");
+
+    TagLayout layout;
+    if (!scan_tag_layout(f_in, layout)) {
+        fclose(f_in);
+        throw std::runtime_error("MpegProcessor: cannot read tag layout");
+    }
+
+    // the leading region to emit: the ID3v2 tag minus its padding when
+    // the frame walk pinned the padding down, the whole tag when it did
+    // not, nothing when metadata is being dropped
+    std::vector<std::byte> lead;
+    if (preserve_metadata && !layout.v2_region.empty()) {
+        lead = layout.v2_region;
+        if (layout.frames_walked && layout.padding > 0) {
+            lead.resize(lead.size() - layout.padding);
+            const std::uint32_t new_size = static_cast<std::uint32_t>(lead.size()) - 10;
+            auto* p = reinterpret_cast<unsigned char*>(lead.data());
+            p[6] = (new_size >> 21) & 0x7F;
+            p[7] = (new_size >> 14) & 0x7F;
+            p[8] = (new_size >> 7) & 0x7F;
+            p[9] = new_size & 0x7F;
+        }
+    }
+
+    FILE* f_out = chisel::open_file(output, "wb");
+    if (f_out == nullptr) {
+        fclose(f_in);
+        throw std::runtime_error("MpegProcessor: cannot open output");
+    }
+
+    bool ok = lead.empty() || fwrite(lead.data(), 1, lead.size(), f_out) == lead.size();
+    ok = ok && copy_region(f_in, f_out, layout.audio_begin, layout.audio_end - layout.audio_begin);
+    if (ok && preserve_metadata && !layout.trailer.empty()) {
+        ok = fwrite(layout.trailer.data(), 1, layout.trailer.size(), f_out) == layout.trailer.size();
+    }
+
+    fclose(f_in);
+    const bool closed = fclose(f_out) == 0;
+
+    if (!ok || !closed) {
+        std::error_code ec;
+        fs::remove(output, ec);
+        throw std::runtime_error("MpegProcessor: tag rewrite failed");
+    }
+
+    const std::uint64_t out_size = fs::file_size(output);
+    Logger::log(LogLevel::Info, "MP3 tag rewrite saved " +
+                std::to_string(layout.file_size - std::min(layout.file_size, out_size)) +
+                " bytes (audio frames spliced untouched)", processor_tag());
+}
+
+std::string MpegProcessor::get_raw_checksum(const fs::path& file_path) const {
+    FILE* f = chisel::open_file(file_path, "rb");
+    if (f == nullptr) return "";
+
+    TagLayout layout;
+    if (!scan_tag_layout(f, layout)) {
+        fclose(f);
+        return "";
+    }
 
-    if (ec) {
-        throw std::runtime_error("Placeholder recompress failed to copy file.");
+    // hash only the frame region, so trimmed tags still compare equal
+    StreamingChecksum crc;
+    std::vector<std::byte> buffer(1 << 20);
+    fseek(f, static_cast<long>(layout.audio_begin), SEEK_SET);
+    std::uint64_t left = layout.audio_end - layout.audio_begin;
+    while (left > 0) {
+        const std::size_t want = static_cast<std::size_t>(std::min<std::uint64_t>(left, buffer.size()));
+        if (fread(buffer.data(), 1, want, f) != want) {
+            fclose(f);
+            return "";
+        }
+        crc.update(buffer.data(), want);
+        left -= want;
     }
+    fclose(f);
+    return crc.hex();
 }
 
 std::optional<ExtractedContent> MpegProcessor::prepare_extraction(const fs::path& input_path) {
@@ -7,23 +7,27 @@
 #include <stdexcept>
 #include <iostream>
 #include <map>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
 #include "file_utils.hpp"
 #include "logger.hpp"
 #include "log_sink.hpp"
+#include "core_budget.hpp"
 
 namespace chisel {
 
+/// Appends each packed record to a per-segment byte buffer so segments can
+/// be encoded in parallel and written out in their original order.
 extern "C" void record_handler_c(char *record, int reclen, void *userdata) {
     if (userdata == nullptr) {
-        Logger::log(LogLevel::Error, "record_handler_c: userdata (FILE*) is null");
+        Logger::log(LogLevel::Error, "record_handler_c: userdata (buffer) is null");
         return;
     }
 
-    auto outfile = static_cast<FILE*>(userdata);
-
-    if (fwrite(record, 1, reclen, outfile) != static_cast<size_t>(reclen)) {
-        Logger::log(LogLevel::Error, "record_handler_c: Error writing record to output file");
-    }
+    auto* packed = static_cast<std::vector<char>*>(userdata);
+    packed->insert(packed->end(), record, record + reclen);
 }
 int MseedProcessor::choose_reclen(const uint8_t original_version,
                                   const char sampleType,
@@ -106,8 +110,32 @@ void MseedProcessor::recompress(const std::filesystem::path& input,
         throw std::runtime_error("Failed to open output file for writing: " + output.string());
     }
 
+    // Segments are independent miniSEED record streams, so the Steim
+    // encoding (the bottleneck on large archives) is parallelized across
+    // them: each job packs into its own buffer and the buffers are written
+    // out afterwards in the original trace/segment order.
+    struct PackJob {
+        MS3TraceID *id;          ///< Owning trace (for log messages)
+        MS3TraceSeg *seg;        ///< Segment to encode
+        std::vector<char> packed; ///< Packed records, ready to write
+        bool failed = false;     ///< True when packing failed even after fallback
+    };
+
+    std::vector<PackJob> jobs;
     for (MS3TraceID *id = mstl->traces.next[0]; id != nullptr; id = id->next[0]) {
         for (MS3TraceSeg *seg = id->first; seg != nullptr; seg = seg->next) {
+            jobs.push_back({id, seg, {}, false});
+        }
+    }
+
+    std::atomic<size_t> next_job{0};
+
+    auto pack_jobs = [&]() {
+        while (true) {
+            const size_t j = next_job.fetch_add(1, std::memory_order_relaxed);
+            if (j >= jobs.size()) break;
+            PackJob& job = jobs[j];
+            MS3TraceSeg *seg = job.seg;
 
             int8_t target_encoding;
 
@@ -128,31 +156,61 @@ void MseedProcessor::recompress(const std::filesystem::path& input,
                 target_encoding = -1;
             }
 
-            ret_pack = mstl3_pack_segment(mstl, id, seg,
-                                          record_handler_c, outfile,
+            ret_pack = mstl3_pack_segment(mstl, job.id, seg,
+                                          record_handler_c, &job.packed,
                                           reclen, target_encoding,
                                           &packed_samples, pack_flags, 0, nullptr);
 
             if (ret_pack < 0 && seg->sampletype == 'i') {
 
-                Logger::log(LogLevel::Warning, std::string("SID ") + id->sid +
+                Logger::log(LogLevel::Warning, std::string("SID ") + job.id->sid +
                                                ": Steim2 packing failed (data range likely too large). " +
                                                "Retrying with uncompressed 32-bit integers (DE_INT32).");
 
                 target_encoding = DE_INT32;
                 packed_samples = 0;
+                job.packed.clear();
 
-                ret_pack = mstl3_pack_segment(mstl, id, seg,
-                                              record_handler_c, outfile,
+                ret_pack = mstl3_pack_segment(mstl, job.id, seg,
+                                              record_handler_c, &job.packed,
                                               reclen, target_encoding,
                                               &packed_samples, pack_flags, 0, nullptr);
             }
 
             if (ret_pack < 0) {
-                Logger::log(LogLevel::Error, std::string("Final packing error for SID ") + id->sid +
-                                             " (type " + seg->sampletype + ") after fallback. Segment skipped.");
+                job.failed = true;
             }
         }
+    };
+
+    if (jobs.size() > 1) {
+        const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+        const CoreBudget::Lease lease(
+            static_cast<int>(std::min<size_t>(hw, jobs.size())) - 1);
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(lease.taken());
+            for (int t = 0; t < lease.taken(); ++t) {
+                workers.emplace_back(pack_jobs);
+            }
+            pack_jobs();
+        }
+    } else {
+        pack_jobs();
+    }
+
+    for (const PackJob& job : jobs) {
+        if (job.failed) {
+            Logger::log(LogLevel::Error, std::string("Final packing error for SID ") + job.id->sid +
+                                         " (type " + job.seg->sampletype + ") after fallback. Segment skipped.");
+            continue;
+        }
+        if (!job.packed.empty() &&
+            fwrite(job.packed.data(), 1, job.packed.size(), outfile) != job.packed.size()) {
+            fclose(outfile);
+            mstl3_free(&mstl, 0);
+            throw std::runtime_error("Failed to write packed records to output: " + output.string());
+        }
     }
 
     fclose(outfile);
@@ -14,8 +14,6 @@
 #include <vector>
 #include <algorithm>
 #include "file_utils.hpp"
-#include "zlib_container.h"
-#include "zopfli.h"
 
 namespace chisel {
 
@@ -24,6 +22,11 @@ static const char* processor_tag() {
     return "ODFProcessor";
 }
 
+/// Per-member cap for in-memory staging; matches the archive default.
+/// ODF packages are mostly small XML, so the whole document usually
+/// stays off the temp volume.
+static constexpr uintmax_t odf_memory_member_limit = 64ull << 20;
+
 std::optional<ExtractedContent> OdfProcessor::prepare_extraction(const std::filesystem::path& input_path) {
     Logger::log(LogLevel::Info, "Preparing ODF: " + input_path.filename().string(), processor_tag());
 
@@ -77,6 +80,36 @@ std::optional<ExtractedContent> OdfProcessor::prepare_extraction(const std::file
             continue;
         }
 
+        // Small members are staged in memory: XML parts go straight back
+        // into the rebuilt package, and only embedded media that a
+        // registered processor claims ever reaches the temp volume (the
+        // executor spills those to out_path itself).
+        if (archive_entry_size_is_set(entry) &&
+            static_cast<uintmax_t>(archive_entry_size(entry)) < odf_memory_member_limit) {
+            ExtractedContent::MemoryMember member;
+            member.path = out_path;
+            member.data.reserve(static_cast<size_t>(archive_entry_size(entry)));
+            const void* buff = nullptr;
+            size_t size = 0;
+            la_int64_t offset = 0;
+            bool ok = true;
+            while (true) {
+                const int rb = archive_read_data_block(in, &buff, &size, &offset);
+                if (rb == ARCHIVE_EOF) break;
+                if (rb != ARCHIVE_OK) {
+                    Logger::log(LogLevel::Error, "Error reading data block: " + std::string(archive_error_string(in)), processor_tag());
+                    ok = false;
+                    break;
+                }
+                const auto* bytes = static_cast<const std::byte*>(buff);
+                member.data.insert(member.data.end(), bytes, bytes + size);
+            }
+            if (ok) {
+                content.memory_members.push_back(std::move(member));
+            }
+            continue;
+        }
+
         fs::create_directories(out_path.parent_path(), ec);
         if (ec) {
             Logger::log(LogLevel::Error,
@@ -118,7 +151,8 @@ std::optional<ExtractedContent> OdfProcessor::prepare_extraction(const std::file
     archive_read_free(in);
 
     Logger::log(LogLevel::Debug,
-                "ODF prepare complete: " + std::to_string(content.extracted_files.size()) + " files",
+                "ODF prepare complete: " + std::to_string(content.memory_members.size()) +
+                " members in memory, " + std::to_string(content.extracted_files.size()) + " on disk",
                 processor_tag());
 
     return content;
@@ -151,7 +185,7 @@ std::filesystem::path OdfProcessor::finalize_extraction(const ExtractedContent&
         cleanup_temp_dir(content.temp_dir);
         throw std::runtime_error("ODFProcessor: set_format_zip failed");
     }
-    archive_write_set_format_option(out, "zip", "compression", "store");
+    archive_write_set_options(out, "compression=deflate,compression-level=9");
 
     int open_w = archive_write_open_filename(out, tmp_path.string().c_str());
     if (open_w == ARCHIVE_WARN) {
@@ -164,55 +198,57 @@ std::filesystem::path OdfProcessor::finalize_extraction(const ExtractedContent&
         throw std::runtime_error("ODFProcessor: open_filename failed");
     }
 
-    // ensure "mimetype" is written first
-    std::vector<fs::path> files_ordered;
-    auto it = std::find_if(content.extracted_files.begin(), content.extracted_files.end(),
-                           [](const fs::path& f){ return f.filename() == "mimetype"; });
-    if (it != content.extracted_files.end()) {
-        files_ordered.push_back(*it);
+    // Gather entries: members that stayed in memory plus everything on
+    // disk under temp_dir (oversized members and the ones the executor
+    // spilled for path-based processors), with "mimetype" first as the
+    // ODF spec requires.
+    struct ZipEntry {
+        fs::path rel;                             ///< Path inside the package
+        const std::vector<std::byte>* mem;        ///< In-memory payload, or null
+        fs::path disk_path;                       ///< Source file when mem is null
+    };
+    std::vector<ZipEntry> entries;
+    for (const auto& member : content.memory_members) {
+        if (member.path.empty()) continue; // spilled to disk during analysis
+        fs::path rel = fs::relative(member.path, content.temp_dir, ec);
+        if (ec) rel = member.path.filename();
+        entries.push_back({std::move(rel), &member.data, {}});
     }
-    for (const auto& f : content.extracted_files) {
-        if (fs::path(f).filename() != "mimetype") {
-            files_ordered.push_back(f);
+    if (fs::exists(content.temp_dir, ec)) {
+        for (const auto& dirent : fs::recursive_directory_iterator(content.temp_dir, ec)) {
+            if (!dirent.is_regular_file()) continue;
+            fs::path rel = fs::relative(dirent.path(), content.temp_dir, ec);
+            if (ec) rel = dirent.path().filename();
+            entries.push_back({std::move(rel), nullptr, dirent.path()});
         }
     }
+    std::stable_partition(entries.begin(), entries.end(),
+                          [](const ZipEntry& e){ return e.rel.filename() == "mimetype"; });
 
     try {
-        for (const auto& file : files_ordered) {
-            fs::path rel = fs::relative(file, content.temp_dir, ec);
-            if (ec) rel = fs::path(file).filename();
-
-            std::ifstream ifs(file, std::ios::binary);
-            if (!ifs) {
-                Logger::log(LogLevel::Error, "Failed to open file for reading: " + file.filename().string(), processor_tag());
-                continue;
+        for (const auto& zip_entry : entries) {
+            const fs::path& rel = zip_entry.rel;
+
+            std::vector<std::byte> disk_buf;
+            if (zip_entry.mem == nullptr) {
+                std::ifstream ifs(zip_entry.disk_path, std::ios::binary);
+                if (!ifs) {
+                    Logger::log(LogLevel::Error, "Failed to open file for reading: " + rel.filename().string(), processor_tag());
+                    continue;
+                }
+                std::transform(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>(),
+                               std::back_inserter(disk_buf),
+                               [](const char c) { return static_cast<std::byte>(c); });
             }
-            std::vector<unsigned char> buf((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
-
-            std::vector<unsigned char> final_data;
-            std::string ext = rel.extension().string();
+            const std::vector<std::byte>& final_data = zip_entry.mem ? *zip_entry.mem : disk_buf;
 
+            // The mimetype entry must be stored uncompressed so document
+            // sniffers can read it from a fixed offset; everything else
+            // gets the deflate level set above.
             if (rel.filename() == "mimetype") {
-                final_data = buf;
-                Logger::log(LogLevel::Debug, "Stored mimetype entry uncompressed", processor_tag());
-                // option is already 'store', do nothing
-            } else if (ext == ".xml") {
-                ZopfliOptions opts;
-                ZopfliInitOptions(&opts);
-                opts.numiterations = 15;
-                opts.blocksplitting = 1;
-                unsigned char* out_data = nullptr;
-                size_t out_size = 0;
-                ZopfliZlibCompress(&opts, buf.data(), buf.size(), &out_data, &out_size);
-
-                std::vector<unsigned char> result(out_data, out_data + out_size);
-                free(out_data);
-                final_data = result;
-
-                Logger::log(LogLevel::Debug, "Recompressed XML with Zopfli: " + rel.string(), processor_tag());
+                archive_write_set_format_option(out, "zip", "compression", "store");
             } else {
-                final_data = buf;
-                Logger::log(LogLevel::Debug, "Copied entry unchanged: " + rel.string(), processor_tag());
+                archive_write_set_format_option(out, "zip", "compression", "deflate");
             }
 
             archive_entry* entry = archive_entry_new();
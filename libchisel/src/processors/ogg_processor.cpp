@@ -3,6 +3,7 @@
 //
 
 #include "../../include/ogg_processor.hpp"
+#include "../../include/core_budget.hpp"
 #include "../../include/logger.hpp"
 #include "../../include/audio_metadata_util.hpp"
 #include "../../include/file_utils.hpp"
@@ -11,6 +12,9 @@
 #include <filesystem>
 #include <cstdio>
 #include <vector>
+#include <atomic>
+#include <span>
+#include <thread>
 #include <FLAC/all.h>
 #include "file_type.hpp"
 
@@ -263,6 +267,112 @@ namespace {
         return ctx.pcm;
     }
 
+    // --- Chained-stream support ---
+
+    /**
+     * @brief Finds the byte offset of every chained logical stream.
+     *
+     * Internet-radio rips chain hundreds of complete Ogg streams into one
+     * file, and each chain is an independent OptiVorbis job. Walks the
+     * page framing: a BOS page following a non-BOS page opens a new
+     * chain, while the run of BOS pages that opens a grouped
+     * (multiplexed) file stays inside one chain.
+     *
+     * @return Chain start offsets (front is always 0), or an empty vector
+     * if the file is not wall-to-wall well-formed pages.
+     */
+    std::vector<size_t> split_ogg_chains(const std::vector<std::byte>& data) {
+        std::vector<size_t> starts;
+        size_t pos = 0;
+        bool prev_bos = false;
+        while (pos + 27 <= data.size()) {
+            const auto* p = reinterpret_cast<const unsigned char*>(data.data()) + pos;
+            if (memcmp(p, "OggS", 4) != 0 || p[4] != 0) return {}; // lost page sync
+            const bool bos = (p[5] & 0x02) != 0;
+            const size_t num_segments = p[26];
+            if (pos + 27 + num_segments > data.size()) return {};
+            size_t page_len = 27 + num_segments;
+            for (size_t i = 0; i < num_segments; ++i) page_len += p[27 + i];
+            if (pos + page_len > data.size()) return {};
+            if (bos && !prev_bos) starts.push_back(pos);
+            prev_bos = bos;
+            pos += page_len;
+        }
+        if (pos != data.size() || starts.empty() || starts.front() != 0) return {};
+        return starts;
+    }
+
+    /**
+     * @brief Runs OptiVorbis once per chained logical stream, in parallel.
+     *
+     * Each chain is staged as its own temp file, remuxed on a leased core
+     * and the results are concatenated in chain order. Any chain failure
+     * fails the whole file, matching the single-stream behaviour.
+     */
+    void optimize_vorbis_chained(const fs::path& input, const fs::path& output,
+                                 const std::vector<std::byte>& data,
+                                 const std::vector<size_t>& starts) {
+        const fs::path work_dir = make_temp_dir_for(input, "ogg-chains");
+
+        std::vector<fs::path> staged(starts.size());
+        std::vector<fs::path> remuxed(starts.size());
+        for (size_t i = 0; i < starts.size(); ++i) {
+            const size_t end = (i + 1 < starts.size()) ? starts[i + 1] : data.size();
+            staged[i]  = work_dir / ("chain_" + std::to_string(i) + ".ogg");
+            remuxed[i] = work_dir / ("chain_" + std::to_string(i) + ".opt.ogg");
+            if (!write_file(staged[i], std::span(data).subspan(starts[i], end - starts[i]))) {
+                cleanup_temp_dir(work_dir, processor_tag());
+                throw std::runtime_error("OggProcessor: cannot stage chained streams");
+            }
+        }
+
+        const auto hw = std::max<size_t>(1, std::thread::hardware_concurrency());
+        const CoreBudget::Lease ogg_cores(static_cast<int>(std::min(hw, starts.size())) - 1);
+        std::atomic<size_t> next{0};
+        std::atomic<bool> failed{false};
+
+        auto worker = [&] {
+            size_t i = 0;
+            while (!failed.load() && (i = next.fetch_add(1)) < starts.size()) {
+                if (chisel_optimize_vorbis(staged[i].string().c_str(),
+                                           remuxed[i].string().c_str()) != 0) {
+                    failed.store(true);
+                }
+            }
+        };
+
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(static_cast<size_t>(ogg_cores.taken()));
+            for (int t = 0; t < ogg_cores.taken(); ++t) workers.emplace_back(worker);
+            worker(); // the calling thread takes its share of chains
+        }
+
+        if (failed.load()) {
+            cleanup_temp_dir(work_dir, processor_tag());
+            const std::string msg = "OptiVorbis failed on a chained stream";
+            Logger::log(LogLevel::Error, msg, processor_tag());
+            throw std::runtime_error(msg);
+        }
+
+        // stitch the remuxed chains back together in order
+        FILE* f_out = chisel::open_file(output, "wb");
+        bool stitched = f_out != nullptr;
+        std::vector<std::byte> part;
+        for (size_t i = 0; i < remuxed.size() && stitched; ++i) {
+            stitched = read_file(remuxed[i], part) &&
+                       fwrite(part.data(), 1, part.size(), f_out) == part.size();
+        }
+        if (f_out != nullptr) fclose(f_out);
+        cleanup_temp_dir(work_dir, processor_tag());
+
+        if (!stitched) {
+            std::error_code ec;
+            fs::remove(output, ec);
+            throw std::runtime_error("OggProcessor: failed to stitch chained streams");
+        }
+    }
+
 } // namespace
 
 void OggProcessor::recompress(const fs::path& input,
@@ -307,14 +417,27 @@ void OggProcessor::recompress(const fs::path& input,
             FLAC__stream_encoder_delete(encoder);
             fclose(f_in);
 
-            const std::string input_str = input.string();
-            const std::string output_str = output.string();
-
-            int result = chisel_optimize_vorbis(input_str.c_str(), output_str.c_str());
-            if (result != 0) {
-                const std::string msg = "OptiVorbis failed with error code: " + std::to_string(result);
-                Logger::log(LogLevel::Error, msg, processor_tag());
-                throw std::runtime_error(msg);
+            // Chained files (internet-radio rips) carry hundreds of
+            // independent logical streams; remux them in parallel instead
+            // of feeding OptiVorbis one serial unit.
+            std::vector<std::byte> data;
+            std::vector<size_t> chains;
+            if (read_file(input, data)) chains = split_ogg_chains(data);
+
+            if (chains.size() > 1) {
+                Logger::log(LogLevel::Info, "Optimizing " + std::to_string(chains.size()) +
+                            " chained Ogg streams in parallel", processor_tag());
+                optimize_vorbis_chained(input, output, data, chains);
+            } else {
+                const std::string input_str = input.string();
+                const std::string output_str = output.string();
+
+                int result = chisel_optimize_vorbis(input_str.c_str(), output_str.c_str());
+                if (result != 0) {
+                    const std::string msg = "OptiVorbis failed with error code: " + std::to_string(result);
+                    Logger::log(LogLevel::Error, msg, processor_tag());
+                    throw std::runtime_error(msg);
+                }
             }
         } else {
             FILE* f_out = chisel::open_file(output, "wb");
@@ -14,33 +14,11 @@
 #include <vector>
 #include <algorithm>
 #include "file_utils.hpp"
-#include "zlib_container.h"
-#include "zopfli.h"
 
 namespace chisel {
 
 namespace fs = std::filesystem;
 
-/**
- * @brief Recompresses a byte vector using Zopfli's Zlib implementation.
- * @param input The raw data to be compressed.
- * @return A vector containing the Zlib-compressed data.
- */
-std::vector<unsigned char> recompress_with_zopfli(const std::vector<unsigned char>& input) {
-        ZopfliOptions opts;
-        ZopfliInitOptions(&opts);
-        opts.numiterations = 15;
-        opts.blocksplitting = 1;
-
-        unsigned char* out_data = nullptr;
-        size_t out_size = 0;
-        ZopfliZlibCompress(&opts, input.data(), input.size(), &out_data, &out_size);
-
-        std::vector<unsigned char> result(out_data, out_data + out_size);
-        free(out_data);
-        return result;
-    }
-
 /**
  * @brief Returns the tag used for logging by this processor.
  * @return A constant string identifier.
@@ -49,6 +27,11 @@ static const char* processor_tag() {
     return "OOXMLProcessor";
 }
 
+/// Per-member cap for in-memory staging; matches the archive default.
+/// Document parts are overwhelmingly tiny XML, so in practice the whole
+/// package stays off the temp volume.
+static constexpr uintmax_t ooxml_memory_member_limit = 64ull << 20;
+
 std::optional<ExtractedContent> OOXMLProcessor::prepare_extraction(const std::filesystem::path& input_path) {
     Logger::log(LogLevel::Info, "Preparing OOXML: " + input_path.filename().string(), processor_tag());
 
@@ -105,6 +88,36 @@ std::optional<ExtractedContent> OOXMLProcessor::prepare_extraction(const std::fi
             continue;
         }
 
+        // Small members are staged in memory: XML parts go straight back
+        // into the rebuilt package, and only embedded media that a
+        // registered processor claims ever reaches the temp volume (the
+        // executor spills those to out_path itself).
+        if (archive_entry_size_is_set(entry) &&
+            static_cast<uintmax_t>(archive_entry_size(entry)) < ooxml_memory_member_limit) {
+            ExtractedContent::MemoryMember member;
+            member.path = out_path;
+            member.data.reserve(static_cast<size_t>(archive_entry_size(entry)));
+            const void* buff = nullptr;
+            size_t size = 0;
+            la_int64_t offset = 0;
+            bool ok = true;
+            while (true) {
+                const int rb = archive_read_data_block(in, &buff, &size, &offset);
+                if (rb == ARCHIVE_EOF) break;
+                if (rb != ARCHIVE_OK) {
+                    Logger::log(LogLevel::Error, "Error reading data block: " + std::string(archive_error_string(in)), processor_tag());
+                    ok = false;
+                    break;
+                }
+                const auto* bytes = static_cast<const std::byte*>(buff);
+                member.data.insert(member.data.end(), bytes, bytes + size);
+            }
+            if (ok) {
+                content.memory_members.push_back(std::move(member));
+            }
+            continue;
+        }
+
         fs::create_directories(out_path.parent_path(), ec);
         if (ec) {
             Logger::log(LogLevel::Error,
@@ -146,7 +159,8 @@ std::optional<ExtractedContent> OOXMLProcessor::prepare_extraction(const std::fi
     archive_read_free(in);
 
     Logger::log(LogLevel::Debug,
-                "OOXML prepare complete: " + std::to_string(content.extracted_files.size()) + " files",
+                "OOXML prepare complete: " + std::to_string(content.memory_members.size()) +
+                " members in memory, " + std::to_string(content.extracted_files.size()) + " on disk",
                 processor_tag());
 
     return content;
@@ -180,7 +194,7 @@ std::filesystem::path OOXMLProcessor::finalize_extraction(const ExtractedContent
         cleanup_temp_dir(content.temp_dir);
         throw std::runtime_error("OOXMLProcessor: set_format_zip failed");
     }
-    archive_write_set_options(out, "compression=deflate");
+    archive_write_set_options(out, "compression=deflate,compression-level=9");
 
     const int open_w = archive_write_open_filename(out, tmp_path.string().c_str());
     if (open_w == ARCHIVE_WARN) {
@@ -193,46 +207,50 @@ std::filesystem::path OOXMLProcessor::finalize_extraction(const ExtractedContent
         throw std::runtime_error("OOXMLProcessor: open_filename failed");
     }
 
-    // ensure [Content_Types].xml is written first
-    std::vector<fs::path> files_ordered;
-    auto it = std::find_if(content.extracted_files.begin(), content.extracted_files.end(),
-                           [](const fs::path& f){ return f.filename() == "[Content_Types].xml"; });
-    if (it != content.extracted_files.end()) {
-        files_ordered.push_back(*it);
+    // Gather entries: members that stayed in memory plus everything on
+    // disk under temp_dir (oversized members and the ones the executor
+    // spilled for path-based processors), with [Content_Types].xml first.
+    struct ZipEntry {
+        fs::path rel;                             ///< Path inside the package
+        const std::vector<std::byte>* mem;        ///< In-memory payload, or null
+        fs::path disk_path;                       ///< Source file when mem is null
+    };
+    std::vector<ZipEntry> entries;
+    for (const auto& member : content.memory_members) {
+        if (member.path.empty()) continue; // spilled to disk during analysis
+        fs::path rel = fs::relative(member.path, content.temp_dir, ec);
+        if (ec) rel = member.path.filename();
+        entries.push_back({std::move(rel), &member.data, {}});
     }
-    for (const auto& f : content.extracted_files) {
-        if (fs::path(f).filename() != "[Content_Types].xml") {
-            files_ordered.push_back(f);
+    if (fs::exists(content.temp_dir, ec)) {
+        for (const auto& dirent : fs::recursive_directory_iterator(content.temp_dir, ec)) {
+            if (!dirent.is_regular_file()) continue;
+            fs::path rel = fs::relative(dirent.path(), content.temp_dir, ec);
+            if (ec) rel = dirent.path().filename();
+            entries.push_back({std::move(rel), nullptr, dirent.path()});
         }
     }
+    std::stable_partition(entries.begin(), entries.end(),
+                          [](const ZipEntry& e){ return e.rel.filename() == "[Content_Types].xml"; });
 
     try {
-        // write all entries (recompress images; copy others)
-        for (const auto& file : files_ordered) {
-            fs::path rel = fs::relative(file, content.temp_dir, ec);
-            if (ec) rel = fs::path(file).filename();
-
-            std::ifstream ifs(file, std::ios::binary);
-            if (!ifs) {
-                Logger::log(LogLevel::Error, "Failed to open file for reading: " + file.filename().string(), processor_tag());
-                continue;
-            }
-            const std::vector<unsigned char> buf((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
-
-            std::vector<unsigned char> final_data;
-            const auto ext = rel.extension().string();
-
-            // recompress only PNG/JPG images, leave XML and others untouched
-            if (ext == ".png" || ext == ".jpg" || ext == ".jpeg") {
-                final_data = recompress_with_zopfli(buf);
-                Logger::log(LogLevel::Debug,
-                            "Recompressed image: " + rel.string() + " (" +
-                            std::to_string(buf.size()) + " -> " +
-                            std::to_string(final_data.size()) + " bytes)", processor_tag());
-            } else {
-                final_data = buf;
-                Logger::log(LogLevel::Debug, "Copied entry unchanged: " + rel.string(), processor_tag());
+        // write all entries; embedded media were already optimized by
+        // their own processors (in memory or on disk) before finalize
+        for (const auto& zip_entry : entries) {
+            const fs::path& rel = zip_entry.rel;
+
+            std::vector<std::byte> disk_buf;
+            if (zip_entry.mem == nullptr) {
+                std::ifstream ifs(zip_entry.disk_path, std::ios::binary);
+                if (!ifs) {
+                    Logger::log(LogLevel::Error, "Failed to open file for reading: " + rel.filename().string(), processor_tag());
+                    continue;
+                }
+                std::transform(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>(),
+                               std::back_inserter(disk_buf),
+                               [](const char c) { return static_cast<std::byte>(c); });
             }
+            const std::vector<std::byte>& final_data = zip_entry.mem ? *zip_entry.mem : disk_buf;
 
             archive_entry* entry = archive_entry_new();
             if (!entry) {
@@ -10,12 +10,17 @@
 #include <qpdf/QPDFObjectHandle.hh>
 #include <qpdf/Buffer.hh>
 #include <qpdf/QPDFLogger.hh>
+#include "../../include/core_budget.hpp"
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include <random>
 #include <chrono>
+#include <zlib.h>
 #include "zlib_container.h"
 #include "zopfli.h"
 
@@ -116,6 +121,28 @@ std::vector<unsigned char> recompress_with_zopfli(const std::vector<unsigned cha
  * @param stream The QPDFObjectHandle for the stream.
  * @return True if the stream uses a single /FlateDecode filter, false otherwise.
  */
+/**
+ * @brief Quick probe for whether a flate stream is worth re-encoding.
+ *
+ * A single zlib level-9 pass costs a small fraction of a zopfli run;
+ * if even that cannot beat the stream's current encoded size, the
+ * producer already compressed at max effort and zopfli is skipped.
+ *
+ * @param decoded The decoded stream bytes.
+ * @param current_size The stream's current encoded size in the file.
+ * @return True if the stream looks worth handing to zopfli.
+ */
+bool probe_says_recompress(const std::vector<unsigned char>& decoded,
+                           const size_t current_size) {
+    uLongf probe_len = compressBound(static_cast<uLong>(decoded.size()));
+    std::vector<unsigned char> probe(probe_len);
+    if (compress2(probe.data(), &probe_len, decoded.data(),
+                  static_cast<uLong>(decoded.size()), Z_BEST_COMPRESSION) != Z_OK) {
+        return true; // probe failed, fall through to the real encoder
+    }
+    return static_cast<size_t>(probe_len) < current_size;
+}
+
 bool stream_is_single_flate(QPDFObjectHandle const& stream) {
     if (!stream.isStream()) return false;
     const QPDFObjectHandle dict = stream.getDict();
@@ -231,6 +258,16 @@ std::filesystem::path PdfProcessor::finalize_extraction(const ExtractedContent &
             st.streams.resize(objects.size());
         }
 
+        // Phase 1 (serial — QPDF is not thread-safe): collect the decoded
+        // bytes and current encoded size of every candidate stream.
+        struct StreamJob {
+            size_t index;                        ///< Position in objects
+            std::vector<unsigned char> decoded;  ///< Decoded stream bytes
+            size_t current_size;                 ///< Encoded size in the source file
+            std::vector<unsigned char> result;   ///< Zopfli output (empty = keep original)
+        };
+        std::vector<StreamJob> jobs;
+
         for (size_t i = 0; i < objects.size(); ++i) {
             auto& obj = objects[i];
             if (!obj.isStream()) continue;
@@ -259,14 +296,60 @@ std::filesystem::path PdfProcessor::finalize_extraction(const ExtractedContent &
                 }
             }
 
-            std::vector<unsigned char> recompressed = recompress_with_zopfli(decoded);
+            jobs.push_back({i, std::move(decoded), obj.getRawStreamData()->getSize(), {}});
+        }
+
+        // Phase 2 (parallel): streams compress independently, so probe
+        // and re-encode them across the core budget, claimed in file
+        // order by atomic index. The zlib probe weeds out streams whose
+        // producer already compressed at max effort before any zopfli
+        // time is spent on them.
+        std::atomic<size_t> next_job{0};
+        std::atomic<size_t> probe_skipped{0};
+        auto recompress_jobs = [&] {
+            for (size_t j = next_job.fetch_add(1, std::memory_order_relaxed);
+                 j < jobs.size();
+                 j = next_job.fetch_add(1, std::memory_order_relaxed)) {
+                auto& job = jobs[j];
+                if (!probe_says_recompress(job.decoded, job.current_size)) {
+                    probe_skipped.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                auto candidate = recompress_with_zopfli(job.decoded);
+                if (!candidate.empty() && candidate.size() < job.current_size) {
+                    job.result = std::move(candidate);
+                }
+            }
+        };
+        if (!jobs.empty()) {
+            const auto hw = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            const CoreBudget::Lease lease(std::min(hw, static_cast<int>(jobs.size())) - 1);
+            std::vector<std::jthread> workers;
+            workers.reserve(lease.taken());
+            for (int k = 0; k < lease.taken(); ++k) {
+                workers.emplace_back(recompress_jobs);
+            }
+            recompress_jobs(); // this thread recompresses too
+        }
 
-            obj.replaceStreamData(
-                std::string(reinterpret_cast<const char*>(recompressed.data()), recompressed.size()),
+        // Phase 3 (serial): swap the winners into the document.
+        size_t replaced = 0;
+        for (auto& job : jobs) {
+            if (job.result.empty()) continue;
+            objects[job.index].replaceStreamData(
+                std::string(reinterpret_cast<const char*>(job.result.data()), job.result.size()),
                 QPDFObjectHandle::newName("/FlateDecode"),
                 QPDFObjectHandle::newNull()
             );
+            ++replaced;
         }
+        Logger::log(LogLevel::Debug,
+                    [&] {
+                        return "PDF streams: " + std::to_string(jobs.size()) + " candidates, " +
+                               std::to_string(probe_skipped.load(std::memory_order_relaxed)) +
+                               " already at max effort, " + std::to_string(replaced) + " replaced";
+                    },
+                    "pdf_processor");
 
         // Always write to a new temporary file
         auto tmp_path = content.original_path;
@@ -9,6 +9,8 @@
 #include <stdexcept>
 #include <vector>
 #include <fstream>
+#include <climits>
+#include <cstdio>
 #include <cstring> // for memcmp
 
 namespace chisel {
@@ -72,6 +74,44 @@ void PnmProcessor::recompress(const std::filesystem::path& input,
     Logger::log(LogLevel::Info, "PNM recompression finished: " + output.string(), processor_tag());
 }
 
+bool PnmProcessor::recompress_buffer(const std::span<const std::byte> input,
+                                     std::vector<std::byte>& output,
+                                     bool /*preserve_metadata*/) {
+    if (input.empty() || input.size() > static_cast<size_t>(INT_MAX)) return false;
+
+    const auto* bytes = reinterpret_cast<const stbi_uc*>(input.data());
+    const int len = static_cast<int>(input.size());
+
+    int width, height, channels;
+    if (!stbi_info_from_memory(bytes, len, &width, &height, &channels)) {
+        Logger::log(LogLevel::Warning, "recompress_buffer: failed to parse PNM header", processor_tag());
+        return false;
+    }
+
+    const int desired_channels = (channels == 1) ? 1 : 3;
+    unsigned char* data = stbi_load_from_memory(bytes, len, &width, &height, &channels, desired_channels);
+    if (!data) {
+        Logger::log(LogLevel::Warning, "recompress_buffer: failed to load PNM data", processor_tag());
+        return false;
+    }
+
+    // header plus raw rows, assembled straight into the caller's buffer
+    char header[64];
+    const int header_len = snprintf(header, sizeof(header), "%s\n%d %d\n255\n",
+                                    (desired_channels == 1) ? "P5" : "P6", width, height);
+    const size_t data_size = static_cast<size_t>(width) * height * desired_channels;
+
+    output.clear();
+    output.reserve(static_cast<size_t>(header_len) + data_size);
+    const auto* hp = reinterpret_cast<const std::byte*>(header);
+    output.insert(output.end(), hp, hp + header_len);
+    const auto* dp = reinterpret_cast<const std::byte*>(data);
+    output.insert(output.end(), dp, dp + data_size);
+
+    stbi_image_free(data);
+    return true;
+}
+
 std::string PnmProcessor::get_raw_checksum(const std::filesystem::path& /*file_path*/) const {
     return "";
 }
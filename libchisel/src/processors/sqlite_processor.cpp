@@ -4,46 +4,112 @@
 
 #include "../../include/sqlite_processor.hpp"
 #include "../../include/logger.hpp"
+#include "../../include/file_utils.hpp"
 #include <sqlite3.h>
 #include <stdexcept>
 #include <filesystem>
 #include <sstream>
 #include <string>
+#include <system_error>
 
 namespace chisel {
 
+/// Minimum free space before a rebuild is worth its I/O: below both
+/// 64 KiB and 1% of the file, the pre-check skips the rewrite entirely.
+static constexpr sqlite3_int64 min_reclaim_bytes = 64 * 1024;
+static constexpr double min_reclaim_fraction = 0.01;
+
+/// Runs a single-value PRAGMA and returns its integer result.
+static sqlite3_int64 query_pragma_i64(sqlite3 *db, const char *pragma_sql,
+                                      const sqlite3_int64 fallback) {
+    sqlite3_stmt *stmt = nullptr;
+    if (sqlite3_prepare_v2(db, pragma_sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return fallback;
+    }
+    sqlite3_int64 value = fallback;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        value = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return value;
+}
+
+/// Escapes a path for use inside a single-quoted SQL literal.
+static std::string sql_quote_path(const std::filesystem::path &p) {
+    std::string quoted;
+    for (const char c : p.string()) {
+        quoted += c;
+        if (c == '\'') quoted += '\'';
+    }
+    return quoted;
+}
+
 void SqliteProcessor::recompress(const std::filesystem::path& input,
                                  const std::filesystem::path& output,
                                  bool /*preserve_metadata*/) {
     Logger::log(LogLevel::Info, "Starting SQLite recompression: " + input.string(), "sqlite_processor");
 
-    // copy input to output
-    try {
-        std::filesystem::copy_file(input, output,
-                                   std::filesystem::copy_options::overwrite_existing);
-    } catch (const std::exception& e) {
-        Logger::log(LogLevel::Error, "Failed to copy input to output: " + std::string(e.what()), "sqlite_processor");
-        throw;
-    }
-
-    // open output database
+    // open source database read-only for the pre-check and the rebuild
     sqlite3* db = nullptr;
-    int rc = sqlite3_open_v2(output.string().c_str(), &db, SQLITE_OPEN_READWRITE, nullptr);
+    int rc = sqlite3_open_v2(input.string().c_str(), &db, SQLITE_OPEN_READONLY, nullptr);
     if (rc != SQLITE_OK) {
-        if (db) sqlite3_close(db);
         Logger::log(LogLevel::Error, "Cannot open database: " + std::string(sqlite3_errmsg(db)), "sqlite_processor");
+        if (db) sqlite3_close(db);
         throw std::runtime_error("SqliteProcessor: cannot open database");
     }
 
-    // run VACUUM
-    rc = sqlite3_exec(db, "VACUUM;", nullptr, nullptr, nullptr);
+    // Pre-check: freelist_count * page_size is what a rebuild could
+    // reclaim. Most databases are already tight, and skipping the
+    // rewrite here avoids streaming the whole file for nothing.
+    const sqlite3_int64 page_size = query_pragma_i64(db, "PRAGMA page_size;", 0);
+    const sqlite3_int64 page_count = query_pragma_i64(db, "PRAGMA page_count;", 0);
+    const sqlite3_int64 freelist_count = query_pragma_i64(db, "PRAGMA freelist_count;", -1);
+    if (page_size > 0 && freelist_count >= 0) {
+        const sqlite3_int64 reclaimable = freelist_count * page_size;
+        const auto threshold = static_cast<sqlite3_int64>(
+            static_cast<double>(page_count * page_size) * min_reclaim_fraction);
+        if (reclaimable < min_reclaim_bytes && reclaimable < threshold) {
+            sqlite3_close(db);
+            Logger::log(LogLevel::Debug,
+                        [&] {
+                            return "SQLite rebuild skipped: only " + std::to_string(reclaimable) +
+                                   " of " + std::to_string(page_count * page_size) +
+                                   " bytes reclaimable";
+                        },
+                        "sqlite_processor");
+            // byte-identical clone; the executor discards it as "no improvement"
+            if (!clone_or_copy_file(input, output)) {
+                Logger::log(LogLevel::Error, "Failed to copy input to output: " + input.string(), "sqlite_processor");
+                throw std::runtime_error("SqliteProcessor: failed to copy file");
+            }
+            return;
+        }
+    }
+
+    // Streaming rebuild: VACUUM INTO writes only the live pages straight
+    // to the output in one pass — no working copy of the source and no
+    // second rewrite, unlike the old copy-then-VACUUM sequence.
+    std::error_code rm_ec;
+    std::filesystem::remove(output, rm_ec); // VACUUM INTO refuses to overwrite
+    const std::string rebuild_sql = "VACUUM INTO '" + sql_quote_path(output) + "';";
+    rc = sqlite3_exec(db, rebuild_sql.c_str(), nullptr, nullptr, nullptr);
     if (rc != SQLITE_OK) {
-        Logger::log(LogLevel::Error, "VACUUM failed: " + std::string(sqlite3_errmsg(db)), "sqlite_processor");
+        Logger::log(LogLevel::Error, "VACUUM INTO failed: " + std::string(sqlite3_errmsg(db)), "sqlite_processor");
         sqlite3_close(db);
-        throw std::runtime_error("SqliteProcessor: VACUUM failed");
+        throw std::runtime_error("SqliteProcessor: VACUUM INTO failed");
     }
+    sqlite3_close(db);
     Logger::log(LogLevel::Info, "VACUUM completed", "sqlite_processor");
 
+    // reopen the rebuilt copy for ANALYZE
+    db = nullptr;
+    rc = sqlite3_open_v2(output.string().c_str(), &db, SQLITE_OPEN_READWRITE, nullptr);
+    if (rc != SQLITE_OK) {
+        Logger::log(LogLevel::Error, "Cannot open database: " + std::string(sqlite3_errmsg(db)), "sqlite_processor");
+        if (db) sqlite3_close(db);
+        throw std::runtime_error("SqliteProcessor: cannot open database");
+    }
+
     // run ANALYZE
     rc = sqlite3_exec(db, "ANALYZE;", nullptr, nullptr, nullptr);
     if (rc != SQLITE_OK) {
@@ -4,6 +4,7 @@
 
 #include "../../include/tga_processor.hpp"
 #include "../../include/logger.hpp"
+#include <climits>
 #include <stdexcept>
 #include <memory>
 
@@ -83,6 +84,45 @@ namespace chisel {
         Logger::log(LogLevel::Debug, "TGA RLE recompression complete: " + output.string(), processor_tag());
     }
 
+    bool TgaProcessor::recompress_buffer(const std::span<const std::byte> input,
+                                         std::vector<std::byte>& output,
+                                         bool /*preserve_metadata*/) {
+        if (input.empty() || input.size() > static_cast<size_t>(INT_MAX)) return false;
+
+        int width, height, channels;
+        unsigned char* data = stbi_load_from_memory(
+            reinterpret_cast<const stbi_uc*>(input.data()), static_cast<int>(input.size()),
+            &width, &height, &channels, 0);
+        if (!data) {
+            Logger::log(LogLevel::Warning,
+                        std::string("recompress_buffer: failed to load TGA: ") + stbi_failure_reason(),
+                        processor_tag());
+            return false;
+        }
+
+        stbi_write_tga_with_rle = 1;
+
+        output.clear();
+        const int success = stbi_write_tga_to_func(
+            [](void* context, void* chunk, const int size) {
+                if (size <= 0) return;
+                auto* out = static_cast<std::vector<std::byte>*>(context);
+                const auto* p = static_cast<const std::byte*>(chunk);
+                out->insert(out->end(), p, p + size);
+            },
+            &output,
+            width, height, channels, data
+        );
+
+        stbi_image_free(data);
+
+        if (!success) {
+            Logger::log(LogLevel::Warning, "recompress_buffer: failed to encode RLE TGA", processor_tag());
+            return false;
+        }
+        return true;
+    }
+
     std::string TgaProcessor::get_raw_checksum(const std::filesystem::path& /*file_path*/) const {
         // not implemented for tga
         return "";
@@ -4,7 +4,13 @@
 
 #include "../../include/tiff_processor.hpp"
 #include "../../include/logger.hpp"
+#include "../../include/core_budget.hpp"
 #include <tiffio.h>
+#include <zlib.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
 #include <vector>
 #include <stdexcept>
 
@@ -44,6 +50,46 @@ void copy_tags_with_metadata(TIFF* in, TIFF* out, const bool preserve_metadata)
     // note: color map is intentionally skipped as we convert to rgba
 }
 
+/**
+ * @brief Compresses one strip of RGBA rows the way libtiff's deflate
+ * codec would (horizontal-differencing predictor, then zlib level 9).
+ *
+ * Strips are independent zlib streams in a deflate-compressed TIFF, so
+ * they can be produced on any thread and handed to TIFFWriteRawStrip.
+ *
+ * @param raster The full decoded RGBA raster of the directory.
+ * @param width Row width in pixels.
+ * @param first_row First row of the strip.
+ * @param row_count Number of rows in the strip.
+ * @param out Receives the compressed strip bytes.
+ * @return true on success.
+ */
+bool compress_strip(const std::vector<uint32_t> &raster, const uint32_t width,
+                    const uint32_t first_row, const uint32_t row_count,
+                    std::vector<unsigned char> &out) {
+    constexpr size_t bytes_per_pixel = 4; // rgba, 8 bits per sample
+    const size_t row_bytes = static_cast<size_t>(width) * bytes_per_pixel;
+    std::vector<unsigned char> strip(row_bytes * row_count);
+    std::memcpy(strip.data(), &raster[static_cast<size_t>(first_row) * width], strip.size());
+
+    // predictor 2: each sample byte becomes the delta to the previous pixel
+    for (uint32_t r = 0; r < row_count; ++r) {
+        unsigned char *row = strip.data() + static_cast<size_t>(r) * row_bytes;
+        for (size_t i = row_bytes; i-- > bytes_per_pixel;) {
+            row[i] = static_cast<unsigned char>(row[i] - row[i - bytes_per_pixel]);
+        }
+    }
+
+    uLongf dest_len = compressBound(static_cast<uLong>(strip.size()));
+    out.resize(dest_len);
+    if (compress2(out.data(), &dest_len, strip.data(),
+                  static_cast<uLong>(strip.size()), Z_BEST_COMPRESSION) != Z_OK) {
+        return false;
+    }
+    out.resize(dest_len);
+    return true;
+}
+
 } // namespace
 
 namespace chisel {
@@ -51,6 +97,13 @@ namespace chisel {
 void TiffProcessor::recompress(const std::filesystem::path& input,
                                const std::filesystem::path& output,
                                bool preserve_metadata) {
+    recompress(input, output, preserve_metadata, std::stop_token{});
+}
+
+void TiffProcessor::recompress(const std::filesystem::path& input,
+                               const std::filesystem::path& output,
+                               bool preserve_metadata,
+                               const std::stop_token& stop) {
     Logger::log(LogLevel::Info, "Re-encoding " + input.string(), "tiff_processor");
 
     TIFF* in = TIFFOpen(input.string().c_str(), "r");
@@ -100,13 +153,61 @@ void TiffProcessor::recompress(const std::filesystem::path& input,
         unsigned short extra_samples = 1;
         TIFFSetField(out, TIFFTAG_EXTRASAMPLES, 1, &extra_samples);
 
-        for (uint32_t row = 0; row < height; ++row) {
-            tdata_t row_data = &raster[static_cast<size_t>(row) * width];
-            if (TIFFWriteScanline(out, row_data, row) < 0) {
+        // Strips compress independently, so encode them across the core
+        // budget instead of feeding scanlines through one deflate stream.
+        // ~1 MiB per strip keeps the zlib-reset overhead negligible while
+        // a multi-page scan still yields hundreds of parallel units.
+        const size_t row_bytes = static_cast<size_t>(width) * 4;
+        const auto rows_per_strip = static_cast<uint32_t>(
+            std::clamp<size_t>((1u << 20) / row_bytes, 1, height));
+        TIFFSetField(out, TIFFTAG_ROWSPERSTRIP, rows_per_strip);
+
+        const uint32_t strip_count = (height + rows_per_strip - 1) / rows_per_strip;
+        std::vector<std::vector<unsigned char>> strips(strip_count);
+        std::atomic<uint32_t> next{0};
+        std::atomic<bool> failed{false};
+        auto compress_strips = [&] {
+            for (uint32_t s = next.fetch_add(1, std::memory_order_relaxed);
+                 s < strip_count;
+                 s = next.fetch_add(1, std::memory_order_relaxed)) {
+                if (stop.stop_requested()) return;
+                const uint32_t first_row = s * rows_per_strip;
+                const uint32_t rows = std::min(rows_per_strip, height - first_row);
+                if (!compress_strip(raster, width, first_row, rows, strips[s])) {
+                    failed.store(true, std::memory_order_relaxed);
+                }
+            }
+        };
+        const auto hw = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        const CoreBudget::Lease lease(std::min(hw, static_cast<int>(strip_count)) - 1);
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(lease.taken());
+            for (int k = 0; k < lease.taken(); ++k) {
+                workers.emplace_back(compress_strips);
+            }
+            compress_strips(); // this thread compresses too
+        }
+        if (failed.load(std::memory_order_relaxed)) {
+            TIFFClose(in);
+            TIFFClose(out);
+            Logger::log(LogLevel::Error, "Failed to compress TIFF strip for: " + output.string(), "tiff_processor");
+            throw std::runtime_error("TiffProcessor: strip compression failed");
+        }
+        if (stop.stop_requested()) {
+            TIFFClose(in);
+            TIFFClose(out);
+            throw std::runtime_error("TiffProcessor: recompression interrupted");
+        }
+
+        // raw strips land in ascending file order, keeping writes sequential
+        for (uint32_t s = 0; s < strip_count; ++s) {
+            if (TIFFWriteRawStrip(out, s, strips[s].data(),
+                                  static_cast<tmsize_t>(strips[s].size())) < 0) {
                 TIFFClose(in);
                 TIFFClose(out);
-                Logger::log(LogLevel::Error, "Failed to write TIFF scanline for: " + output.string(), "tiff_processor");
-                throw std::runtime_error("TiffProcessor: write scanline failed");
+                Logger::log(LogLevel::Error, "Failed to write TIFF strip for: " + output.string(), "tiff_processor");
+                throw std::runtime_error("TiffProcessor: write strip failed");
             }
         }
 
@@ -3,25 +3,67 @@
 //
 
 #include "../../include/wavpack_processor.hpp"
+#include "../../include/core_budget.hpp"
 #include "../../include/logger.hpp"
 #include <wavpack.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 #include <cstdio>
 #include <filesystem>
 #include "file_utils.hpp"
 
+namespace {
+
+/**
+ * @brief Whether the vendored libwavpack supports encoder worker threads.
+ *
+ * WavPack blocks are self-contained, and the 5.7+ library packs them on
+ * worker threads when WavpackConfig carries a worker count (stitching
+ * the block chain itself). Older copies compile the assignment away and
+ * keep the single-threaded packer.
+ */
+template <typename Config>
+concept wavpack_has_workers = requires(Config cfg) { cfg.worker_threads; };
+
+/// Applies the worker count when the config field exists, a no-op otherwise.
+template <typename Config>
+void set_wavpack_workers(Config &cfg, const int threads) {
+    if constexpr (wavpack_has_workers<Config>) {
+        cfg.worker_threads = threads;
+    }
+}
+
+} // namespace
+
 namespace chisel {
 
 void WavPackProcessor::recompress(const std::filesystem::path& input,
                                   const std::filesystem::path& output,
-                                  bool preserve_metadata) {
+                                  const bool preserve_metadata) {
+    recompress(input, output, preserve_metadata, std::stop_token{});
+}
+
+void WavPackProcessor::recompress(const std::filesystem::path& input,
+                                  const std::filesystem::path& output,
+                                  bool preserve_metadata,
+                                  const std::stop_token& stop) {
     Logger::log(LogLevel::Info, "Starting WavPack recompression: " + input.string(), "wavpack_processor");
 
     char error[128]{};
 
+    int open_flags = OPEN_TAGS;
+#ifdef OPEN_THREADS
+    // 5.7+ decodes blocks on its own worker pool when asked
+    open_flags |= OPEN_THREADS;
+#endif
+
     // open input context
-    WavpackContext* ctx_in = WavpackOpenFileInput(input.string().c_str(), error, OPEN_TAGS, 0);
+    WavpackContext* ctx_in = WavpackOpenFileInput(input.string().c_str(), error, open_flags, 0);
     if (!ctx_in) {
         Logger::log(LogLevel::Error, std::string("WavPack open failed: ") + error, "wavpack_processor");
         throw std::runtime_error("WavPack open failed");
@@ -61,6 +103,12 @@ void WavPackProcessor::recompress(const std::filesystem::path& input,
     config.xmode            = 6;
     config.flags &= ~CONFIG_HYBRID_FLAG;             // force lossless
 
+    // Lease the free cores for the whole transcode and hand them to the
+    // block packer when the library can use them (see set_wavpack_workers).
+    const auto hw = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    const CoreBudget::Lease wv_cores(hw - 1);
+    set_wavpack_workers(config, wv_cores.taken());
+
     if (!WavpackSetConfiguration(ctx_out, &config, -1)) {
         WavpackCloseFile(ctx_out);
         std::fclose(out);
@@ -77,16 +125,75 @@ void WavPackProcessor::recompress(const std::filesystem::path& input,
 
     const int32_t num_channels = config.num_channels > 0 ? config.num_channels : 1;
     constexpr int32_t block_size = 65536;
-    std::vector<int32_t> buffer(static_cast<size_t>(block_size) * static_cast<size_t>(num_channels));
 
-    uint32_t samples = 0;
-    while ((samples = WavpackUnpackSamples(ctx_in, buffer.data(), block_size)) > 0) {
-        if (!WavpackPackSamples(ctx_out, buffer.data(), static_cast<int32_t>(samples))) {
-            WavpackCloseFile(ctx_out);
-            std::fclose(out);
-            WavpackCloseFile(ctx_in);
+    // Unpack and pack are both CPU-bound; overlap them with the same
+    // bounded-queue pipeline as the APE path. Chunks are packed on this
+    // thread in decode order, so the output stays a sequential write.
+    struct Chunk {
+        std::vector<int32_t> samples;
+        uint32_t count = 0;
+    };
+    constexpr size_t queue_depth = 4;
+    std::deque<Chunk> queue;
+    std::mutex queue_mtx;
+    std::condition_variable queue_cv;
+    bool decode_done = false;
+    bool abort_pipeline = false;
+
+    std::jthread decoder([&] {
+        std::vector<int32_t> buffer(static_cast<size_t>(block_size) * static_cast<size_t>(num_channels));
+        uint32_t samples = 0;
+        while (!stop.stop_requested() &&
+               (samples = WavpackUnpackSamples(ctx_in, buffer.data(), block_size)) > 0) {
+            Chunk chunk;
+            chunk.count = samples;
+            chunk.samples.assign(buffer.begin(), buffer.begin() + samples * num_channels);
+            {
+                std::unique_lock lock(queue_mtx);
+                queue_cv.wait(lock, [&] { return queue.size() < queue_depth || abort_pipeline; });
+                if (abort_pipeline) return;
+                queue.push_back(std::move(chunk));
+            }
+            queue_cv.notify_all();
+        }
+        {
+            std::lock_guard lock(queue_mtx);
+            decode_done = true;
+        }
+        queue_cv.notify_all();
+    });
+
+    bool pack_failed = false;
+    while (true) {
+        Chunk chunk;
+        {
+            std::unique_lock lock(queue_mtx);
+            queue_cv.wait(lock, [&] { return !queue.empty() || decode_done; });
+            if (queue.empty()) break; // drained and decoder finished
+            chunk = std::move(queue.front());
+            queue.pop_front();
+        }
+        queue_cv.notify_all();
+
+        if (stop.stop_requested() ||
+            !WavpackPackSamples(ctx_out, chunk.samples.data(), static_cast<int32_t>(chunk.count))) {
+            pack_failed = !stop.stop_requested();
+            std::lock_guard lock(queue_mtx);
+            abort_pipeline = true;
+            queue_cv.notify_all();
+            break;
+        }
+    }
+    decoder.join();
+
+    if (pack_failed || stop.stop_requested()) {
+        WavpackCloseFile(ctx_out);
+        std::fclose(out);
+        WavpackCloseFile(ctx_in);
+        if (pack_failed) {
             throw std::runtime_error("Error packing samples");
         }
+        throw std::runtime_error("WavPackProcessor: recompression interrupted");
     }
 
     if (!WavpackFlushSamples(ctx_out)) {
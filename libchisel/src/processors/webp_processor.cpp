@@ -4,13 +4,77 @@
 
 #include "../../include/webp_processor.hpp"
 #include "../../include/logger.hpp"
+#include "../../include/core_budget.hpp"
 #include <webp/decode.h>
 #include <webp/encode.h>
 #include <webp/mux.h>
+#include <array>
+#include <atomic>
 #include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 #include <fstream>
 
+namespace {
+
+/**
+ * @brief Encodes a shared RGBA buffer as lossless WebP with one preset.
+ *
+ * Each racing variant imports its own WebPPicture from the read-only
+ * decoded buffer, so any number of encodes can run concurrently.
+ *
+ * @param rgba The decoded RGBA pixels.
+ * @param width Image width in pixels.
+ * @param height Image height in pixels.
+ * @param preset Lossless preset level (cwebp's -z scale, 0-9).
+ * @return The encoded bytes, or an empty vector if this variant failed.
+ */
+std::vector<uint8_t> encode_lossless_variant(const uint8_t* rgba,
+                                             const int width,
+                                             const int height,
+                                             const int preset) {
+    WebPConfig config;
+    if (!WebPConfigInit(&config) || !WebPConfigLosslessPreset(&config, preset)) {
+        Logger::log(LogLevel::Warning,
+                    "WebpProcessor: lossless preset " + std::to_string(preset) + " rejected",
+                    "webp_processor");
+        return {};
+    }
+
+    WebPPicture picture;
+    if (!WebPPictureInit(&picture)) {
+        Logger::log(LogLevel::Warning, "WebpProcessor: WebPPictureInit failed", "webp_processor");
+        return {};
+    }
+    picture.width = width;
+    picture.height = height;
+    if (!WebPPictureImportRGBA(&picture, rgba, width * 4)) {
+        Logger::log(LogLevel::Warning, "WebpProcessor: WebPPictureImportRGBA failed", "webp_processor");
+        WebPPictureFree(&picture);
+        return {};
+    }
+
+    WebPMemoryWriter writer;
+    WebPMemoryWriterInit(&writer);
+    picture.writer = WebPMemoryWrite;
+    picture.custom_ptr = &writer;
+
+    std::vector<uint8_t> out;
+    if (WebPEncode(&config, &picture)) {
+        out.assign(writer.mem, writer.mem + writer.size);
+    } else {
+        Logger::log(LogLevel::Warning,
+                    "WebpProcessor: WebPEncode failed for preset " + std::to_string(preset),
+                    "webp_processor");
+    }
+    WebPPictureFree(&picture);
+    WebPMemoryWriterClear(&writer);
+    return out;
+}
+
+} // namespace
+
 namespace chisel {
 
 void WebpProcessor::recompress(const std::filesystem::path& input,
@@ -59,52 +123,59 @@ void WebpProcessor::recompress(const std::filesystem::path& input,
         throw std::runtime_error("WebpProcessor: decode failed");
     }
 
-    WebPConfig config;
-    if (!WebPConfigInit(&config)) {
-        Logger::log(LogLevel::Error, "WebpProcessor: WebPConfigInit failed", "webp_processor");
-        WebPFree(decoded);
-        throw std::runtime_error("WebpProcessor: WebPConfigInit failed");
-    }
-    if (!WebPConfigLosslessPreset(&config, 9)) {
-        Logger::log(LogLevel::Error, "WebpProcessor: WebPConfigLosslessPreset(9) failed", "webp_processor");
-        WebPFree(decoded);
-        throw std::runtime_error("WebpProcessor: WebPConfigLosslessPreset failed");
-    }
-
-    WebPPicture picture;
-    if (!WebPPictureInit(&picture)) {
-        Logger::log(LogLevel::Error, "WebpProcessor: WebPPictureInit failed", "webp_processor");
-        WebPFree(decoded);
-        throw std::runtime_error("WebpProcessor: WebPPictureInit failed");
-    }
-    picture.width = width;
-    picture.height = height;
-    if (!WebPPictureImportRGBA(&picture, decoded, width * 4)) {
-        Logger::log(LogLevel::Error, "WebpProcessor: WebPPictureImportRGBA failed", "webp_processor");
-        WebPPictureFree(&picture);
-        WebPFree(decoded);
-        throw std::runtime_error("WebpProcessor: WebPPictureImportRGBA failed");
+    // Different lossless presets frequently differ by several percent
+    // with no a-priori winner, so race them from the shared decoded
+    // buffer and keep the smallest: one decode, wall time bounded by
+    // the slowest preset instead of the sum.
+    static constexpr std::array<int, 3> lossless_presets = {9, 8, 6};
+    std::array<std::vector<uint8_t>, lossless_presets.size()> variants;
+    std::atomic<size_t> next_variant{0};
+    auto encode_variants = [&] {
+        for (size_t i = next_variant.fetch_add(1, std::memory_order_relaxed);
+             i < lossless_presets.size();
+             i = next_variant.fetch_add(1, std::memory_order_relaxed)) {
+            variants[i] = encode_lossless_variant(decoded, width, height, lossless_presets[i]);
+        }
+    };
+    {
+        const CoreBudget::Lease lease(static_cast<int>(lossless_presets.size()) - 1);
+        std::vector<std::jthread> workers;
+        workers.reserve(lease.taken());
+        for (int k = 0; k < lease.taken(); ++k) {
+            workers.emplace_back(encode_variants);
+        }
+        encode_variants(); // this thread encodes too
     }
     WebPFree(decoded);
 
-    WebPMemoryWriter writer;
-    WebPMemoryWriterInit(&writer);
-    picture.writer = WebPMemoryWrite;
-    picture.custom_ptr = &writer;
-
-    if (!WebPEncode(&config, &picture)) {
+    size_t best = lossless_presets.size();
+    for (size_t i = 0; i < lossless_presets.size(); ++i) {
+        if (variants[i].empty()) continue;
+        if (best == lossless_presets.size() || variants[i].size() < variants[best].size()) {
+            best = i;
+        }
+    }
+    if (best == lossless_presets.size()) {
         Logger::log(LogLevel::Error, "WebpProcessor: WebPEncode failed", "webp_processor");
-        WebPPictureFree(&picture);
-        WebPMemoryWriterClear(&writer);
         throw std::runtime_error("WebpProcessor: WebPEncode failed");
     }
-    WebPPictureFree(&picture);
+    Logger::log(LogLevel::Debug,
+                [&] {
+                    std::string sizes;
+                    for (size_t i = 0; i < lossless_presets.size(); ++i) {
+                        if (!sizes.empty()) sizes += ", ";
+                        sizes += "z" + std::to_string(lossless_presets[i]) + "=" +
+                                 (variants[i].empty() ? "failed" : std::to_string(variants[i].size()));
+                    }
+                    return "WebP lossless preset z" + std::to_string(lossless_presets[best]) +
+                           " wins (" + sizes + ")";
+                },
+                "webp_processor");
 
-    WebPData output_image{ writer.mem, writer.size };
+    WebPData output_image{ variants[best].data(), variants[best].size() };
     WebPMux* mux = WebPMuxCreate(&output_image, 1);
     if (!mux) {
         Logger::log(LogLevel::Error, "WebpProcessor: WebPMuxCreate failed", "webp_processor");
-        WebPMemoryWriterClear(&writer);
         throw std::runtime_error("WebpProcessor: WebPMuxCreate failed");
     }
 
@@ -126,7 +197,6 @@ void WebpProcessor::recompress(const std::filesystem::path& input,
     if (WebPMuxAssemble(mux, &final_data) != WEBP_MUX_OK) {
         Logger::log(LogLevel::Error, "WebpProcessor: WebPMuxAssemble failed", "webp_processor");
         WebPMuxDelete(mux);
-        WebPMemoryWriterClear(&writer);
         throw std::runtime_error("WebpProcessor: WebPMuxAssemble failed");
     }
 
@@ -134,14 +204,12 @@ void WebpProcessor::recompress(const std::filesystem::path& input,
     if (!out) {
         Logger::log(LogLevel::Error, "WebpProcessor: cannot open output file: " + output.string(), "webp_processor");
         WebPMuxDelete(mux);
-        WebPMemoryWriterClear(&writer);
         WebPDataClear(&final_data);
         throw std::runtime_error("WebpProcessor: cannot open output file");
     }
     out.write(reinterpret_cast<const char*>(final_data.bytes), static_cast<long>(final_data.size));
 
     WebPMuxDelete(mux);
-    WebPMemoryWriterClear(&writer);
     WebPDataClear(&final_data);
 
     Logger::log(LogLevel::Info, "WebP recompression completed: " + output.string(), "webp_processor");
@@ -3,16 +3,25 @@
 //
 
 #include "../../include/zopflipng_processor.hpp"
+#include "../../include/core_budget.hpp"
 #include "../../include/logger.hpp"
 #include "zopflipng_lib.h"
 #include "zlib_container.h"
+#include "deflate.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <limits>
+#include <optional>
+#include <thread>
 #include <vector>
 #include <string>
 #include <stdexcept>
 #include <png.h>
 #include <zlib.h>
+#include <cstdint>
 #include <cstring>
 #include <memory>
 #include <iostream>
@@ -105,6 +114,207 @@ namespace { // anonymous namespace for helpers
         return image;
     }
 
+    /**
+     * @brief Zopfli iteration count scaled to the input size.
+     *
+     * Zopfli cost grows roughly linearly with iterations but each one
+     * yields less on big images, so multi-megabyte screenshots no longer
+     * monopolize a core for minutes over fractions of a percent. The
+     * first tier matches zopflipng's own small/large split (200 KiB).
+     */
+    int scaled_iterations(const uintmax_t png_size) {
+        if (png_size < 200ull * 1024) return 15;
+        if (png_size < (2ull << 20)) return 5;
+        if (png_size < (8ull << 20)) return 3;
+        return 1;
+    }
+
+    // --- parallel Zopfli across deflate chunks ---
+
+    /// Master chunk size for parallel compression; boundaries cost a few
+    /// bytes each, so chunks are kept large enough not to matter.
+    constexpr size_t zopfli_chunk_size = 1ull << 20;
+
+    /// File size above which recompress() takes the parallel IDAT path.
+    constexpr uintmax_t parallel_idat_threshold = 8ull << 20;
+
+    /**
+     * @brief Compress @p data as one zlib stream with Zopfli chunks in parallel.
+     *
+     * The input is split into master chunks compressed independently with
+     * ZopfliDeflatePart() on the calling thread plus workers borrowed from
+     * a shared core budget. Every non-final chunk is byte-aligned with an
+     * empty stored block so the per-chunk bitstreams stitch together by
+     * plain concatenation, then the whole stream is wrapped in a zlib
+     * container with the adler32 of the uncompressed data.
+     *
+     * Workers poll @p stop between chunks; when a stop arrives the
+     * remaining chunks are abandoned and the function throws.
+     */
+    std::vector<unsigned char> parallel_zopfli_zlib(const std::vector<unsigned char>& data,
+                                                    const int iterations,
+                                                    const std::stop_token& stop = {}) {
+        const size_t chunk_count = std::max<size_t>(1, (data.size() + zopfli_chunk_size - 1) / zopfli_chunk_size);
+
+        ZopfliOptions zopts;
+        ZopfliInitOptions(&zopts);
+        zopts.numiterations = iterations;
+        zopts.blocksplitting = 1;
+
+        std::vector<std::vector<unsigned char>> parts(chunk_count);
+        std::atomic<size_t> next{0};
+        auto work = [&] {
+            for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < chunk_count;
+                 i = next.fetch_add(1, std::memory_order_relaxed)) {
+                if (stop.stop_requested()) return;
+                const size_t start = i * zopfli_chunk_size;
+                const size_t end = std::min(data.size(), start + zopfli_chunk_size);
+                const int final_chunk = i + 1 == chunk_count ? 1 : 0;
+                unsigned char bp = 0;
+                unsigned char* out = nullptr;
+                size_t outsize = 0;
+                ZopfliDeflatePart(&zopts, 2, final_chunk, data.data(), start, end, &bp, &out, &outsize);
+                parts[i].assign(out, out + outsize);
+                free(out);
+                if (!final_chunk && bp != 0) {
+                    // byte-align with an empty stored block: its 3 header
+                    // bits are zero, so only the spill byte (when fewer
+                    // than 3 bits remain) plus LEN/NLEN must be appended
+                    if (bp > 5) parts[i].push_back(0x00);
+                    parts[i].push_back(0x00);
+                    parts[i].push_back(0x00);
+                    parts[i].push_back(0xFF);
+                    parts[i].push_back(0xFF);
+                }
+            }
+        };
+
+        const auto hw = static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency()));
+        {
+            // extra workers on top of the calling thread, drawn from the
+            // shared budget so concurrent big PNGs don't oversubscribe
+            const chisel::CoreBudget::Lease lease(static_cast<int>(std::min(chunk_count, hw)) - 1);
+            std::vector<std::jthread> workers;
+            workers.reserve(lease.taken());
+            for (int k = 0; k < lease.taken(); ++k) {
+                workers.emplace_back(work);
+            }
+            work(); // the calling thread compresses too
+        }
+        if (stop.stop_requested()) {
+            throw std::runtime_error("Zopfli compression interrupted");
+        }
+
+        std::vector<unsigned char> out;
+        out.push_back(0x78); // zlib header, max window
+        out.push_back(0xDA);
+        for (const auto& part : parts) {
+            out.insert(out.end(), part.begin(), part.end());
+        }
+        uLong adler = adler32(0L, Z_NULL, 0);
+        adler = adler32(adler, data.data(), static_cast<uInt>(data.size()));
+        out.push_back(static_cast<unsigned char>(adler >> 24 & 0xFF));
+        out.push_back(static_cast<unsigned char>(adler >> 16 & 0xFF));
+        out.push_back(static_cast<unsigned char>(adler >> 8 & 0xFF));
+        out.push_back(static_cast<unsigned char>(adler & 0xFF));
+        return out;
+    }
+
+    /// Inflates a whole zlib stream, or std::nullopt if it is corrupt.
+    std::optional<std::vector<unsigned char>> zlib_inflate_all(const unsigned char* data, const size_t size) {
+        if (size == 0 || size > std::numeric_limits<uInt>::max()) return std::nullopt;
+        z_stream strm{};
+        if (inflateInit(&strm) != Z_OK) return std::nullopt;
+        std::vector<unsigned char> out;
+        std::vector<unsigned char> buf(1u << 16);
+        strm.next_in = const_cast<unsigned char*>(data);
+        strm.avail_in = static_cast<uInt>(size);
+        int ret = Z_OK;
+        while (ret != Z_STREAM_END) {
+            strm.next_out = buf.data();
+            strm.avail_out = static_cast<uInt>(buf.size());
+            ret = inflate(&strm, Z_NO_FLUSH);
+            if (ret != Z_OK && ret != Z_STREAM_END) {
+                inflateEnd(&strm);
+                return std::nullopt;
+            }
+            out.insert(out.end(), buf.data(), buf.data() + (buf.size() - strm.avail_out));
+            if (ret == Z_OK && strm.avail_in == 0 && strm.avail_out != 0) {
+                inflateEnd(&strm); // truncated stream
+                return std::nullopt;
+            }
+        }
+        inflateEnd(&strm);
+        return out;
+    }
+
+    uint32_t read_u32_be(const unsigned char* p) {
+        return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 |
+               static_cast<uint32_t>(p[2]) << 8 | static_cast<uint32_t>(p[3]);
+    }
+
+    void append_u32_be(std::vector<unsigned char>& out, const uint32_t v) {
+        out.push_back(static_cast<unsigned char>(v >> 24 & 0xFF));
+        out.push_back(static_cast<unsigned char>(v >> 16 & 0xFF));
+        out.push_back(static_cast<unsigned char>(v >> 8 & 0xFF));
+        out.push_back(static_cast<unsigned char>(v & 0xFF));
+    }
+
+    /**
+     * @brief Rebuild a PNG with its IDAT stream recompressed in parallel.
+     *
+     * Walks the chunk list, inflates the concatenated IDAT payload (the
+     * filtered scanlines, left exactly as authored) and recompresses it
+     * with parallel_zopfli_zlib(), then writes the file back with a
+     * single IDAT chunk in place of the original run. All other chunks
+     * are copied verbatim, so metadata survives regardless of settings.
+     *
+     * @return The rebuilt file, or std::nullopt when the input cannot be
+     * parsed; the caller then falls back to ZopfliPNGOptimize.
+     */
+    std::optional<std::vector<unsigned char>> recompress_idat_parallel(const std::vector<unsigned char>& png,
+                                                                       const int iterations,
+                                                                       const std::stop_token& stop) {
+        static constexpr unsigned char signature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+        if (png.size() < 8 + 12 || std::memcmp(png.data(), signature, 8) != 0) return std::nullopt;
+
+        std::vector<unsigned char> out(png.begin(), png.begin() + 8);
+        std::vector<unsigned char> idat;
+        size_t insert_at = 0;
+        bool seen_idat = false;
+        size_t pos = 8;
+        while (pos + 12 <= png.size()) {
+            const uint32_t len = read_u32_be(&png[pos]);
+            if (len > png.size() || pos + 12 + len > png.size()) return std::nullopt;
+            if (std::memcmp(&png[pos + 4], "IDAT", 4) == 0) {
+                if (!seen_idat) {
+                    insert_at = out.size();
+                    seen_idat = true;
+                }
+                idat.insert(idat.end(), &png[pos + 8], &png[pos + 8] + len);
+            } else {
+                out.insert(out.end(), &png[pos], &png[pos] + 12 + len);
+            }
+            pos += 12 + len;
+        }
+        if (pos != png.size() || !seen_idat || idat.empty()) return std::nullopt;
+
+        const auto raw = zlib_inflate_all(idat.data(), idat.size());
+        if (!raw) return std::nullopt;
+        const auto compressed = parallel_zopfli_zlib(*raw, iterations, stop);
+
+        std::vector<unsigned char> idat_chunk;
+        append_u32_be(idat_chunk, static_cast<uint32_t>(compressed.size()));
+        idat_chunk.insert(idat_chunk.end(), {'I', 'D', 'A', 'T'});
+        idat_chunk.insert(idat_chunk.end(), compressed.begin(), compressed.end());
+        uLong crc = crc32(0L, Z_NULL, 0);
+        crc = crc32(crc, idat_chunk.data() + 4, static_cast<uInt>(compressed.size() + 4));
+        append_u32_be(idat_chunk, static_cast<uint32_t>(crc));
+
+        out.insert(out.begin() + static_cast<std::ptrdiff_t>(insert_at), idat_chunk.begin(), idat_chunk.end());
+        return out;
+    }
+
 } // namespace
 
 namespace chisel {
@@ -112,16 +322,54 @@ namespace chisel {
 void ZopfliPngProcessor::recompress(const fs::path& input,
                                     const fs::path& output,
                                     bool preserve_metadata) {
+    recompress(input, output, preserve_metadata, std::stop_token{});
+}
+
+void ZopfliPngProcessor::recompress(const fs::path& input,
+                                    const fs::path& output,
+                                    bool preserve_metadata,
+                                    const std::stop_token& stop) {
     Logger::log(LogLevel::Info, "Starting PNG optimization with ZopfliPNG: " + input.string(), "zopflipng_processor");
 
     try {
-        // configure options
+        // read input file
+        std::ifstream ifs(input, std::ios::binary);
+        if (!ifs) {
+            Logger::log(LogLevel::Error, "Failed to open input file", "zopflipng_processor");
+            throw std::runtime_error("ZopflipngProcessor: cannot open input");
+        }
+        auto size = fs::file_size(input);
+        std::vector<unsigned char> origpng;
+        origpng.reserve(size);
+        origpng.assign((std::istreambuf_iterator<char>(ifs)),
+                       std::istreambuf_iterator<char>());
+
+        // Above the parallel threshold, recompress the IDAT stream in
+        // chunks across borrowed worker threads instead of pinning one
+        // core in single-threaded ZopfliPNGOptimize. Filters and pixels
+        // stay exactly as authored.
+        if (size >= parallel_idat_threshold) {
+            const int iterations = effort_ <= 1 ? 5 : effort_ >= 3 ? 15 : 10;
+            if (const auto rebuilt = recompress_idat_parallel(origpng, iterations, stop)) {
+                std::ofstream ofs(output, std::ios::binary);
+                ofs.write(reinterpret_cast<const char*>(rebuilt->data()),
+                          static_cast<std::streamsize>(rebuilt->size()));
+                Logger::log(LogLevel::Info, "PNG optimization finished (parallel IDAT): " + output.string(),
+                            "zopflipng_processor");
+                return;
+            }
+            // unparseable or unexpected layout: fall back to the standard path
+        }
+
+        // configure options; iterations scale with size and effort
         ZopfliPNGOptions opts;
         opts.lossy_transparent = false;
         opts.lossy_8bit = false;
         opts.use_zopfli = true;
-        opts.num_iterations = 15;
-        opts.num_iterations_large = 5;
+        const int base_iterations = scaled_iterations(size);
+        const int first_iterations = effort_ <= 1 ? std::max(1, base_iterations / 3) : base_iterations;
+        opts.num_iterations = first_iterations;
+        opts.num_iterations_large = first_iterations;
 
         if (preserve_metadata) {
             // keep common metadata chunks
@@ -130,25 +378,44 @@ void ZopfliPngProcessor::recompress(const fs::path& input,
             opts.keepchunks.clear();
         }
 
-        // read input file
-        std::ifstream ifs(input, std::ios::binary);
-        if (!ifs) {
-            Logger::log(LogLevel::Error, "Failed to open input file", "zopflipng_processor");
-            throw std::runtime_error("ZopflipngProcessor: cannot open input");
+        // ZopfliPNGOptimize cannot be interrupted mid-call, so the token
+        // is honoured at pass granularity: bail before the first pass
+        // and skip the refinement below when a stop has arrived
+        if (stop.stop_requested()) {
+            throw std::runtime_error("ZopflipngProcessor: recompression interrupted");
         }
-        auto size = fs::file_size(input);
-        std::vector<unsigned char> origpng;
-        origpng.reserve(size);
-        origpng.assign((std::istreambuf_iterator<char>(ifs)),
-                       std::istreambuf_iterator<char>());
 
         // optimize
+        const auto pass_start = std::chrono::steady_clock::now();
         std::vector<unsigned char> resultpng;
         if (ZopfliPNGOptimize(origpng, opts, false, &resultpng) != 0) {
             Logger::log(LogLevel::Error, "ZopfliPNG optimization failed for: " + input.string(), "zopflipng_processor");
             throw std::runtime_error("ZopflipngProcessor: optimization failed");
         }
 
+        // Refinement: spend what is left of the per-file time budget on a
+        // deeper pass and keep the smaller result. Zopfli cannot be
+        // interrupted mid-iteration, so the cap is enforced at pass
+        // granularity: the refinement only runs when its projected cost
+        // (proportional to the iteration ratio) still fits the budget,
+        // otherwise the first pass already is the best-so-far result.
+        if (effort_ >= 2 && !stop.stop_requested()) {
+            const auto budget = effort_ >= 3 ? std::chrono::seconds(300) : std::chrono::seconds(15);
+            const auto elapsed = std::chrono::steady_clock::now() - pass_start;
+            const int deep_iterations = first_iterations * (effort_ >= 3 ? 8 : 4);
+            const auto projected = elapsed * deep_iterations / first_iterations;
+            if (elapsed + projected <= budget) {
+                ZopfliPNGOptions deep_opts = opts;
+                deep_opts.num_iterations = deep_iterations;
+                deep_opts.num_iterations_large = deep_iterations;
+                std::vector<unsigned char> refined;
+                if (ZopfliPNGOptimize(origpng, deep_opts, false, &refined) == 0 &&
+                    !refined.empty() && refined.size() < resultpng.size()) {
+                    resultpng = std::move(refined);
+                }
+            }
+        }
+
         // write output file
         std::ofstream ofs(output, std::ios::binary);
         ofs.write(reinterpret_cast<const char*>(resultpng.data()), resultpng.size());
@@ -162,6 +429,12 @@ void ZopfliPngProcessor::recompress(const fs::path& input,
 }
 
 std::vector<unsigned char> ZopfliPngProcessor::recompress_with_zopfli(const std::vector<unsigned char>& input) {
+    // big buffers take the chunked parallel path; small ones are not
+    // worth the per-chunk stitching overhead
+    if (input.size() >= 2 * zopfli_chunk_size) {
+        return parallel_zopfli_zlib(input, 15);
+    }
+
     ZopfliOptions opts;
     ZopfliInitOptions(&opts);
     opts.numiterations = 15;
@@ -0,0 +1,192 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+#include "../../include/zstd_processor.hpp"
+#include "../../include/core_budget.hpp"
+#include "../../include/file_utils.hpp"
+#include "../../include/logger.hpp"
+
+#include <zstd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /// Input fed per ZSTD_compressStream2 call; also the stop-poll grain.
+    constexpr std::size_t compress_chunk = 8 << 20;
+
+    /**
+     * @brief Decompresses a whole .zst payload, frame by frame, the way
+     * `zstd -d` does (skippable frames are passed over by the decoder).
+     *
+     * Frames written with the checksum flag are verified as a side
+     * effect; a truncated or corrupt stream fails instead of yielding
+     * partial data.
+     */
+    bool decompress_all(const std::span<const std::byte> input, std::vector<std::byte> &out,
+                        const std::stop_token &stop) {
+        if (input.size() < 4) return false;
+        std::uint32_t magic = 0;
+        std::memcpy(&magic, input.data(), sizeof magic);
+        if (magic != ZSTD_MAGICNUMBER && (magic & 0xFFFFFFF0u) != ZSTD_MAGIC_SKIPPABLE_START) {
+            return false;
+        }
+
+        ZSTD_DCtx *dctx = ZSTD_createDCtx();
+        if (dctx == nullptr) return false;
+        // accept frames from writers with big LDM windows
+        ZSTD_DCtx_setParameter(dctx, ZSTD_d_windowLogMax, 31);
+
+        ZSTD_inBuffer zin{input.data(), input.size(), 0};
+        std::vector<char> buf(1 << 20);
+        std::size_t rc = 0;
+        while (zin.pos < zin.size) {
+            if (stop.stop_requested()) {
+                ZSTD_freeDCtx(dctx);
+                return false;
+            }
+            ZSTD_outBuffer zout{buf.data(), buf.size(), 0};
+            rc = ZSTD_decompressStream(dctx, &zout, &zin);
+            if (ZSTD_isError(rc)) {
+                ZSTD_freeDCtx(dctx);
+                return false;
+            }
+            const auto *produced = reinterpret_cast<const std::byte *>(buf.data());
+            out.insert(out.end(), produced, produced + zout.pos);
+        }
+        ZSTD_freeDCtx(dctx);
+        return rc == 0; // rc > 0 here means the last frame was cut short
+    }
+
+    /**
+     * @brief Compresses @p data into a single high-level frame; the
+     * shared path behind both recompress() overloads and
+     * recompress_buffer().
+     */
+    bool compress_all(const std::span<const std::byte> data, std::vector<std::byte> &output,
+                      const int level, const std::stop_token &stop) {
+        ZSTD_CCtx *cctx = ZSTD_createCCtx();
+        if (cctx == nullptr) return false;
+
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableLongDistanceMatching, 1);
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1);
+        ZSTD_CCtx_setPledgedSrcSize(cctx, data.size());
+
+        // One zstd worker job covers roughly 32 MiB at these levels, so
+        // leasing more cores than jobs would just park them. A zero
+        // grant (or a single-threaded libzstd build, which rejects the
+        // parameter) degrades to blocking single-threaded compression.
+        const auto hw = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        const auto useful = static_cast<int>(data.size() / (32ull << 20)) + 1;
+        const chisel::CoreBudget::Lease lease(std::min(hw, useful) - 1);
+        if (lease.taken() > 0) {
+            ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, lease.taken());
+        }
+
+        output.resize(ZSTD_compressBound(data.size()));
+        ZSTD_outBuffer zout{output.data(), output.size(), 0};
+        std::size_t pos = 0;
+        while (pos < data.size()) {
+            if (stop.stop_requested()) {
+                ZSTD_freeCCtx(cctx);
+                return false;
+            }
+            const std::size_t len = std::min(compress_chunk, data.size() - pos);
+            ZSTD_inBuffer zin{data.data() + pos, len, 0};
+            while (zin.pos < zin.size) {
+                const std::size_t rc = ZSTD_compressStream2(cctx, &zout, &zin, ZSTD_e_continue);
+                if (ZSTD_isError(rc)) {
+                    ZSTD_freeCCtx(cctx);
+                    return false;
+                }
+            }
+            pos += len;
+        }
+        ZSTD_inBuffer drained{nullptr, 0, 0};
+        std::size_t remaining = 0;
+        do {
+            remaining = ZSTD_compressStream2(cctx, &zout, &drained, ZSTD_e_end);
+            if (ZSTD_isError(remaining)) {
+                ZSTD_freeCCtx(cctx);
+                return false;
+            }
+        } while (remaining != 0);
+        ZSTD_freeCCtx(cctx);
+        output.resize(zout.pos);
+        return true;
+    }
+
+    /// Maps the executor's effort scale onto zstd levels.
+    int effort_to_level(const int effort) {
+        switch (effort) {
+            case 1: return 12;
+            case 3: return 22; // ultra; decoders need no special handling
+            default: return 19;
+        }
+    }
+
+    bool reencode(const std::span<const std::byte> input, std::vector<std::byte> &output,
+                  const int level, const std::stop_token &stop) {
+        std::vector<std::byte> data;
+        if (!decompress_all(input, data, stop)) return false;
+        return compress_all(data, output, level, stop);
+    }
+
+} // namespace
+
+namespace chisel {
+
+void ZstdProcessor::recompress(const std::filesystem::path &input,
+                               const std::filesystem::path &output,
+                               const bool preserve_metadata) {
+    recompress(input, output, preserve_metadata, std::stop_token{});
+}
+
+void ZstdProcessor::recompress(const std::filesystem::path &input,
+                               const std::filesystem::path &output,
+                               [[maybe_unused]] const bool preserve_metadata,
+                               const std::stop_token &stop) {
+    std::vector<std::byte> in_data;
+    if (!read_file(input, in_data)) {
+        Logger::log(LogLevel::Error, "Failed to read zstd file: " + input.string(), "zstd_processor");
+        throw std::runtime_error("ZstdProcessor: cannot read input");
+    }
+    std::vector<std::byte> out_data;
+    if (!reencode(in_data, out_data, effort_to_level(effort_), stop)) {
+        if (stop.stop_requested()) {
+            throw std::runtime_error("ZstdProcessor: recompression interrupted");
+        }
+        Logger::log(LogLevel::Warning, "Not a recompressible zstd stream: " + input.string(), "zstd_processor");
+        throw std::runtime_error("ZstdProcessor: malformed zstd stream");
+    }
+    if (!write_file(output, out_data)) {
+        Logger::log(LogLevel::Error, "Failed to write zstd file: " + output.string(), "zstd_processor");
+        throw std::runtime_error("ZstdProcessor: cannot write output");
+    }
+    Logger::log(LogLevel::Info, "Re-encoding complete: " + output.string(), "zstd_processor");
+}
+
+bool ZstdProcessor::recompress_buffer(const std::span<const std::byte> input,
+                                      std::vector<std::byte> &output,
+                                      [[maybe_unused]] const bool preserve_metadata) {
+    return reencode(input, output, effort_to_level(effort_), std::stop_token{});
+}
+
+std::string ZstdProcessor::get_raw_checksum(const std::filesystem::path &file_path) const {
+    std::vector<std::byte> in_data;
+    if (!read_file(file_path, in_data)) return "";
+    std::vector<std::byte> data;
+    if (!decompress_all(in_data, data, std::stop_token{})) return "";
+    StreamingChecksum crc;
+    crc.update(data);
+    return crc.hex();
+}
+
+} // namespace chisel
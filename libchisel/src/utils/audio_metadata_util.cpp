@@ -3,9 +3,14 @@
 //
 
 #include "audio_metadata_util.hpp"
+#include <deque>
 #include <fstream>
 #include <iterator>
+#include <memory>
+#include <mutex>
 #include <setjmp.h>
+#include <system_error>
+#include <unordered_map>
 #include <vector>
 #include <taglib/fileref.h>
 #include "flac/flacfile.h"
@@ -281,14 +286,49 @@ bool rebuildId3v2Covers(TagLib::ID3v2::Tag* tag,
     return true;
 }
 
+//
+// snapshot cache
+//
+
+/// One parsed cover held in memory, ready to be re-materialized.
+struct CoverBlob {
+    AudioCoverInfo info;     ///< temp_file_path holds only the file name
+    std::vector<char> bytes; ///< The cover image bytes
+};
+
+/// Parsed-cover snapshots keyed by path|size|mtime, so one TagLib parse
+/// serves every later request for the same file content (duplicate
+/// copies, resumed runs); a changed file simply misses and re-parses.
+std::mutex snapshot_mtx;
+std::unordered_map<std::string, std::shared_ptr<const std::vector<CoverBlob>>> snapshot_cache;
+std::deque<std::string> snapshot_order; ///< FIFO eviction order
+constexpr size_t snapshot_cache_capacity = 32;
+
+/// Builds the content-versioned cache key, or an empty string when the
+/// file cannot be stat'ed (which bypasses the cache).
+std::string snapshotKey(const std::filesystem::path &input_path) {
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(input_path, ec);
+    if (ec) return {};
+    const auto mtime = std::filesystem::last_write_time(input_path, ec);
+    if (ec) return {};
+    return input_path.string() + '|' + std::to_string(size) + '|' +
+           std::to_string(mtime.time_since_epoch().count());
+}
+
 } // namespace
 
 //
 // extraction
 //
 
-AudioExtractionState AudioMetadataUtil::extractCovers(const std::filesystem::path &input_path,
-                                                      const std::filesystem::path &temp_dir) {
+/**
+ * @brief Parses @p input_path with TagLib and writes its covers to @p temp_dir.
+ *
+ * This is the uncached worker behind AudioMetadataUtil::extractCovers().
+ */
+static AudioExtractionState extractCoversParse(const std::filesystem::path &input_path,
+                                               const std::filesystem::path &temp_dir) {
     AudioExtractionState state;
 
 #ifdef _WIN32
@@ -480,6 +520,69 @@ AudioExtractionState AudioMetadataUtil::extractCovers(const std::filesystem::pat
     return state;
 }
 
+AudioExtractionState AudioMetadataUtil::extractCovers(const std::filesystem::path &input_path,
+                                                      const std::filesystem::path &temp_dir) {
+    const std::string key = snapshotKey(input_path);
+    if (key.empty()) {
+        return extractCoversParse(input_path, temp_dir);
+    }
+
+    // A cached snapshot re-materializes without touching TagLib at all.
+    std::shared_ptr<const std::vector<CoverBlob>> blobs;
+    {
+        std::lock_guard lock(snapshot_mtx);
+        if (const auto it = snapshot_cache.find(key); it != snapshot_cache.end()) {
+            blobs = it->second;
+        }
+    }
+    if (blobs) {
+        AudioExtractionState state;
+        for (const auto &blob : *blobs) {
+            AudioCoverInfo info = blob.info;
+            info.temp_file_path = temp_dir / blob.info.temp_file_path;
+            std::ofstream out(info.temp_file_path, std::ios::binary);
+            out.write(blob.bytes.data(), static_cast<std::streamsize>(blob.bytes.size()));
+            if (!out) {
+                Logger::log(LogLevel::Warning,
+                            "Failed to materialize cached cover; re-parsing: " + input_path.string(),
+                            "audio_util");
+                return extractCoversParse(input_path, temp_dir);
+            }
+            state.extracted_covers.push_back(std::move(info));
+        }
+        return state;
+    }
+
+    // Miss: parse once, then snapshot the just-written covers (still in
+    // the page cache) so any later request for this content skips the
+    // parse entirely.
+    AudioExtractionState state = extractCoversParse(input_path, temp_dir);
+    auto snapshot = std::make_shared<std::vector<CoverBlob>>();
+    snapshot->reserve(state.extracted_covers.size());
+    for (const auto &info : state.extracted_covers) {
+        CoverBlob blob;
+        blob.info = info;
+        blob.info.temp_file_path = info.temp_file_path.filename();
+        std::ifstream in(info.temp_file_path, std::ios::binary);
+        blob.bytes.assign(std::istreambuf_iterator<char>(in), {});
+        if (!in.good() && !in.eof()) {
+            return state; // don't cache a snapshot we couldn't read back
+        }
+        snapshot->push_back(std::move(blob));
+    }
+    {
+        std::lock_guard lock(snapshot_mtx);
+        if (snapshot_cache.emplace(key, std::move(snapshot)).second) {
+            snapshot_order.push_back(key);
+            while (snapshot_order.size() > snapshot_cache_capacity) {
+                snapshot_cache.erase(snapshot_order.front());
+                snapshot_order.pop_front();
+            }
+        }
+    }
+    return state;
+}
+
 //
 // reinsertion
 //
@@ -14,10 +14,14 @@
 #include "../include/event_bus.hpp"
 #include "../include/logger.hpp"
 #include "../include/log_sink.hpp"
+#include "../include/mime_detector.hpp"
+#include "../include/stats.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
 #include <thread>
-#include <algorithm>
 
 #include "events.hpp"
 #include "file_type.hpp"
@@ -37,6 +41,74 @@ public:
     }
 };
 
+/**
+ * @brief Shared state of one asynchronous run.
+ *
+ * Owns the run's private EventBus and the coordinating thread; the
+ * handle and the owning Chisel each hold a shared_ptr, so a dropped
+ * handle never tears down a run still in flight.
+ */
+struct RunHandle::State {
+    EventBus bus;                              ///< Per-run event stream
+    std::atomic<uint64_t> files_done{0};       ///< Terminal outcomes seen
+    std::atomic<uint64_t> files_total{0};      ///< Known work items
+    std::atomic<uintmax_t> bytes_saved{0};     ///< Accepted savings so far
+    std::atomic<bool> finished{false};         ///< Run fully drained
+    std::atomic<bool> stop_requested{false};   ///< Cancel before/after executor exists
+    std::atomic<ProcessorExecutor*> executor{nullptr}; ///< Live executor, if any
+    std::mutex mtx;                            ///< Guards cv waits and the callback
+    std::condition_variable cv;                ///< Signalled once on completion
+    std::function<void(const RunProgress&)> on_complete; ///< One-shot callback
+    std::jthread thread;                       ///< Joined by the owning Chisel
+
+    [[nodiscard]] RunProgress snapshot() const {
+        RunProgress p;
+        p.files_done = files_done.load(std::memory_order_relaxed);
+        p.files_total = files_total.load(std::memory_order_relaxed);
+        p.bytes_saved = bytes_saved.load(std::memory_order_relaxed);
+        p.finished = finished.load(std::memory_order_acquire);
+        return p;
+    }
+};
+
+RunHandle::RunHandle(std::shared_ptr<State> state) : state_(std::move(state)) {}
+RunHandle::~RunHandle() = default;
+RunHandle::RunHandle(RunHandle&&) noexcept = default;
+RunHandle& RunHandle::operator=(RunHandle&&) noexcept = default;
+
+void RunHandle::wait() {
+    if (!state_) return;
+    std::unique_lock lock(state_->mtx);
+    state_->cv.wait(lock, [&] { return state_->finished.load(std::memory_order_acquire); });
+}
+
+bool RunHandle::finished() const {
+    return state_ && state_->finished.load(std::memory_order_acquire);
+}
+
+RunProgress RunHandle::progress() const {
+    return state_ ? state_->snapshot() : RunProgress{};
+}
+
+void RunHandle::onComplete(std::function<void(const RunProgress&)> callback) {
+    if (!state_ || !callback) return;
+    std::unique_lock lock(state_->mtx);
+    if (!state_->finished.load(std::memory_order_acquire)) {
+        state_->on_complete = std::move(callback);
+        return;
+    }
+    lock.unlock();
+    callback(state_->snapshot());
+}
+
+void RunHandle::stop() {
+    if (!state_) return;
+    state_->stop_requested.store(true, std::memory_order_release);
+    if (auto* exec = state_->executor.load()) {
+        exec->request_stop();
+    }
+}
+
 struct Chisel::Impl {
     ProcessorRegistry registry;
     EventBus eventBus;
@@ -46,15 +118,55 @@ struct Chisel::Impl {
     bool dryRun = false;
     unsigned numThreads = std::thread::hardware_concurrency() / 2;
     EncodeMode encodeMode = EncodeMode::PIPE;
+    uintmax_t memoryBudget = 0;
+    uintmax_t tempBudget = 0;
+    uintmax_t sizeMin = 0;
+    uintmax_t sizeMax = 0;
+    bool backgroundMode = false;
+    AffinityPolicy affinityPolicy = AffinityPolicy::NONE;
+    unsigned adaptiveMin = 0;
+    unsigned adaptiveMax = 0;
+    int effortLevel = 2;
+    double pipePruneThreshold = 0.001;
     std::filesystem::path outputDir;
 
     ChiselObserver* observer = nullptr;
     std::atomic<ProcessorExecutor*> currentExecutor = nullptr;
 
+    /// @brief Constructor-bound executor settings, used to decide whether
+    /// the warm executor from the previous call can be reused as-is.
+    struct WarmConfig {
+        bool preserve = true;
+        bool verify = false;
+        bool dry = false;
+        ::EncodeMode mode = ::EncodeMode::PIPE;
+        std::filesystem::path output;
+        unsigned threads = 0;
+
+        bool operator==(const WarmConfig&) const = default;
+    };
+
+    std::unique_ptr<ProcessorExecutor> warmExecutor; ///< Reused across sync recompress calls
+    WarmConfig warmConfig;       ///< Config the warm executor was built with
+    bool eventsBridged = false;  ///< Observer subscribed to eventBus once
+    bool logBridged = false;     ///< BridgeLogSink registered once
+
+    std::mutex runsMtx;  ///< Guards activeRuns
+    std::vector<std::shared_ptr<RunHandle::State>> activeRuns; ///< In-flight async runs
+
     Impl() {
         if (numThreads == 0) numThreads = 1;
     }
 
+    // map public enum to the pool's placement enum
+    static ThreadPool::Affinity getInternalAffinity(const AffinityPolicy policy) {
+        switch (policy) {
+            case AffinityPolicy::COMPACT: return ThreadPool::Affinity::Compact;
+            case AffinityPolicy::SCATTER: return ThreadPool::Affinity::Scatter;
+            default: return ThreadPool::Affinity::None;
+        }
+    }
+
     // map public enum to internal global enum
     ::EncodeMode getInternalMode() const {
         switch (encodeMode) {
@@ -64,36 +176,78 @@ struct Chisel::Impl {
         }
     }
 
-    void setupEventBridging() {
+    void setupEventBridging() { setupEventBridging(eventBus); }
+
+    void setupEventBridging(EventBus& bus) {
         if (!observer) return;
 
-        eventBus.subscribe<FileProcessStartEvent>([this](const FileProcessStartEvent& e) {
+        bus.subscribe<FileProcessStartEvent>([this](const FileProcessStartEvent& e) {
             observer->onFileStart(e.path);
         });
 
-        eventBus.subscribe<FileProcessCompleteEvent>([this](const FileProcessCompleteEvent& e) {
+        bus.subscribe<FileProcessCompleteEvent>([this](const FileProcessCompleteEvent& e) {
             observer->onFileFinish(e.path, e.original_size, e.new_size, e.replaced);
         });
 
-        eventBus.subscribe<FileProcessErrorEvent>([this](const FileProcessErrorEvent& e) {
+        bus.subscribe<FileProcessErrorEvent>([this](const FileProcessErrorEvent& e) {
             observer->onFileError(e.path, e.error_message);
         });
 
-        eventBus.subscribe<FileProcessSkippedEvent>([this](const FileProcessSkippedEvent& e) {
+        bus.subscribe<FileProcessSkippedEvent>([this](const FileProcessSkippedEvent& e) {
             // skipped implies success but no replacement
             observer->onFileFinish(e.path, 0, 0, false);
         });
 
-        eventBus.subscribe<ContainerFinalizeErrorEvent>([this](const ContainerFinalizeErrorEvent& e) {
+        bus.subscribe<ContainerFinalizeErrorEvent>([this](const ContainerFinalizeErrorEvent& e) {
             observer->onFileError(e.path, "Container finalize error: " + e.error_message);
         });
     }
+
+    /**
+     * @brief Returns the warm executor, (re)building it only when needed.
+     *
+     * The expensive fixed costs — processor registry, thread pool, and
+     * the per-thread magic databases loaded lazily on those pool
+     * threads — are paid on the first call and amortized across every
+     * subsequent recompress(). The executor is rebuilt only when a
+     * constructor-bound setting changed or a previous run was cancelled
+     * (a stopped executor stays stopped); setter-bound settings are
+     * refreshed by the caller on every run.
+     */
+    ProcessorExecutor& warm_executor() {
+        const WarmConfig cfg{preserveMetadata, verifyChecksums, dryRun,
+                             getInternalMode(), outputDir, numThreads};
+        if (!warmExecutor || warmConfig != cfg || warmExecutor->is_stopped()) {
+            warmExecutor = std::make_unique<ProcessorExecutor>(
+                registry,
+                cfg.preserve,
+                cfg.verify,
+                static_cast<EncodeMode>(cfg.mode),
+                cfg.dry,
+                cfg.output,
+                eventBus,
+                cfg.threads
+            );
+            warmConfig = cfg;
+        }
+        return *warmExecutor;
+    }
 };
 
 Chisel::Chisel() : impl_(std::make_unique<Impl>()) {}
 
 Chisel::~Chisel() {
+    if (!impl_) return; // moved-from
     stop();
+    // async runs borrow the registry, so they must drain before it goes
+    std::vector<std::shared_ptr<RunHandle::State>> runs;
+    {
+        std::scoped_lock lock(impl_->runsMtx);
+        runs.swap(impl_->activeRuns);
+    }
+    for (const auto& run : runs) {
+        if (run->thread.joinable()) run->thread.join();
+    }
 }
 
 Chisel::Chisel(Chisel&&) noexcept = default;
@@ -120,6 +274,48 @@ Chisel& Chisel::threads(unsigned val) {
     return *this;
 }
 
+Chisel& Chisel::memoryBudget(uintmax_t bytes) {
+    impl_->memoryBudget = bytes;
+    return *this;
+}
+
+Chisel& Chisel::tempBudget(uintmax_t bytes) {
+    impl_->tempBudget = bytes;
+    return *this;
+}
+
+Chisel& Chisel::sizeWindow(uintmax_t min_bytes, uintmax_t max_bytes) {
+    impl_->sizeMin = min_bytes;
+    impl_->sizeMax = max_bytes;
+    return *this;
+}
+
+Chisel& Chisel::backgroundMode(bool val) {
+    impl_->backgroundMode = val;
+    return *this;
+}
+
+Chisel& Chisel::affinity(AffinityPolicy policy) {
+    impl_->affinityPolicy = policy;
+    return *this;
+}
+
+Chisel& Chisel::adaptiveThreads(unsigned min_threads, unsigned max_threads) {
+    impl_->adaptiveMin = min_threads;
+    impl_->adaptiveMax = max_threads;
+    return *this;
+}
+
+Chisel& Chisel::effort(int level) {
+    impl_->effortLevel = std::clamp(level, 1, 3);
+    return *this;
+}
+
+Chisel& Chisel::pipePruneThreshold(double fraction) {
+    impl_->pipePruneThreshold = fraction;
+    return *this;
+}
+
 Chisel& Chisel::mode(EncodeMode m) {
     impl_->encodeMode = m;
     return *this;
@@ -135,24 +331,34 @@ void Chisel::setObserver(ChiselObserver* observer) {
 }
 
 void Chisel::recompress(const std::vector<std::filesystem::path>& paths) {
-    impl_->setupEventBridging();
+    // bridge once: the shared eventBus outlives individual runs, so
+    // re-subscribing here would fan every event out N times by call N
+    if (!impl_->eventsBridged) {
+        impl_->setupEventBridging();
+        impl_->eventsBridged = impl_->observer != nullptr;
+    }
 
-    // inject bridge sink if observer is present
-    if (impl_->observer) {
+    // inject bridge sink if observer is present (once, same reasoning)
+    if (impl_->observer && !impl_->logBridged) {
         auto sink = std::make_unique<BridgeLogSink>(impl_->observer);
         Logger::add_sink(std::move(sink));
+        impl_->logBridged = true;
     }
 
-    ProcessorExecutor executor(
-        impl_->registry,
-        impl_->preserveMetadata,
-        impl_->verifyChecksums,
-        static_cast<EncodeMode>(impl_->getInternalMode()),
-        impl_->dryRun,
-        impl_->outputDir,
-        impl_->eventBus,
-        impl_->numThreads
-    );
+    // warm session: pool, registry and magic databases carry over from
+    // the previous call; only per-run state is fresh
+    ProcessorExecutor& executor = impl_->warm_executor();
+
+    executor.set_memory_budget(impl_->memoryBudget);
+    executor.set_temp_budget(impl_->tempBudget);
+    executor.set_size_window(impl_->sizeMin, impl_->sizeMax);
+    executor.set_effort(impl_->effortLevel);
+    executor.set_pipe_prune_threshold(impl_->pipePruneThreshold);
+    executor.set_background(impl_->backgroundMode);
+    executor.set_affinity(Impl::getInternalAffinity(impl_->affinityPolicy));
+    if (impl_->adaptiveMax > 0) {
+        executor.set_adaptive_sizing(impl_->adaptiveMin, impl_->adaptiveMax);
+    }
 
     impl_->currentExecutor.store(&executor);
 
@@ -179,11 +385,227 @@ void Chisel::recompress(const std::vector<std::string>& paths) {
     recompress(fs_paths);
 }
 
+bool Chisel::recompressBuffer(std::span<const std::byte> input,
+                              std::vector<std::byte>& output,
+                              const std::filesystem::path& name_hint) {
+    if (input.empty()) return false;
+
+    // sniff straight off the buffer; the stat-keyed verdict cache is
+    // pointless here since there is no file behind the bytes
+    const std::string mime = MimeDetector::thread_session().detect(name_hint, input);
+    auto candidates = impl_->registry.find_by_mime(mime);
+    if (candidates.empty() && !name_hint.empty()) {
+        candidates = impl_->registry.find_by_extension(name_hint.extension().string());
+    }
+    std::erase_if(candidates, [](const IProcessor* p) {
+        return !p->can_recompress_buffer();
+    });
+    if (candidates.empty()) return false;
+
+    for (auto* candidate : candidates) {
+        candidate->set_effort(impl_->effortLevel);
+    }
+
+    const bool preserve = impl_->preserveMetadata;
+    const double prune = impl_->pipePruneThreshold;
+
+    if (impl_->encodeMode == EncodeMode::PARALLEL) {
+        // each stage sees the original bytes; smallest result wins
+        std::vector<std::byte> best;
+        for (auto* candidate : candidates) {
+            std::vector<std::byte> next;
+            Stats::add_processor_call(candidate->get_name());
+            bool stage_ok = false;
+            try {
+                stage_ok = candidate->recompress_buffer(input, next, preserve) && !next.empty();
+            } catch (const std::exception& e) {
+                Logger::log(LogLevel::Warning,
+                            std::string(candidate->get_name()) + " buffer stage failed: " + e.what(),
+                            "chisel");
+            }
+            if (stage_ok && next.size() < input.size() &&
+                (best.empty() || next.size() < best.size())) {
+                best = std::move(next);
+            }
+        }
+        if (best.empty()) return false;
+        output = std::move(best);
+        return true;
+    }
+
+    // PIPE: chain through memory, same pruning rule as the executor's
+    // in-memory member pipeline
+    std::span<const std::byte> current = input;
+    std::vector<std::byte> held; // owns the latest stage output
+    bool any_stage = false;
+    double last_gain = -1.0;     // fractional gain of the previous stage (-1 = none ran yet)
+
+    for (auto* candidate : candidates) {
+        if (prune >= 0.0 && any_stage && last_gain < prune && candidate->is_expensive()) {
+            continue;
+        }
+        std::vector<std::byte> next;
+        Stats::add_processor_call(candidate->get_name());
+        bool stage_ok = false;
+        try {
+            stage_ok = candidate->recompress_buffer(current, next, preserve) && !next.empty();
+        } catch (const std::exception& e) {
+            Logger::log(LogLevel::Warning,
+                        std::string(candidate->get_name()) + " buffer stage failed: " + e.what(),
+                        "chisel");
+        }
+        if (!stage_ok) return false;
+        last_gain = current.empty() ? 0.0
+            : 1.0 - static_cast<double>(next.size()) / static_cast<double>(current.size());
+        held = std::move(next);
+        current = std::span<const std::byte>(held);
+        any_stage = true;
+    }
+
+    if (!any_stage || held.size() >= input.size()) return false;
+    output = std::move(held);
+    return true;
+}
+
+RunHandle Chisel::recompressAsync(std::vector<std::filesystem::path> paths) {
+    auto state = std::make_shared<RunHandle::State>();
+    auto* s = state.get(); // handlers live and die with the state's bus
+
+    // progress accounting mirrors what the CLI derives from the same
+    // events: totals grow as containers extract, done counts terminal
+    // outcomes, savings accumulate from accepted results
+    state->bus.subscribe<FileAnalyzeCompleteEvent>([s](const FileAnalyzeCompleteEvent& e) {
+        const uint64_t added = (e.scheduled ? 1u : 0u) + (e.extracted ? 1u : 0u);
+        if (added != 0) s->files_total.fetch_add(added, std::memory_order_relaxed);
+    });
+    state->bus.subscribe<FileProcessCompleteEvent>([s](const FileProcessCompleteEvent& e) {
+        if (e.new_size < e.original_size) {
+            s->bytes_saved.fetch_add(e.original_size - e.new_size, std::memory_order_relaxed);
+        }
+        s->files_done.fetch_add(1, std::memory_order_relaxed);
+    });
+    state->bus.subscribe<FileProcessSkippedEvent>([s](const FileProcessSkippedEvent&) {
+        s->files_done.fetch_add(1, std::memory_order_relaxed);
+    });
+    state->bus.subscribe<FileProcessErrorEvent>([s](const FileProcessErrorEvent&) {
+        s->files_done.fetch_add(1, std::memory_order_relaxed);
+    });
+    state->bus.subscribe<ContainerFinalizeCompleteEvent>([s](const ContainerFinalizeCompleteEvent&) {
+        s->files_done.fetch_add(1, std::memory_order_relaxed);
+    });
+    state->bus.subscribe<ContainerFinalizeErrorEvent>([s](const ContainerFinalizeErrorEvent&) {
+        s->files_done.fetch_add(1, std::memory_order_relaxed);
+    });
+    impl_->setupEventBridging(state->bus);
+
+    // configuration snapshot: builder changes after this call must not
+    // affect a run already in flight
+    auto* registry = &impl_->registry;
+    const bool preserve = impl_->preserveMetadata;
+    const bool verify = impl_->verifyChecksums;
+    const bool dry = impl_->dryRun;
+    const auto internalMode = impl_->getInternalMode();
+    const auto outputDir = impl_->outputDir;
+    const unsigned threads = impl_->numThreads;
+    const uintmax_t memBudget = impl_->memoryBudget;
+    const uintmax_t tmpBudget = impl_->tempBudget;
+    const uintmax_t sizeMin = impl_->sizeMin;
+    const uintmax_t sizeMax = impl_->sizeMax;
+    const bool background = impl_->backgroundMode;
+    const auto placement = Impl::getInternalAffinity(impl_->affinityPolicy);
+    const unsigned adaptiveMin = impl_->adaptiveMin;
+    const unsigned adaptiveMax = impl_->adaptiveMax;
+    const int effortLevel = impl_->effortLevel;
+    const double prune = impl_->pipePruneThreshold;
+
+    state->thread = std::jthread([state, registry, preserve, verify, dry, internalMode,
+                                  outputDir, threads, memBudget, tmpBudget, sizeMin,
+                                  sizeMax, background, placement, adaptiveMin,
+                                  adaptiveMax, effortLevel, prune,
+                                  paths = std::move(paths)] {
+        ProcessorExecutor executor(*registry, preserve, verify,
+                                   static_cast<EncodeMode>(internalMode), dry,
+                                   outputDir, state->bus, threads);
+        executor.set_memory_budget(memBudget);
+        executor.set_temp_budget(tmpBudget);
+        executor.set_size_window(sizeMin, sizeMax);
+        executor.set_effort(effortLevel);
+        executor.set_pipe_prune_threshold(prune);
+        executor.set_background(background);
+        executor.set_affinity(placement);
+        if (adaptiveMax > 0) {
+            executor.set_adaptive_sizing(adaptiveMin, adaptiveMax);
+        }
+
+        state->executor.store(&executor);
+        if (state->stop_requested.load(std::memory_order_acquire)) {
+            executor.request_stop();
+        }
+        try {
+            executor.process(paths);
+        } catch (const std::exception& e) {
+            Logger::log(LogLevel::Error,
+                        "Async run failed: " + std::string(e.what()), "chisel");
+        }
+        state->executor.store(nullptr);
+
+        std::function<void(const RunProgress&)> callback;
+        {
+            std::scoped_lock lock(state->mtx);
+            state->finished.store(true, std::memory_order_release);
+            callback = std::move(state->on_complete);
+        }
+        state->cv.notify_all();
+        if (callback) callback(state->snapshot());
+    });
+
+    {
+        std::scoped_lock lock(impl_->runsMtx);
+        // drained runs join promptly when their jthread is destroyed here
+        std::erase_if(impl_->activeRuns, [](const auto& run) {
+            return run->finished.load(std::memory_order_acquire);
+        });
+        impl_->activeRuns.push_back(state);
+    }
+    return RunHandle(std::move(state));
+}
+
 void Chisel::stop() {
     auto* exec = impl_->currentExecutor.load();
     if (exec) {
         exec->request_stop();
     }
+    std::scoped_lock lock(impl_->runsMtx);
+    for (const auto& run : impl_->activeRuns) {
+        run->stop_requested.store(true, std::memory_order_release);
+        if (auto* async_exec = run->executor.load()) {
+            async_exec->request_stop();
+        }
+    }
+}
+
+void Chisel::pause() {
+    if (auto* exec = impl_->currentExecutor.load()) {
+        exec->pause();
+    }
+    std::scoped_lock lock(impl_->runsMtx);
+    for (const auto& run : impl_->activeRuns) {
+        if (auto* async_exec = run->executor.load()) {
+            async_exec->pause();
+        }
+    }
+}
+
+void Chisel::resume() {
+    if (auto* exec = impl_->currentExecutor.load()) {
+        exec->resume();
+    }
+    std::scoped_lock lock(impl_->runsMtx);
+    for (const auto& run : impl_->activeRuns) {
+        if (auto* async_exec = run->executor.load()) {
+            async_exec->resume();
+        }
+    }
 }
 
 } // namespace chisel
\ No newline at end of file
@@ -0,0 +1,40 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+#include "../../include/core_budget.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace chisel {
+
+namespace {
+
+std::atomic<int>& budget() {
+    static std::atomic<int> cores{static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))};
+    return cores;
+}
+
+} // namespace
+
+int CoreBudget::borrow(const int want) {
+    if (want <= 0) return 0;
+    auto& cores = budget();
+    int cur = cores.load(std::memory_order_relaxed);
+    while (cur > 0) {
+        const int take = std::min(want, cur);
+        if (cores.compare_exchange_weak(cur, cur - take, std::memory_order_relaxed)) {
+            return take;
+        }
+    }
+    return 0;
+}
+
+void CoreBudget::release(const int taken) {
+    if (taken > 0) {
+        budget().fetch_add(taken, std::memory_order_relaxed);
+    }
+}
+
+} // namespace chisel
@@ -4,12 +4,77 @@
 
 #include <filesystem>
 #include "../../include/file_utils.hpp"
+#include "../../include/io_engine.hpp"
 #include "../../include/logger.hpp"
 #include "../../include/random_utils.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
 #include <system_error>
+#include <thread>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+
+#ifdef __APPLE__
+#include <sys/clonefile.h>
+#endif
+
+namespace {
+    // Process-wide token bucket for the reading helpers. Readers reserve
+    // a time slot proportional to the bytes they consumed and sleep until
+    // it arrives, so the aggregate rate converges on the configured cap
+    // without any per-thread state.
+    std::atomic<uintmax_t> read_rate_limit{0}; ///< Bytes per second, 0 = off
+    std::mutex throttle_mtx;                   ///< Guards next_read_slot
+    std::chrono::steady_clock::time_point next_read_slot{};
+
+    void throttle_read(const std::size_t bytes) {
+        const auto rate = read_rate_limit.load(std::memory_order_relaxed);
+        if (rate == 0 || bytes == 0) return;
+
+        const auto cost = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(bytes) / static_cast<double>(rate)));
+
+        std::chrono::steady_clock::time_point wake;
+        {
+            std::lock_guard lock(throttle_mtx);
+            const auto now = std::chrono::steady_clock::now();
+            if (next_read_slot < now) next_read_slot = now; // idle bucket: no stale debt
+            wake = next_read_slot;
+            next_read_slot += cost;
+        }
+        std::this_thread::sleep_until(wake);
+    }
+}
 
 namespace chisel {
 
+    void set_read_throttle(const uintmax_t bytes_per_second) {
+        read_rate_limit.store(bytes_per_second, std::memory_order_relaxed);
+    }
+
     FILE* open_file(const std::filesystem::path& path, const char* mode) {
 #ifdef _WIN32
         // On Windows, convert mode to wstring and use _wfopen, which accepts
@@ -53,6 +118,346 @@ namespace chisel {
         return dir;
     }
 
+    std::filesystem::path make_sibling_temp(const std::filesystem::path& target,
+                                            const std::string& label) {
+        return target.parent_path() /
+            (".chisel-tmp." + target.filename().string() + "." + label + "." + RandomUtils::random_suffix());
+    }
+
+    bool clone_or_copy_file(const std::filesystem::path& src, const std::filesystem::path& dst) {
+#ifdef __linux__
+        const int in = ::open(src.string().c_str(), O_RDONLY);
+        if (in >= 0) {
+            const int out = ::open(dst.string().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+            if (out >= 0) {
+#ifdef FICLONE
+                // reflink: shares extents on XFS/btrfs, finishing at
+                // metadata speed without touching the data at all
+                if (ioctl(out, FICLONE, in) == 0) {
+                    ::close(out);
+                    ::close(in);
+                    return true;
+                }
+#endif
+                // in-kernel copy: no userspace bounce buffer, and still a
+                // server-side copy on NFS
+                bool used = false;
+                bool ok = true;
+                for (;;) {
+                    const ssize_t n = copy_file_range(in, nullptr, out, nullptr, 1 << 30, 0);
+                    if (n < 0) {
+                        ok = false;
+                        break;
+                    }
+                    if (n == 0) break;
+                    used = true;
+                }
+                ::close(out);
+                ::close(in);
+                if (ok) return true;
+                if (used) {
+                    // partial copy: scrap it and let the fallback rewrite
+                    std::error_code ec;
+                    std::filesystem::remove(dst, ec);
+                }
+            } else {
+                ::close(in);
+            }
+        }
+#elif defined(__APPLE__)
+        {
+            // clonefile refuses to overwrite, so clear the target first
+            std::error_code ec;
+            std::filesystem::remove(dst, ec);
+            if (clonefile(src.string().c_str(), dst.string().c_str(), 0) == 0) {
+                return true;
+            }
+        }
+#endif
+        std::error_code ec;
+        std::filesystem::copy_file(src, dst, std::filesystem::copy_options::overwrite_existing, ec);
+        if (ec) {
+            Logger::log(LogLevel::Warning,
+                "Copy failed: " + src.string() + " -> " + dst.string() + " (" + ec.message() + ")",
+                "file_utils");
+            return false;
+        }
+        return true;
+    }
+
+    bool read_file(const std::filesystem::path& path, std::vector<std::byte>& out) {
+        // slurps go through the I/O engine (io_uring when built in, a
+        // buffered read otherwise); the throttle paces whichever backend ran
+        if (!io::read_whole(path, out)) return false;
+        throttle_read(out.size());
+        return true;
+    }
+
+    bool write_file(const std::filesystem::path& path, const std::span<const std::byte> data) {
+        return io::write_whole(path, data);
+    }
+
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+#ifdef _WIN32
+        // match open_file(): absolute path plus the \\?\ prefix so long
+        // paths and Unicode names map fine
+        std::error_code ec;
+        auto abs_path = std::filesystem::absolute(path, ec);
+        const std::wstring long_path = L"\\\\?\\" + (ec ? path : abs_path).wstring();
+
+        HANDLE file = CreateFileW(long_path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                                  nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            Logger::log(LogLevel::Warning, "MappedFile: cannot open " + path.string(), "file_utils");
+            return;
+        }
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size)) {
+            CloseHandle(file);
+            Logger::log(LogLevel::Warning, "MappedFile: cannot stat " + path.string(), "file_utils");
+            return;
+        }
+
+        if (file_size.QuadPart == 0) {
+            // CreateFileMapping rejects empty files; an empty view is fine
+            CloseHandle(file);
+            open_ = true;
+            return;
+        }
+
+        mapping_ = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file); // the mapping object keeps the file alive
+        if (mapping_ == nullptr) {
+            Logger::log(LogLevel::Warning, "MappedFile: CreateFileMapping failed for " + path.string(), "file_utils");
+            return;
+        }
+
+        data_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+        if (data_ == nullptr) {
+            CloseHandle(mapping_);
+            mapping_ = nullptr;
+            Logger::log(LogLevel::Warning, "MappedFile: MapViewOfFile failed for " + path.string(), "file_utils");
+            return;
+        }
+        size_ = static_cast<std::size_t>(file_size.QuadPart);
+        open_ = true;
+#else
+        const int fd = ::open(path.string().c_str(), O_RDONLY);
+        if (fd < 0) {
+            Logger::log(LogLevel::Warning, "MappedFile: cannot open " + path.string(), "file_utils");
+            return;
+        }
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            Logger::log(LogLevel::Warning, "MappedFile: cannot stat " + path.string(), "file_utils");
+            return;
+        }
+
+        if (st.st_size == 0) {
+            ::close(fd);
+            open_ = true;
+            return;
+        }
+
+        void* addr = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // the mapping keeps the file alive
+        if (addr == MAP_FAILED) {
+            Logger::log(LogLevel::Warning, "MappedFile: mmap failed for " + path.string(), "file_utils");
+            return;
+        }
+        data_ = addr;
+        size_ = static_cast<std::size_t>(st.st_size);
+        open_ = true;
+#endif
+    }
+
+    void MappedFile::close() {
+        if (data_ != nullptr) {
+#ifdef _WIN32
+            UnmapViewOfFile(data_);
+            if (mapping_ != nullptr) {
+                CloseHandle(mapping_);
+                mapping_ = nullptr;
+            }
+#else
+            munmap(data_, size_);
+#endif
+        }
+        data_ = nullptr;
+        size_ = 0;
+        open_ = false;
+    }
+
+    MappedFile::~MappedFile() {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : data_(other.data_), size_(other.size_), open_(other.open_)
+#ifdef _WIN32
+        , mapping_(other.mapping_)
+#endif
+    {
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.open_ = false;
+#ifdef _WIN32
+        other.mapping_ = nullptr;
+#endif
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            data_ = other.data_;
+            size_ = other.size_;
+            open_ = other.open_;
+            other.data_ = nullptr;
+            other.size_ = 0;
+            other.open_ = false;
+#ifdef _WIN32
+            mapping_ = other.mapping_;
+            other.mapping_ = nullptr;
+#endif
+        }
+        return *this;
+    }
+
+#if !defined(__SSE4_2__) && !defined(__ARM_FEATURE_CRC32)
+    namespace {
+        // software fallback: standard CRC32C (Castagnoli) byte table
+        const std::array<uint32_t, 256>& crc32c_table() {
+            static const auto table = [] {
+                std::array<uint32_t, 256> t{};
+                for (uint32_t i = 0; i < 256; ++i) {
+                    uint32_t c = i;
+                    for (int k = 0; k < 8; ++k) {
+                        c = (c & 1u) ? 0x82F63B78u ^ (c >> 1) : c >> 1;
+                    }
+                    t[i] = c;
+                }
+                return t;
+            }();
+            return table;
+        }
+    }
+#endif
+
+    void StreamingChecksum::update(const void* data, std::size_t len) {
+        const auto* p = static_cast<const unsigned char*>(data);
+        uint32_t crc = crc_;
+#if defined(__SSE4_2__)
+        while (len >= 8) {
+            uint64_t chunk;
+            std::memcpy(&chunk, p, sizeof(chunk));
+            crc = static_cast<uint32_t>(_mm_crc32_u64(crc, chunk));
+            p += 8;
+            len -= 8;
+        }
+        while (len-- > 0) {
+            crc = _mm_crc32_u8(crc, *p++);
+        }
+#elif defined(__ARM_FEATURE_CRC32)
+        while (len >= 8) {
+            uint64_t chunk;
+            std::memcpy(&chunk, p, sizeof(chunk));
+            crc = __crc32cd(crc, chunk);
+            p += 8;
+            len -= 8;
+        }
+        while (len-- > 0) {
+            crc = __crc32cb(crc, *p++);
+        }
+#else
+        const auto& table = crc32c_table();
+        while (len-- > 0) {
+            crc = table[(crc ^ *p++) & 0xFFu] ^ (crc >> 8);
+        }
+#endif
+        crc_ = crc;
+    }
+
+    std::string StreamingChecksum::hex() const {
+        std::ostringstream oss;
+        oss << std::hex << std::setw(8) << std::setfill('0') << value();
+        return oss.str();
+    }
+
+    std::string checksum_file(const std::filesystem::path& path) {
+        FILE* f = open_file(path, "rb");
+        if (f == nullptr) {
+            Logger::log(LogLevel::Warning, "checksum_file: cannot open " + path.string(), "file_utils");
+            return "";
+        }
+
+        StreamingChecksum sum;
+        // large blocks keep the hash loop fed and the syscall count low
+        static constexpr std::size_t block_size = 1 << 20;
+        std::vector<unsigned char> block(block_size);
+        size_t read;
+        while ((read = std::fread(block.data(), 1, block.size(), f)) > 0) {
+            sum.update(block.data(), read);
+            throttle_read(read);
+        }
+        const bool ok = std::ferror(f) == 0;
+        std::fclose(f);
+        if (!ok) {
+            Logger::log(LogLevel::Warning, "checksum_file: read error on " + path.string(), "file_utils");
+            return "";
+        }
+        return sum.hex();
+    }
+
+    bool raw_equal_files(const std::filesystem::path& a, const std::filesystem::path& b) {
+        // a size mismatch settles it before any byte is read
+        std::error_code ec;
+        const auto size_a = std::filesystem::file_size(a, ec);
+        if (ec) return false;
+        const auto size_b = std::filesystem::file_size(b, ec);
+        if (ec || size_a != size_b) return false;
+        if (size_a == 0) return true;
+
+        static constexpr std::size_t block_size = 1 << 20;
+
+        const MappedFile map_a(a);
+        const MappedFile map_b(b);
+        if (map_a.is_open() && map_b.is_open()) {
+            if (map_a.size() != map_b.size()) return false; // raced a rewrite
+            // block-wise so a mismatch stops after one block instead of
+            // faulting in the rest of both mappings
+            for (std::size_t off = 0; off < map_a.size(); off += block_size) {
+                const std::size_t len = std::min(block_size, map_a.size() - off);
+                if (std::memcmp(map_a.data() + off, map_b.data() + off, len) != 0) return false;
+            }
+            return true;
+        }
+
+        // mapping failed (special filesystems): same early-exit compare, buffered
+        FILE* f_a = open_file(a, "rb");
+        FILE* f_b = open_file(b, "rb");
+        bool equal = f_a != nullptr && f_b != nullptr;
+        if (equal) {
+            std::vector<unsigned char> block_a(block_size);
+            std::vector<unsigned char> block_b(block_size);
+            while (equal) {
+                const std::size_t read_a = std::fread(block_a.data(), 1, block_size, f_a);
+                const std::size_t read_b = std::fread(block_b.data(), 1, block_size, f_b);
+                if (read_a != read_b || std::ferror(f_a) != 0 || std::ferror(f_b) != 0) {
+                    equal = false;
+                    break;
+                }
+                if (read_a == 0) break; // both at EOF
+                equal = std::memcmp(block_a.data(), block_b.data(), read_a) == 0;
+            }
+        }
+        if (f_a != nullptr) std::fclose(f_a);
+        if (f_b != nullptr) std::fclose(f_b);
+        return equal;
+    }
+
     void cleanup_temp_dir(const std::filesystem::path& dir, const std::string_view tag) {
         std::error_code ec;
         std::filesystem::remove_all(dir, ec);
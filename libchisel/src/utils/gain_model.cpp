@@ -0,0 +1,150 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+#include "../../include/gain_model.hpp"
+#include "../../include/logger.hpp"
+#include <sqlite3.h>
+#include <bit>
+
+namespace chisel {
+
+namespace {
+    constexpr auto create_schema_sql =
+        "CREATE TABLE IF NOT EXISTS stage_stats ("
+        "  processor TEXT NOT NULL,"
+        "  mime TEXT NOT NULL,"
+        "  size_bucket INTEGER NOT NULL,"
+        "  version TEXT NOT NULL,"
+        "  invocations INTEGER NOT NULL,"
+        "  bytes_in INTEGER NOT NULL,"
+        "  bytes_out INTEGER NOT NULL,"
+        "  millis INTEGER NOT NULL,"
+        "  PRIMARY KEY (processor, mime, size_bucket, version)"
+        ");";
+
+    constexpr auto record_sql =
+        "INSERT INTO stage_stats"
+        " (processor, mime, size_bucket, version, invocations, bytes_in, bytes_out, millis)"
+        " VALUES (?1, ?2, ?3, ?4, 1, ?5, ?6, ?7)"
+        " ON CONFLICT (processor, mime, size_bucket, version) DO UPDATE SET"
+        "  invocations = invocations + 1,"
+        "  bytes_in = bytes_in + excluded.bytes_in,"
+        "  bytes_out = bytes_out + excluded.bytes_out,"
+        "  millis = millis + excluded.millis;";
+
+    constexpr auto expect_sql =
+        "SELECT invocations, bytes_in, bytes_out, millis FROM stage_stats"
+        " WHERE processor = ?1 AND mime = ?2 AND size_bucket = ?3 AND version = ?4;";
+}
+
+GainModel::GainModel(const std::filesystem::path& db_path, std::string version)
+    : version_(std::move(version)) {
+    int rc = sqlite3_open_v2(db_path.string().c_str(), &db_,
+                             SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+    if (rc != SQLITE_OK) {
+        Logger::log(LogLevel::Warning,
+                    "Gain model disabled, cannot open: " + db_path.string() +
+                    " (" + (db_ ? sqlite3_errmsg(db_) : "out of memory") + ")",
+                    "gain_model");
+        if (db_) sqlite3_close(db_);
+        db_ = nullptr;
+        return;
+    }
+
+    // WAL keeps concurrent worker writes from serializing on fsyncs
+    sqlite3_exec(db_, "PRAGMA journal_mode=WAL;", nullptr, nullptr, nullptr);
+    sqlite3_exec(db_, "PRAGMA synchronous=NORMAL;", nullptr, nullptr, nullptr);
+
+    char* err = nullptr;
+    rc = sqlite3_exec(db_, create_schema_sql, nullptr, nullptr, &err);
+    if (rc != SQLITE_OK) {
+        Logger::log(LogLevel::Warning,
+                    "Gain model disabled, schema error: " + std::string(err ? err : "unknown"),
+                    "gain_model");
+        sqlite3_free(err);
+        sqlite3_close(db_);
+        db_ = nullptr;
+        return;
+    }
+
+    if (sqlite3_prepare_v2(db_, record_sql, -1, &record_stmt_, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db_, expect_sql, -1, &expect_stmt_, nullptr) != SQLITE_OK) {
+        Logger::log(LogLevel::Warning,
+                    "Gain model disabled, prepare error: " + std::string(sqlite3_errmsg(db_)),
+                    "gain_model");
+        if (record_stmt_) sqlite3_finalize(record_stmt_);
+        if (expect_stmt_) sqlite3_finalize(expect_stmt_);
+        record_stmt_ = nullptr;
+        expect_stmt_ = nullptr;
+        sqlite3_close(db_);
+        db_ = nullptr;
+    }
+}
+
+GainModel::~GainModel() {
+    if (record_stmt_) sqlite3_finalize(record_stmt_);
+    if (expect_stmt_) sqlite3_finalize(expect_stmt_);
+    if (db_) sqlite3_close(db_);
+}
+
+int GainModel::size_bucket(const uintmax_t bytes) noexcept {
+    return bytes == 0 ? 0 : std::bit_width(bytes);
+}
+
+void GainModel::record(const std::string_view processor,
+                       const std::string& mime,
+                       const uintmax_t input_bytes,
+                       const uintmax_t output_bytes,
+                       const std::chrono::milliseconds elapsed) {
+    if (db_ == nullptr) return;
+
+    std::lock_guard lock(mtx_);
+    sqlite3_reset(record_stmt_);
+    sqlite3_bind_text(record_stmt_, 1, processor.data(), static_cast<int>(processor.size()), SQLITE_TRANSIENT);
+    sqlite3_bind_text(record_stmt_, 2, mime.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(record_stmt_, 3, size_bucket(input_bytes));
+    sqlite3_bind_text(record_stmt_, 4, version_.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(record_stmt_, 5, static_cast<sqlite3_int64>(input_bytes));
+    sqlite3_bind_int64(record_stmt_, 6, static_cast<sqlite3_int64>(output_bytes));
+    sqlite3_bind_int64(record_stmt_, 7, static_cast<sqlite3_int64>(elapsed.count()));
+
+    if (sqlite3_step(record_stmt_) != SQLITE_DONE) {
+        Logger::log(LogLevel::Debug,
+                    [this] { return "Gain model record failed: " + std::string(sqlite3_errmsg(db_)); },
+                    "gain_model");
+    }
+}
+
+std::optional<GainModel::Expectation> GainModel::expect(const std::string_view processor,
+                                                        const std::string& mime,
+                                                        const uintmax_t input_bytes) {
+    if (db_ == nullptr) return std::nullopt;
+
+    std::lock_guard lock(mtx_);
+    sqlite3_reset(expect_stmt_);
+    sqlite3_bind_text(expect_stmt_, 1, processor.data(), static_cast<int>(processor.size()), SQLITE_TRANSIENT);
+    sqlite3_bind_text(expect_stmt_, 2, mime.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(expect_stmt_, 3, size_bucket(input_bytes));
+    sqlite3_bind_text(expect_stmt_, 4, version_.c_str(), -1, SQLITE_TRANSIENT);
+
+    if (sqlite3_step(expect_stmt_) != SQLITE_ROW) {
+        return std::nullopt;
+    }
+
+    const auto invocations = sqlite3_column_int64(expect_stmt_, 0);
+    const auto bytes_in = sqlite3_column_int64(expect_stmt_, 1);
+    const auto bytes_out = sqlite3_column_int64(expect_stmt_, 2);
+    const auto millis = sqlite3_column_int64(expect_stmt_, 3);
+    if (invocations < min_samples || bytes_in <= 0) {
+        return std::nullopt;
+    }
+
+    Expectation exp{};
+    exp.gain = 1.0 - static_cast<double>(bytes_out) / static_cast<double>(bytes_in);
+    exp.millis_per_mib = static_cast<double>(millis) /
+                         (static_cast<double>(bytes_in) / static_cast<double>(1 << 20));
+    return exp;
+}
+
+} // namespace chisel
@@ -7,26 +7,123 @@
 
 std::vector<std::unique_ptr<ILogSink>> Logger::sinks_;
 std::mutex Logger::mtx_;
+std::deque<Logger::LogRecord> Logger::queue_;
+std::mutex Logger::queue_mtx_;
+std::condition_variable_any Logger::queue_cv_;
+std::condition_variable Logger::drained_cv_;
+std::atomic<bool> Logger::async_{false};
+bool Logger::in_flight_ = false;
+size_t Logger::dropped_ = 0;
+std::jthread Logger::drain_thread_;
+std::atomic<unsigned> Logger::enabled_mask_{0};
+
+void Logger::refresh_enabled_mask() {
+    unsigned mask = 0;
+    for (const auto& sink : sinks_) {
+        if (!sink) continue;
+        for (const auto level : {LogLevel::Debug, LogLevel::Info, LogLevel::Warning, LogLevel::Error}) {
+            if (sink->accepts(level)) {
+                mask |= 1u << static_cast<unsigned>(level);
+            }
+        }
+    }
+    enabled_mask_.store(mask, std::memory_order_relaxed);
+}
 
 void Logger::add_sink(std::unique_ptr<ILogSink> sink) {
     std::lock_guard lock(mtx_);
     if (sink) {
         sinks_.push_back(std::move(sink));
     }
+    refresh_enabled_mask();
 }
 
 void Logger::clear_sinks() {
+    flush();
     std::lock_guard lock(mtx_);
     sinks_.clear();
+    refresh_enabled_mask();
 }
 
 void Logger::log(const LogLevel level,
                   const std::string_view msg,
                   const std::string_view tag) {
+    if (async_.load(std::memory_order_relaxed)) {
+        // Producers only touch the in-memory queue; sink I/O happens on
+        // the drain thread. A full queue drops the oldest record rather
+        // than stalling a worker.
+        {
+            std::lock_guard lock(queue_mtx_);
+            if (queue_.size() >= max_queue_length) {
+                queue_.pop_front();
+                ++dropped_;
+            }
+            queue_.push_back(LogRecord{level, std::string(msg), std::string(tag)});
+        }
+        queue_cv_.notify_one();
+        return;
+    }
+
     std::lock_guard lock(mtx_);
     for (const auto& sink : sinks_) {
         if (sink) {
             sink->log(level, msg, tag);
         }
     }
-}
\ No newline at end of file
+}
+
+void Logger::write_records(const std::deque<LogRecord>& records) {
+    std::lock_guard lock(mtx_);
+    for (const auto& record : records) {
+        for (const auto& sink : sinks_) {
+            if (sink) {
+                sink->log(record.level, record.msg, record.tag);
+            }
+        }
+    }
+}
+
+void Logger::drain_loop(const std::stop_token& st) {
+    for (;;) {
+        std::deque<LogRecord> batch;
+        {
+            std::unique_lock lock(queue_mtx_);
+            queue_cv_.wait(lock, st, [] { return !queue_.empty(); });
+            if (queue_.empty()) break; // stop requested and nothing left
+            batch.swap(queue_);
+            if (dropped_ > 0) {
+                batch.push_back(LogRecord{LogLevel::Warning,
+                                          std::to_string(dropped_) + " log record(s) dropped (queue full)",
+                                          "Logger"});
+                dropped_ = 0;
+            }
+            in_flight_ = true;
+        }
+
+        write_records(batch);
+
+        {
+            std::lock_guard lock(queue_mtx_);
+            in_flight_ = false;
+        }
+        drained_cv_.notify_all();
+    }
+}
+
+void Logger::flush() {
+    if (!async_.load(std::memory_order_relaxed)) return;
+    std::unique_lock lock(queue_mtx_);
+    drained_cv_.wait(lock, [] { return queue_.empty() && !in_flight_; });
+}
+
+void Logger::set_async(const bool enabled) {
+    if (enabled == async_.load(std::memory_order_relaxed)) return;
+    if (enabled) {
+        async_.store(true, std::memory_order_relaxed);
+        drain_thread_ = std::jthread(drain_loop);
+    } else {
+        flush();
+        async_.store(false, std::memory_order_relaxed);
+        drain_thread_ = {}; // requests stop and joins
+    }
+}
@@ -9,26 +9,181 @@
 #include "../../include/file_type.hpp"
 #include "../../include/logger.hpp"
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
-#include <cstdlib>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
 #include <vector>
+#include <sys/stat.h>
+#include <sys/types.h>
 #include <zlib.h>
 
-std::string chisel::MimeDetector::detect(const std::filesystem::path& path)
+#ifndef _WIN32
+std::vector<unsigned char> decompress_gzip(const unsigned char* data, size_t len);
+
+namespace
+{
+    /**
+     * @brief Returns the embedded magic database, decompressed once per process.
+     *
+     * An empty vector means decompression failed and callers should fall
+     * back to the on-disk database.
+     */
+    const std::vector<unsigned char>& embedded_magic_database()
+    {
+        static const std::vector<unsigned char> db = []() -> std::vector<unsigned char> {
+            try
+            {
+                return decompress_gzip(embedded_magic_mgc, embedded_magic_mgc_len);
+            }
+            catch (const std::exception& e)
+            {
+                Logger::log(LogLevel::Warning,
+                            "Failed to decompress embedded magic database: " + std::string(e.what()),
+                            "libmagic");
+                return {};
+            }
+        }();
+        return db;
+    }
+} // namespace
+#endif
+
+namespace
+{
+    /// Identity of one file's bytes on disk, from a single stat.
+    struct StatIdentity
+    {
+        uint64_t dev = 0;
+        uint64_t ino = 0;
+        int64_t mtime = 0;
+        uint64_t size = 0;
+
+        bool operator==(const StatIdentity&) const = default;
+    };
+
+    struct StatIdentityHash
+    {
+        size_t operator()(const StatIdentity& k) const noexcept
+        {
+            uint64_t h = k.dev * 0x9E3779B97F4A7C15ull;
+            h ^= k.ino + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+            h ^= static_cast<uint64_t>(k.mtime) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+            h ^= k.size + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+            return static_cast<size_t>(h);
+        }
+    };
+
+    bool stat_identity(const std::filesystem::path& path, StatIdentity& out)
+    {
+#ifdef _WIN32
+        struct _stat64 st{};
+        if (_wstat64(path.c_str(), &st) != 0) return false;
+#else
+        struct stat st{};
+        if (::stat(path.c_str(), &st) != 0) return false;
+#endif
+        out.dev = static_cast<uint64_t>(st.st_dev);
+        out.ino = static_cast<uint64_t>(st.st_ino);
+        out.mtime = static_cast<int64_t>(st.st_mtime);
+        out.size = static_cast<uint64_t>(st.st_size);
+        return true;
+    }
+
+    /**
+     * @brief Process-wide MIME verdict cache keyed on stat identity.
+     *
+     * The same path is detected in analyze_path(), again in the report
+     * handlers, and once more at container finalization; keying on
+     * (device, inode, mtime, size) makes the repeats cost one stat
+     * instead of an open+read+magic pass, and a rewritten file gets a
+     * new inode or mtime so stale verdicts can never be returned.
+     * Sharded so workers and report handlers don't contend on one lock.
+     */
+    constexpr size_t mime_cache_shards = 16;
+
+    struct MimeCacheShard
+    {
+        std::shared_mutex mtx;
+        std::unordered_map<StatIdentity, std::string, StatIdentityHash> entries;
+    };
+
+    MimeCacheShard& shard_for(const StatIdentity& key)
+    {
+        static std::array<MimeCacheShard, mime_cache_shards> shards;
+        return shards[StatIdentityHash{}(key) % mime_cache_shards];
+    }
+
+    std::optional<std::string> mime_cache_lookup(const StatIdentity& key)
+    {
+        auto& shard = shard_for(key);
+        std::shared_lock lock(shard.mtx);
+        if (const auto it = shard.entries.find(key); it != shard.entries.end())
+        {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    void mime_cache_store(const StatIdentity& key, const std::string& mime)
+    {
+        auto& shard = shard_for(key);
+        std::unique_lock lock(shard.mtx);
+        shard.entries.emplace(key, mime);
+    }
+} // namespace
+
+chisel::MimeDetector::Session::Session()
 {
 #ifndef _WIN32
-    const magic_t magic = magic_open(MAGIC_MIME_TYPE | MAGIC_ERROR);
-    if (magic == nullptr) return {};
-    if (magic_load(magic, nullptr) != 0)
+    magic_ = magic_open(MAGIC_MIME_TYPE | MAGIC_ERROR);
+    if (magic_ == nullptr) return;
+
+    // Prefer loading the compiled database straight from the in-binary
+    // buffer: no disk round trip, and fresh containers skip the
+    // extract-to-data-dir cold start entirely.
+    bool loaded = false;
+    if (const auto& db = embedded_magic_database(); !db.empty())
+    {
+        void* buffers[] = {const_cast<unsigned char*>(db.data())};
+        size_t sizes[] = {db.size()};
+        loaded = magic_load_buffers(magic_, buffers, sizes, 1) == 0;
+        if (!loaded)
+        {
+            Logger::log(LogLevel::Warning,
+                        "magic_load_buffers failed, falling back to on-disk database", "libmagic");
+        }
+    }
+
+    // Fallback: the database extracted by ensure_magic_installed()
+    // (or whatever the MAGIC environment variable points at).
+    if (!loaded && magic_load(magic_, nullptr) != 0)
     {
-        magic_close(magic);
-        return {};
+        Logger::log(LogLevel::Warning, "magic_load failed, MIME detection disabled for this thread", "libmagic");
+        magic_close(magic_);
+        magic_ = nullptr;
     }
-    const char* mime = magic_file(magic, path.string().c_str());
-    std::string result = (mime != nullptr) ? mime : "";
-    magic_close(magic);
-    return result;
+#endif
+}
+
+chisel::MimeDetector::Session::~Session()
+{
+#ifndef _WIN32
+    if (magic_ != nullptr) magic_close(magic_);
+#endif
+}
+
+std::string chisel::MimeDetector::Session::detect(const std::filesystem::path& path) const
+{
+#ifndef _WIN32
+    if (magic_ == nullptr) return {};
+    const char* mime = magic_file(magic_, path.string().c_str());
+    return (mime != nullptr) ? mime : "";
 #else
     auto ext = path.extension().string();
     std::ranges::transform(ext, ext.begin(), ::tolower);
@@ -37,36 +192,102 @@ std::string chisel::MimeDetector::detect(const std::filesystem::path& path)
 #endif
 }
 
-bool chisel::MimeDetector::is_mpeg1_layer3(const std::filesystem::path& path)
+std::string chisel::MimeDetector::Session::detect(const std::filesystem::path& path,
+                                                  const std::span<const std::byte> header) const
 {
 #ifndef _WIN32
-    const magic_t magic = magic_open(MAGIC_MIME_TYPE | MAGIC_ERROR);
-    if (magic == nullptr) return false;
-    if (magic_load(magic, nullptr) != 0)
-    {
-        magic_close(magic);
-        return false;
-    }
-    const char* desc = magic_file(magic, path.string().c_str());
-    bool ok = false;
-    if (desc != nullptr)
-    {
-        std::string s(desc);
-        if (s.find("MPEG") != std::string::npos &&
-            s.find("layer III") != std::string::npos &&
-            (s.find("v1") != std::string::npos || s.find("version 1") != std::string::npos))
-        {
-            ok = true;
-        }
-    }
-    magic_close(magic);
-    return ok;
+    if (magic_ == nullptr || header.empty()) return {};
+    const char* mime = magic_buffer(magic_, header.data(), header.size());
+    return (mime != nullptr) ? mime : "";
+#else
+    (void)header;
+    return detect(path);
+#endif
+}
+
+bool chisel::MimeDetector::Session::is_mpeg1_layer3(const std::filesystem::path& path) const
+{
+#ifndef _WIN32
+    if (magic_ == nullptr) return false;
+    const char* desc = magic_file(magic_, path.string().c_str());
+    if (desc == nullptr) return false;
+    const std::string s(desc);
+    return s.find("MPEG") != std::string::npos &&
+        s.find("layer III") != std::string::npos &&
+        (s.find("v1") != std::string::npos || s.find("version 1") != std::string::npos);
 #else
     // fallback: only check .mp3 extension
     return path.extension() == ".mp3";
 #endif
 }
 
+bool chisel::MimeDetector::Session::is_mpeg1_layer3(const std::filesystem::path& path,
+                                                    const std::span<const std::byte> header) const
+{
+#ifndef _WIN32
+    if (magic_ == nullptr || header.empty()) return false;
+    const char* desc = magic_buffer(magic_, header.data(), header.size());
+    if (desc == nullptr) return false;
+    const std::string s(desc);
+    return s.find("MPEG") != std::string::npos &&
+        s.find("layer III") != std::string::npos &&
+        (s.find("v1") != std::string::npos || s.find("version 1") != std::string::npos);
+#else
+    (void)header;
+    return is_mpeg1_layer3(path);
+#endif
+}
+
+chisel::MimeDetector::Session& chisel::MimeDetector::thread_session()
+{
+    // One session per thread: the magic database is loaded once per worker
+    // and the handle reused for every detection on that thread.
+    thread_local Session session;
+    return session;
+}
+
+std::string chisel::MimeDetector::detect(const std::filesystem::path& path)
+{
+    StatIdentity key;
+    const bool have_key = stat_identity(path, key);
+    if (have_key)
+    {
+        if (auto cached = mime_cache_lookup(key)) return *cached;
+    }
+    auto mime = thread_session().detect(path);
+    if (have_key) mime_cache_store(key, mime);
+    return mime;
+}
+
+std::string chisel::MimeDetector::detect(const std::filesystem::path& path,
+                                         const std::span<const std::byte> header)
+{
+    StatIdentity key;
+    const bool have_key = stat_identity(path, key);
+    if (have_key)
+    {
+        if (auto cached = mime_cache_lookup(key)) return *cached;
+    }
+    auto mime = thread_session().detect(path, header);
+    if (have_key) mime_cache_store(key, mime);
+    return mime;
+}
+
+bool chisel::MimeDetector::is_mpeg1_layer3(const std::filesystem::path& path)
+{
+    return thread_session().is_mpeg1_layer3(path);
+}
+
+std::vector<std::byte> chisel::MimeDetector::read_header(const std::filesystem::path& path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) return {};
+    std::vector<std::byte> buf(sniff_length);
+    ifs.read(reinterpret_cast<char*>(buf.data()), static_cast<std::streamsize>(buf.size()));
+    buf.resize(static_cast<size_t>(ifs.gcount()));
+    return buf;
+}
+
 /**
  * @brief Decompresses a Gzip buffer into a vector of bytes.
  * @param data Pointer to the compressed Gzip data.
@@ -130,6 +351,16 @@ void chisel::MimeDetector::ensure_magic_installed()
 {
 #ifndef _WIN32
     const auto target = get_magic_file_path();
+
+    // Sessions load the embedded database straight from memory, so the
+    // on-disk copy is only a fallback: keep an existing one usable via
+    // MAGIC, but don't pay the extraction cost on a cold start.
+    if (!embedded_magic_database().empty())
+    {
+        if (std::filesystem::exists(target)) setenv("MAGIC", target.c_str(), 1);
+        return;
+    }
+
     bool need_install = !std::filesystem::exists(target);
     if (!need_install) {
         std::error_code ec;
@@ -0,0 +1,179 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+#include "../../include/pcm_utils.hpp"
+
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CHISEL_PCM_X86 1
+#include <immintrin.h>
+#else
+#define CHISEL_PCM_X86 0
+#endif
+
+namespace {
+
+#if CHISEL_PCM_X86
+
+    /// One-time CPUID probe; the kernels below are compiled for AVX2
+    /// regardless of the build's baseline and only run when this is true.
+    bool have_avx2() {
+        static const bool ok = __builtin_cpu_supports("avx2");
+        return ok;
+    }
+
+    [[gnu::target("avx2")]] void widen16_avx2(const int16_t *src, int32_t *dst,
+                                              const std::size_t count) {
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_cvtepi16_epi32(v));
+        }
+        for (; i < count; ++i) dst[i] = src[i];
+    }
+
+    [[gnu::target("avx2")]] void widen24_avx2(const unsigned char *src, int32_t *dst,
+                                              const std::size_t count) {
+        // Each dword picks up its 3 bytes left-shifted by 8, then an
+        // arithmetic shift right pulls the sign down. The second 128-bit
+        // load starts at byte 12 so both lanes see their samples at the
+        // same in-lane offsets.
+        const __m256i shuf = _mm256_setr_epi8(
+            -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+            -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+        std::size_t i = 0;
+        // the trailing load reads 4 bytes past the group, so stop early
+        // enough that they are still inside the buffer
+        while (i + 10 <= count) {
+            const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 3));
+            const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 3 + 12));
+            __m256i v = _mm256_set_m128i(hi, lo);
+            v = _mm256_srai_epi32(_mm256_shuffle_epi8(v, shuf), 8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), v);
+            i += 8;
+        }
+        for (; i < count; ++i) {
+            const unsigned char *s = src + i * 3;
+            const auto raw = static_cast<uint32_t>(s[0]) | static_cast<uint32_t>(s[1]) << 8 |
+                             static_cast<uint32_t>(s[2]) << 16;
+            dst[i] = static_cast<int32_t>(raw << 8) >> 8;
+        }
+    }
+
+    [[gnu::target("avx2")]] void byteswap16_avx2(uint16_t *data, const std::size_t count) {
+        const __m256i shuf = _mm256_setr_epi8(
+            1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+            1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            auto *p = reinterpret_cast<__m256i *>(data + i);
+            _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), shuf));
+        }
+        for (; i < count; ++i) data[i] = static_cast<uint16_t>(data[i] << 8 | data[i] >> 8);
+    }
+
+    [[gnu::target("avx2")]] void byteswap32_avx2(uint32_t *data, const std::size_t count) {
+        const __m256i shuf = _mm256_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            auto *p = reinterpret_cast<__m256i *>(data + i);
+            _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), shuf));
+        }
+        for (; i < count; ++i) data[i] = __builtin_bswap32(data[i]);
+    }
+
+    [[gnu::target("avx2")]] void interleave2_avx2(const int32_t *left, const int32_t *right,
+                                                  const std::size_t frames, int32_t *dst) {
+        std::size_t i = 0;
+        for (; i + 8 <= frames; i += 8) {
+            const __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(left + i));
+            const __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(right + i));
+            const __m256i lo = _mm256_unpacklo_epi32(l, r); // L0R0L1R1 | L4R4L5R5
+            const __m256i hi = _mm256_unpackhi_epi32(l, r); // L2R2L3R3 | L6R6L7R7
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 2),
+                                _mm256_permute2x128_si256(lo, hi, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 2 + 8),
+                                _mm256_permute2x128_si256(lo, hi, 0x31));
+        }
+        for (; i < frames; ++i) {
+            dst[i * 2] = left[i];
+            dst[i * 2 + 1] = right[i];
+        }
+    }
+
+#endif // CHISEL_PCM_X86
+
+} // namespace
+
+namespace chisel {
+
+void pcm_widen16(const int16_t *src, int32_t *dst, const std::size_t count) {
+#if CHISEL_PCM_X86
+    if (have_avx2()) return widen16_avx2(src, dst, count);
+#endif
+    for (std::size_t i = 0; i < count; ++i) dst[i] = src[i];
+}
+
+void pcm_widen24(const unsigned char *src, int32_t *dst, const std::size_t count) {
+#if CHISEL_PCM_X86
+    if (have_avx2()) return widen24_avx2(src, dst, count);
+#endif
+    for (std::size_t i = 0; i < count; ++i) {
+        const unsigned char *s = src + i * 3;
+        const auto raw = static_cast<uint32_t>(s[0]) | static_cast<uint32_t>(s[1]) << 8 |
+                         static_cast<uint32_t>(s[2]) << 16;
+        dst[i] = static_cast<int32_t>(raw << 8) >> 8;
+    }
+}
+
+void pcm_byteswap16(uint16_t *data, const std::size_t count) {
+#if CHISEL_PCM_X86
+    if (have_avx2()) return byteswap16_avx2(data, count);
+#endif
+    for (std::size_t i = 0; i < count; ++i) {
+        data[i] = static_cast<uint16_t>(data[i] << 8 | data[i] >> 8);
+    }
+}
+
+void pcm_byteswap32(uint32_t *data, const std::size_t count) {
+#if CHISEL_PCM_X86
+    if (have_avx2()) return byteswap32_avx2(data, count);
+#endif
+    for (std::size_t i = 0; i < count; ++i) {
+#if defined(__GNUC__)
+        data[i] = __builtin_bswap32(data[i]);
+#else
+        data[i] = data[i] << 24 | (data[i] & 0xFF00u) << 8 |
+                  (data[i] >> 8 & 0xFF00u) | data[i] >> 24;
+#endif
+    }
+}
+
+void pcm_interleave(const int32_t *const *channels, const unsigned nch,
+                    const std::size_t frames, int32_t *dst) {
+    if (nch == 1) {
+        std::memcpy(dst, channels[0], frames * sizeof(int32_t));
+        return;
+    }
+    if (nch == 2) {
+#if CHISEL_PCM_X86
+        if (have_avx2()) return interleave2_avx2(channels[0], channels[1], frames, dst);
+#endif
+        for (std::size_t i = 0; i < frames; ++i) {
+            dst[i * 2] = channels[0][i];
+            dst[i * 2 + 1] = channels[1][i];
+        }
+        return;
+    }
+    for (std::size_t i = 0; i < frames; ++i) {
+        for (unsigned ch = 0; ch < nch; ++ch) {
+            *dst++ = channels[ch][i];
+        }
+    }
+}
+
+} // namespace chisel
@@ -4,20 +4,71 @@
 
 #include "../../include/processor_executor.hpp"
 #include "../../include/file_type.hpp"
+#include "../../include/file_utils.hpp"
 #include "../../include/mime_detector.hpp"
 #include "../../include/thread_pool.hpp"
 #include "../../include/logger.hpp"
 #include "../../include/events.hpp"
 #include "../../include/event_bus.hpp"
+#include "../../include/random_utils.hpp"
+#include "../../include/gain_model.hpp"
+#include "../../include/result_cache.hpp"
+#include "../../include/stats.hpp"
+#include "../../include/trace.hpp"
+#include "../../include/run_journal.hpp"
+#include <algorithm>
 #include <filesystem>
 #include <future>
+#include <limits>
 #include <vector>
-#include <stack>
 #include <string>
 #include <chrono>
 
 namespace fs = std::filesystem;
 
+namespace {
+    // Dispatch priorities for the pool. Analysis and finalization outrank
+    // recompression so discovery keeps the queue fed and finished
+    // containers drain promptly; recompression tasks use the file size as
+    // priority so the biggest files start first instead of becoming the
+    // long tail of the run.
+    constexpr uintmax_t analysis_priority = std::numeric_limits<uintmax_t>::max();
+    constexpr uintmax_t finalize_priority = std::numeric_limits<uintmax_t>::max() - 1;
+
+    // A stage whose expected fractional gain is below this floor is
+    // dropped from the candidate list when the gain model has enough
+    // samples to be trusted.
+    constexpr double gain_model_floor = 0.0005;
+
+    // PARALLEL racing: once a candidate finishes with at least this
+    // fractional gain, candidates that have not started by the grace
+    // deadline are skipped instead of run.
+    constexpr double parallel_race_min_gain = 0.001;
+    // The grace deadline gives laggards the winner's own runtime again,
+    // so per-file latency is roughly 2x the winner's time instead of the
+    // sum over all candidates.
+    constexpr int race_grace_factor = 2;
+
+    // Files under this size spend more on per-task overhead than on
+    // codec work; they are grouped into composite tasks (see
+    // ProcessorExecutor::enqueue_small_file()). The batch drainer is
+    // enqueued at this value, consistent with the size-as-priority
+    // scheme used for regular recompress tasks.
+    constexpr uintmax_t small_file_batch_threshold = 64ull << 10;
+
+    // Pre-extraction estimate of a container's on-disk footprint, as a
+    // multiple of the compressed size; trimmed to the measured size once
+    // the children exist (see adjust_temp_space()).
+    constexpr uintmax_t temp_extract_factor = 4;
+
+    // Transient rename failures worth retrying: on Windows these raw
+    // values are ERROR_SHARING_VIOLATION, ERROR_ACCESS_DENIED and
+    // ERROR_FILE_NOT_FOUND, typically a scanner holding the file open.
+    bool is_sharing_violation(const std::error_code& ec) {
+        return ec.value() == 32 || ec.value() == 5 || ec.value() == 2;
+    }
+}
+
 namespace chisel {
     ProcessorExecutor::ProcessorExecutor(ProcessorRegistry &registry,
                                          const bool preserve_metadata,
@@ -39,6 +90,10 @@ namespace chisel {
            {
            }
 
+    ProcessorExecutor::~ProcessorExecutor() {
+        wait_pending_renames();
+    }
+
     void ProcessorExecutor::process(const std::vector<fs::path> &inputs) {
         if (has_output_dir_ && !dry_run_) {
             bool create_dir = false;
@@ -74,133 +129,491 @@ namespace chisel {
             }
         }
 
+        // A warm executor is reused across runs; duplicate clusters are
+        // strictly per-run state (their outcomes point at the previous
+        // run's paths), so each run starts from an empty table.
+        {
+            std::scoped_lock dedup_lock(dedup_mtx_);
+            dup_clusters_.clear();
+        }
+
+        // Run-scoped arena: every intermediate pipeline temp lives under
+        // this one directory with a unique per-task name, so concurrent
+        // same-named files can't collide and teardown is a single
+        // remove_all instead of one unlink per temp.
+        arena_dir_ = make_temp_dir_for(inputs.empty() ? fs::path("chisel") : inputs.front(), "run");
+
+        std::vector<ThreadPool::Task> analysis_tasks;
+        analysis_tasks.reserve(inputs.size());
         for (const auto &path: inputs) {
-            if (stop_flag_.load(std::memory_order_relaxed)) return;
-            analyze_path(path);
+            if (stop_flag_.load(std::memory_order_relaxed)) break;
+            analysis_tasks.push_back([this, path](const std::stop_token &st) {
+                if (st.stop_requested()) return;
+                analyze_path(path, nullptr);
+            });
+        }
+        pool_.enqueue_bulk(analysis_tasks, analysis_priority);
+        // Every downstream task (recompression, finalization) is enqueued
+        // from within an already-running task, so a single drain covers
+        // the whole dataflow.
+        pool_.wait_idle();
+        // Completion events for renames parked on the retry queue must
+        // land before the run returns.
+        wait_pending_renames();
+
+        // Interrupted runs drop their half-written temps here too, so no
+        // orphans survive the process.
+        cleanup_temp_dir(arena_dir_, "Executor");
+        arena_dir_.clear();
+    }
+
+    void ProcessorExecutor::process(const PathSource &source) {
+        if (has_output_dir_ && !dry_run_) {
+            // The input count is unknown up front, so the output target
+            // is always a directory in streaming mode.
+            output_is_directory_ = true;
+            std::error_code ec;
+            fs::create_directories(output_dir_, ec);
+            if (ec) {
+                Logger::log(LogLevel::Error, "Failed to create output directory: " + output_dir_.string(), "Executor");
+                return;
+            }
+        }
+
+        arena_dir_ = make_temp_dir_for(fs::path("chisel"), "run");
+
+        // Each pulled path is enqueued immediately, so workers start
+        // analyzing while the rest of the stream is still being read.
+        fs::path path;
+        while (!stop_flag_.load(std::memory_order_relaxed) && source(path)) {
+            pool_.post([this, p = std::move(path)](const std::stop_token &st) {
+                if (st.stop_requested()) return;
+                analyze_path(p, nullptr);
+            }, analysis_priority);
+            path.clear();
+        }
+        pool_.wait_idle();
+        wait_pending_renames();
+
+        cleanup_temp_dir(arena_dir_, "Executor");
+        arena_dir_.clear();
+    }
+
+    uintmax_t ProcessorExecutor::acquire_memory(const uintmax_t estimate) {
+        if (memory_budget_ == 0 || estimate == 0) {
+            return 0;
+        }
+        std::unique_lock lock(memory_mtx_);
+        memory_cv_.wait(lock, [&] {
+            // Always admit when nothing is in flight: a single file whose
+            // estimate exceeds the whole budget must not deadlock the run.
+            if (memory_in_flight_ == 0) return true;
+            if (stop_flag_.load(std::memory_order_relaxed)) return true;
+            return memory_in_flight_ + estimate <= memory_budget_;
+        });
+        memory_in_flight_ += estimate;
+        return estimate;
+    }
+
+    void ProcessorExecutor::release_memory(const uintmax_t reserved) {
+        {
+            std::scoped_lock lock(memory_mtx_);
+            memory_in_flight_ -= reserved;
+        }
+        memory_cv_.notify_all();
+    }
+
+    uintmax_t ProcessorExecutor::acquire_temp_space(const uintmax_t estimate) {
+        if (temp_budget_ == 0 || estimate == 0) {
+            return 0;
+        }
+        std::unique_lock lock(temp_mtx_);
+        ++temp_waiters_;
+        temp_cv_.wait(lock, [&] {
+            // A single oversized container must not deadlock the run.
+            if (temp_in_flight_ == 0) return true;
+            if (stop_flag_.load(std::memory_order_relaxed)) return true;
+            // Never park every worker: the finalize tasks that reclaim
+            // temp space need one to run on, so the last free worker is
+            // admitted past the budget rather than stalled.
+            if (temp_waiters_ >= pool_.thread_count()) return true;
+            return temp_in_flight_ + estimate <= temp_budget_;
+        });
+        --temp_waiters_;
+        temp_in_flight_ += estimate;
+        return estimate;
+    }
+
+    uintmax_t ProcessorExecutor::adjust_temp_space(const uintmax_t reserved, const uintmax_t actual) {
+        if (reserved == actual) return reserved;
+        {
+            std::scoped_lock lock(temp_mtx_);
+            temp_in_flight_ += actual;
+            temp_in_flight_ -= reserved;
+        }
+        temp_cv_.notify_all();
+        return actual;
+    }
+
+    void ProcessorExecutor::release_temp_space(const uintmax_t reserved) {
+        if (reserved == 0) return;
+        {
+            std::scoped_lock lock(temp_mtx_);
+            temp_in_flight_ -= reserved;
+        }
+        temp_cv_.notify_all();
+    }
+
+    fs::path ProcessorExecutor::temp_destination(const fs::path &original_file,
+                                                 const std::string &label) const {
+        const fs::path dest = has_output_dir_
+                                  ? (output_is_directory_ ? output_dir_ / original_file.filename() : output_dir_)
+                                  : original_file;
+        return make_sibling_temp(dest, label);
+    }
+
+    void ProcessorExecutor::copy_unimproved_to_output(const fs::path& original_file) const {
+        if (!has_output_dir_ || dry_run_) return;
+        const fs::path dest = output_is_directory_
+                              ? (output_dir_ / original_file.filename())
+                              : output_dir_;
+        if (!clone_or_copy_file(original_file, dest)) {
+            Logger::log(LogLevel::Warning,
+                        "Failed to copy unimproved file to output: " + original_file.string(),
+                        "Executor");
         }
-        if (stop_flag_.load(std::memory_order_relaxed)) return;
-        process_work_list();
-        if (stop_flag_.load(std::memory_order_relaxed)) return;
-        finalize_containers();
     }
 
     void ProcessorExecutor::handle_temp_file(const fs::path& original_file,
                                              const fs::path& temp_file,
                                              const uintmax_t original_size,
-                                             const std::chrono::milliseconds duration) const {
+                                             const std::chrono::milliseconds duration,
+                                             const bool allow_deferral) {
         std::error_code ec;
         auto new_size = fs::file_size(temp_file, ec);
         if (ec || new_size == 0) {
             Logger::log(LogLevel::Warning, "Temp file is invalid or empty: " + temp_file.string(), "Executor");
             fs::remove(temp_file, ec);
+            Stats::add(Stats::Counter::FilesErrored);
             event_bus_.publish(FileProcessErrorEvent{original_file, "Failed to create optimized file"});
             return;
         }
 
-        bool replaced = false;
+        const Trace::Span rename_span("rename", original_file, new_size);
 
         if (dry_run_) {
             Logger::log(LogLevel::Info, "[DRY-RUN] Would replace: " + original_file.string(), "Executor");
             fs::remove(temp_file, ec);
+            Stats::add(Stats::Counter::FilesProcessed);
+            Stats::add(Stats::Counter::BytesWritten, new_size);
+            if (new_size < original_size) {
+                Stats::add(Stats::Counter::BytesSaved, original_size - new_size);
+            }
+            event_bus_.publish(FileProcessCompleteEvent{original_file, original_size, new_size, false, duration});
+            return;
+        }
 
-        } else if (has_output_dir_) {
-            const fs::path dest = output_is_directory_
-                                  ? (output_dir_ / original_file.filename())
-                                  : output_dir_;
+        const fs::path dest = has_output_dir_
+                              ? (output_is_directory_ ? output_dir_ / original_file.filename() : output_dir_)
+                              : original_file;
+        // Output renames contend with scanners reading fresh files,
+        // which tend to clear faster than in-place source locks.
+        const auto retry_interval = std::chrono::milliseconds(has_output_dir_ ? 250 : 500);
 
-            int retries = 10;
-            while (retries > 0) {
+        fs::rename(temp_file, dest, ec);
+        if (ec && is_sharing_violation(ec)) {
+            if (allow_deferral) {
+                // Park the rename for the timer thread instead of
+                // sleeping here: this worker moves straight on to the
+                // next file and the completion event is published when
+                // the rename eventually lands.
+                Logger::log(LogLevel::Debug, [&] {
+                    return "Rename blocked (sharing violation), deferred: " + dest.string();
+                }, "Executor");
+                defer_rename(PendingRename{temp_file, dest, original_file, original_size, new_size,
+                                           duration, retry_interval, 9,
+                                           std::chrono::steady_clock::now() + retry_interval});
+                return;
+            }
+            // A container child must resolve before this task returns,
+            // because the parent's finalize may start right after; keep
+            // the bounded blocking retry for that case only.
+            int retries = 9;
+            while (retries > 0 && ec && is_sharing_violation(ec)) {
+                Logger::log(LogLevel::Debug, "Rename failed (sharing/lock violation), retrying in " +
+                            std::to_string(retry_interval.count()) + "ms...", "Executor");
+                std::this_thread::sleep_for(retry_interval);
                 fs::rename(temp_file, dest, ec);
-                if (!ec) break;
-
-                if (ec.value() != 32 && ec.value() != 5 && ec.value() != 2) break;
-                constexpr auto retry_ms = 250;
-                Logger::log(LogLevel::Debug, "Rename (output) failed (sharing violation), retrying in " + std::to_string(retry_ms) + "ms...", "Executor");
-                std::this_thread::sleep_for(std::chrono::milliseconds(retry_ms));
                 --retries;
             }
-            if (ec) {
-                const std::string rename_error = ec.message();
-                Logger::log(LogLevel::Error, "Rename failed: " + original_file.string() + " -> " + dest.string() + " (" + rename_error + ")", "Executor");
-                fs::remove(temp_file, ec);
-                event_bus_.publish(FileProcessErrorEvent{original_file, "Rename failed: " + rename_error});
-                return;
-            }
-            replaced = true;
+        }
 
-        } else { // in-place
-            int retries = 10;
-            while (retries > 0) {
-                fs::rename(temp_file, original_file, ec);
-                if (!ec) break; // success
+        complete_rename(PendingRename{temp_file, dest, original_file, original_size, new_size,
+                                      duration, retry_interval, 0, {}}, ec);
+    }
 
-                if (ec.value() != 32 && ec.value() != 5 && ec.value() != 2) break;
-                constexpr auto retry_ms = 500;
-                Logger::log(LogLevel::Debug, "Rename failed (sharing/lock violation), retrying in " + std::to_string(retry_ms) + "ms...", "Executor");
-                std::this_thread::sleep_for(std::chrono::milliseconds(retry_ms));
-                --retries;
+    void ProcessorExecutor::complete_rename(const PendingRename& entry, const std::error_code& ec) {
+        if (ec) {
+            Logger::log(LogLevel::Error, "Rename failed: " + entry.original_file.string() + " -> " +
+                        entry.dest.string() + " (" + ec.message() + ")", "Executor");
+            std::error_code remove_ec;
+            fs::remove(entry.temp_file, remove_ec);
+            Stats::add(Stats::Counter::FilesErrored);
+            event_bus_.publish(FileProcessErrorEvent{entry.original_file, "Rename failed: " + ec.message()});
+            return;
+        }
+
+        Stats::add(Stats::Counter::FilesProcessed);
+        Stats::add(Stats::Counter::BytesWritten, entry.new_size);
+        if (entry.new_size < entry.original_size) {
+            Stats::add(Stats::Counter::BytesSaved, entry.original_size - entry.new_size);
+        }
+        event_bus_.publish(FileProcessCompleteEvent{entry.original_file, entry.original_size,
+                                                    entry.new_size, true, entry.duration});
+    }
+
+    void ProcessorExecutor::defer_rename(PendingRename entry) {
+        {
+            std::scoped_lock lock(rename_mtx_);
+            if (!rename_retry_thread_.joinable()) {
+                // started lazily: most runs never hit a sharing violation
+                rename_retry_thread_ = std::thread([this] { rename_retry_loop(); });
+            }
+            pending_renames_.push_back(std::move(entry));
+        }
+        rename_cv_.notify_one();
+    }
+
+    void ProcessorExecutor::rename_retry_loop() {
+        std::unique_lock lock(rename_mtx_);
+        while (true) {
+            if (pending_renames_.empty()) {
+                rename_cv_.wait(lock, [&] { return rename_thread_exit_ || !pending_renames_.empty(); });
+                if (pending_renames_.empty()) {
+                    return; // exit requested with nothing left to drain
+                }
             }
-            if (ec) {
 
-                const std::string rename_error = ec.message();
-                Logger::log(LogLevel::Error, "Rename failed (in-place): " + original_file.string() + " (" + rename_error + ")", "Executor");
+            auto due = pending_renames_.front().next_attempt;
+            for (const auto& entry : pending_renames_) {
+                due = std::min(due, entry.next_attempt);
+            }
+            rename_cv_.wait_until(lock, due);
 
-                std::error_code remove_ec;
-                fs::remove(temp_file, remove_ec);
+            const auto now = std::chrono::steady_clock::now();
+            std::vector<PendingRename> ready;
+            std::erase_if(pending_renames_, [&](PendingRename& entry) {
+                if (entry.next_attempt > now) return false;
+                ready.push_back(std::move(entry));
+                return true;
+            });
 
-                event_bus_.publish(FileProcessErrorEvent{original_file, "Rename failed: " + rename_error});
-                return;
+            // fs operations and event publication run unlocked so
+            // workers deferring new renames never wait on the disk
+            lock.unlock();
+            std::vector<PendingRename> still_blocked;
+            for (auto& entry : ready) {
+                std::error_code ec;
+                fs::rename(entry.temp_file, entry.dest, ec);
+                if (ec && is_sharing_violation(ec) && entry.attempts_left > 0) {
+                    --entry.attempts_left;
+                    entry.next_attempt = now + entry.retry_interval;
+                    still_blocked.push_back(std::move(entry));
+                } else {
+                    complete_rename(entry, ec);
+                }
+            }
+            lock.lock();
+            for (auto& entry : still_blocked) {
+                pending_renames_.push_back(std::move(entry));
             }
-            replaced = true;
         }
+    }
 
-        event_bus_.publish(FileProcessCompleteEvent{original_file, original_size, new_size, replaced, duration});
+    void ProcessorExecutor::wait_pending_renames() {
+        std::thread retry_thread;
+        {
+            std::scoped_lock lock(rename_mtx_);
+            if (!rename_retry_thread_.joinable()) return;
+            rename_thread_exit_ = true;
+            retry_thread = std::move(rename_retry_thread_);
+        }
+        rename_cv_.notify_all();
+        retry_thread.join();
+        std::scoped_lock lock(rename_mtx_);
+        rename_thread_exit_ = false; // a later run may restart the thread
     }
 
 
-    void ProcessorExecutor::analyze_path(const fs::path &path) {
+    void ProcessorExecutor::analyze_path(const fs::path &path,
+                                         const std::shared_ptr<ContainerNode> &owner) {
         if (stop_flag_.load(std::memory_order_relaxed)) return;
+        const Trace::Span trace_span("analyze", path);
+        Stats::add(Stats::Counter::FilesAnalyzed);
 
         auto name = path.filename().string();
 
         std::transform(name.begin(), name.end(), name.begin(), ::tolower);
         if (name == ".ds_store" || name == "desktop.ini" || name.starts_with("._")) {
+            Stats::add(Stats::Counter::FilesSkipped);
             event_bus_.publish(FileAnalyzeSkippedEvent{path, "Junk file"});
+            child_done(owner);
+            return;
+        }
 
+        // A resumed run skips everything the interrupted run already
+        // brought to a terminal outcome.
+        if (run_journal_ != nullptr && run_journal_->is_completed(path)) {
+            Stats::add(Stats::Counter::FilesSkipped);
+            event_bus_.publish(FileAnalyzeSkippedEvent{path, "Completed in previous run"});
+            child_done(owner);
             return;
         }
 
+        // Stat-only size window: files outside it are dropped before the
+        // header read, so an excluded corpus costs one metadata query per
+        // file. Container members are exempt — their extraction is sunk.
+        if (owner == nullptr && (size_min_ > 0 || size_max_ > 0)) {
+            std::error_code window_ec;
+            const auto stat_size = fs::file_size(path, window_ec);
+            if (!window_ec && ((size_min_ > 0 && stat_size < size_min_) ||
+                               (size_max_ > 0 && stat_size > size_max_))) {
+                Stats::add(Stats::Counter::FilesSkipped);
+                Stats::add(Stats::Counter::FilesSizeFiltered);
+                event_bus_.publish(FileAnalyzeSkippedEvent{path, "Outside size window"});
+                child_done(owner);
+                return;
+            }
+        }
+
         event_bus_.publish(FileAnalyzeStartEvent{path});
 
-        const auto mime = MimeDetector::detect(path);
+        // One open+read for the header, reused for every sniff on this file.
+        const auto header = MimeDetector::read_header(path);
+        const auto mime = MimeDetector::detect(path, header);
         auto procs = registry_.find_by_mime(mime);
         if (procs.empty()) {
             procs = registry_.find_by_extension(path.extension().string());
         }
 
         if (procs.empty()) {
-            Logger::log(LogLevel::Warning, "no processor for " + path.string(), "Executor");
+            Logger::log(LogLevel::Warning, [&] { return "no processor for " + path.string(); }, "Executor");
+            Stats::add(Stats::Counter::FilesSkipped);
             event_bus_.publish(FileAnalyzeSkippedEvent{path, "Unsupported format"});
+            if (run_journal_ != nullptr) run_journal_->mark_completed(path);
+            child_done(owner);
             return;
         }
 
+        const fs::path& current_path = path;
+        std::error_code size_ec;
+        const auto size = fs::file_size(current_path, size_ec);
+
+        // With a gain model attached, accumulated statistics reorder the
+        // candidates and drop predicted-pointless stages. Containers keep
+        // registry order: their front processor drives extraction, not
+        // recompression.
+        if (gain_model_ != nullptr && procs.size() > 1 &&
+            std::none_of(procs.begin(), procs.end(),
+                         [](const IProcessor *p) { return p->can_extract_contents(); })) {
+            order_candidates(procs, mime, size_ec ? 0 : size);
+        }
+
         IProcessor *processor = procs.front();
 
-        const fs::path& current_path = path;
         bool scheduled_for_extraction = false;
+        const bool can_recompress = processor->can_recompress();
         bool scheduled_for_recompression = false;
+
+        // Consult the cross-run cache before committing to any work: a
+        // file whose exact content was already found unimprovable by the
+        // same processors is skipped outright. Only the NoImprovement
+        // verdict helps here; an Optimized verdict can't reproduce the
+        // output bytes, so those files are re-processed.
+        bool recompress_needed = can_recompress;
+        std::string content_hash;
+        std::string processor_set;
+        // containers stay out of duplicate clusters: their outcome is a
+        // finalization, not a byte result that can be replayed
+        const bool dedup_eligible = deduplicate_ && can_recompress &&
+                                    !processor->can_extract_contents();
+        if (can_recompress && (result_cache_ != nullptr || dedup_eligible)) {
+            content_hash = checksum_file(current_path);
+        }
+        if (can_recompress && result_cache_ != nullptr) {
+            for (const auto *p: procs) {
+                if (!processor_set.empty()) processor_set += '+';
+                processor_set += p->get_name();
+            }
+            if (!content_hash.empty()) {
+                const auto entry = result_cache_->lookup(content_hash, size_ec ? 0 : size, processor_set);
+                if (entry && entry->verdict == CacheVerdict::NoImprovement) {
+                    recompress_needed = false;
+                    copy_unimproved_to_output(current_path);
+                    Stats::add(Stats::Counter::FilesSkipped);
+                    event_bus_.publish(FileProcessSkippedEvent{current_path, "Cached: no improvement"});
+                    // terminal for plain files; containers are journaled
+                    // by their finalization instead
+                    if (run_journal_ != nullptr && !processor->can_extract_contents()) {
+                        run_journal_->mark_completed(current_path);
+                    }
+                }
+            }
+        }
         std::optional<ExtractedContent> content;
+        std::shared_ptr<ContainerNode> node;
         if (processor->can_extract_contents()) {
-             content = processor->prepare_extraction(current_path);
+            // Backpressure between extraction and finalization: stall
+            // here while enough extracted bytes are already in flight,
+            // letting completed containers finalize and reclaim their
+            // temp space before more is committed.
+            uintmax_t temp_reserved =
+                acquire_temp_space(size_ec ? 0 : size * temp_extract_factor);
+            content = processor->prepare_extraction(current_path);
             if (content) {
-                finalize_stack_.push(*content);
-                for (const auto &child: content->extracted_files) {
-                    analyze_path(child);
+                node = std::make_shared<ContainerNode>();
+                // moved, not copied: memory_members may hold large payloads
+                node->content = std::move(*content);
+                node->parent = owner;
+                if (temp_budget_ > 0) {
+                    // replace the estimate with the measured footprint
+                    uintmax_t extracted_bytes = 0;
+                    for (const auto &child: node->content.extracted_files) {
+                        std::error_code child_ec;
+                        const auto child_size = fs::file_size(child, child_ec);
+                        if (!child_ec) extracted_bytes += child_size;
+                    }
+                    temp_reserved = adjust_temp_space(temp_reserved, extracted_bytes);
+                }
+                node->temp_reserved = temp_reserved;
+                const auto &disk_children = node->content.extracted_files;
+                const size_t memory_children = node->content.memory_members.size();
+                // Count every child plus (optionally) the container's own
+                // recompression before scheduling anything, so the counter
+                // can never hit zero while more units are on their way.
+                node->pending.store(disk_children.size() + memory_children + (recompress_needed ? 1 : 0),
+                                    std::memory_order_relaxed);
+                std::vector<ThreadPool::Task> child_tasks;
+                child_tasks.reserve(disk_children.size());
+                for (const auto &child: disk_children) {
+                    child_tasks.push_back([this, child, node](const std::stop_token &st) {
+                        if (st.stop_requested()) return;
+                        analyze_path(child, node);
+                    });
+                }
+                pool_.enqueue_bulk(child_tasks, analysis_priority);
+                for (size_t i = 0; i < memory_children; ++i) {
+                    schedule_memory_recompress(node, i);
                 }
                 scheduled_for_extraction = true;
+                if (node->pending.load(std::memory_order_relaxed) == 0) {
+                    schedule_finalize(node);
+                }
             } else {
-                if (processor->can_recompress()) {
+                release_temp_space(temp_reserved);
+                if (can_recompress) {
                     Logger::log(LogLevel::Warning, "prepare_extraction resulted in no elements for " + path.string(), "Executor");
+                    Stats::add(Stats::Counter::FilesSkipped);
                     event_bus_.publish(FileAnalyzeSkippedEvent{path, "Extraction resulted in no elements"});
                 } else {
                     Logger::log(LogLevel::Error, "prepare_extraction failed for " + path.string(), "Executor");
@@ -208,233 +621,1002 @@ namespace chisel {
                 }
             }
         }
-        if (processor->can_recompress()) {
-            work_list_.push_back(current_path);
-            scheduled_for_recompression = true;
+        if (recompress_needed) {
+            AnalyzedFile entry{current_path, std::move(procs), mime,
+                               size_ec ? 0 : size,
+                               std::move(content_hash), std::move(processor_set)};
+            if (dedup_eligible && !entry.content_hash.empty() &&
+                register_duplicate(entry, node ? node : owner)) {
+                // absorbed into a cluster; its representative's outcome
+                // will be applied and reported for it
+                scheduled_for_recompression = true;
+            } else {
+                // A container's own recompression counts against its node, so
+                // finalization waits for it; plain files report to their owner.
+                schedule_recompress(std::move(entry), node ? node : owner);
+                scheduled_for_recompression = true;
+            }
         }
         if (scheduled_for_extraction || scheduled_for_recompression) {
             if (scheduled_for_extraction) {
-                event_bus_.publish(FileAnalyzeCompleteEvent{path, true, scheduled_for_recompression, content->extracted_files.size()});
+                event_bus_.publish(FileAnalyzeCompleteEvent{path, true, scheduled_for_recompression,
+                                                            node->content.extracted_files.size() +
+                                                            node->content.memory_members.size()});
             } else {
                 event_bus_.publish(FileAnalyzeCompleteEvent{path, false, scheduled_for_recompression});
             }
+        } else if (can_recompress && !recompress_needed) {
+            // the cache already published the skip for this file
         } else {
-            Logger::log(LogLevel::Debug, "file ignored: " + path.string(), "Executor");
+            Logger::log(LogLevel::Debug, [&] { return "file ignored: " + path.string(); }, "Executor");
+            Stats::add(Stats::Counter::FilesSkipped);
             event_bus_.publish(FileAnalyzeSkippedEvent{path, "No operations available"});
+            if (run_journal_ != nullptr) run_journal_->mark_completed(path);
+        }
+
+        // The container (if any) reports to the owner through its own
+        // finalization and a recompressed file through its task; only a
+        // path that produced no work at all reports here.
+        if (!scheduled_for_extraction && !scheduled_for_recompression) {
+            child_done(owner);
         }
     }
 
-    void ProcessorExecutor::process_work_list() {
-        for (const auto &file: work_list_) {
-            if (stop_flag_.load(std::memory_order_relaxed)) return;
-            pool_.enqueue([this, file](const std::stop_token &st) {
-                if (st.stop_requested()) {
-                    event_bus_.publish(FileProcessSkippedEvent{file, "Interrupted"});
-                    return;
-                }
-                event_bus_.publish(FileProcessStartEvent{file});
+    /**
+     * @brief Per-file state shared by racing candidate tasks in PARALLEL mode.
+     *
+     * Each candidate task owns one slot of results; remaining acts as a
+     * countdown latch and the task that brings it to zero runs
+     * finish_parallel().
+     */
+    struct ProcessorExecutor::ParallelFileState {
+        struct Result {
+            fs::path tmp;
+            uintmax_t size{};
+            bool success{false};
+        };
 
-                // collect all candidates
-                auto candidates = registry_.find_by_mime(MimeDetector::detect(file));
-                if (candidates.empty()) {
-                    candidates = registry_.find_by_extension(file.extension().string());
-                }
-                if (candidates.empty()) {
-                    Logger::log(LogLevel::Warning, "no processor for " + file.string(), "Executor");
-                    event_bus_.publish(FileProcessSkippedEvent{file, "Unsupported format"});
-                    return;
-                }
+        AnalyzedFile entry;                     ///< The file being raced
+        std::shared_ptr<ContainerNode> owner;   ///< Owning container, if any
+        std::vector<Result> results;            ///< One slot per candidate
+        std::atomic<size_t> remaining{0};       ///< Candidates still running
+        std::atomic<bool> started{false};       ///< Ensures a single start event
+        std::chrono::steady_clock::time_point start_time; ///< Scheduling time
+        /// Steady-clock deadline (time_since_epoch count) set by the
+        /// first candidate to finish with a gain past the race
+        /// threshold; candidates that have not started by it are
+        /// skipped. 0 while no such winner exists.
+        std::atomic<std::chrono::steady_clock::rep> race_deadline{0};
+    };
 
-                auto safe_size = [](const fs::path &p) {
-                    std::error_code ec;
-                    const auto s = fs::file_size(p, ec);
-                    return ec ? 0ull : s;
-                };
+    void ProcessorExecutor::order_candidates(std::vector<IProcessor *> &procs,
+                                             const std::string &mime,
+                                             const uintmax_t size) {
+        struct Scored {
+            IProcessor *proc;
+            std::optional<GainModel::Expectation> exp;
+        };
+        std::vector<Scored> scored;
+        scored.reserve(procs.size());
+        for (auto *p: procs) {
+            scored.push_back({p, gain_model_->expect(p->get_name(), mime, size)});
+        }
 
-                try {
-                    const auto orig_size = safe_size(file);
-                    auto start = std::chrono::steady_clock::now();
+        // Drop stages the model confidently calls pointless — but never
+        // the whole list, or the file would be misreported as unsupported.
+        const auto below_floor = [](const Scored &s) {
+            return s.exp.has_value() && s.exp->gain < gain_model_floor;
+        };
+        if (!std::ranges::all_of(scored, below_floor)) {
+            std::erase_if(scored, below_floor);
+        } else {
+            const auto best = std::ranges::max_element(scored, {}, [](const Scored &s) {
+                return s.exp->gain;
+            });
+            scored = {*best};
+        }
 
-                    if (mode_ == EncodeMode::PIPE) {
-                        fs::path current = file;
-                        fs::path last_tmp;
-                        bool pipeline_ok = true;
+        // Best expected gain per unit cost first; candidates without
+        // trusted statistics keep their relative registry order so they
+        // still run and feed the model.
+        const auto ratio = [](const Scored &s) {
+            return s.exp->gain / std::max(s.exp->millis_per_mib, 1.0);
+        };
+        std::stable_sort(scored.begin(), scored.end(),
+                         [&](const Scored &a, const Scored &b) {
+                             if (!a.exp || !b.exp) return false;
+                             return ratio(a) > ratio(b);
+                         });
 
-                        for (size_t i = 0; i < candidates.size(); ++i) {
-                            if (st.stop_requested()) {
-                                pipeline_ok = false;
-                                break;
-                            }
+        procs.clear();
+        for (const auto &s: scored) {
+            procs.push_back(s.proc);
+        }
+    }
+
+    void ProcessorExecutor::schedule_recompress(AnalyzedFile entry,
+                                                const std::shared_ptr<ContainerNode> &owner) {
+        if (stop_flag_.load(std::memory_order_relaxed)) {
+            child_done(owner);
+            return;
+        }
+        if (mode_ == EncodeMode::PARALLEL) {
+            schedule_parallel_candidates(std::move(entry), owner);
+            return;
+        }
+        const auto priority = entry.size;
+        event_bus_.publish(FileProcessQueuedEvent{entry.path, entry.size, priority});
+        // Small files cost more in per-task overhead (dispatch, temp
+        // create/rename) than in codec time; group them into composite
+        // tasks drained in a tight loop on one worker instead of paying
+        // one pool dispatch each.
+        if (entry.size > 0 && entry.size < small_file_batch_threshold) {
+            enqueue_small_file(std::move(entry), owner);
+            return;
+        }
+        pool_.post([this, entry = std::move(entry), owner](const std::stop_token &st) {
+            recompress_file(entry, owner, st);
+        }, priority);
+    }
+
+    void ProcessorExecutor::recompress_file(const AnalyzedFile &entry,
+                                            const std::shared_ptr<ContainerNode> &owner,
+                                            const std::stop_token &st) {
+        // Report to the owning container on every exit path so its
+        // finalization is never stranded.
+        struct DoneGuard {
+            ProcessorExecutor *executor;
+            const std::shared_ptr<ContainerNode> &node;
+            ~DoneGuard() { executor->child_done(node); }
+        } done_guard{this, owner};
+
+        // Whatever way this task exits, its duplicate cluster (if
+        // any) must learn the outcome so followers are never stranded.
+        struct ClusterGuard {
+            ProcessorExecutor *executor;
+            const AnalyzedFile &entry;
+            bool improved = false;
+            uintmax_t new_size = 0;
+            ~ClusterGuard() { executor->complete_cluster(entry, improved, new_size); }
+        } cluster_guard{this, entry};
+
+        const auto &file = entry.path;
+        if (st.stop_requested()) {
+            Stats::add(Stats::Counter::FilesSkipped);
+            event_bus_.publish(FileProcessSkippedEvent{file, "Interrupted"});
+            return;
+        }
+        // a container's own recompression is not terminal: its
+        // journal entry is written by finalize_container() instead
+        const bool container_self = owner != nullptr && owner->content.original_path == file;
+        event_bus_.publish(FileProcessStartEvent{file});
+
+        // candidates were already resolved during analysis
+        const auto &candidates = entry.processors;
+        if (candidates.empty()) {
+            Logger::log(LogLevel::Warning, [&] { return "no processor for " + file.string(); }, "Executor");
+            Stats::add(Stats::Counter::FilesSkipped);
+            event_bus_.publish(FileProcessSkippedEvent{file, "Unsupported format"});
+            return;
+        }
+
+        auto safe_size = [](const fs::path &p) {
+            std::error_code ec;
+            const auto s = fs::file_size(p, ec);
+            return ec ? 0ull : s;
+        };
 
-                            fs::path tmp = fs::temp_directory_path() / (file.filename().string() + ".pipe." + std::to_string(i) + ".tmp");
+        // Reserve the worst case over the candidate stages so a
+        // configured budget bounds the peak of concurrent tasks.
+        uintmax_t mem_estimate = 0;
+        if (memory_budget_ > 0) {
+            const auto input_bytes = entry.size > 0 ? entry.size : safe_size(file);
+            for (const auto *candidate: candidates) {
+                mem_estimate = std::max(mem_estimate, candidate->estimate_memory(input_bytes));
+            }
+        }
+        const MemoryReservation mem_guard{this, acquire_memory(mem_estimate)};
+
+        try {
+            const auto orig_size = entry.size > 0 ? entry.size : safe_size(file);
+            Stats::add(Stats::Counter::BytesRead, orig_size);
+            auto start = std::chrono::steady_clock::now();
+
+            {
+                fs::path current = file;
+                fs::path last_tmp;
+                std::vector<std::byte> mem;    // pipeline data while chained in memory
+                bool in_memory = false;
+                bool any_stage = false;
+                bool pipeline_ok = true;
+                double last_gain = -1.0;       // fractional gain of the previous stage (-1 = none ran yet)
+
+                for (size_t i = 0; i < candidates.size(); ++i) {
+                    if (st.stop_requested()) {
+                        pipeline_ok = false;
+                        break;
+                    }
+
+                    if (pipe_prune_min_gain_ >= 0.0 && any_stage &&
+                        last_gain < pipe_prune_min_gain_ &&
+                        candidates[i]->is_expensive()) {
+                        // The upstream stage found no headroom in this
+                        // data; a deeper search over it is almost
+                        // certainly wasted work.
+                        Logger::log(LogLevel::Debug, [&] {
+                            return "pruned " + std::string(candidates[i]->get_name()) + " for " +
+                                   file.string() + ": upstream gain " +
+                                   std::to_string(last_gain * 100.0) + "%";
+                        }, "Executor");
+                        continue;
+                    }
 
-                            candidates[i]->recompress(current, tmp, preserve_metadata_);
-                            auto sz = safe_size(tmp);
-                            if (sz == 0) {
+                    if (candidates[i]->can_recompress_buffer()) {
+                        // Buffer-capable stage: chain through memory so the
+                        // intermediate result never touches the temp volume.
+                        if (!in_memory) {
+                            if (!read_file(current, mem)) {
                                 pipeline_ok = false;
-                                std::error_code ec;
-                                fs::remove(tmp, ec);
                                 break;
                             }
                             if (current != file) {
                                 std::error_code ec;
                                 fs::remove(current, ec);
                             }
-                            current = tmp;
-                            last_tmp = tmp;
+                            last_tmp.clear();
+                            in_memory = true;
+                        }
+                        std::vector<std::byte> next;
+                        Stats::add_processor_call(candidates[i]->get_name());
+                        const auto stage_start = std::chrono::steady_clock::now();
+                        bool stage_ok = false;
+                        {
+                            const Trace::Span stage_span(candidates[i]->get_name(), file, mem.size());
+                            stage_ok = candidates[i]->recompress_buffer(mem, next, preserve_metadata_) &&
+                                       !next.empty();
                         }
+                        const auto stage_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - stage_start);
+                        event_bus_.publish(ProcessorTimingEvent{
+                            file, std::string(candidates[i]->get_name()), mem.size(),
+                            stage_ok ? next.size() : 0, stage_ms});
+                        if (gain_model_ != nullptr) {
+                            // a failed stage paid its cost for zero gain
+                            gain_model_->record(candidates[i]->get_name(), entry.mime, mem.size(),
+                                                stage_ok ? next.size() : mem.size(), stage_ms);
+                        }
+                        if (!stage_ok) {
+                            pipeline_ok = false;
+                            break;
+                        }
+                        last_gain = mem.empty() ? 0.0
+                            : 1.0 - static_cast<double>(next.size()) / static_cast<double>(mem.size());
+                        mem = std::move(next);
+                        any_stage = true;
+                        continue;
+                    }
 
-                        auto end = std::chrono::steady_clock::now();
-                        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-
-                        if (pipeline_ok && !last_tmp.empty()) {
-                            auto new_size = safe_size(last_tmp);
-                            // accept the recompressed file only if it is smaller than the original
-                            // and, if checksum verification is enabled, the raw checksums match
-                            const bool size_improved = (new_size > 0 && new_size < orig_size);
-                            const bool checksum_ok = !verify_checksums_ ||
-                                candidates[0]->raw_equal(file, last_tmp);
-
-                            if (size_improved && checksum_ok) {
-                                handle_temp_file(file, last_tmp, orig_size, duration);
-                            } else {
-                                if (!checksum_ok) {
-                                    std::error_code ec;
-                                    fs::remove(last_tmp, ec);
-                                    event_bus_.publish(FileProcessErrorEvent{file, "INTEGRITY CHECK FAILED: Data corruption detected"});
-                                } else {
-                                    std::error_code ec;
-                                    fs::remove(last_tmp, ec);
-                                    event_bus_.publish(FileProcessSkippedEvent{file, "No size improvement"});
-                                }
-                            }
-                        } else {
-                            auto err = std::error_code{};
-                            if (!last_tmp.empty()) fs::remove(last_tmp, err);
-                            if (st.stop_requested()) {
-                                event_bus_.publish(FileProcessSkippedEvent{file, "Interrupted"});
-                            } else {
-                                event_bus_.publish(FileProcessErrorEvent{file, "Pipeline failed"});
-                            }
+                    if (in_memory) {
+                        // Next stage is path-based: spill the current data once.
+                        fs::path spill = arena_dir_ / (file.filename().string() + ".pipe." + std::to_string(i) + ".in." + RandomUtils::random_suffix());
+                        if (!write_file(spill, mem)) {
+                            pipeline_ok = false;
+                            break;
                         }
+                        mem.clear();
+                        in_memory = false;
+                        current = spill;
+                        last_tmp = spill;
+                    }
+
+                    // The last stage's output may become the final result:
+                    // place it beside the destination so the swap renames
+                    // instead of copying across filesystems.
+                    fs::path tmp = (i + 1 == candidates.size())
+                                       ? temp_destination(file, "pipe" + std::to_string(i))
+                                       : arena_dir_ / (file.filename().string() + ".pipe." + std::to_string(i) + "." + RandomUtils::random_suffix());
+
+                    const auto stage_input = (current == file) ? orig_size : safe_size(current);
+                    Stats::add_processor_call(candidates[i]->get_name());
+                    const auto stage_start = std::chrono::steady_clock::now();
+                    {
+                        const Trace::Span stage_span(candidates[i]->get_name(), file, stage_input);
+                        candidates[i]->recompress(current, tmp, preserve_metadata_, st);
+                    }
+                    auto sz = safe_size(tmp);
+                    const auto stage_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - stage_start);
+                    event_bus_.publish(ProcessorTimingEvent{
+                        file, std::string(candidates[i]->get_name()), stage_input, sz, stage_ms});
+                    if (gain_model_ != nullptr) {
+                        gain_model_->record(candidates[i]->get_name(), entry.mime, stage_input,
+                                            sz > 0 ? sz : stage_input, stage_ms);
+                    }
+                    if (sz == 0) {
+                        pipeline_ok = false;
+                        std::error_code ec;
+                        fs::remove(tmp, ec);
+                        break;
+                    }
+                    if (current != file) {
+                        std::error_code ec;
+                        fs::remove(current, ec);
+                    }
+                    last_gain = stage_input > 0
+                        ? 1.0 - static_cast<double>(sz) / static_cast<double>(stage_input)
+                        : 0.0;
+                    current = tmp;
+                    last_tmp = tmp;
+                    any_stage = true;
+                }
+
+                if (pipeline_ok && in_memory && any_stage) {
+                    // Disk is only touched for the final winner.
+                    fs::path tmp = temp_destination(file, "pipe-out");
+                    if (write_file(tmp, mem)) {
+                        last_tmp = tmp;
                     } else {
-                        // parallel
-                        struct Result {
-                            fs::path tmp;
-                            uintmax_t size{};
-                            bool success{false};
-                        };
-                        std::vector<Result> results;
-
-                        for (size_t i = 0; i < candidates.size(); ++i) {
-                            if (st.stop_requested()) break;
-                            fs::path tmp = fs::temp_directory_path() / (file.filename().string() + ".cand." + std::to_string(i) + ".tmp");
-                            Result r{tmp, 0, false};
-                            try {
-                                candidates[i]->recompress(file, tmp, preserve_metadata_);
-                                auto sz = safe_size(tmp);
-                                if (sz > 0) {
-                                    r.size = sz;
-                                    r.success = true;
-                                } else {
-                                    std::error_code ec;
-                                    fs::remove(tmp, ec);
-                                }
-                            } catch (...) {
-                                std::error_code ec;
-                                fs::remove(tmp, ec);
-                            }
-                            results.push_back(r);
-                        }
+                        pipeline_ok = false;
+                    }
+                    mem.clear();
+                }
 
-                        auto end = std::chrono::steady_clock::now();
-                        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-
-                        auto best_it = std::min_element(results.begin(), results.end(),
-                                                        [](const Result &a, const Result &b) {
-                                                            if (a.success != b.success) return a.success && !b.success;
-                                                            return a.size < b.size;
-                                                        });
-
-                        if (best_it != results.end() && best_it->success && best_it->size < orig_size) {
-                            handle_temp_file(file, best_it->tmp, orig_size, duration);
-                            for (const auto &r: results) {
-                                if (r.tmp != best_it->tmp) {
-                                    std::error_code ec2;
-                                    fs::remove(r.tmp, ec2);
-                                }
-                            }
+                auto end = std::chrono::steady_clock::now();
+                auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+                if (pipeline_ok && !last_tmp.empty()) {
+                    auto new_size = safe_size(last_tmp);
+                    // accept the recompressed file only if it is smaller than the original
+                    // and, if checksum verification is enabled, the raw checksums match
+                    const bool size_improved = (new_size > 0 && new_size < orig_size);
+                    bool checksum_ok = true;
+                    if (verify_checksums_) {
+                        const Trace::Span verify_span("verify", file, new_size);
+                        checksum_ok = candidates[0]->raw_equal(file, last_tmp);
+                    }
+
+                    if (size_improved && checksum_ok) {
+                        if (result_cache_ != nullptr && !entry.content_hash.empty()) {
+                            result_cache_->store(entry.content_hash, orig_size, entry.processor_set,
+                                                 CacheVerdict::Optimized, new_size);
+                        }
+                        // No deferral for container children (the parent's
+                        // finalize may start right away) or with dedup on
+                        // (followers copy from the renamed destination).
+                        handle_temp_file(file, last_tmp, orig_size, duration,
+                                         owner == nullptr && !deduplicate_);
+                        if (owner) owner->any_child_improved.store(true, std::memory_order_relaxed);
+                        cluster_guard.improved = true;
+                        cluster_guard.new_size = new_size;
+                        if (run_journal_ != nullptr && !container_self) {
+                            run_journal_->mark_completed(file);
+                        }
+                    } else {
+                        if (!checksum_ok) {
+                            std::error_code ec;
+                            fs::remove(last_tmp, ec);
+                            Stats::add(Stats::Counter::FilesErrored);
+                            event_bus_.publish(FileProcessErrorEvent{file, "INTEGRITY CHECK FAILED: Data corruption detected"});
                         } else {
-                            for (const auto &r: results) {
-                                std::error_code ec;
-                                fs::remove(r.tmp, ec);
+                            std::error_code ec;
+                            fs::remove(last_tmp, ec);
+                            if (result_cache_ != nullptr && !entry.content_hash.empty()) {
+                                result_cache_->store(entry.content_hash, orig_size, entry.processor_set,
+                                                     CacheVerdict::NoImprovement, 0);
                             }
-                            if (st.stop_requested()) {
-                                event_bus_.publish(FileProcessSkippedEvent{file, "Interrupted"});
-                            } else {
-                                event_bus_.publish(FileProcessSkippedEvent{file, "No size improvement"});
+                            copy_unimproved_to_output(file);
+                            Stats::add(Stats::Counter::FilesSkipped);
+                            event_bus_.publish(FileProcessSkippedEvent{file, "No size improvement"});
+                            if (run_journal_ != nullptr && !container_self) {
+                                run_journal_->mark_completed(file);
                             }
                         }
                     }
-                } catch (const std::exception &e) {
-                    Logger::log(LogLevel::Error, "error on " + file.string() + ": " + std::string(e.what()),
-                                "Executor");
-                    event_bus_.publish(FileProcessErrorEvent{file, e.what()});
+                } else {
+                    auto err = std::error_code{};
+                    if (!last_tmp.empty()) fs::remove(last_tmp, err);
+                    if (st.stop_requested()) {
+                        Stats::add(Stats::Counter::FilesSkipped);
+                        event_bus_.publish(FileProcessSkippedEvent{file, "Interrupted"});
+                    } else {
+                        Stats::add(Stats::Counter::FilesErrored);
+                        event_bus_.publish(FileProcessErrorEvent{file, "Pipeline failed"});
+                    }
                 }
-            });
+            }
+        } catch (const std::exception &e) {
+            Logger::log(LogLevel::Error, "error on " + file.string() + ": " + std::string(e.what()),
+                        "Executor");
+            Stats::add(Stats::Counter::FilesErrored);
+            event_bus_.publish(FileProcessErrorEvent{file, e.what()});
+        }
+    }
+
+    void ProcessorExecutor::enqueue_small_file(AnalyzedFile entry,
+                                               const std::shared_ptr<ContainerNode> &owner) {
+        const std::string key{entry.processors.front()->get_name()};
+        bool schedule_drain = false;
+        {
+            std::scoped_lock lock(batch_mtx_);
+            auto &bucket = small_batches_[key];
+            // one drainer per bucket: scheduled on the empty -> non-empty
+            // transition, it claims whatever has accumulated by the time
+            // a worker picks it up
+            schedule_drain = bucket.empty();
+            bucket.push_back({std::move(entry), owner});
+        }
+        if (schedule_drain) {
+            pool_.post([this, key](const std::stop_token &st) {
+                drain_small_batch(key, st);
+            }, small_file_batch_threshold);
+        }
+    }
+
+    void ProcessorExecutor::drain_small_batch(const std::string &key, const std::stop_token &st) {
+        std::vector<SmallFileBatch> batch;
+        {
+            std::scoped_lock lock(batch_mtx_);
+            const auto it = small_batches_.find(key);
+            if (it == small_batches_.end()) return;
+            batch.swap(it->second);
+        }
+        // same processor back to back: one dispatch and a warm
+        // instruction cache for the whole group
+        for (const auto &item: batch) {
+            recompress_file(item.entry, item.owner, st);
         }
-        pool_.wait_idle();
     }
 
-    void ProcessorExecutor::finalize_containers() {
-        while (!finalize_stack_.empty() && !stop_flag_.load()) {
-            auto content = finalize_stack_.top();
-            finalize_stack_.pop();
+    void ProcessorExecutor::schedule_memory_recompress(const std::shared_ptr<ContainerNode> &node,
+                                                       const size_t index) {
+        const auto &member = node->content.memory_members[index];
+        const auto priority = static_cast<uintmax_t>(member.data.size());
+        event_bus_.publish(FileProcessQueuedEvent{member.path, member.data.size(), priority});
+        pool_.post([this, node, index](const std::stop_token &st) {
+            auto &member = node->content.memory_members[index];
+            // copy: the path field is cleared when the member leaves memory
+            const fs::path file = member.path;
 
-            event_bus_.publish(ContainerFinalizeStartEvent{content.original_path});
+            if (st.stop_requested()) {
+                Stats::add(Stats::Counter::FilesSkipped);
+                event_bus_.publish(FileProcessSkippedEvent{file, "Interrupted"});
+                child_done(node);
+                return;
+            }
 
-            auto procs = registry_.find_by_mime(MimeDetector::detect(content.original_path));
-            if (procs.empty()) {
-                procs = registry_.find_by_extension(content.original_path.extension().string());
+            // Same dispatch as analyze_path(), sniffing the in-memory
+            // payload instead of re-reading the file.
+            const std::string member_mime = MimeDetector::detect(file, member.data);
+            auto candidates = registry_.find_by_mime(member_mime);
+            if (candidates.empty()) {
+                candidates = registry_.find_by_extension(file.extension().string());
             }
-            if (procs.empty()) {
-                Logger::log(LogLevel::Warning, "no processor to finalize: " + content.original_path.string(),
-                            "Executor");
-                event_bus_.publish(ContainerFinalizeErrorEvent{content.original_path, "Unsupported format"});
-                continue;
+            if (candidates.empty()) {
+                // No registered processor claims this member at all (e.g.
+                // the XML parts of a document container): leave it staged
+                // in memory for finalize_extraction() — no disk round trip.
+                Stats::add(Stats::Counter::FilesSkipped);
+                event_bus_.publish(FileProcessSkippedEvent{file, "Unsupported format"});
+                child_done(node);
+                return;
             }
+            std::erase_if(candidates, [](const IProcessor *p) {
+                return !p->can_recompress_buffer();
+            });
 
+            if (candidates.empty()) {
+                // No buffer-capable stage (path-based processor or nested
+                // container slipped through the extraction heuristics):
+                // spill the member to its virtual path and let the normal
+                // analysis take over — it accounts for this work unit
+                // itself, so no child_done() here.
+                std::error_code dir_ec;
+                fs::create_directories(file.parent_path(), dir_ec);
+                const bool spilled = !dir_ec && write_file(file, member.data);
+                member.data.clear();
+                member.data.shrink_to_fit();
+                member.path.clear(); // finalize_extraction() skips cleared slots
+                if (!spilled) {
+                    Stats::add(Stats::Counter::FilesErrored);
+                    event_bus_.publish(FileProcessErrorEvent{file, "Failed to spill member to disk"});
+                    child_done(node);
+                    return;
+                }
+                analyze_path(file, node);
+                return;
+            }
+
+            if (gain_model_ != nullptr && candidates.size() > 1) {
+                order_candidates(candidates, member_mime, member.data.size());
+            }
+
+            event_bus_.publish(FileProcessStartEvent{file});
+            const auto orig_size = static_cast<uintmax_t>(member.data.size());
+            Stats::add(Stats::Counter::BytesRead, orig_size);
+
+            // Reserve the worst case over the candidate stages, like the
+            // path-based PIPE task does.
+            uintmax_t mem_estimate = 0;
+            if (memory_budget_ > 0) {
+                for (const auto *candidate: candidates) {
+                    mem_estimate = std::max(mem_estimate, candidate->estimate_memory(orig_size));
+                }
+            }
+            const MemoryReservation mem_guard{this, acquire_memory(mem_estimate)};
+
+            const auto start = std::chrono::steady_clock::now();
             try {
-                auto start = std::chrono::steady_clock::now();
-                std::filesystem::path new_temp_file = procs.front()->finalize_extraction(content);
-                auto end = std::chrono::steady_clock::now();
-                auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+                std::span<const std::byte> input(member.data);
+                std::vector<std::byte> held; // owns the latest stage output
+                bool any_stage = false;
+                bool pipeline_ok = true;
+                double last_gain = -1.0;     // fractional gain of the previous stage (-1 = none ran yet)
+
+                for (auto *candidate: candidates) {
+                    if (st.stop_requested()) {
+                        pipeline_ok = false;
+                        break;
+                    }
+                    if (pipe_prune_min_gain_ >= 0.0 && any_stage &&
+                        last_gain < pipe_prune_min_gain_ &&
+                        candidate->is_expensive()) {
+                        // Same pruning rule as the path-based PIPE chain.
+                        Logger::log(LogLevel::Debug, [&] {
+                            return "pruned " + std::string(candidate->get_name()) + " for " +
+                                   file.string() + ": upstream gain " +
+                                   std::to_string(last_gain * 100.0) + "%";
+                        }, "Executor");
+                        continue;
+                    }
+                    std::vector<std::byte> next;
+                    Stats::add_processor_call(candidate->get_name());
+                    const auto stage_start = std::chrono::steady_clock::now();
+                    bool stage_ok = false;
+                    {
+                        const Trace::Span stage_span(candidate->get_name(), file, input.size());
+                        stage_ok = candidate->recompress_buffer(input, next, preserve_metadata_) &&
+                                   !next.empty();
+                    }
+                    const auto stage_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - stage_start);
+                    event_bus_.publish(ProcessorTimingEvent{
+                        file, std::string(candidate->get_name()), input.size(),
+                        stage_ok ? next.size() : 0, stage_ms});
+                    if (gain_model_ != nullptr) {
+                        gain_model_->record(candidate->get_name(), member_mime, input.size(),
+                                            stage_ok ? next.size() : input.size(), stage_ms);
+                    }
+                    if (!stage_ok) {
+                        pipeline_ok = false;
+                        break;
+                    }
+                    last_gain = input.empty() ? 0.0
+                        : 1.0 - static_cast<double>(next.size()) / static_cast<double>(input.size());
+                    held = std::move(next);
+                    input = std::span<const std::byte>(held);
+                    any_stage = true;
+                }
 
+                const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start);
+
+                if (pipeline_ok && any_stage && held.size() < orig_size) {
+                    // The container rebuild carries the new bytes; disk is
+                    // never touched for the intermediate results.
+                    member.data = std::move(held);
+                    node->any_child_improved.store(true, std::memory_order_relaxed);
+                    Stats::add(Stats::Counter::FilesProcessed);
+                    Stats::add(Stats::Counter::BytesWritten, member.data.size());
+                    Stats::add(Stats::Counter::BytesSaved, orig_size - member.data.size());
+                    event_bus_.publish(FileProcessCompleteEvent{
+                        file, orig_size, member.data.size(), !dry_run_, duration});
+                } else if (pipeline_ok) {
+                    Stats::add(Stats::Counter::FilesSkipped);
+                    event_bus_.publish(FileProcessSkippedEvent{file, "No size improvement"});
+                } else if (st.stop_requested()) {
+                    Stats::add(Stats::Counter::FilesSkipped);
+                    event_bus_.publish(FileProcessSkippedEvent{file, "Interrupted"});
+                } else {
+                    Stats::add(Stats::Counter::FilesErrored);
+                    event_bus_.publish(FileProcessErrorEvent{file, "Pipeline failed"});
+                }
+            } catch (const std::exception &e) {
+                Logger::log(LogLevel::Error, "error on " + file.string() + ": " + std::string(e.what()),
+                            "Executor");
+                Stats::add(Stats::Counter::FilesErrored);
+                event_bus_.publish(FileProcessErrorEvent{file, e.what()});
+            }
+            child_done(node);
+        }, priority);
+    }
+
+    void ProcessorExecutor::schedule_parallel_candidates(AnalyzedFile entry,
+                                                         const std::shared_ptr<ContainerNode> &owner) {
+        event_bus_.publish(FileProcessQueuedEvent{entry.path, entry.size, entry.size});
+        auto state = std::make_shared<ParallelFileState>();
+        state->entry = std::move(entry);
+        state->owner = owner;
+        state->results.resize(state->entry.processors.size());
+        state->remaining.store(state->entry.processors.size(), std::memory_order_relaxed);
+        state->start_time = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < state->entry.processors.size(); ++i) {
+            pool_.post([this, state, i](const std::stop_token &st) {
+                const auto &file = state->entry.path;
+                if (!state->started.exchange(true, std::memory_order_relaxed)) {
+                    event_bus_.publish(FileProcessStartEvent{file});
+                }
+
+                auto &r = state->results[i];
+                // A good-enough winner plus an expired grace deadline
+                // cancels candidates still waiting in the queue; one
+                // already inside recompress() runs to completion, since
+                // interrupting it mid-call would need cancellation
+                // support in every codec.
+                const auto deadline = state->race_deadline.load(std::memory_order_acquire);
+                const bool raced_out = deadline != 0 &&
+                    std::chrono::steady_clock::now().time_since_epoch().count() > deadline;
+                if (raced_out) {
+                    Logger::log(LogLevel::Debug, [&] {
+                        return "raced out " + std::string(state->entry.processors[i]->get_name()) +
+                               " for " + file.string() + ": a winner already finished";
+                    }, "Executor");
+                }
+                if (!st.stop_requested() && !raced_out) {
+                    // Each racing candidate reserves its own estimate; the
+                    // budget then bounds the sum across files and candidates.
+                    const uintmax_t mem_estimate = memory_budget_ > 0
+                        ? state->entry.processors[i]->estimate_memory(state->entry.size)
+                        : 0;
+                    const MemoryReservation mem_guard{this, acquire_memory(mem_estimate)};
+                    fs::path tmp = temp_destination(file, "cand" + std::to_string(i));
+                    r.tmp = tmp;
+                    Stats::add_processor_call(state->entry.processors[i]->get_name());
+                    const auto cand_start = std::chrono::steady_clock::now();
+                    try {
+                        {
+                            const Trace::Span cand_span(state->entry.processors[i]->get_name(), file,
+                                                        state->entry.size);
+                            state->entry.processors[i]->recompress(file, tmp, preserve_metadata_, st);
+                        }
+                        std::error_code ec;
+                        const auto sz = fs::file_size(tmp, ec);
+                        if (!ec && sz > 0) {
+                            r.size = sz;
+                            r.success = true;
+                        } else {
+                            fs::remove(tmp, ec);
+                        }
+                        const auto cand_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - cand_start);
+                        event_bus_.publish(ProcessorTimingEvent{
+                            file, std::string(state->entry.processors[i]->get_name()),
+                            state->entry.size, r.success ? r.size : 0, cand_ms});
+                        if (gain_model_ != nullptr) {
+                            gain_model_->record(state->entry.processors[i]->get_name(),
+                                                state->entry.mime, state->entry.size,
+                                                r.success ? r.size : state->entry.size, cand_ms);
+                        }
+                        if (r.success && state->entry.size > 0) {
+                            const double gain = 1.0 - static_cast<double>(r.size) /
+                                                      static_cast<double>(state->entry.size);
+                            if (gain >= parallel_race_min_gain) {
+                                // First good winner arms the grace deadline:
+                                // laggards get the winner's own runtime again.
+                                const auto race_end = std::chrono::steady_clock::now() +
+                                                      cand_ms * (race_grace_factor - 1);
+                                auto expected = std::chrono::steady_clock::rep{0};
+                                state->race_deadline.compare_exchange_strong(
+                                    expected, race_end.time_since_epoch().count(),
+                                    std::memory_order_acq_rel);
+                            }
+                        }
+                    } catch (const std::exception &e) {
+                        Logger::log(LogLevel::Error, "error on " + file.string() + ": " + std::string(e.what()),
+                                    "Executor");
+                        std::error_code ec;
+                        fs::remove(tmp, ec);
+                        event_bus_.publish(ProcessorTimingEvent{
+                            file, std::string(state->entry.processors[i]->get_name()),
+                            state->entry.size, 0,
+                            std::chrono::duration_cast<std::chrono::milliseconds>(
+                                std::chrono::steady_clock::now() - cand_start)});
+                    }
+                }
+
+                // Last candidate across the line picks the winner.
+                if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    finish_parallel(state);
+                }
+            }, state->entry.size);
+        }
+    }
+
+    void ProcessorExecutor::finish_parallel(const std::shared_ptr<ParallelFileState> &state) {
+        const auto &file = state->entry.path;
+        auto safe_size = [](const fs::path &p) {
+            std::error_code ec;
+            const auto s = fs::file_size(p, ec);
+            return ec ? 0ull : s;
+        };
+        const auto orig_size = state->entry.size > 0 ? state->entry.size : safe_size(file);
+        Stats::add(Stats::Counter::BytesRead, orig_size);
+
+        const auto end = std::chrono::steady_clock::now();
+        const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - state->start_time);
+
+        auto &results = state->results;
+        auto best_it = std::min_element(results.begin(), results.end(),
+                                        [](const ParallelFileState::Result &a, const ParallelFileState::Result &b) {
+                                            if (a.success != b.success) return a.success && !b.success;
+                                            return a.size < b.size;
+                                        });
+
+        bool cluster_improved = false;
+        uintmax_t cluster_new_size = 0;
+        if (best_it != results.end() && best_it->success && best_it->size < orig_size) {
+            cluster_improved = true;
+            cluster_new_size = best_it->size;
+            if (result_cache_ != nullptr && !state->entry.content_hash.empty()) {
+                result_cache_->store(state->entry.content_hash, orig_size, state->entry.processor_set,
+                                     CacheVerdict::Optimized, best_it->size);
+            }
+            // same deferral rules as the PIPE path: children and dedup
+            // representatives must rename before dependents proceed
+            handle_temp_file(file, best_it->tmp, orig_size, duration,
+                             state->owner == nullptr && !deduplicate_);
+            if (state->owner) state->owner->any_child_improved.store(true, std::memory_order_relaxed);
+            if (run_journal_ != nullptr &&
+                !(state->owner && state->owner->content.original_path == file)) {
+                run_journal_->mark_completed(file);
+            }
+            for (const auto &r: results) {
+                if (r.tmp != best_it->tmp && !r.tmp.empty()) {
+                    std::error_code ec;
+                    fs::remove(r.tmp, ec);
+                }
+            }
+        } else {
+            for (const auto &r: results) {
+                if (r.tmp.empty()) continue;
                 std::error_code ec;
+                fs::remove(r.tmp, ec);
+            }
+            if (stop_flag_.load(std::memory_order_relaxed)) {
+                Stats::add(Stats::Counter::FilesSkipped);
+                event_bus_.publish(FileProcessSkippedEvent{file, "Interrupted"});
+            } else {
+                if (result_cache_ != nullptr && !state->entry.content_hash.empty()) {
+                    result_cache_->store(state->entry.content_hash, orig_size, state->entry.processor_set,
+                                         CacheVerdict::NoImprovement, 0);
+                }
+                copy_unimproved_to_output(file);
+                Stats::add(Stats::Counter::FilesSkipped);
+                event_bus_.publish(FileProcessSkippedEvent{file, "No size improvement"});
+                if (run_journal_ != nullptr &&
+                    !(state->owner && state->owner->content.original_path == file)) {
+                    run_journal_->mark_completed(file);
+                }
+            }
+        }
+
+        complete_cluster(state->entry, cluster_improved, cluster_new_size);
+        child_done(state->owner);
+    }
+
+    bool ProcessorExecutor::register_duplicate(const AnalyzedFile &entry,
+                                               const std::shared_ptr<ContainerNode> &owner) {
+        const std::string key = entry.content_hash + ":" + std::to_string(entry.size);
+
+        std::shared_ptr<DupCluster> finished;
+        {
+            std::lock_guard lock(dedup_mtx_);
+            auto &slot = dup_clusters_[key];
+            if (!slot) {
+                // first of its content: becomes the representative
+                slot = std::make_shared<DupCluster>();
+                slot->representative = entry.path;
+                return false;
+            }
+            if (!slot->done) {
+                slot->followers.push_back({entry.path, entry.size, owner});
+                return true;
+            }
+            finished = slot;
+        }
+
+        // the representative already finished; replay its outcome now
+        apply_duplicate_outcome(*finished, {entry.path, entry.size, owner});
+        return true;
+    }
+
+    void ProcessorExecutor::complete_cluster(const AnalyzedFile &entry,
+                                             const bool improved,
+                                             const uintmax_t new_size) {
+        if (entry.content_hash.empty()) return;
+        const std::string key = entry.content_hash + ":" + std::to_string(entry.size);
+
+        std::shared_ptr<DupCluster> cluster;
+        std::vector<DupCluster::Follower> waiting;
+        {
+            std::lock_guard lock(dedup_mtx_);
+            const auto it = dup_clusters_.find(key);
+            if (it == dup_clusters_.end() || it->second->done) return;
+            cluster = it->second;
+            cluster->done = true;
+            cluster->improved = improved;
+            cluster->new_size = new_size;
+            waiting.swap(cluster->followers);
+        }
+
+        if (!waiting.empty()) {
+            uintmax_t deduplicated = 0;
+            for (const auto &f: waiting) deduplicated += f.size;
+            event_bus_.publish(DuplicateClusterEvent{entry.path, waiting.size(), deduplicated});
+        }
+        for (const auto &follower: waiting) {
+            apply_duplicate_outcome(*cluster, follower);
+        }
+    }
+
+    void ProcessorExecutor::apply_duplicate_outcome(const DupCluster &cluster,
+                                                    const DupCluster::Follower &follower) {
+        struct DoneGuard {
+            ProcessorExecutor *executor;
+            const std::shared_ptr<ContainerNode> &node;
+            ~DoneGuard() { executor->child_done(node); }
+        } done_guard{this, follower.owner};
 
-                if (new_temp_file.empty()) {
-                    Logger::log(LogLevel::Debug, "Container finalize skipped (no improvement): " + content.original_path.string(), "Executor");
-                    const auto final_size = std::filesystem::file_size(content.original_path, ec);
-                    event_bus_.publish(ContainerFinalizeCompleteEvent{content.original_path, ec ? 0 : final_size});
-                    continue;
+        if (stop_flag_.load(std::memory_order_relaxed)) {
+            Stats::add(Stats::Counter::FilesSkipped);
+            event_bus_.publish(FileProcessSkippedEvent{follower.path, "Interrupted"});
+            return;
+        }
+
+        if (!cluster.improved) {
+            copy_unimproved_to_output(follower.path);
+            Stats::add(Stats::Counter::FilesSkipped);
+            event_bus_.publish(FileProcessSkippedEvent{follower.path, "No size improvement (duplicate)"});
+            if (run_journal_ != nullptr) run_journal_->mark_completed(follower.path);
+            return;
+        }
+
+        if (dry_run_) {
+            Logger::log(LogLevel::Info, "[DRY-RUN] Would replace (duplicate): " + follower.path.string(), "Executor");
+            Stats::add(Stats::Counter::FilesProcessed);
+            event_bus_.publish(FileProcessCompleteEvent{follower.path, follower.size,
+                                                        cluster.new_size, false,
+                                                        std::chrono::milliseconds{0}});
+            if (run_journal_ != nullptr) run_journal_->mark_completed(follower.path);
+            return;
+        }
+
+        // the winning bytes live where the representative's result landed
+        const fs::path source = has_output_dir_
+                                ? (output_is_directory_ ? output_dir_ / cluster.representative.filename()
+                                                        : output_dir_)
+                                : cluster.representative;
+        const fs::path dest = has_output_dir_
+                              ? (output_is_directory_ ? output_dir_ / follower.path.filename()
+                                                      : output_dir_)
+                              : follower.path;
+
+        if (clone_or_copy_file(source, dest)) {
+            if (follower.owner) follower.owner->any_child_improved.store(true, std::memory_order_relaxed);
+            Stats::add(Stats::Counter::FilesProcessed);
+            Stats::add(Stats::Counter::BytesWritten, cluster.new_size);
+            if (cluster.new_size < follower.size) {
+                Stats::add(Stats::Counter::BytesSaved, follower.size - cluster.new_size);
+            }
+            event_bus_.publish(FileProcessCompleteEvent{follower.path, follower.size,
+                                                        cluster.new_size, true,
+                                                        std::chrono::milliseconds{0}});
+            if (run_journal_ != nullptr) run_journal_->mark_completed(follower.path);
+        } else {
+            Stats::add(Stats::Counter::FilesErrored);
+            event_bus_.publish(FileProcessErrorEvent{follower.path, "Failed to apply duplicate result"});
+        }
+    }
+
+    void ProcessorExecutor::child_done(const std::shared_ptr<ContainerNode> &node) {
+        if (!node) return;
+        if (node->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            schedule_finalize(node);
+        }
+    }
+
+    void ProcessorExecutor::schedule_finalize(const std::shared_ptr<ContainerNode> &node) {
+        if (stop_flag_.load(std::memory_order_relaxed)) return;
+        pool_.post([this, node](const std::stop_token &st) {
+            if (st.stop_requested()) return;
+            finalize_container(node);
+        }, finalize_priority);
+    }
+
+    void ProcessorExecutor::finalize_container(const std::shared_ptr<ContainerNode> &node) {
+        const auto &content = node->content;
+
+        event_bus_.publish(ContainerFinalizeStartEvent{content.original_path});
+
+        auto procs = registry_.find_by_mime(MimeDetector::detect(content.original_path));
+        if (procs.empty()) {
+            procs = registry_.find_by_extension(content.original_path.extension().string());
+        }
+        if (procs.empty()) {
+            Logger::log(LogLevel::Warning, "no processor to finalize: " + content.original_path.string(),
+                        "Executor");
+            event_bus_.publish(ContainerFinalizeErrorEvent{content.original_path, "Unsupported format"});
+            release_temp_space(node->temp_reserved);
+            child_done(node->parent);
+            return;
+        }
+
+        try {
+            auto start = std::chrono::steady_clock::now();
+            std::filesystem::path new_temp_file;
+            if (procs.front()->finalize_is_rebuild_only() &&
+                !node->any_child_improved.load(std::memory_order_acquire)) {
+                // No work unit of this container shrank, so a rebuild
+                // could only reproduce the original bytes; keep the
+                // original and save the whole container rewrite.
+                Logger::log(LogLevel::Debug, [&] {
+                    return "Container finalize skipped (no children changed): " + content.original_path.string();
+                }, "Executor");
+                if (!content.temp_dir.empty()) {
+                    cleanup_temp_dir(content.temp_dir, "Executor");
                 }
+                copy_unimproved_to_output(content.original_path);
+            } else {
+                std::error_code size_ec;
+                const auto container_size = std::filesystem::file_size(content.original_path, size_ec);
+                const Trace::Span finalize_span("finalize", content.original_path,
+                                                size_ec ? 0 : container_size);
+                new_temp_file = procs.front()->finalize_extraction(content);
+            }
+            auto end = std::chrono::steady_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+            std::error_code ec;
 
+            if (new_temp_file.empty()) {
+                Logger::log(LogLevel::Debug, [&] { return "Container finalize skipped (no improvement): " + content.original_path.string(); }, "Executor");
+                const auto final_size = std::filesystem::file_size(content.original_path, ec);
+                event_bus_.publish(ContainerFinalizeCompleteEvent{content.original_path, ec ? 0 : final_size});
+            } else {
                 auto orig_size = std::filesystem::file_size(content.original_path, ec);
                 if (ec) orig_size = 0;
 
-                handle_temp_file(content.original_path, new_temp_file, orig_size, duration);
+                handle_temp_file(content.original_path, new_temp_file, orig_size, duration,
+                                 node->parent == nullptr);
+                // a rebuilt nested container counts as a changed child
+                // of its enclosing container
+                if (node->parent) node->parent->any_child_improved.store(true, std::memory_order_relaxed);
+            }
 
-            } catch (const std::exception &e) {
-                Logger::log(LogLevel::Error,
-                            "Finalize error: " + content.original_path.string() + " - " + std::string(e.what()),
-                            "Executor");
-                event_bus_.publish(ContainerFinalizeErrorEvent{content.original_path, e.what()});
+            // the container is done with, finalized or not
+            if (run_journal_ != nullptr) {
+                run_journal_->mark_completed(content.original_path);
             }
+
+        } catch (const std::exception &e) {
+            Logger::log(LogLevel::Error,
+                        "Finalize error: " + content.original_path.string() + " - " + std::string(e.what()),
+                        "Executor");
+            event_bus_.publish(ContainerFinalizeErrorEvent{content.original_path, e.what()});
         }
+
+        // Finalization (or the skip above) reclaimed the temp dir, so the
+        // reserved temp space goes back to stalled extractions.
+        release_temp_space(node->temp_reserved);
+
+        // The finalized container is itself one completed unit of its parent.
+        child_done(node->parent);
     }
 
     void ProcessorExecutor::request_stop() {
         stop_flag_.store(true, std::memory_order_relaxed);
+        memory_cv_.notify_all();
+        temp_cv_.notify_all();
         pool_.request_stop();
     }
 
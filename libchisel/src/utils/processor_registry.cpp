@@ -7,6 +7,7 @@
 #include "../../include/ape_processor.hpp"
 #include "../../include/archive_processor.hpp"
 #include "../../include/bmp_processor.hpp"
+#include "../../include/bzip2_processor.hpp"
 #include "../../include/flac_processor.hpp"
 #include "../../include/flexigif_processor.hpp"
 #include "../../include/gif_processor.hpp"
@@ -29,6 +30,7 @@
 #include "../../include/wavpack_processor.hpp"
 #include "../../include/webp_processor.hpp"
 #include "../../include/zopflipng_processor.hpp"
+#include "../../include/zstd_processor.hpp"
 #include <algorithm>
 #include <cctype>
 
@@ -49,6 +51,8 @@ ProcessorRegistry::ProcessorRegistry() {
     processors_.push_back(std::make_unique<JxlProcessor>());
     processors_.push_back(std::make_unique<PdfProcessor>());
     processors_.push_back(std::make_unique<ArchiveProcessor>());
+    processors_.push_back(std::make_unique<Bzip2Processor>());
+    processors_.push_back(std::make_unique<ZstdProcessor>());
     processors_.push_back(std::make_unique<OOXMLProcessor>());
     processors_.push_back(std::make_unique<OdfProcessor>());
     processors_.push_back(std::make_unique<SqliteProcessor>());
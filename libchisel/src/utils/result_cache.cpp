@@ -0,0 +1,130 @@
+//
+// Created by Giuseppe Francione on 19/10/25.
+//
+
+#include "../../include/result_cache.hpp"
+#include "../../include/logger.hpp"
+#include <sqlite3.h>
+
+namespace chisel {
+
+namespace {
+    constexpr auto create_schema_sql =
+        "CREATE TABLE IF NOT EXISTS results ("
+        "  content_hash TEXT NOT NULL,"
+        "  size INTEGER NOT NULL,"
+        "  processors TEXT NOT NULL,"
+        "  version TEXT NOT NULL,"
+        "  verdict INTEGER NOT NULL,"
+        "  optimized_size INTEGER NOT NULL,"
+        "  PRIMARY KEY (content_hash, size, processors, version)"
+        ");";
+
+    constexpr auto lookup_sql =
+        "SELECT verdict, optimized_size FROM results"
+        " WHERE content_hash = ?1 AND size = ?2 AND processors = ?3 AND version = ?4;";
+
+    constexpr auto store_sql =
+        "INSERT OR REPLACE INTO results"
+        " (content_hash, size, processors, version, verdict, optimized_size)"
+        " VALUES (?1, ?2, ?3, ?4, ?5, ?6);";
+}
+
+ResultCache::ResultCache(const std::filesystem::path& db_path, std::string version)
+    : version_(std::move(version)) {
+    int rc = sqlite3_open_v2(db_path.string().c_str(), &db_,
+                             SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+    if (rc != SQLITE_OK) {
+        Logger::log(LogLevel::Warning,
+                    "Result cache disabled, cannot open: " + db_path.string() +
+                    " (" + (db_ ? sqlite3_errmsg(db_) : "out of memory") + ")",
+                    "result_cache");
+        if (db_) sqlite3_close(db_);
+        db_ = nullptr;
+        return;
+    }
+
+    // WAL keeps concurrent worker writes from serializing on fsyncs
+    sqlite3_exec(db_, "PRAGMA journal_mode=WAL;", nullptr, nullptr, nullptr);
+    sqlite3_exec(db_, "PRAGMA synchronous=NORMAL;", nullptr, nullptr, nullptr);
+
+    char* err = nullptr;
+    rc = sqlite3_exec(db_, create_schema_sql, nullptr, nullptr, &err);
+    if (rc != SQLITE_OK) {
+        Logger::log(LogLevel::Warning,
+                    "Result cache disabled, schema error: " + std::string(err ? err : "unknown"),
+                    "result_cache");
+        sqlite3_free(err);
+        sqlite3_close(db_);
+        db_ = nullptr;
+        return;
+    }
+
+    if (sqlite3_prepare_v2(db_, lookup_sql, -1, &lookup_stmt_, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db_, store_sql, -1, &store_stmt_, nullptr) != SQLITE_OK) {
+        Logger::log(LogLevel::Warning,
+                    "Result cache disabled, prepare error: " + std::string(sqlite3_errmsg(db_)),
+                    "result_cache");
+        if (lookup_stmt_) sqlite3_finalize(lookup_stmt_);
+        if (store_stmt_) sqlite3_finalize(store_stmt_);
+        lookup_stmt_ = nullptr;
+        store_stmt_ = nullptr;
+        sqlite3_close(db_);
+        db_ = nullptr;
+    }
+}
+
+ResultCache::~ResultCache() {
+    if (lookup_stmt_) sqlite3_finalize(lookup_stmt_);
+    if (store_stmt_) sqlite3_finalize(store_stmt_);
+    if (db_) sqlite3_close(db_);
+}
+
+std::optional<CacheEntry> ResultCache::lookup(const std::string& content_hash,
+                                              const uintmax_t size,
+                                              const std::string& processor_set) {
+    if (db_ == nullptr) return std::nullopt;
+
+    std::lock_guard lock(mtx_);
+    sqlite3_reset(lookup_stmt_);
+    sqlite3_bind_text(lookup_stmt_, 1, content_hash.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(lookup_stmt_, 2, static_cast<sqlite3_int64>(size));
+    sqlite3_bind_text(lookup_stmt_, 3, processor_set.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(lookup_stmt_, 4, version_.c_str(), -1, SQLITE_TRANSIENT);
+
+    if (sqlite3_step(lookup_stmt_) != SQLITE_ROW) {
+        return std::nullopt;
+    }
+
+    CacheEntry entry;
+    entry.verdict = sqlite3_column_int(lookup_stmt_, 0) == 0
+                        ? CacheVerdict::NoImprovement
+                        : CacheVerdict::Optimized;
+    entry.optimized_size = static_cast<uintmax_t>(sqlite3_column_int64(lookup_stmt_, 1));
+    return entry;
+}
+
+void ResultCache::store(const std::string& content_hash,
+                        const uintmax_t size,
+                        const std::string& processor_set,
+                        const CacheVerdict verdict,
+                        const uintmax_t optimized_size) {
+    if (db_ == nullptr) return;
+
+    std::lock_guard lock(mtx_);
+    sqlite3_reset(store_stmt_);
+    sqlite3_bind_text(store_stmt_, 1, content_hash.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(store_stmt_, 2, static_cast<sqlite3_int64>(size));
+    sqlite3_bind_text(store_stmt_, 3, processor_set.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(store_stmt_, 4, version_.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(store_stmt_, 5, verdict == CacheVerdict::NoImprovement ? 0 : 1);
+    sqlite3_bind_int64(store_stmt_, 6, static_cast<sqlite3_int64>(optimized_size));
+
+    if (sqlite3_step(store_stmt_) != SQLITE_DONE) {
+        Logger::log(LogLevel::Debug,
+                    [this] { return "Cache store failed: " + std::string(sqlite3_errmsg(db_)); },
+                    "result_cache");
+    }
+}
+
+} // namespace chisel
@@ -0,0 +1,125 @@
+//
+// Created by Giuseppe Francione on 19/10/25.
+//
+
+#include "../../include/run_journal.hpp"
+#include "../../include/logger.hpp"
+#include <sqlite3.h>
+
+namespace chisel {
+
+namespace {
+    constexpr auto create_schema_sql =
+        "CREATE TABLE IF NOT EXISTS completed ("
+        "  path TEXT NOT NULL PRIMARY KEY"
+        ");";
+
+    constexpr auto insert_sql =
+        "INSERT OR IGNORE INTO completed (path) VALUES (?1);";
+}
+
+RunJournal::RunJournal(const std::filesystem::path& db_path, const bool resume) {
+    int rc = sqlite3_open_v2(db_path.string().c_str(), &db_,
+                             SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+    if (rc != SQLITE_OK) {
+        Logger::log(LogLevel::Warning,
+                    "Run journal disabled, cannot open: " + db_path.string() +
+                    " (" + (db_ ? sqlite3_errmsg(db_) : "out of memory") + ")",
+                    "run_journal");
+        if (db_) sqlite3_close(db_);
+        db_ = nullptr;
+        return;
+    }
+
+    // WAL so batch commits don't block a resume-time reader
+    sqlite3_exec(db_, "PRAGMA journal_mode=WAL;", nullptr, nullptr, nullptr);
+    sqlite3_exec(db_, "PRAGMA synchronous=NORMAL;", nullptr, nullptr, nullptr);
+
+    char* err = nullptr;
+    rc = sqlite3_exec(db_, create_schema_sql, nullptr, nullptr, &err);
+    if (rc != SQLITE_OK) {
+        Logger::log(LogLevel::Warning,
+                    "Run journal disabled, schema error: " + std::string(err ? err : "unknown"),
+                    "run_journal");
+        sqlite3_free(err);
+        sqlite3_close(db_);
+        db_ = nullptr;
+        return;
+    }
+
+    if (resume) {
+        // serve lookups from memory; the analysis path must not pay a
+        // query per file
+        sqlite3_stmt* select = nullptr;
+        if (sqlite3_prepare_v2(db_, "SELECT path FROM completed;", -1, &select, nullptr) == SQLITE_OK) {
+            while (sqlite3_step(select) == SQLITE_ROW) {
+                const auto* text = sqlite3_column_text(select, 0);
+                if (text != nullptr) {
+                    completed_.emplace(reinterpret_cast<const char*>(text));
+                }
+            }
+            sqlite3_finalize(select);
+        }
+        Logger::log(LogLevel::Info,
+                    "Resuming: " + std::to_string(completed_.size()) + " file(s) already completed",
+                    "run_journal");
+    } else {
+        sqlite3_exec(db_, "DELETE FROM completed;", nullptr, nullptr, nullptr);
+    }
+
+    if (sqlite3_prepare_v2(db_, insert_sql, -1, &insert_stmt_, nullptr) != SQLITE_OK) {
+        Logger::log(LogLevel::Warning,
+                    "Run journal disabled, prepare error: " + std::string(sqlite3_errmsg(db_)),
+                    "run_journal");
+        sqlite3_close(db_);
+        db_ = nullptr;
+        insert_stmt_ = nullptr;
+    }
+}
+
+RunJournal::~RunJournal() {
+    flush();
+    if (insert_stmt_) sqlite3_finalize(insert_stmt_);
+    if (db_) sqlite3_close(db_);
+}
+
+bool RunJournal::is_completed(const std::filesystem::path& path) const {
+    if (db_ == nullptr || completed_.empty()) return false;
+    return completed_.contains(path.string());
+}
+
+void RunJournal::mark_completed(const std::filesystem::path& path) {
+    if (db_ == nullptr) return;
+
+    std::lock_guard lock(mtx_);
+    pending_.push_back(path.string());
+    if (pending_.size() >= batch_size) {
+        commit_batch_locked();
+    }
+}
+
+void RunJournal::flush() {
+    if (db_ == nullptr) return;
+
+    std::lock_guard lock(mtx_);
+    commit_batch_locked();
+}
+
+void RunJournal::commit_batch_locked() {
+    if (pending_.empty()) return;
+
+    sqlite3_exec(db_, "BEGIN;", nullptr, nullptr, nullptr);
+    for (const auto& path: pending_) {
+        sqlite3_reset(insert_stmt_);
+        sqlite3_bind_text(insert_stmt_, 1, path.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(insert_stmt_) != SQLITE_DONE) {
+            Logger::log(LogLevel::Debug,
+                        [this] { return "Journal write failed: " + std::string(sqlite3_errmsg(db_)); },
+                        "run_journal");
+        }
+    }
+    sqlite3_exec(db_, "COMMIT;", nullptr, nullptr, nullptr);
+    pending_.clear();
+}
+
+} // namespace chisel
@@ -0,0 +1,181 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+#include "../../include/scan_index.hpp"
+#include "../../include/logger.hpp"
+#include <sqlite3.h>
+
+namespace chisel {
+
+namespace {
+    constexpr auto create_schema_sql =
+        "CREATE TABLE IF NOT EXISTS dirs ("
+        "  path TEXT PRIMARY KEY,"
+        "  parent TEXT NOT NULL,"
+        "  mtime INTEGER NOT NULL,"
+        "  links INTEGER NOT NULL"
+        ");"
+        "CREATE INDEX IF NOT EXISTS dirs_by_parent ON dirs (parent);";
+
+    constexpr auto lookup_sql =
+        "SELECT mtime, links FROM dirs WHERE path = ?1;";
+
+    constexpr auto children_sql =
+        "SELECT path FROM dirs WHERE parent = ?1;";
+
+    constexpr auto store_sql =
+        "INSERT OR REPLACE INTO dirs (path, parent, mtime, links)"
+        " VALUES (?1, ?2, ?3, ?4);";
+
+    constexpr auto delete_sql =
+        "DELETE FROM dirs WHERE path = ?1 OR path LIKE ?2;";
+}
+
+ScanIndex::ScanIndex(const std::filesystem::path& db_path) {
+    int rc = sqlite3_open_v2(db_path.string().c_str(), &db_,
+                             SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+    if (rc != SQLITE_OK) {
+        Logger::log(LogLevel::Warning,
+                    "Scan index disabled, cannot open: " + db_path.string() +
+                    " (" + (db_ ? sqlite3_errmsg(db_) : "out of memory") + ")",
+                    "scan_index");
+        if (db_) sqlite3_close(db_);
+        db_ = nullptr;
+        return;
+    }
+
+    sqlite3_exec(db_, "PRAGMA journal_mode=WAL;", nullptr, nullptr, nullptr);
+    sqlite3_exec(db_, "PRAGMA synchronous=NORMAL;", nullptr, nullptr, nullptr);
+
+    char* err = nullptr;
+    rc = sqlite3_exec(db_, create_schema_sql, nullptr, nullptr, &err);
+    if (rc != SQLITE_OK) {
+        Logger::log(LogLevel::Warning,
+                    "Scan index disabled, schema error: " + std::string(err ? err : "unknown"),
+                    "scan_index");
+        sqlite3_free(err);
+        sqlite3_close(db_);
+        db_ = nullptr;
+        return;
+    }
+
+    if (sqlite3_prepare_v2(db_, lookup_sql, -1, &lookup_stmt_, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db_, children_sql, -1, &children_stmt_, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db_, store_sql, -1, &store_stmt_, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db_, delete_sql, -1, &delete_stmt_, nullptr) != SQLITE_OK) {
+        Logger::log(LogLevel::Warning,
+                    "Scan index disabled, prepare error: " + std::string(sqlite3_errmsg(db_)),
+                    "scan_index");
+        if (lookup_stmt_) sqlite3_finalize(lookup_stmt_);
+        if (children_stmt_) sqlite3_finalize(children_stmt_);
+        if (store_stmt_) sqlite3_finalize(store_stmt_);
+        if (delete_stmt_) sqlite3_finalize(delete_stmt_);
+        lookup_stmt_ = nullptr;
+        children_stmt_ = nullptr;
+        store_stmt_ = nullptr;
+        delete_stmt_ = nullptr;
+        sqlite3_close(db_);
+        db_ = nullptr;
+    }
+}
+
+ScanIndex::~ScanIndex() {
+    if (lookup_stmt_) sqlite3_finalize(lookup_stmt_);
+    if (children_stmt_) sqlite3_finalize(children_stmt_);
+    if (store_stmt_) sqlite3_finalize(store_stmt_);
+    if (delete_stmt_) sqlite3_finalize(delete_stmt_);
+    if (db_) sqlite3_close(db_);
+}
+
+DirSignature ScanIndex::signature_of(const std::filesystem::path& dir,
+                                     std::error_code& ec) {
+    DirSignature sig;
+    const auto mtime = std::filesystem::last_write_time(dir, ec);
+    if (ec) return sig;
+    sig.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    sig.link_count = std::filesystem::hard_link_count(dir, ec);
+    return sig;
+}
+
+std::optional<DirSignature> ScanIndex::lookup(const std::string& dir) {
+    if (db_ == nullptr) return std::nullopt;
+
+    std::lock_guard lock(mtx_);
+    sqlite3_reset(lookup_stmt_);
+    sqlite3_bind_text(lookup_stmt_, 1, dir.c_str(), -1, SQLITE_TRANSIENT);
+
+    if (sqlite3_step(lookup_stmt_) != SQLITE_ROW) {
+        return std::nullopt;
+    }
+
+    DirSignature sig;
+    sig.mtime = sqlite3_column_int64(lookup_stmt_, 0);
+    sig.link_count = static_cast<uint64_t>(sqlite3_column_int64(lookup_stmt_, 1));
+    return sig;
+}
+
+std::vector<std::string> ScanIndex::children(const std::string& dir) {
+    std::vector<std::string> result;
+    if (db_ == nullptr) return result;
+
+    std::lock_guard lock(mtx_);
+    sqlite3_reset(children_stmt_);
+    sqlite3_bind_text(children_stmt_, 1, dir.c_str(), -1, SQLITE_TRANSIENT);
+    while (sqlite3_step(children_stmt_) == SQLITE_ROW) {
+        if (const auto* text = sqlite3_column_text(children_stmt_, 0)) {
+            result.emplace_back(reinterpret_cast<const char*>(text));
+        }
+    }
+    return result;
+}
+
+void ScanIndex::record(const std::string& dir, const DirSignature& sig) {
+    if (db_ == nullptr) return;
+
+    const auto parent = std::filesystem::path(dir).parent_path().string();
+    std::lock_guard lock(mtx_);
+    pending_.push_back({dir, parent, sig});
+}
+
+void ScanIndex::forget(const std::string& dir) {
+    if (db_ == nullptr) return;
+
+    std::lock_guard lock(mtx_);
+    forgotten_.push_back(dir);
+}
+
+void ScanIndex::flush() {
+    if (db_ == nullptr) return;
+
+    std::lock_guard lock(mtx_);
+    if (pending_.empty() && forgotten_.empty()) return;
+
+    sqlite3_exec(db_, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
+    for (const auto& dir : forgotten_) {
+        // a vanished directory takes its whole recorded subtree with it
+        sqlite3_reset(delete_stmt_);
+        sqlite3_bind_text(delete_stmt_, 1, dir.c_str(), -1, SQLITE_TRANSIENT);
+        const auto prefix = dir + "/%";
+        sqlite3_bind_text(delete_stmt_, 2, prefix.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_step(delete_stmt_);
+    }
+    for (const auto& [dir, parent, sig] : pending_) {
+        sqlite3_reset(store_stmt_);
+        sqlite3_bind_text(store_stmt_, 1, dir.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(store_stmt_, 2, parent.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(store_stmt_, 3, sig.mtime);
+        sqlite3_bind_int64(store_stmt_, 4, static_cast<sqlite3_int64>(sig.link_count));
+        sqlite3_step(store_stmt_);
+    }
+    if (sqlite3_exec(db_, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        Logger::log(LogLevel::Warning,
+                    "Scan index flush failed: " + std::string(sqlite3_errmsg(db_)),
+                    "scan_index");
+        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+    }
+    pending_.clear();
+    forgotten_.clear();
+}
+
+} // namespace chisel
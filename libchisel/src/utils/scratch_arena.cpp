@@ -0,0 +1,53 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+#include "../../include/scratch_arena.hpp"
+
+namespace chisel {
+
+namespace {
+    /// Every rent starts on a boundary safe for any fundamental type.
+    constexpr size_t arena_alignment = alignof(std::max_align_t);
+
+    size_t align_up(const size_t n) {
+        return (n + arena_alignment - 1) & ~(arena_alignment - 1);
+    }
+} // namespace
+
+ScratchArena &ScratchArena::local() {
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+std::span<unsigned char> ScratchArena::rent(const size_t bytes) {
+    used_ = align_up(used_);
+    if (used_ + bytes <= block_.size()) {
+        unsigned char *p = block_.data() + used_;
+        used_ += bytes;
+        return {p, bytes};
+    }
+    // Does not fit: satisfy from a dedicated allocation so earlier
+    // rents keep their addresses; reset() folds the size into block_.
+    auto &overflow = overflow_.emplace_back(bytes);
+    return {overflow.data(), overflow.size()};
+}
+
+void ScratchArena::reset() noexcept {
+    size_t high_water = used_;
+    for (const auto &overflow: overflow_) {
+        high_water += align_up(overflow.size());
+    }
+    if (high_water > block_.size()) {
+        try {
+            block_.resize(high_water); // one growth, then steady state
+        } catch (...) {
+            // growth is an optimization only; the next file just rents
+            // through the overflow path again
+        }
+    }
+    overflow_.clear();
+    used_ = 0;
+}
+
+} // namespace chisel
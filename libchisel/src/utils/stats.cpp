@@ -0,0 +1,125 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+#include "../../include/stats.hpp"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace chisel {
+
+namespace {
+
+constexpr size_t counter_count = static_cast<size_t>(Stats::Counter::Count_);
+constexpr size_t max_processors = 64;
+
+/// One counter on its own cache line so threads never false-share.
+struct alignas(64) PaddedCounter {
+    std::atomic<uint64_t> value{0};
+};
+
+/// Per-thread counter block; only its owner writes, anyone may read.
+struct ThreadSlots {
+    std::array<PaddedCounter, counter_count> counters;
+    std::array<std::atomic<uint64_t>, max_processors> processor_calls{};
+};
+
+struct StatsState {
+    std::mutex mtx;  ///< Guards slots registry and processor names
+    std::vector<std::shared_ptr<ThreadSlots>> slots;
+    std::vector<std::string> processor_names;  ///< Index = slot in processor_calls
+};
+
+StatsState& state() {
+    static StatsState s;
+    return s;
+}
+
+// Registered shared_ptrs keep slots alive past thread exit so
+// snapshot() still sees counts from wound-down pool threads.
+ThreadSlots& local_slots() {
+    thread_local std::shared_ptr<ThreadSlots> slots = [] {
+        auto s = std::make_shared<ThreadSlots>();
+        auto& st = state();
+        std::scoped_lock lock(st.mtx);
+        st.slots.push_back(s);
+        return s;
+    }();
+    return *slots;
+}
+
+/// Resolves a processor name to its global slot index (locks on miss).
+size_t processor_slot(const std::string_view name) {
+    auto& st = state();
+    std::scoped_lock lock(st.mtx);
+    for (size_t i = 0; i < st.processor_names.size(); ++i) {
+        if (st.processor_names[i] == name) return i;
+    }
+    if (st.processor_names.size() >= max_processors) return max_processors - 1;
+    st.processor_names.emplace_back(name);
+    return st.processor_names.size() - 1;
+}
+
+} // namespace
+
+void Stats::add(const Counter counter, const uint64_t value) noexcept {
+    local_slots().counters[static_cast<size_t>(counter)]
+        .value.fetch_add(value, std::memory_order_relaxed);
+}
+
+void Stats::add_processor_call(const std::string_view processor) {
+    // get_name() returns a stable literal per processor, so caching the
+    // resolved slot by data pointer makes steady-state calls lock-free
+    struct CacheEntry {
+        const char* key;
+        size_t slot;
+    };
+    thread_local std::vector<CacheEntry> cache;
+    size_t slot = max_processors;
+    for (const auto& [key, cached_slot] : cache) {
+        if (key == processor.data()) {
+            slot = cached_slot;
+            break;
+        }
+    }
+    if (slot == max_processors) {
+        slot = processor_slot(processor);
+        cache.push_back({processor.data(), slot});
+    }
+    local_slots().processor_calls[slot].fetch_add(1, std::memory_order_relaxed);
+}
+
+Stats::Snapshot Stats::snapshot() {
+    Snapshot snap;
+    std::array<uint64_t, counter_count> totals{};
+    std::array<uint64_t, max_processors> proc_totals{};
+
+    auto& st = state();
+    std::scoped_lock lock(st.mtx);
+    for (const auto& slots : st.slots) {
+        for (size_t i = 0; i < counter_count; ++i) {
+            totals[i] += slots->counters[i].value.load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < st.processor_names.size(); ++i) {
+            proc_totals[i] += slots->processor_calls[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    snap.files_analyzed = totals[static_cast<size_t>(Counter::FilesAnalyzed)];
+    snap.files_processed = totals[static_cast<size_t>(Counter::FilesProcessed)];
+    snap.files_skipped = totals[static_cast<size_t>(Counter::FilesSkipped)];
+    snap.files_size_filtered = totals[static_cast<size_t>(Counter::FilesSizeFiltered)];
+    snap.files_errored = totals[static_cast<size_t>(Counter::FilesErrored)];
+    snap.bytes_read = totals[static_cast<size_t>(Counter::BytesRead)];
+    snap.bytes_written = totals[static_cast<size_t>(Counter::BytesWritten)];
+    snap.bytes_saved = totals[static_cast<size_t>(Counter::BytesSaved)];
+    snap.processor_calls.reserve(st.processor_names.size());
+    for (size_t i = 0; i < st.processor_names.size(); ++i) {
+        snap.processor_calls.emplace_back(st.processor_names[i], proc_totals[i]);
+    }
+    return snap;
+}
+
+} // namespace chisel
@@ -5,74 +5,486 @@
 #include "../../include/thread_pool.hpp"
 #include "logger.hpp"
 #include "log_sink.hpp"
+#include <algorithm>
+#include <chrono>
+
+#ifdef __linux__
+#include <cstdlib>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#include <pthread/qos.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+namespace {
+    // Identifies the owning pool and queue index of the current thread so
+    // tasks spawned from inside a task land on the spawning worker's own
+    // queue (good locality, no cross-thread contention).
+    thread_local ThreadPool* tl_pool = nullptr;
+    thread_local size_t tl_index = 0;
+
+#ifdef __linux__
+    // <linux/ioprio.h> is not exported everywhere, so the tiny ABI is
+    // spelled out here: class in the top 3 bits, data in the rest.
+    constexpr int ioprio_class_shift = 13;
+    constexpr int ioprio_class_be = 2;
+    constexpr int ioprio_class_idle = 3;
+    constexpr int ioprio_who_process = 1;
+
+    void set_io_priority(const int io_class, const int level) {
+#ifdef SYS_ioprio_set
+        // 0 = the calling thread; failure (old kernel, seccomp) is
+        // harmless — the CPU demotion alone still yields most of the way
+        syscall(SYS_ioprio_set, ioprio_who_process, 0,
+                (io_class << ioprio_class_shift) | level);
+#else
+        (void)io_class;
+        (void)level;
+#endif
+    }
+#endif
+
+#ifdef __linux__
+    /**
+     * @brief CPU lists of the online NUMA nodes, discovered once from sysfs.
+     *
+     * Parses /sys/devices/system/node/nodeN/cpulist ("0-31,64-95"). On a
+     * machine without the node hierarchy (or a single node) the result
+     * has at most one entry and placement policies degenerate to None.
+     */
+    const std::vector<std::vector<int>>& numa_node_cpus() {
+        static const auto nodes = [] {
+            std::vector<std::vector<int>> out;
+            for (int n = 0;; ++n) {
+                std::ifstream f("/sys/devices/system/node/node" + std::to_string(n) + "/cpulist");
+                if (!f.is_open()) break;
+                std::string list;
+                std::getline(f, list);
+                std::vector<int> cpus;
+                size_t pos = 0;
+                while (pos < list.size()) {
+                    char* end = nullptr;
+                    const long first = std::strtol(list.c_str() + pos, &end, 10);
+                    long last = first;
+                    if (end != nullptr && *end == '-') {
+                        last = std::strtol(end + 1, &end, 10);
+                    }
+                    for (long cpu = first; cpu <= last; ++cpu) cpus.push_back(static_cast<int>(cpu));
+                    pos = static_cast<size_t>(end - list.c_str());
+                    if (pos < list.size() && list[pos] == ',') ++pos;
+                }
+                if (!cpus.empty()) out.push_back(std::move(cpus));
+            }
+            return out;
+        }();
+        return nodes;
+    }
+#endif
+
+    /**
+     * @brief Pins the calling worker to its node under the given policy.
+     *
+     * Compact fills nodes by capacity (worker 0..k-1 on node 0's k CPUs,
+     * then node 1, ...); Scatter round-robins workers across nodes; None
+     * restores the full CPU set. Best-effort, Linux only.
+     */
+    void apply_affinity(const ThreadPool::Affinity policy, const size_t index) {
+#ifdef __linux__
+        const auto& nodes = numa_node_cpus();
+        if (nodes.empty()) return;
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (policy == ThreadPool::Affinity::None || nodes.size() == 1) {
+            for (const auto& node : nodes) {
+                for (const int cpu : node) CPU_SET(cpu, &set);
+            }
+        } else {
+            size_t node = 0;
+            if (policy == ThreadPool::Affinity::Scatter) {
+                node = index % nodes.size();
+            } else { // Compact
+                size_t i = index;
+                while (node + 1 < nodes.size() && i >= nodes[node].size()) {
+                    i -= nodes[node].size();
+                    ++node;
+                }
+            }
+            for (const int cpu : nodes[node]) CPU_SET(cpu, &set);
+        }
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+        (void)policy;
+        (void)index;
+#endif
+    }
+
+    /**
+     * @brief Moves the calling thread in or out of the platform's idle classes.
+     *
+     * Best-effort on every platform: a failed demotion just means the
+     * worker keeps competing at normal priority.
+     */
+    void apply_background_scheduling(const bool background) {
+#ifdef __linux__
+        sched_param param{};
+        if (background) {
+            // SCHED_IDLE runs only when nothing else wants the CPU
+            sched_setscheduler(0, SCHED_IDLE, &param);
+            set_io_priority(ioprio_class_idle, 0);
+        } else {
+            sched_setscheduler(0, SCHED_OTHER, &param);
+            set_io_priority(ioprio_class_be, 4); // best-effort default
+        }
+#elif defined(__APPLE__)
+        pthread_set_qos_class_self_np(
+            background ? QOS_CLASS_BACKGROUND : QOS_CLASS_DEFAULT, 0);
+#elif defined(_WIN32)
+        // MODE_BACKGROUND demotes CPU, I/O and page priority together
+        SetThreadPriority(GetCurrentThread(),
+                          background ? THREAD_MODE_BACKGROUND_BEGIN
+                                     : THREAD_MODE_BACKGROUND_END);
+#else
+        (void)background;
+#endif
+    }
+}
 
 ThreadPool::ThreadPool(unsigned threads) {
     if (threads == 0) threads = 1;
+    active_limit_.store(threads, std::memory_order_relaxed);
+    queues_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    states_.reserve(threads);
     workers_.reserve(threads);
     for (unsigned i = 0; i < threads; ++i) {
-        workers_.emplace_back([this](const std::stop_token& st) {
-            for (;;) {
-                std::function<void(std::stop_token)> task;
-                {
-                    std::unique_lock lock(queue_mutex_);
-                    condition_.wait(lock, st, [this] {
-                        return stop_ || !tasks_.empty();
-                    });
-                    if ((stop_ && tasks_.empty()) || st.stop_requested())
-                        return;
-                    if (tasks_.empty())
-                        continue;
-                    task = std::move(tasks_.front());
-                    tasks_.pop();
-                }
-                struct PendingGuard {
-                    size_t &pending;
-                    std::mutex &mtx;
-                    std::condition_variable &cv;
-                    ~PendingGuard() {
-                        std::lock_guard lock(mtx);
-                        if (pending > 0) --pending;
-                        cv.notify_all();
+        states_.push_back(std::make_unique<WorkerState>());
+        auto* state = states_.back().get();
+        workers_.emplace_back([this, i, state](const std::stop_token& st) {
+            worker_loop(st, i, state);
+        });
+    }
+}
+
+void ThreadPool::spawn_worker() {
+    std::lock_guard workers_lock(workers_mtx_);
+    if (stop_.load(std::memory_order_relaxed)) return;
+    const size_t index = workers_.size();
+    states_.push_back(std::make_unique<WorkerState>());
+    auto* state = states_.back().get();
+    workers_.emplace_back([this, index, state](const std::stop_token& st) {
+        worker_loop(st, index, state);
+    });
+}
+
+void ThreadPool::push_task(const uintmax_t priority, Task fn) {
+    if (stop_.load(std::memory_order_relaxed)) throw std::runtime_error("enqueue on stopped ThreadPool");
+
+    // Workers push to their own queue; external callers are spread
+    // round-robin across the shards.
+    const size_t index = (tl_pool == this)
+                             ? tl_index
+                             : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+
+    PrioritizedTask task{priority, next_seq_.fetch_add(1, std::memory_order_relaxed), std::move(fn)};
+    {
+        auto& queue = *queues_[index];
+        std::lock_guard lock(queue.mtx);
+        queue.heap.push_back(std::move(task));
+        std::push_heap(queue.heap.begin(), queue.heap.end());
+    }
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    queued_.fetch_add(1, std::memory_order_release);
+
+    // Touch the wake mutex so a worker between its predicate check and
+    // its actual wait cannot miss this notification. notify_all, not
+    // notify_one: parked workers (index >= active_limit_) wait on the
+    // same condition variable, and a single notify landing on one of
+    // them would be consumed without waking anyone eligible to run.
+    { std::lock_guard lock(wake_mutex_); }
+    condition_.notify_all();
+}
+
+void ThreadPool::enqueue_bulk(const std::span<Task> tasks, const uintmax_t priority) {
+    if (tasks.empty()) return;
+    if (stop_.load(std::memory_order_relaxed)) throw std::runtime_error("enqueue on stopped ThreadPool");
+
+    // Spread the batch over the shards in contiguous chunks so each
+    // shard lock is taken at most once per call.
+    const size_t shards = queues_.size();
+    const size_t start = (tl_pool == this)
+                             ? tl_index
+                             : next_queue_.fetch_add(1, std::memory_order_relaxed) % shards;
+    size_t i = 0;
+    for (size_t q = 0; q < shards && i < tasks.size(); ++q) {
+        // Even split of what's left over the remaining shards.
+        const size_t count = (tasks.size() - i + (shards - q) - 1) / (shards - q);
+        auto& queue = *queues_[(start + q) % shards];
+        std::lock_guard lock(queue.mtx);
+        for (size_t k = 0; k < count; ++k, ++i) {
+            queue.heap.push_back(PrioritizedTask{priority,
+                                                 next_seq_.fetch_add(1, std::memory_order_relaxed),
+                                                 std::move(tasks[i])});
+            std::push_heap(queue.heap.begin(), queue.heap.end());
+        }
+    }
+    pending_.fetch_add(tasks.size(), std::memory_order_relaxed);
+    queued_.fetch_add(tasks.size(), std::memory_order_release);
+
+    { std::lock_guard lock(wake_mutex_); }
+    condition_.notify_all();
+}
+
+bool ThreadPool::try_pop(const size_t self, PrioritizedTask& out) {
+    // Own queue first: a full lock here is uncontended in the common case.
+    {
+        auto& queue = *queues_[self];
+        std::lock_guard lock(queue.mtx);
+        if (!queue.heap.empty()) {
+            std::pop_heap(queue.heap.begin(), queue.heap.end());
+            out = std::move(queue.heap.back());
+            queue.heap.pop_back();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Steal path: try_lock only, so a shard being serviced by its owner
+    // is skipped rather than blocked on.
+    for (size_t offset = 1; offset < queues_.size(); ++offset) {
+        auto& queue = *queues_[(self + offset) % queues_.size()];
+        std::unique_lock lock(queue.mtx, std::try_to_lock);
+        if (!lock.owns_lock() || queue.heap.empty()) continue;
+        std::pop_heap(queue.heap.begin(), queue.heap.end());
+        out = std::move(queue.heap.back());
+        queue.heap.pop_back();
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::worker_loop(const std::stop_token& st, const size_t index, WorkerState* state) {
+    tl_pool = this;
+    // Workers spawned past the initial set share a shard with an
+    // earlier sibling; the shard count itself never changes.
+    tl_index = index % queues_.size();
+#ifdef __linux__
+    if (pthread_getcpuclockid(pthread_self(), &state->cpu_clock) == 0) {
+        state->clock_ready.store(true, std::memory_order_release);
+    }
+#endif
+    bool in_background = false;
+    auto placed = Affinity::None;
+    for (;;) {
+        // Scheduling class and placement follow the pool flags lazily:
+        // each worker re-applies them before its next dequeue, so the
+        // setters need no cross-thread signalling.
+        if (const bool want = background_.load(std::memory_order_relaxed);
+            want != in_background) {
+            apply_background_scheduling(want);
+            in_background = want;
+        }
+        if (const auto want = affinity_.load(std::memory_order_relaxed);
+            want != placed) {
+            apply_affinity(want, index);
+            placed = want;
+        }
+
+        PrioritizedTask task;
+        // A paused or parked worker skips straight to the wait below;
+        // the task it was already running when pause() (or the adaptive
+        // monitor) hit has finished by now.
+        if (!paused_.load(std::memory_order_acquire) &&
+            index < active_limit_.load(std::memory_order_acquire) &&
+            try_pop(tl_index, task)) {
+            struct PendingGuard {
+                ThreadPool* pool;
+                ~PendingGuard() {
+                    if (pool->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        std::lock_guard lock(pool->idle_mutex_);
+                        pool->idle_cv_.notify_all();
                     }
-                } guard{pending_, queue_mutex_, idle_cv_};
-                try {
-                    task(st);
-                } catch (const std::exception& e) {
-                    Logger::log(LogLevel::Error, std::string("Unhandled exception in thread pool: ") + e.what());
                 }
+            } guard{this};
+            state->busy.store(true, std::memory_order_relaxed);
+            try {
+                task.fn(st);
+            } catch (const std::exception& e) {
+                Logger::log(LogLevel::Error, std::string("Unhandled exception in thread pool: ") + e.what());
             }
+            state->busy.store(false, std::memory_order_relaxed);
+            continue;
+        }
+
+        std::unique_lock lock(wake_mutex_);
+        condition_.wait(lock, st, [this, index] {
+            return stop_.load(std::memory_order_relaxed) ||
+                   (!paused_.load(std::memory_order_acquire) &&
+                    index < active_limit_.load(std::memory_order_acquire) &&
+                    queued_.load(std::memory_order_acquire) > 0);
         });
+        if (st.stop_requested()) return;
+        if (stop_.load(std::memory_order_relaxed) &&
+            queued_.load(std::memory_order_acquire) == 0)
+            return;
     }
 }
 
 void ThreadPool::request_stop() {
-    {
-        std::unique_lock lock(queue_mutex_);
-        stop_ = true;
-        while (!tasks_.empty()) {
-            tasks_.pop();
-            if (pending_ > 0) {
-                pending_--;
-            }
+    stop_.store(true, std::memory_order_relaxed);
+    size_t discarded = 0;
+    for (auto& queue : queues_) {
+        std::lock_guard lock(queue->mtx);
+        discarded += queue->heap.size();
+        queue->heap.clear();
+    }
+    if (discarded > 0) {
+        queued_.fetch_sub(discarded, std::memory_order_relaxed);
+        if (pending_.fetch_sub(discarded, std::memory_order_acq_rel) == discarded) {
+            std::lock_guard lock(idle_mutex_);
+            idle_cv_.notify_all();
         }
     }
+    { std::lock_guard lock(wake_mutex_); }
     condition_.notify_all();
+    monitor_.request_stop(); // no-op when adaptivity was never enabled
+    std::lock_guard workers_lock(workers_mtx_);
     for (auto& worker : workers_) {
         worker.request_stop();
     }
 }
 
+void ThreadPool::pause() {
+    paused_.store(true, std::memory_order_release);
+}
+
+void ThreadPool::resume() {
+    paused_.store(false, std::memory_order_release);
+    // Same wake protocol as push_task(): touch the mutex so a worker
+    // between its predicate check and its wait cannot miss this.
+    { std::lock_guard lock(wake_mutex_); }
+    condition_.notify_all();
+}
+
+void ThreadPool::set_background(const bool background) {
+    background_.store(background, std::memory_order_relaxed);
+    // Wake sleeping workers so an idle pool picks the change up promptly
+    // instead of on its next task.
+    { std::lock_guard lock(wake_mutex_); }
+    condition_.notify_all();
+}
+
+void ThreadPool::enable_adaptive(size_t min_threads, size_t max_threads) {
+    if (min_threads == 0) min_threads = 1;
+    if (max_threads < min_threads) max_threads = min_threads;
+    adaptive_min_.store(min_threads, std::memory_order_relaxed);
+    adaptive_max_.store(max_threads, std::memory_order_relaxed);
+    // All limit adjustment (including pulling the current size into the
+    // new bounds) happens on the monitor thread, so there is exactly one
+    // writer of active_limit_ once adaptivity is on.
+    if (!monitor_.joinable()) {
+        monitor_ = std::jthread([this](const std::stop_token& st) {
+            monitor_loop(st);
+        });
+    }
+}
+
+void ThreadPool::monitor_loop(const std::stop_token& st) {
+    using namespace std::chrono;
+    std::vector<double> last_cpu; // per worker, seconds of thread CPU time
+    auto last = steady_clock::now();
+
+    while (!st.stop_requested()) {
+        std::this_thread::sleep_for(milliseconds(100));
+        if (st.stop_requested() || stop_.load(std::memory_order_relaxed)) break;
+
+        const auto now = steady_clock::now();
+        const double interval = duration<double>(now - last).count();
+        last = now;
+        if (paused_.load(std::memory_order_acquire) || interval <= 0.0) continue;
+
+        // Classify each busy worker: one that burned less than half the
+        // interval on the CPU is waiting on I/O, not computing.
+        size_t busy = 0;
+        size_t blocked = 0;
+        if (last_cpu.size() < states_.size()) last_cpu.resize(states_.size(), 0.0);
+        for (size_t i = 0; i < states_.size(); ++i) {
+            auto& state = *states_[i];
+            const bool is_busy = state.busy.load(std::memory_order_relaxed);
+#ifdef __linux__
+            double cpu = last_cpu[i];
+            if (state.clock_ready.load(std::memory_order_acquire)) {
+                timespec ts{};
+                if (clock_gettime(state.cpu_clock, &ts) == 0) {
+                    cpu = static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+                }
+            }
+            const double delta = cpu - last_cpu[i];
+            last_cpu[i] = cpu;
+            if (is_busy) {
+                ++busy;
+                if (delta < interval * 0.5) ++blocked;
+            }
+#else
+            // No per-thread CPU clock: count every busy worker as
+            // runnable, which still corrects oversubscription.
+            if (is_busy) ++busy;
+#endif
+        }
+        const size_t runnable = busy - blocked;
+
+        const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        const size_t floor_limit = adaptive_min_.load(std::memory_order_relaxed);
+        const size_t ceil_limit = adaptive_max_.load(std::memory_order_relaxed);
+        const size_t limit = active_limit_.load(std::memory_order_relaxed);
+
+        size_t next = limit;
+        if (limit < floor_limit) {
+            next = limit + 1; // bounds were raised: grow back one per tick
+        } else if (limit > ceil_limit) {
+            next = limit - 1;
+        } else if (queued_.load(std::memory_order_acquire) > 0 &&
+                   runnable < cores && limit < ceil_limit) {
+            next = limit + 1; // blocked workers leave cores idle: unpark one
+        } else if (runnable > cores && limit > floor_limit) {
+            next = limit - 1; // oversubscribed: park one after its task
+        }
+        if (next == limit) continue;
+
+        active_limit_.store(next, std::memory_order_release);
+        if (next > limit) {
+            if (next > workers_.size()) spawn_worker();
+            { std::lock_guard lock(wake_mutex_); }
+            condition_.notify_all();
+        }
+    }
+}
+
+void ThreadPool::set_affinity(const Affinity policy) {
+    affinity_.store(policy, std::memory_order_relaxed);
+    { std::lock_guard lock(wake_mutex_); }
+    condition_.notify_all();
+}
+
 void ThreadPool::wait_idle() {
-    std::unique_lock lock(queue_mutex_);
+    std::unique_lock lock(idle_mutex_);
     idle_cv_.wait(lock, [this] {
-        return pending_ == 0 && tasks_.empty();
+        return pending_.load(std::memory_order_acquire) == 0;
     });
 }
 
 ThreadPool::~ThreadPool() {
-    {
-        std::unique_lock lock(queue_mutex_);
-        stop_ = true;
-    }
+    stop_.store(true, std::memory_order_relaxed);
+    { std::lock_guard lock(wake_mutex_); }
     condition_.notify_all();
 }
@@ -0,0 +1,143 @@
+//
+// Created by Giuseppe Francione on 01/09/26.
+//
+
+#include "../../include/trace.hpp"
+#include "../../include/logger.hpp"
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/// One completed span as buffered per thread.
+struct Record {
+    std::string name;   ///< Span name
+    std::string path;   ///< Tagged file path
+    uintmax_t size;     ///< Tagged byte size
+    uint64_t ts_us;     ///< Start, microseconds since trace enable
+    uint64_t dur_us;    ///< Duration in microseconds
+};
+
+/// Per-thread span buffer; appended to without locking by its owner.
+struct ThreadBuffer {
+    uint32_t tid;
+    std::vector<Record> records;
+};
+
+struct TraceState {
+    std::atomic<bool> enabled{false};
+    std::filesystem::path output;
+    std::chrono::steady_clock::time_point epoch;
+    std::mutex registry_mtx;  ///< Guards buffers and next_tid
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    uint32_t next_tid = 0;
+};
+
+TraceState& state() {
+    static TraceState s;
+    return s;
+}
+
+// The registry keeps buffers alive past thread exit so write() can
+// still read spans from pool threads that already wound down.
+ThreadBuffer& local_buffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buf = [] {
+        auto b = std::make_shared<ThreadBuffer>();
+        auto& s = state();
+        std::scoped_lock lock(s.registry_mtx);
+        b->tid = s.next_tid++;
+        s.buffers.push_back(b);
+        return b;
+    }();
+    return *buf;
+}
+
+/// Minimal JSON string escaping (quotes, backslashes, control chars).
+std::string json_escape(const std::string& in) {
+    std::string out;
+    out.reserve(in.size() + 2);
+    for (const char c : in) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char hex[8];
+                    std::snprintf(hex, sizeof(hex), "\\u%04x", c);
+                    out += hex;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+void Trace::enable(std::filesystem::path output_path) {
+    auto& s = state();
+    s.output = std::move(output_path);
+    s.epoch = std::chrono::steady_clock::now();
+    s.enabled.store(true, std::memory_order_release);
+}
+
+bool Trace::enabled() noexcept {
+    return state().enabled.load(std::memory_order_relaxed);
+}
+
+bool Trace::write() {
+    auto& s = state();
+    if (!s.enabled.load(std::memory_order_acquire)) return false;
+
+    std::ofstream out(s.output);
+    if (!out) {
+        Logger::log(LogLevel::Error, "Cannot write trace file: " + s.output.string(), "Trace");
+        return false;
+    }
+
+    std::scoped_lock lock(s.registry_mtx);
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto& buf : s.buffers) {
+        for (const auto& r : buf->records) {
+            if (!first) out << ",";
+            first = false;
+            out << "\n{\"name\":\"" << json_escape(r.name)
+                << "\",\"cat\":\"chisel\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buf->tid
+                << ",\"ts\":" << r.ts_us
+                << ",\"dur\":" << r.dur_us
+                << ",\"args\":{\"path\":\"" << json_escape(r.path)
+                << "\",\"size\":" << r.size << "}}";
+        }
+    }
+    out << "\n]}\n";
+    return out.good();
+}
+
+Trace::Span::Span(const std::string_view name, const std::filesystem::path& path, const uintmax_t size) {
+    if (!Trace::enabled()) return;
+    active_ = true;
+    name_ = name;
+    path_ = path.string();
+    size_ = size;
+    start_ = std::chrono::steady_clock::now();
+}
+
+Trace::Span::~Span() {
+    if (!active_) return;
+    const auto end = std::chrono::steady_clock::now();
+    auto& s = state();
+    const auto ts = std::chrono::duration_cast<std::chrono::microseconds>(start_ - s.epoch).count();
+    const auto dur = std::chrono::duration_cast<std::chrono::microseconds>(end - start_).count();
+    local_buffer().records.push_back(Record{
+        std::move(name_), std::move(path_), size_,
+        static_cast<uint64_t>(ts), static_cast<uint64_t>(dur)});
+}